@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Thrown by TaskProgress::checkCancelled to unwind a cancelled task
+struct TaskCancelled : public std::runtime_error
+{
+    TaskCancelled() : std::runtime_error("cancelled") {}
+};
+
+// Progress and cancellation shared between a running task and the console.
+// The task reports work done against a total (0 = unknown) and polls for
+// cancellation at convenient points.
+class TaskProgress
+{
+public:
+    TaskProgress() : done(0), total(0), cancelled(false) {}
+
+    void setTotal(uint64_t units) { total = units; }
+    void setDone(uint64_t units) { done = units; }
+    void advance(uint64_t units = 1) { done += units; }
+    void cancel() { cancelled = true; }
+
+    bool isCancelled() const { return cancelled; }
+    void checkCancelled() const { if (cancelled) throw TaskCancelled(); }
+    uint64_t getDone() const { return done; }
+    uint64_t getTotal() const { return total; }
+    int getPercent() const;     // -1 when the total is unknown
+
+private:
+    std::atomic<uint64_t> done;
+    std::atomic<uint64_t> total;
+    std::atomic<bool> cancelled;
+};
+
+// Runs slow work (saves, loads, summary recomputation) on one worker thread,
+// in submission order, so the menu stays responsive.
+//
+// A task is split in two: work() runs on the worker and must only touch data
+// it owns (snapshots, its own buffers); onComplete() runs later on the
+// console thread, inside runCompletions(), and is where results are applied
+// to shared state. Completions run whether the work finished, failed or was
+// cancelled, so they can report the outcome.
+class BackgroundTasks
+{
+public:
+    enum class State { QUEUED, RUNNING, DONE, CANCELLED, FAILED };
+
+    struct Task
+    {
+        uint64_t id;
+        std::string name;
+        TaskProgress progress;
+        std::atomic<State> state;
+        std::string error;      // Set when FAILED; read only after the state changes
+        std::function<void(TaskProgress&)> work;
+        std::function<void(const Task&)> onComplete;
+
+        Task() : id(0), state(State::QUEUED) {}
+        bool isFinished() const;
+    };
+
+    typedef std::shared_ptr<Task> Handle;
+
+    BackgroundTasks();
+    ~BackgroundTasks();     // Cancels queued tasks and waits for the running one
+
+    BackgroundTasks(const BackgroundTasks&) = delete;
+    BackgroundTasks& operator=(const BackgroundTasks&) = delete;
+
+    Handle submit(const std::string& name, std::function<void(TaskProgress&)> work,
+                  std::function<void(const Task&)> onComplete = std::function<void(const Task&)>());
+
+    // True when the task finished within the timeout
+    bool waitFor(const Handle& task, std::chrono::milliseconds timeout);
+    void waitIdle();
+
+    // Runs the completions of finished tasks on the calling thread; returns how many ran
+    size_t runCompletions();
+
+    std::vector<Handle> getPending() const;    // Queued and running, in order
+    bool isIdle() const;
+    void cancelAll();
+
+    static const char* stateName(State state);
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable wakeWorker;
+    std::condition_variable taskFinished;
+    std::deque<Handle> queue;
+    Handle running;
+    std::vector<Handle> finished;       // Completions not yet run
+    uint64_t nextId;
+    bool stopping;
+    std::thread worker;
+
+    void workerLoop();
+};
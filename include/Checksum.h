@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class Checksum
+{
+public:
+    // CRC-32C (Castagnoli). Pass the previous result as crc to checksum data
+    // that arrives in pieces.
+    static uint32_t crc32c(const void* data, size_t length, uint32_t crc = 0);
+};
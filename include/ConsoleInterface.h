@@ -1,18 +1,68 @@
 #pragma once
+#include "BackgroundTasks.h"
 #include "GamblingSession.h"
+#include "LocationNormalizer.h"
+#include "SessionDatabase.h"
+#include "SessionDeduplicator.h"
+#include "SessionJournal.h"
+#include "SessionPartitions.h"
+#include "SessionTextIndex.h"
+#include "SessionTimeIndex.h"
+#include "StartupScheduler.h"
 #include "TaxCalculator.h"
+#include "TicketBatch.h"
 #include "UserProfile.h"
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
 #include <vector>
 #include <string>
 
 class ConsoleInterface {
 private:
-    std::vector<GamblingSession> sessions;
+    SessionDatabase sessions;                // Slot map: stable IDs, O(1) edit/delete
+    std::vector<TicketBatch> ticketBatches;  // Bulk-entered losing tickets
+    SessionHashIndex sessionIndex;           // Content hashes of everything loaded, for dedup
     TaxCalculator calculator;
+    SessionTimeIndex timeIndex;              // Fenwick trees by day, for date-range summaries
+    SessionPartitions partitions;            // By tax year and state, with zone maps and cached totals
+    SessionTextIndex textIndex;              // Words in location and notes, for Search Sessions
     UserProfile userProfile;
+    std::map<std::string, size_t> unknownGameTypes;  // Spellings not in the game type dictionary -> records
+    LocationNormalizer venues;                       // Fuzzy match to config/venues.cfg; decisions cached
+    size_t locationRewrites;                         // Records whose location was changed to a venue name
+    StartupScheduler startup;  // Loads rules, profile and venues concurrently; after them so it joins first
+    std::unique_ptr<SessionJournal> journal;  // Autosave; null when disabled
+    
+    // Data a background task works on, so later edits can't race it. Sessions
+    // are shared copy-on-write with the database. Ticket batches are copied
+    // once per change to them and the copy is shared by every snapshot taken
+    // until the next change.
+    struct SessionSnapshot
+    {
+        SessionChunks sessions;
+        std::shared_ptr<const std::vector<TicketBatch>> ticketBatches;
+    };
+    
+    // Records parsed off the console thread, admitted when the load completes
+    struct ImportBuffer
+    {
+        std::vector<GamblingSession> sessions;
+        std::vector<TicketBatch> ticketBatches;
+        std::vector<std::string> messages;  // Warnings, printed when the import is applied
+    };
+    
+    uint64_t dataVersion;                            // Bumped on every change to sessions or batches
+    mutable std::shared_ptr<const std::vector<TicketBatch>> sharedBatches;  // For snapshots; reset on every batch change
+    std::shared_ptr<const SessionAggregate> lastTotals;  // Last completed summary aggregate
+    uint64_t lastTotalsVersion;                      // dataVersion lastTotals was computed at
+    BackgroundTasks::Handle summaryTask;             // Recalculation in flight, if any
+    uint64_t summaryTaskVersion;
+    BackgroundTasks tasks;                   // Declared last so it stops before the data its completions touch
     
 public:
-    ConsoleInterface();
+    explicit ConsoleInterface(bool autosave = true);
     
     // Main menu and program flow
     void run();
@@ -24,14 +74,31 @@ public:
     void addBulkLosingSessions();  // For entering lots of losing tickets
     void viewAllSessions();
     void viewSessionSummary();
+    void editSession();
+    void deleteSession();
+    void editTicketBatch();        // Change, trim or delete a bulk-entered batch
     
     // Tax calculations and reports
     void calculateAndShowTaxes();
+    void calculateTaxesFromFile();  // Streams a file through the calculator without loading it
+    void compareTaxScenarios();     // What-if table over filing status, tax year and professional mode
+    void showDateRangeSummary();
+    void showTaxYearSummary();      // One year (and state) from its partitions, pruning the rest
+    void showPivotReport();
+    void showSessionStatistics();
+    void showUnknownGameTypes();
+    void showLocationMatches();
+    void searchSessions();
+    void showBackgroundTasks();     // Progress of saves, loads and recalculations; cancellation
     void showDocumentationReminders();
     
     // Data management
     void saveToFile(const std::string& filename);
-    void loadFromFile(const std::string& filename);
+    void loadFromFile(const std::string& filename, bool merge = false,
+                      DuplicateMode duplicateMode = DuplicateMode::SKIP);
+    void promptAndLoadFromFile(const std::string& filename);
+    void mergeSessionFiles();       // Sorts and merges files from several sources into one by date
+    void exportToJson(const std::string& sessionsFile, const std::string& summaryFile);
     void clearAllSessions();
     
     // Settings
@@ -43,18 +110,41 @@ public:
 private:
     // Input helpers
     std::string getStringInput(const std::string& prompt);
-    std::string getLocationInput(const std::string& prompt);  // Validated location input
+    std::string getLocationInput(const std::string& prompt, bool allowEmpty = false);  // Validated location input
     std::string getDateInput(const std::string& prompt);
+    bool getOptionalDateInput(const std::string& prompt, std::string& date);  // false when left blank
     double getDoubleInput(const std::string& prompt);
     bool getBoolInput(const std::string& prompt);
     std::string getGameType();
+    std::string canonicalGameType(const std::string& gameType);  // Dictionary name; unknown spellings are counted
     std::string getStateCode();
     std::string getCurrentDate();  // Helper for default dates
     bool isValidDate(const std::string& date);  // Validate MM-DD-YYYY format
     bool isValidStateCode(const std::string& stateCode);  // Validate 2-letter state codes
+    SessionId chooseSession(const std::string& action);  // Asks for a session number from "View All Sessions"
     
     // Display helpers
     void clearScreen();
     void pauseForUser();
     void showHeader(const std::string& title);
+    
+    // Autosave helpers
+    void recoverAutosave();
+    void snapshotAutosave();  // After bulk changes (load, clear) a snapshot beats journaling each row
+    
+    // Background work
+    std::shared_ptr<const SessionSnapshot> takeSnapshot() const;
+    void refreshSummary();    // Starts recalculating the summary unless one is already under way
+    bool finishInForeground(const BackgroundTasks::Handle& task, const std::string& pendingMessage);
+    void showTaskProgress(const BackgroundTasks::Task& task);
+    void saveSnapshot(const std::string& filename, const std::shared_ptr<const SessionSnapshot>& snapshot);
+    void applyImport(const std::string& filename, ImportBuffer& import, bool merge, DuplicateMode duplicateMode);
+    
+    // File format helpers (.json is JSON, .gsa the compressed archive, anything else CSV).
+    // These run on the background worker and touch only their arguments
+    static void writeSessionFile(const std::string& filename, const SessionSnapshot& snapshot, TaskProgress& progress);
+    static void writeCSV(std::ostream& file, const SessionSnapshot& snapshot, TaskProgress& progress);
+    static void readSessionFile(const std::string& filename, ImportBuffer& import, TaskProgress& progress);
+    bool admitSession(GamblingSession& session, DuplicateMode duplicateMode, MergeStats& stats);
+    void admitBatch(TicketBatch& batch, DuplicateMode duplicateMode, MergeStats& stats);
 };
\ No newline at end of file
@@ -42,7 +42,6 @@ public:
     double getNetResult() const { return cashOut - buyIn; }
     bool isWin() const { return getNetResult() > 0; }
     bool isLoss() const { return getNetResult() < 0; }
-    bool triggersWithholding() const;  // Based on IRS thresholds
 
     // Setters
     void setDate(const std::string& date) { this->date = date; }
@@ -57,7 +56,9 @@ public:
     void setNotes(const std::string& notes) { this->notes = notes; }
 
     // Utility functions
-    std::string toString() const;
+    // thresholdReached is the calculator's triggersWithholding() for this
+    // session (configured W-2G thresholds); it drives the withholding warning
+    std::string toString(bool thresholdReached) const;
     std::string toCSV() const;
     
     // For file I/O
@@ -65,4 +66,9 @@ public:
 
     // Date validation utility
     static bool isValidDate(const std::string& date);
+
+    // Date arithmetic helpers (days since 01-01-1970, proleptic Gregorian)
+    static long long dateToDayNumber(int year, int month, int day);
+    static long long dateToDayNumber(const std::string& date);  // MM-DD-YYYY; throws std::invalid_argument otherwise
+    static std::string dayNumberToDate(long long dayNumber);
 };
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Canonical game type names and the other spellings that map to them.
+//
+// Matching ignores case and treats spaces, underscores and hyphens alike, so
+// "slot_machine" needs no alias; real alternatives ("Slots", "Scratch-off")
+// come from config/game_types.cfg. Every spelling is compiled into a perfect
+// hash table: a lookup hashes the normalized form of the input as it reads
+// it, probes exactly one slot and compares one key, without allocating.
+class GameTypeDictionary
+{
+public:
+    static const int UNKNOWN = -1;
+
+    GameTypeDictionary();   // Built-in canonical names, no aliases
+
+    // Lines are "Canonical Name = alias, alias, ..."; adds to what is loaded
+    bool load(const std::string& path);
+    bool addAlias(const std::string& canonical, const std::string& alias);  // False if alias names another type
+
+    int find(const std::string& gameType) const;
+    const std::string& getName(int id) const { return names[id]; }
+    size_t getTypeCount() const { return names.size(); }
+    size_t getSpellingCount() const { return entries.size(); }
+
+    // Rewrites gameType to its canonical spelling; false (unchanged) when unknown
+    bool canonicalize(std::string& gameType) const;
+
+    // unknownCounts: raw spelling -> records seen with it
+    std::string generateUnknownReport(const std::map<std::string, size_t>& unknownCounts) const;
+
+    static std::string normalize(const std::string& gameType);
+
+private:
+    std::vector<std::string> names;                    // By id
+    std::vector<std::pair<std::string, int>> entries;  // Normalized spelling -> id
+    std::vector<int32_t> table;                        // Slot -> entry index, -1 empty
+    uint64_t seed;
+    uint64_t mask;
+
+    int addName(const std::string& canonical);
+    bool insertAlias(const std::string& canonical, const std::string& alias);
+    int findEntry(const std::string& normalized) const;
+    void compile();
+    uint64_t hash(const std::string& gameType, uint64_t hashSeed) const;
+};
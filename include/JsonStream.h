@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Minimal streaming JSON writer. Output is buffered in fixed-size blocks and
+// nesting state is one flag per open container, so memory use does not grow
+// with the number of elements written.
+class JsonWriter
+{
+private:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    std::ostream& out;
+    std::string buffer;
+    std::vector<bool> needsComma;   // One entry per open object/array
+    bool afterKey;
+
+    void separator();
+    void appendEscaped(const std::string& text);
+    void flushIfFull();
+
+public:
+    explicit JsonWriter(std::ostream& out);
+    ~JsonWriter();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(const std::string& name);
+
+    void value(const std::string& text);
+    void value(const char* text);
+    void value(double number);
+    void value(long long number);
+    void value(bool flag);
+    void nullValue();
+    void moneyValue(double amount);   // Written with exactly two decimals
+
+    void flush();
+};
+
+// Callbacks for JsonReader. Values arrive in document order; nothing is
+// retained by the reader once a callback returns.
+class JsonHandler
+{
+public:
+    virtual ~JsonHandler() {}
+
+    virtual void startObject() {}
+    virtual void endObject() {}
+    virtual void startArray() {}
+    virtual void endArray() {}
+    virtual void key(const std::string& name) { (void)name; }
+    virtual void stringValue(const std::string& text) { (void)text; }
+    virtual void numberValue(double number) { (void)number; }
+    virtual void boolValue(bool flag) { (void)flag; }
+    virtual void nullValue() {}
+};
+
+// SAX-style JSON reader. Reads the stream in fixed-size chunks and never builds
+// a document tree; throws std::runtime_error on malformed input.
+class JsonReader
+{
+private:
+    static const size_t CHUNK_SIZE = 1 << 16;
+    static const size_t MAX_DEPTH = 64;
+
+    std::istream& in;
+    std::vector<char> chunk;
+    size_t position;
+    size_t available;
+    uint64_t consumed;      // Bytes before the current chunk, for error messages
+    std::string token;      // Reused scratch buffer for strings and numbers
+
+    bool fill();
+    int peek();
+    int get();
+    void skipWhitespace();
+    void expect(const char* literal);
+    [[noreturn]] void fail(const std::string& message);
+
+    void parseValue(JsonHandler& handler, size_t depth);
+    void parseObject(JsonHandler& handler, size_t depth);
+    void parseArray(JsonHandler& handler, size_t depth);
+    void parseString();
+    void parseNumber();
+    void appendUtf8(uint32_t codePoint);
+
+public:
+    explicit JsonReader(std::istream& in);
+
+    // Parses one complete JSON value from the stream
+    void parse(JsonHandler& handler);
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Maps the many spellings of a venue ("BELLAGIO LAS VEGAS", "Bellagio LV",
+// "Belagio") to one canonical name from config/venues.cfg.
+//
+// Locations are folded (lower case, punctuation to spaces) and matched in
+// three steps: an exact lookup of the folded text; a trigram index that
+// keeps only venues sharing enough trigrams to be within the allowed number
+// of edits (q-gram lemma); and Myers' bit-parallel edit distance, which
+// finds the best approximate occurrence of each candidate name as a run of
+// whole words of the location, so "Circadian Lounge" is not "Circa". Names
+// under six characters or with a one- or two-letter word ("Parx",
+// "Hard Rock AC") only match the whole location exactly. Decisions are
+// cached per raw spelling, so an import pays for each distinct location once.
+class LocationNormalizer
+{
+public:
+    static const int NO_MATCH = -1;
+
+    LocationNormalizer();
+
+    // Lines are "Canonical Venue = alias, alias, ..."; adds to what is loaded
+    bool load(const std::string& path);
+    void addVenue(const std::string& name, const std::vector<std::string>& aliases = std::vector<std::string>());
+
+    int match(const std::string& location);       // Venue id or NO_MATCH; cached
+    bool normalize(std::string& location);        // Rewrites to the venue name; false when nothing matched
+
+    size_t getVenueCount() const { return venues.size(); }
+    const std::string& getVenueName(int id) const { return venues[id]; }
+    size_t getCachedCount() const { return decisions.size(); }
+    void clearCache() { decisions.clear(); }
+
+    // Every distinct spelling rewritten so far, with how often it was seen
+    std::string generateReport() const;
+
+    // Fewest edits turning pattern into text (substring = false) or into any
+    // substring of text (substring = true). Patterns longer than 64 characters
+    // are compared on their first 64.
+    static int editDistance(const std::string& pattern, const std::string& text, bool substring);
+    // Fewest edits turning pattern into a run of whole words of text
+    static int wordDistance(const std::string& pattern, const std::string& text);
+    static std::string fold(const std::string& location);
+
+private:
+    struct Pattern
+    {
+        std::string folded;
+        int venue;
+        bool fuzzy;         // False for names that must match exactly
+    };
+
+    struct Decision
+    {
+        int venue;
+        size_t uses;
+    };
+
+    std::vector<std::string> venues;                                // By id
+    std::vector<Pattern> patterns;                                  // Names and aliases, folded
+    std::unordered_map<std::string, int> exact;                     // Folded spelling -> venue
+    std::unordered_map<std::string, Decision> decisions;            // Raw location -> outcome
+
+    // Trigram index in compressed rows: the patterns containing trigram g are
+    // postings[postingStart[g] .. postingStart[g + 1]). Rebuilt after venues change.
+    std::vector<std::pair<uint32_t, uint32_t>> gramPatterns;        // (trigram, pattern) as added
+    std::vector<uint32_t> postingStart;
+    std::vector<uint32_t> postings;
+    std::vector<int32_t> sharedNeeded;      // Uncommon trigrams a pattern must share to be checked
+    std::vector<uint32_t> alwaysCheck;      // Patterns that pass the filter on common trigrams alone
+    size_t commonLimit;                     // Postings longer than this are not walked
+    bool indexDirty;
+
+    std::vector<uint32_t> sharedCounts;     // Scratch for candidate counting
+    std::vector<uint32_t> gramScratch;
+    std::vector<uint32_t> candidates;
+
+    void addPattern(const std::string& text, int venue);
+    void refreshIndex();
+    int search(const std::string& folded);
+    static int allowedEdits(size_t length);
+    static void trigramsOf(const std::string& folded, std::vector<uint32_t>& grams);
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Opt-in heap accounting per subsystem. Build with -DENABLE_MEMORY_ACCOUNTING=ON to
+// replace the global operator new/delete with counting versions; allocations are
+// attributed to whichever MEMORY_SCOPE tag is active on the allocating thread.
+
+enum class MemoryTag : uint8_t
+{
+    UNTAGGED,
+    SESSION_STORAGE,
+    RULES,
+    SUMMARY,
+    REPORTS,
+    IMPORT_BUFFERS,
+    COUNT
+};
+
+struct MemoryStats
+{
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t bytesAllocated;
+    uint64_t liveBytes;
+    uint64_t peakLiveBytes;
+};
+
+class MemoryAccounting
+{
+public:
+    static bool isCompiledIn();
+
+    static MemoryTag currentTag();
+    static MemoryTag exchangeTag(MemoryTag tag);   // Returns the previous tag
+
+    static MemoryStats getStats(MemoryTag tag);
+    static MemoryStats getTotalStats();
+    static const char* tagName(MemoryTag tag);
+    static bool parseTag(const std::string& name, MemoryTag& tag);
+
+    // Formatted table of every subsystem (for --mem-report)
+    static std::string generateReport();
+
+    // Benchmark assertion hook: false (with a message) if the tag's peak exceeded the budget
+    static bool checkBudget(MemoryTag tag, uint64_t maxPeakBytes, std::string& message);
+
+    // Hooks used by the replacement allocator
+    static void recordAllocation(MemoryTag tag, uint64_t bytes);
+    static void recordDeallocation(MemoryTag tag, uint64_t bytes);
+};
+
+class MemoryScope
+{
+private:
+    MemoryTag previous;
+
+public:
+    explicit MemoryScope(MemoryTag tag) : previous(MemoryAccounting::exchangeTag(tag)) {}
+    ~MemoryScope() { MemoryAccounting::exchangeTag(previous); }
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+};
+
+#ifdef GAMBLING_MEMORY_ACCOUNTING
+#define MEMORY_CONCAT_INNER(a, b) a##b
+#define MEMORY_CONCAT(a, b) MEMORY_CONCAT_INNER(a, b)
+#define MEMORY_SCOPE(tag) MemoryScope MEMORY_CONCAT(memoryScope_, __LINE__)(tag)
+#else
+#define MEMORY_SCOPE(tag) ((void)0)
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+#include "GamblingSession.h"
+#include "SessionChunks.h"
+#include "TicketBatch.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class PivotKey
+{
+    STATE,
+    GAME_TYPE,
+    LOCATION,
+    YEAR,       // YYYY
+    MONTH,      // YYYY-MM, sorts chronologically
+    DATE        // YYYY-MM-DD, one group per session day (IRS session method)
+};
+
+enum class PivotMeasure
+{
+    WINNINGS,   // Sum of winning results
+    LOSSES,     // Sum of losing results (positive)
+    NET,        // Sum of net results
+    COUNT,      // Records in the group
+    MAX_WIN,
+    MAX_LOSS
+};
+
+struct PivotQuery
+{
+    std::vector<PivotKey> keys;
+    std::vector<PivotMeasure> measures;
+
+    PivotQuery() {}
+    PivotQuery(const std::vector<PivotKey>& keys, const std::vector<PivotMeasure>& measures)
+        : keys(keys), measures(measures) {}
+};
+
+struct PivotRow
+{
+    std::vector<std::string> key;   // One value per query key
+    std::vector<double> values;     // One value per query measure
+};
+
+struct PivotResult
+{
+    PivotQuery query;
+    std::vector<PivotRow> rows;     // Sorted by key
+    PivotRow total;                 // Every record, key left empty
+};
+
+// Generic group-by over sessions and ticket batches.
+//
+// Aggregation is a two-phase partitioned hash group-by: each worker thread
+// scans a contiguous slice of the input and aggregates into one hash table
+// per partition (chosen by key hash); then each worker merges one partition
+// across all workers. No locks are taken and no partition is touched by two
+// threads in the same phase. A ticket batch counts as one losing record of
+// its total.
+class PivotEngine
+{
+public:
+    // threads = 0 uses std::thread::hardware_concurrency()
+    static PivotResult run(const std::vector<GamblingSession>& sessions,
+                           const std::vector<TicketBatch>& ticketBatches,
+                           const PivotQuery& query, unsigned threads = 0);
+    static PivotResult run(const SessionChunks& sessions, const std::vector<TicketBatch>& ticketBatches,
+                           const PivotQuery& query, unsigned threads = 0);
+
+    static std::string generateReport(const PivotResult& result);
+    static void writeCSV(std::ostream& out, const PivotResult& result);
+
+    static std::string keyName(PivotKey key);
+    static std::string measureName(PivotMeasure measure);
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include "SessionAggregate.h"
+#include "TaxCalculator.h"
+#include "UserProfile.h"
+#include <string>
+#include <vector>
+
+// One "what if" rule set to evaluate against the same sessions
+struct TaxScenario
+{
+    std::string name;
+    int taxYear;
+    bool professional;
+    FilingStatus filingStatus;
+    double lossDeductionLimit;  // < 0 = use the limit for taxYear
+
+    TaxScenario() : taxYear(2024), professional(false), filingStatus(FilingStatus::SINGLE),
+                    lossDeductionLimit(-1.0) {}
+};
+
+struct ScenarioResult
+{
+    std::string name;
+    int taxYear;
+    bool professional;
+    FilingStatus filingStatus;
+    double lossDeductionLimit;
+
+    double deductibleLosses;        // Losses allowed by the limit, capped at winnings
+    double standardDeduction;
+    bool itemize;                   // Casual gamblers only benefit when itemizing
+    double effectiveLossDeduction;  // Reduction of taxable income attributable to losses
+    double netTaxableGambling;      // Winnings minus effectiveLossDeduction
+    double federalTax;              // Brackets for the scenario's year and status, after the standard deduction
+    double marginalRate;
+    double stateTax;                // Same for every scenario (computed at the calculator's filing status)
+};
+
+// Evaluates many rule sets against one SessionAggregate. The sessions are
+// summed once; each scenario then costs a handful of arithmetic operations,
+// done column-wise over all scenarios at once.
+//
+// The model is deliberately simple: a casual gambler's losses only help to
+// the extent that itemizing beats the standard deduction (ignoring any other
+// itemized deductions), while a professional deducts them on Schedule C.
+class ScenarioEngine
+{
+public:
+    explicit ScenarioEngine(const TaxCalculator& calculator);
+
+    std::vector<ScenarioResult> evaluate(const SessionAggregate& totals,
+                                         const std::vector<TaxScenario>& scenarios) const;
+
+    // Every filing status, casual and professional, for baseYear and the first
+    // year under the 90% loss limit
+    static std::vector<TaxScenario> standardSweep(int baseYear);
+
+    static std::string generateComparisonTable(const std::vector<ScenarioResult>& results);
+    static std::string filingStatusLabel(FilingStatus status);
+
+private:
+    const TaxCalculator& calculator;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include "GamblingSession.h"
+#include "TicketBatch.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+struct StateTotals
+{
+    double winnings;
+    double losses;
+
+    StateTotals() : winnings(0.0), losses(0.0) {}
+};
+
+// Raw sums over a set of sessions: everything TaxCalculator needs to build a
+// TaxSummary without looking at individual sessions again. Aggregates can be
+// built incrementally and merged, so callers can compute them once and
+// evaluate many rule sets (or many partitions) against them.
+class SessionAggregate
+{
+public:
+    double totalWinnings;
+    double totalLosses;
+    double totalWithheld;
+    size_t sessionCount;
+    size_t ticketCount;
+
+    std::map<std::string, StateTotals> states;
+
+    // States in order of their first winning session; drives the per-state reminders
+    std::vector<std::string> winningStates;
+
+    // A win at or above its W-2G threshold was recorded without tax withheld
+    bool missedWithholding;
+
+    SessionAggregate();
+
+    // thresholdReached is the calculator's triggersWithholding() for this session
+    void addSession(const GamblingSession& session, bool thresholdReached);
+    void addBatch(const TicketBatch& batch);
+    
+    // For callers that already hold per-state sums (e.g. range queries)
+    void addStateTotals(const std::string& state, double winnings, double losses);
+
+    // Folds in sessions that come after this aggregate's (order matters only for winningStates)
+    void merge(const SessionAggregate& other);
+
+    bool isEmpty() const { return sessionCount == 0 && ticketCount == 0; }
+
+private:
+    std::set<std::string> winningStateSet;
+};
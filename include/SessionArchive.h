@@ -0,0 +1,108 @@
+#pragma once
+#include "GamblingSession.h"
+#include "TicketBatch.h"
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Columns of the archive format. Session blocks hold DATE..NOTES, ticket
+// batch blocks hold DATE..GAME_TYPE plus TICKET_COUNT and TICKET_AMOUNTS.
+enum class ArchiveColumn : uint8_t
+{
+    DATE,
+    LOCATION,
+    STATE,
+    GAME_TYPE,
+    BUY_IN,
+    CASH_OUT,
+    TAX_WITHHELD,
+    WITHHELD_AMOUNT,
+    DOCUMENTATION_NOTE,
+    NOTES,
+    TICKET_COUNT,
+    TICKET_AMOUNTS,
+    COUNT
+};
+
+// Compressed columnar archive for long session histories (.gsa files).
+//
+// The file is a sequence of independent blocks of up to blockRows records.
+// Inside a block every column is stored separately with its own CRC32C:
+//   - strings are dictionary encoded (per-block dictionary + integer codes)
+//   - dates become day numbers, stored as the first value plus deltas
+//   - amounts become integer cents
+// and every integer sequence is written either as varints or bit-packed
+// frame-of-reference (minimum + fixed bit width), whichever is smaller.
+// Blocks start with a checksummed column directory, so a reader can skip
+// straight past columns it does not need.
+class ArchiveWriter
+{
+public:
+    static const size_t DEFAULT_BLOCK_ROWS = 65536;
+
+    explicit ArchiveWriter(std::ostream& out, size_t blockRows = DEFAULT_BLOCK_ROWS);
+    ~ArchiveWriter();
+
+    ArchiveWriter(const ArchiveWriter&) = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+    void add(const GamblingSession& session);
+    void add(const TicketBatch& batch);
+
+    // Flushes pending rows and writes the end marker; called by the destructor if needed
+    void finish();
+
+    uint64_t getSessionCount() const { return sessionCount; }
+    uint64_t getBatchCount() const { return batchCount; }
+
+private:
+    std::ostream& out;
+    size_t blockRows;
+    bool finished;
+    uint64_t sessionCount;
+    uint64_t batchCount;
+
+    // Pending session rows, column by column
+    std::vector<std::string> sessionText[4];    // DATE, LOCATION, STATE, GAME_TYPE
+    std::vector<std::string> sessionNotes[2];   // DOCUMENTATION_NOTE, NOTES
+    std::vector<int64_t> sessionAmounts[3];     // BUY_IN, CASH_OUT, WITHHELD_AMOUNT (cents)
+    std::vector<int64_t> sessionWithheld;
+    size_t pendingSessions;
+
+    // Pending ticket batches
+    std::vector<std::string> batchText[4];
+    std::vector<int64_t> batchCounts;
+    std::vector<int64_t> batchTickets;
+    size_t pendingBatches;
+
+    void flushSessions();
+    void flushBatches();
+};
+
+class ArchiveReader
+{
+public:
+    typedef std::function<void(GamblingSession&)> SessionCallback;
+    typedef std::function<void(TicketBatch&)> BatchCallback;
+
+    // Reads and checks the file header; throws std::runtime_error if it is not an archive
+    explicit ArchiveReader(std::istream& in);
+
+    // Decodes every record, one block at a time. Throws std::runtime_error on a
+    // checksum mismatch or truncated file.
+    void read(const SessionCallback& onSession, const BatchCallback& onBatch);
+
+    // Decodes a single integer column of every session block (dates as day
+    // numbers, amounts in cents, TAX_WITHHELD as 0/1) without touching the
+    // others. onBlock receives one vector per block.
+    void scanColumn(ArchiveColumn column, const std::function<void(const std::vector<int64_t>&)>& onBlock);
+
+    static bool isArchive(std::istream& in);    // Peeks at the magic bytes
+
+private:
+    std::istream& in;
+    std::streampos dataStart;   // First block; each pass starts here
+};
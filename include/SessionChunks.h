@@ -0,0 +1,100 @@
+#pragma once
+#include "GamblingSession.h"
+#include "SessionAggregate.h"
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+class TaxCalculator;
+
+// Persistent (structurally shared) list of sessions: fixed-size chunks behind
+// shared pointers, held by a shared chunk table. Copying a list copies one
+// pointer, so snapshots are O(1) however many sessions there are. A write
+// clones the chunk table and the one chunk it changes only while another
+// copy still holds them; an unshared list is changed in place. Every copy
+// keeps seeing the sessions it was taken with.
+//
+// Each chunk caches its SessionAggregate, keyed by the rules version it was
+// built under (TaxRulesConfig::getRulesVersion). A shared chunk never
+// changes, so a cache filled through one copy serves every copy that still
+// holds the chunk: after an edit, aggregating the new snapshot re-aggregates
+// the changed chunk and merges the rest.
+class SessionChunks
+{
+public:
+    static const size_t CHUNK_SIZE = 1024;
+
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef GamblingSession value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const GamblingSession* pointer;
+        typedef const GamblingSession& reference;
+
+        const_iterator(const SessionChunks* list, size_t position) : list(list), position(position) {}
+        reference operator*() const { return (*list)[position]; }
+        pointer operator->() const { return &(*list)[position]; }
+        const_iterator& operator++() { position++; return *this; }
+        bool operator==(const const_iterator& other) const { return position == other.position; }
+        bool operator!=(const const_iterator& other) const { return position != other.position; }
+
+    private:
+        const SessionChunks* list;
+        size_t position;
+    };
+
+    SessionChunks();
+
+    size_t size() const { return table->size; }
+    bool empty() const { return table->size == 0; }
+    const GamblingSession& operator[](size_t position) const
+    {
+        return table->chunks[position / CHUNK_SIZE]->sessions[position % CHUNK_SIZE];
+    }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, table->size); }
+
+    void pushBack(GamblingSession&& session);
+    void set(size_t position, const GamblingSession& session);
+    void popBack();
+    void swapRemove(size_t position);   // Moves the last session into position, then drops the last
+    void clear();
+
+    // Chunks this list shares with another copy, for reporting how much a snapshot costs
+    size_t sharedChunks(const SessionChunks& other) const;
+    size_t chunkCount() const { return table->chunks.size(); }
+
+    // The same records as calculator.aggregate() over the sessions in order,
+    // but summed chunk by chunk, so the dollar totals can differ from it in
+    // the last bits of floating-point rounding
+    SessionAggregate aggregate(const TaxCalculator& calculator) const;
+
+private:
+    struct CachedTotals
+    {
+        uint64_t rulesVersion;
+        SessionAggregate totals;
+    };
+
+    struct Chunk
+    {
+        std::vector<GamblingSession> sessions;
+        mutable std::shared_ptr<const CachedTotals> cached;   // Read and written with std::atomic_load/store
+    };
+
+    struct Table
+    {
+        std::vector<std::shared_ptr<Chunk>> chunks;     // All full but the last
+        size_t size;
+
+        Table() : size(0) {}
+    };
+
+    std::shared_ptr<Table> table;
+
+    Table& writableTable();
+    Chunk& writableChunk(size_t index);
+};
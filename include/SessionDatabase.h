@@ -0,0 +1,84 @@
+#pragma once
+#include "GamblingSession.h"
+#include "SessionChunks.h"
+#include <cstdint>
+#include <vector>
+
+// Stable handle to a session. The generation changes every time a slot is
+// reused, so an ID kept after its session was deleted never resolves to the
+// session that replaced it.
+struct SessionId
+{
+    uint32_t slot;
+    uint32_t generation;    // 0 = never valid
+
+    SessionId() : slot(0), generation(0) {}
+    SessionId(uint32_t slot, uint32_t generation) : slot(slot), generation(generation) {}
+
+    bool isValid() const { return generation != 0; }
+    bool operator==(const SessionId& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const SessionId& other) const { return !(*this == other); }
+
+    // Packed form for indexes and files
+    uint64_t toInteger() const { return (static_cast<uint64_t>(generation) << 32) | slot; }
+    static SessionId fromInteger(uint64_t value)
+    {
+        return SessionId(static_cast<uint32_t>(value), static_cast<uint32_t>(value >> 32));
+    }
+};
+
+// Slot map of sessions. Sessions live in a dense, hole-free list and are
+// addressed through an indirection table of slots. Insert, erase and lookup
+// by ID are O(1); erase moves the last session into the freed position, so
+// dense positions (display numbers) are not stable but IDs are.
+//
+// The dense list is a SessionChunks, the only copy of the sessions, so
+// snapshot() hands out the current sessions in O(1) for background work and
+// what-if copies; only the chunks written after a snapshot are copied.
+class SessionDatabase
+{
+private:
+    struct Slot
+    {
+        uint32_t target;        // Dense index while occupied, next free slot while free
+        uint32_t generation;    // Odd while occupied, even while free
+    };
+
+    static const uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+    SessionChunks dense;                // Shared with snapshots
+    std::vector<uint32_t> denseToSlot;  // Owning slot of each dense element
+    std::vector<Slot> slots;
+    uint32_t freeHead;
+    bool freeListStale;     // Set by insertWithId, which bypasses the free list
+
+    const Slot* resolve(SessionId id) const;
+    void rebuildFreeList();
+
+public:
+    SessionDatabase();
+
+    SessionId insert(const GamblingSession& session);
+    SessionId insert(GamblingSession&& session);
+    bool erase(SessionId id);           // False if the ID is stale or invalid
+    bool insertWithId(SessionId id, GamblingSession&& session);  // For journal replay; false if the slot is taken
+    bool update(SessionId id, const GamblingSession& session);
+
+    bool contains(SessionId id) const { return resolve(id) != nullptr; }
+    const GamblingSession* find(SessionId id) const;   // Read-only: changes go through update()
+
+    // Dense access, in storage order
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+    const GamblingSession& operator[](size_t position) const { return dense[position]; }
+    SessionId idAt(size_t position) const;
+    size_t positionOf(SessionId id) const;  // Dense position of a live ID; size() if stale or invalid
+    const SessionChunks& sessions() const { return dense; }
+    SessionChunks snapshot() const { return dense; }    // O(1); unaffected by later changes
+
+    SessionChunks::const_iterator begin() const { return dense.begin(); }
+    SessionChunks::const_iterator end() const { return dense.end(); }
+
+    void reserve(size_t count);
+    void clear();   // Invalidates every ID handed out so far
+};
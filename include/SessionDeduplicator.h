@@ -0,0 +1,100 @@
+#pragma once
+#include "GamblingSession.h"
+#include "TicketBatch.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How an incoming session that matches one already loaded is handled
+enum class DuplicateMode
+{
+    SKIP,   // Drop the duplicate
+    FLAG,   // Keep it, but mark its notes so it can be reviewed
+    KEEP    // Keep it unchanged (only counted)
+};
+
+struct MergeStats
+{
+    size_t added;
+    size_t skipped;
+    size_t flagged;
+
+    MergeStats() : added(0), skipped(0), flagged(0) {}
+};
+
+// Cache-blocked Bloom filter over precomputed 64-bit hashes: all probe bits for
+// a key live in one 64-byte block, so a lookup costs a single cache miss
+class BloomFilter
+{
+private:
+    static const int PROBE_COUNT = 8;
+
+    std::vector<uint64_t> bits;     // 8 words (512 bits) per block
+    uint64_t blockMask;
+
+public:
+    explicit BloomFilter(size_t expectedItems = 1024);
+
+    void add(uint64_t hash);
+    bool mayContain(uint64_t hash) const;
+    void clear();
+};
+
+// Content-hash index of every session loaded so far. It is a multiset: two
+// identical $5 losing tickets are legitimately two sessions, so an import only
+// counts as duplicating as many copies as were loaded before it started.
+// Lookups go through a Bloom filter first, so the common case on large imports
+// (a brand-new session) never probes the full hash table.
+class SessionHashIndex
+{
+private:
+    struct Entry
+    {
+        uint64_t hash;      // 0 = empty slot
+        uint32_t count;     // Sessions currently stored with this hash
+        uint32_t epoch;     // Import the two counters below belong to
+        uint32_t matched;   // Incoming copies already matched during that import
+        uint32_t added;     // Copies added during that import
+    };
+
+    static const double MAX_LOAD_FACTOR;   // Kept low: linear probing degrades quickly past ~0.7
+
+    BloomFilter bloom;
+    size_t bloomCapacity;
+    std::vector<Entry> slots;   // Open addressing with linear probing
+    size_t entryCount;
+    size_t sessionCount;
+    uint32_t importEpoch;
+
+    Entry* findEntry(uint64_t hash);
+    const Entry* findEntry(uint64_t hash) const;
+    Entry& findOrCreateEntry(uint64_t hash);
+    void growTable();
+    void rebuildBloom(size_t capacity);
+    bool admitHash(uint64_t hash, DuplicateMode mode, MergeStats& stats);
+
+public:
+    static const char* const DUPLICATE_NOTE;
+
+    explicit SessionHashIndex(size_t expectedSessions = 1024);
+
+    // 64-bit hash over normalized date, location, state, game type and amounts.
+    // Notes are ignored so the same session exported by two sources still matches.
+    static uint64_t hashSession(const GamblingSession& session);
+    static uint64_t hashBatch(const TicketBatch& batch);
+
+    uint32_t count(uint64_t hash) const;
+    uint32_t add(uint64_t hash);    // Returns how many copies were already present
+    void remove(uint64_t hash);
+
+    void reserve(size_t expectedSessions);
+    void clear();
+    size_t size() const { return sessionCount; }
+
+    // Starts a new import; admit() judges duplicates against what was loaded before this
+    void beginImport();
+
+    // Decides whether an incoming session should be appended; flags it in FLAG mode
+    bool admit(GamblingSession& session, DuplicateMode mode, MergeStats& stats);
+    bool admit(const TicketBatch& batch, DuplicateMode mode, MergeStats& stats);
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include "BackgroundTasks.h"
+#include "GamblingSession.h"
+#include "TicketBatch.h"
+#include <functional>
+#include <istream>
+#include <string>
+
+// Reads a session file record by record: .json is JSON, .gsa the compressed
+// archive, anything else CSV. Each record goes to a callback as soon as it
+// is parsed, so callers decide what to keep (everything, for a load; running
+// totals, for a streaming calculation).
+//
+// Progress is reported in bytes read; cancellation is checked every few
+// thousand records and unwinds with TaskCancelled. A record that can't be
+// used (a bad CSV line, a JSON record missing fields) goes to onWarning and
+// reading continues. A file that can't be opened, a malformed or truncated
+// JSON document and a damaged archive throw std::runtime_error; whatever
+// the callbacks throw propagates too. A caller never mistakes part of a
+// file for all of it.
+class SessionFileReader
+{
+public:
+    typedef std::function<void(GamblingSession&)> SessionCallback;
+    typedef std::function<void(TicketBatch&)> BatchCallback;
+    typedef std::function<void(const std::string&)> WarningCallback;
+
+    static const char* const CSV_HEADER;    // First line of a session CSV, without the newline
+
+    static void read(const std::string& filename, const SessionCallback& onSession, const BatchCallback& onBatch,
+                     const WarningCallback& onWarning, TaskProgress& progress);
+
+    static bool hasExtension(const std::string& filename, const std::string& extension);  // Case-insensitive
+
+private:
+    static void readCSV(std::istream& file, const SessionCallback& onSession, const BatchCallback& onBatch,
+                        const WarningCallback& onWarning, TaskProgress& progress);
+    static void readJson(std::istream& file, const SessionCallback& onSession, const BatchCallback& onBatch,
+                         const WarningCallback& onWarning, TaskProgress& progress);
+    static void readArchive(std::istream& file, const SessionCallback& onSession, const BatchCallback& onBatch,
+                            TaskProgress& progress);
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include "TaxRulesConfig.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class GeneratorProfile
+{
+    CASUAL,
+    PROFESSIONAL,
+    LOTTERY_POOL
+};
+
+struct GeneratorOptions
+{
+    uint64_t seed;
+    uint64_t rowCount;
+    int startYear;
+    int endYear;
+    GeneratorProfile profile;
+    bool chronological;     // false = dates scattered across the span (unsorted files)
+
+    GeneratorOptions() : seed(1), rowCount(1000), startYear(2019), endYear(2025),
+                         profile(GeneratorProfile::CASUAL), chronological(true) {}
+};
+
+// Deterministic xoshiro256** generator. std::mt19937 would do, but the standard
+// distributions differ between library vendors and we want the same file for the
+// same seed on every platform.
+class GeneratorRandom
+{
+private:
+    uint64_t state[4];
+
+public:
+    explicit GeneratorRandom(uint64_t seed);
+
+    uint64_t next();
+    double uniform();                                   // [0, 1)
+    uint64_t below(uint64_t bound);                     // [0, bound)
+    double pareto(double scale, double alpha);          // heavy-tailed, >= scale
+    double logNormal(double median, double sigma);
+};
+
+// Streams synthetic gambling sessions in the same CSV layout as
+// ConsoleInterface::saveToFile. Nothing is buffered beyond one output block,
+// so row counts are limited only by disk space.
+class SessionGenerator
+{
+private:
+    struct GameChoice
+    {
+        std::string gameType;
+        double withholdingThreshold;   // 0 = never triggers a W-2G
+    };
+
+    GeneratorOptions options;
+    GeneratorRandom random;
+    std::vector<std::string> states;
+    std::vector<double> stateWeights;  // cumulative, skewed toward gambling-heavy states
+    std::vector<GameChoice> games;
+    std::vector<double> gameWeights;   // cumulative, depends on profile
+    std::string homeState;
+    int64_t firstDay;
+    int64_t dayCount;
+    int64_t cachedDayOffset;
+    std::string cachedDate;
+
+    std::string buffer;
+    uint64_t rowsWritten;
+
+    void buildStateTable();
+    void buildGameTable(const FederalTaxRules& rules);
+    size_t pickWeighted(const std::vector<double>& cumulative);
+
+    std::string pickState();
+    std::string pickLocation(const std::string& state, const std::string& gameType);
+    std::string dateForRow(uint64_t row);
+
+    void writeSession(std::ostream& out, const std::string& date, const std::string& location,
+                      const std::string& state, const std::string& gameType,
+                      double buyIn, double cashOut, double withheld,
+                      const std::string& documentationNote, const std::string& notes);
+    void appendAmount(double amount);
+    void flushIfFull(std::ostream& out);
+
+    void emitRegularSession(std::ostream& out, const std::string& date);
+    void emitW2GWin(std::ostream& out, const std::string& date);
+    void emitBulkLosingCluster(std::ostream& out, const std::string& date, uint64_t maxRows);
+
+public:
+    SessionGenerator(const GeneratorOptions& options, const FederalTaxRules& rules);
+
+    // Writes the CSV header followed by options.rowCount rows; returns rows written
+    uint64_t generate(std::ostream& out);
+
+    static bool parseProfile(const std::string& name, GeneratorProfile& profile);
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include "GamblingSession.h"
+#include "SessionDatabase.h"
+#include "TicketBatch.h"
+#include <chrono>
+#include <cstdio>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Write-ahead journal for the working set of sessions. Every change is
+// appended as one checksummed line, so durability costs a small append
+// instead of rewriting the whole session file. Appends are fsync'd in
+// batches; the journal is periodically compacted into a snapshot.
+//
+// Files (base path + extension):
+//   .snapshot  "S <epoch>" header, then one ADD/BATCH record per live entry
+//   .journal   "J <epoch>" header, then changes made since that snapshot
+// Sessions are addressed by SessionId, ticket batches by list position.
+// Each line is "<crc32c hex> <record>". Recovery replays the snapshot, then the
+// journal if its epoch matches, stopping at the first torn or corrupt line.
+class SessionJournal
+{
+public:
+    struct RecoveryStats
+    {
+        size_t snapshotRecords;
+        size_t journalRecords;
+        bool tornTail;          // Journal ended in a partial or corrupt record
+
+        RecoveryStats() : snapshotRecords(0), journalRecords(0), tornTail(false) {}
+    };
+
+    static const size_t SYNC_BATCH = 32;                // Records per fsync while appending
+    static const size_t MIN_COMPACT_RECORDS = 10000;    // Journal length before compaction is considered
+
+    explicit SessionJournal(const std::string& basePath);
+    ~SessionJournal();
+
+    SessionJournal(const SessionJournal&) = delete;
+    SessionJournal& operator=(const SessionJournal&) = delete;
+
+    // Rebuilds state from snapshot + journal and opens the journal for appending.
+    // Returns false when there was nothing to recover.
+    bool recover(SessionDatabase& sessions, std::vector<TicketBatch>& ticketBatches, RecoveryStats& stats);
+
+    void logAdd(SessionId id, const GamblingSession& session);
+    void logUpdate(SessionId id, const GamblingSession& session);
+    void logDelete(SessionId id);
+    void logBatch(const TicketBatch& batch);
+    void logBatchUpdate(size_t index, const TicketBatch& batch);   // index = position in the batch list
+    void logBatchDelete(size_t index);                             // Later batches move up one
+
+    // Flushes and fsyncs anything appended since the last sync
+    void sync();
+
+    // True once the journal has grown large relative to the live data, so
+    // compaction cost stays amortized O(1) per change
+    bool shouldCompact(size_t liveRecords) const;
+
+    // Writes a fresh snapshot (temp file + rename) and starts an empty journal
+    bool compact(const SessionDatabase& sessions, const std::vector<TicketBatch>& ticketBatches);
+
+    bool isOpen() const { return file != nullptr; }
+    const std::string& getJournalPath() const { return journalPath; }
+
+private:
+    std::string journalPath;
+    std::string snapshotPath;
+    std::FILE* file;
+    uint64_t epoch;
+    size_t recordCount;         // Records in the journal since the last snapshot
+    size_t pendingSync;
+    std::chrono::steady_clock::time_point lastSync;
+    std::string line;           // Scratch buffer for formatting records
+
+    void append(char op, const std::string& payload);
+    bool openJournal(bool truncate);
+    void closeJournal();
+
+    static void formatLine(std::string& out, char op, const std::string& payload);
+    static bool parseLine(const std::string& text, char& op, std::string& payload);
+    static bool readHeader(std::istream& in, char expectedOp, uint64_t& headerEpoch);
+    static bool writeAll(std::FILE* out, const std::string& data);
+    static bool syncFile(std::FILE* out);
+    static bool apply(char op, const std::string& payload, SessionDatabase& sessions,
+                      std::vector<TicketBatch>& ticketBatches);
+};
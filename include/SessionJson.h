@@ -0,0 +1,55 @@
+#pragma once
+#include "GamblingSession.h"
+#include "JsonStream.h"
+#include "SessionChunks.h"
+#include "TaxCalculator.h"
+#include "TicketBatch.h"
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// JSON import/export for sessions and tax summaries. Both directions stream:
+// export writes record by record through a buffered JsonWriter, import hands
+// each session to a callback as soon as its closing brace is read, so memory
+// use stays flat regardless of file size.
+//
+// Session documents look like:
+//   {"format":"gambling-sessions","version":1,
+//    "sessions":[{"date":"01-15-2025","location":"...","state":"NV",...}],
+//    "ticketBatches":[{"date":"...","tickets":[5.00,2.00]}]}
+class SessionJson
+{
+public:
+    static const char* const SESSIONS_FORMAT;
+    static const char* const SUMMARY_FORMAT;
+    static const int FORMAT_VERSION = 1;
+
+    struct ReadStats
+    {
+        size_t sessions;
+        size_t ticketBatches;
+        size_t invalid;     // Records dropped for bad dates or amounts
+
+        ReadStats() : sessions(0), ticketBatches(0), invalid(0) {}
+    };
+
+    typedef std::function<void(GamblingSession&)> SessionCallback;
+    typedef std::function<void(TicketBatch&)> BatchCallback;
+
+    // Export
+    static void writeSession(JsonWriter& writer, const GamblingSession& session);
+    static void writeTicketBatch(JsonWriter& writer, const TicketBatch& batch);
+    static void writeSessions(std::ostream& out, const std::vector<GamblingSession>& sessions,
+                              const std::vector<TicketBatch>& ticketBatches);
+    static void writeSessions(std::ostream& out, const SessionChunks& sessions,
+                              const std::vector<TicketBatch>& ticketBatches);
+    static void writeTaxSummary(JsonWriter& writer, const TaxSummary& summary);
+    static void writeTaxSummary(std::ostream& out, const TaxSummary& summary);
+
+    // Import. Malformed JSON throws std::runtime_error; records that parse but
+    // fail validation are skipped and counted in ReadStats::invalid.
+    static ReadStats readSessions(std::istream& in, const SessionCallback& onSession,
+                                  const BatchCallback& onBatch);
+    static TaxSummary readTaxSummary(std::istream& in);
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include "GamblingSession.h"
+#include "SessionAggregate.h"
+#include "SessionDatabase.h"
+#include "TicketBatch.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class TaxCalculator;
+
+// Summary of one partition, kept up to date as sessions come and go. The
+// day bounds only ever widen until the partition empties, so after deletes
+// they may be looser than the data (never tighter).
+struct ZoneMap
+{
+    long long firstDay;
+    long long lastDay;
+    size_t sessions;
+    size_t tickets;
+    int64_t winningsCents;
+    int64_t lossesCents;
+
+    ZoneMap();
+    bool isEmpty() const { return sessions == 0 && tickets == 0; }
+    bool overlaps(long long fromDay, long long toDay) const { return !isEmpty() && firstDay <= toDay && lastDay >= fromDay; }
+    ZoneMap& operator+=(const ZoneMap& other);
+};
+
+// Which partitions a scoped query read and how many it could skip
+struct PartitionScan
+{
+    size_t read;        // Partitions in scope
+    size_t reused;      // Of those, answered from a cached aggregate
+    size_t skipped;     // Partitions outside the scope
+
+    PartitionScan() : read(0), reused(0), skipped(0) {}
+};
+
+// Sessions and ticket batches partitioned by tax year and state. The
+// SessionDatabase stays the one store (IDs and display numbers depend on
+// it); this index lists each partition's members with a zone map, so a
+// year- or state-scoped query touches only the partitions in scope.
+//
+// Each partition also caches its SessionAggregate, tagged with the
+// partition's version and the rules version it was built under: a scoped
+// calculation re-aggregates only partitions that changed since it last ran
+// (or whose cache was built under other withholding thresholds) and merges
+// the rest from the cache.
+// Undated entries go in tax year 0.
+class SessionPartitions
+{
+public:
+    static const int UNDATED_YEAR = 0;
+
+    SessionPartitions();
+
+    void add(SessionId id, const GamblingSession& session);
+    void remove(SessionId id, const GamblingSession& session);
+    void add(size_t batchIndex, const TicketBatch& batch);     // Position in the ticket batch list
+    void clear();
+    void rebuild(const SessionDatabase& sessions, const std::vector<TicketBatch>& ticketBatches);
+
+    static int taxYearOf(const std::string& date);
+
+    std::vector<int> getTaxYears() const;                      // Ascending; only years with entries
+    ZoneMap getZoneMap(int taxYear, const std::string& state = "") const;   // "" = every state
+    std::vector<std::string> getStates(int taxYear) const;
+
+    // Totals for the year (and state, unless ""): its sessions aggregated
+    // partition by partition, so dollar totals can differ from one sequential
+    // aggregate in the last bits of rounding. Per-state reminders come out in
+    // state-code order.
+    SessionAggregate aggregate(int taxYear, const std::string& state, const SessionDatabase& sessions,
+                               const std::vector<TicketBatch>& ticketBatches, const TaxCalculator& calculator,
+                               PartitionScan* scan = nullptr) const;
+
+    // Copies of the year's (and state's) entries, for reports that take plain lists
+    void select(int taxYear, const std::string& state, const SessionDatabase& sessions,
+                const std::vector<TicketBatch>& ticketBatches, std::vector<GamblingSession>& selectedSessions,
+                std::vector<TicketBatch>& selectedBatches, PartitionScan* scan = nullptr) const;
+
+private:
+    struct Key
+    {
+        int taxYear;
+        std::string state;
+
+        bool operator<(const Key& other) const
+        {
+            return taxYear != other.taxYear ? taxYear < other.taxYear : state < other.state;
+        }
+    };
+
+    struct Partition
+    {
+        ZoneMap zone;
+        std::vector<SessionId> sessions;
+        std::vector<size_t> ticketBatches;
+        uint64_t version;                   // Bumped on every change
+        mutable uint64_t cachedVersion;     // Version the cached aggregate was built at; 0 = none
+        mutable uint64_t cachedRules;       // TaxRulesConfig::getRulesVersion it was built under
+        mutable SessionAggregate cached;
+
+        Partition() : version(1), cachedVersion(0), cachedRules(0) {}
+    };
+
+    // Where a slot's session is listed
+    struct Member
+    {
+        Partition* partition;
+        uint32_t position;
+    };
+
+    std::map<Key, Partition> partitions;   // Node-based, so Member pointers stay valid
+    std::vector<Member> members;            // By slot
+
+    Partition& partitionFor(const std::string& date, const std::string& state);
+    static long long dayOf(const std::string& date);
+
+    // Every partition of the year (and state, unless ""), counting the rest as skipped
+    template <typename Visit>
+    void forEachInScope(int taxYear, const std::string& state, PartitionScan* scan, Visit visit) const;
+};
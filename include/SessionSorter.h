@@ -0,0 +1,61 @@
+#pragma once
+#include "BackgroundTasks.h"
+#include "SessionFileReader.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct SortOptions
+{
+    size_t memoryBudget;        // Bytes of records held at once; a full buffer is spilled as a sorted run
+    size_t maxFanIn;            // Files merged at once; more take extra merge passes
+    bool removeDuplicates;      // Drop records another source already supplied
+
+    SortOptions() : memoryBudget(256u << 20), maxFanIn(64), removeDuplicates(false) {}
+};
+
+struct SortStats
+{
+    size_t records;             // Read from the sources
+    size_t written;
+    size_t duplicates;          // Removed (removeDuplicates only)
+    size_t runs;                // Sorted runs spilled to disk
+    size_t mergePasses;         // Including the final one; 0 when everything fit in memory
+
+    SortStats() : records(0), written(0), duplicates(0), runs(0), mergePasses(0) {}
+};
+
+// Combines session files into one CSV in date order with bounded memory.
+//
+// sortFiles reads the sources (any format SessionFileReader reads) into a
+// buffer of at most memoryBudget bytes, spilling each full buffer as a run
+// sorted by date, then k-way merges the runs; with more runs than maxFanIn
+// the merge takes several passes. Run files are written next to the output
+// and removed afterwards, even on error or cancellation. mergeSortedFiles
+// skips the run phase for CSV sources that are already in date order.
+//
+// Bad lines and records are skipped with a warning, as in a load. A source
+// that fails to read (see SessionFileReader) or a damaged run file throws
+// std::runtime_error. The output is written to a temporary file and renamed
+// only on success, so a failed sort leaves any existing output untouched.
+//
+// Records with the same date keep their order: sources in the order given,
+// then file order. With removeDuplicates a record is dropped when an
+// earlier source already supplied as many identical copies (same content
+// hash as the load-time duplicate check). Copies within one source are all
+// kept, since two identical $5 tickets are two sessions.
+class SessionSorter
+{
+public:
+    static SortStats sortFiles(const std::vector<std::string>& sources, const std::string& output,
+                               const SortOptions& options, TaskProgress& progress,
+                               const SessionFileReader::WarningCallback& onWarning);
+
+    // Throws std::runtime_error if a source turns out not to be in date order
+    static SortStats mergeSortedFiles(const std::vector<std::string>& sources, const std::string& output,
+                                      const SortOptions& options, TaskProgress& progress,
+                                      const SessionFileReader::WarningCallback& onWarning);
+
+    // Session files (.csv, .json, .gsa) directly in a directory, by name
+    static std::vector<std::string> listSessionFiles(const std::string& directory);
+};
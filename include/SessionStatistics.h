@@ -0,0 +1,112 @@
+#pragma once
+#include "GamblingSession.h"
+#include "SessionChunks.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// Mergeable quantile sketch (merging t-digest, arcsine scale). Values are
+// buffered and folded into at most ~compression centroids, giving accurate
+// tails (p1, p99) in bounded memory regardless of how many values are added.
+// Queries fold pending values in, so even const use needs one thread at a time.
+class TDigest
+{
+public:
+    explicit TDigest(double compression = 200.0);
+
+    void add(double value);
+    void merge(const TDigest& other);
+
+    double quantile(double q) const;   // q in [0, 1]; 0 when empty
+    double getCount() const { return totalWeight + bufferedWeight; }
+    double getMin() const { return minValue; }
+    double getMax() const { return maxValue; }
+    size_t getCentroidCount() const;
+
+private:
+    struct Centroid
+    {
+        double mean;
+        double weight;
+    };
+
+    double compression;
+    mutable std::vector<Centroid> centroids;   // Sorted by mean
+    mutable std::vector<Centroid> buffer;      // Not yet merged
+    mutable double totalWeight;                // Weight held in centroids
+    mutable double bufferedWeight;
+    double minValue;
+    double maxValue;
+
+    void flush() const;
+};
+
+// One ranked session for the top-N lists
+struct RankedSession
+{
+    double amount;
+    std::string date;
+    std::string location;
+    std::string state;
+    std::string gameType;
+};
+
+// The N largest amounts seen, kept in a size-N min-heap: O(log N) per offer
+class TopN
+{
+public:
+    explicit TopN(size_t limit = 10);
+
+    void offer(double amount, const GamblingSession& session);
+    void merge(const TopN& other);
+
+    std::vector<RankedSession> sorted() const;  // Largest first
+    size_t size() const { return heap.size(); }
+
+private:
+    size_t limit;
+    std::vector<RankedSession> heap;
+
+    void push(const RankedSession& entry);
+};
+
+struct StatisticsGroup
+{
+    size_t sessions;
+    TopN largestWins;
+    TopN largestLosses;
+    TDigest results;    // Net result of every session
+
+    StatisticsGroup() : sessions(0), largestWins(5), largestLosses(5) {}
+
+    void add(const GamblingSession& session);
+    void merge(const StatisticsGroup& other);
+};
+
+// Streaming distribution statistics over session results: largest wins and
+// losses plus quantiles, overall and per state and game type. Every part
+// merges, so large histories are summarized by per-thread instances folded
+// together. Ticket batches are not sessions and are left out.
+class SessionStatistics
+{
+public:
+    SessionStatistics();
+
+    void add(const GamblingSession& session);
+    void merge(const SessionStatistics& other);
+
+    // Parallel scan; threads = 0 uses std::thread::hardware_concurrency()
+    static SessionStatistics compute(const std::vector<GamblingSession>& sessions, unsigned threads = 0);
+    static SessionStatistics compute(const SessionChunks& sessions, unsigned threads = 0);
+
+    const StatisticsGroup& getOverall() const { return overall; }
+    const std::map<std::string, StatisticsGroup>& getByState() const { return byState; }
+    const std::map<std::string, StatisticsGroup>& getByGameType() const { return byGameType; }
+
+    std::string generateReport() const;
+
+private:
+    StatisticsGroup overall;
+    std::map<std::string, StatisticsGroup> byState;
+    std::map<std::string, StatisticsGroup> byGameType;
+};
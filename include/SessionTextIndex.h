@@ -0,0 +1,104 @@
+#pragma once
+#include "GamblingSession.h"
+#include "SessionDatabase.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Full-text index over each session's location, notes and documentation
+// note, for queries like "mohegan sun w2g".
+//
+// Text is split into lower-case alphanumeric words (hyphenated ones are
+// also indexed joined, so "w2g" finds "W-2G"). Every indexed session
+// gets the next document number, so each word's posting list only ever
+// grows at its end and is stored as varint-coded gaps, with a skip entry
+// every few dozen postings so an AND can jump ahead instead of decoding the
+// whole list. Edits and deletes mark the old document dead; rebuild() drops
+// the dead ones once needsCompaction() says they outnumber the live ones.
+//
+// Query syntax: words are ANDed, OR separates alternatives
+// ("bellagio w2g OR wynn w2g"), and a trailing * matches any word with
+// that prefix ("w2*").
+class SessionTextIndex
+{
+public:
+    SessionTextIndex();
+
+    void add(SessionId id, const GamblingSession& session);
+    void remove(SessionId id);
+    void update(SessionId id, const GamblingSession& session) { remove(id); add(id, session); }
+    void clear();
+    void rebuild(const SessionDatabase& sessions);
+    bool needsCompaction() const;
+
+    // Matching sessions in the order they were indexed
+    std::vector<SessionId> search(const std::string& query);
+
+    size_t getSessionCount() const { return documents.size() - deadCount; }
+    size_t getTermCount() const { return terms.size(); }
+
+    static void tokenize(const std::string& text, std::vector<std::string>& words);
+
+private:
+    struct Skip
+    {
+        uint32_t doc;       // Last document before the skip target
+        uint32_t index;     // Postings before the skip target
+        uint32_t offset;    // Byte offset of the skip target
+    };
+
+    struct PostingList
+    {
+        std::vector<uint8_t> bytes;     // Varint gaps between document numbers
+        std::vector<Skip> skips;
+        uint32_t count;
+        uint32_t lastDoc;
+
+        PostingList() : count(0), lastDoc(0) {}
+        void append(uint32_t doc);
+    };
+
+    // Walks one posting list in document order
+    class Cursor
+    {
+    public:
+        explicit Cursor(const PostingList& list);
+        bool next();                    // False past the end
+        bool seek(uint32_t target);     // First document >= target; false past the end
+        uint32_t doc() const { return current; }
+
+    private:
+        const PostingList& list;
+        uint32_t index;
+        uint32_t offset;
+        uint32_t current;
+        size_t skip;
+    };
+
+    // One query word: a single posting list, or for a prefix the merged
+    // documents of every matching word
+    struct Term
+    {
+        const PostingList* list;
+        std::vector<uint32_t> docs;
+        size_t estimate;
+    };
+
+    typedef std::unordered_map<std::string, PostingList> TermMap;
+
+    TermMap terms;
+    std::vector<SessionId> documents;       // Document number -> session
+    std::vector<uint8_t> live;
+    std::vector<uint32_t> slotDocument;     // Session slot -> its live document
+    size_t deadCount;
+
+    std::vector<const TermMap::value_type*> sortedTerms;    // By word, for prefix lookups
+    std::vector<const TermMap::value_type*> newTerms;       // Not yet merged into sortedTerms
+    std::vector<std::string> wordScratch;
+
+    bool resolve(const std::string& word, bool prefix, Term& term);
+    std::vector<uint32_t> matchAll(std::vector<Term>& group);
+    static void decode(const PostingList& list, std::vector<uint32_t>& docs);
+};
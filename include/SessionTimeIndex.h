@@ -0,0 +1,94 @@
+#pragma once
+#include "GamblingSession.h"
+#include "SessionAggregate.h"
+#include "TicketBatch.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class TaxCalculator;
+
+// Sums for one day (or a range of days). Amounts are integer cents so that
+// removing a session cancels its addition exactly.
+struct DayTotals
+{
+    int64_t winningsCents;
+    int64_t lossesCents;
+    int64_t withheldCents;
+    int64_t sessions;
+    int64_t tickets;
+    int64_t missedWithholding;  // Wins at or above their W-2G threshold with nothing withheld
+
+    DayTotals() : winningsCents(0), lossesCents(0), withheldCents(0), sessions(0), tickets(0),
+                  missedWithholding(0) {}
+
+    DayTotals& operator+=(const DayTotals& other);
+    DayTotals& operator-=(const DayTotals& other);
+
+    double getWinnings() const { return winningsCents / 100.0; }
+    double getLosses() const { return lossesCents / 100.0; }
+    double getWithheld() const { return withheldCents / 100.0; }
+};
+
+// Date-range totals over all sessions and ticket batches, globally and per
+// state. Each series is a Fenwick tree over day numbers, so adding, removing
+// (for edits and deletes) and querying any [from, to] range are all
+// O(log days). The day window grows automatically by doubling, rebuilding
+// the trees.
+//
+// Sessions with an invalid date cannot be placed on the timeline and are only
+// counted in getUndatedCount().
+class SessionTimeIndex
+{
+public:
+    explicit SessionTimeIndex(const TaxCalculator& calculator);
+
+    void add(const GamblingSession& session);
+    void remove(const GamblingSession& session);
+    void add(const TicketBatch& batch);
+    void remove(const TicketBatch& batch);
+    void clear();
+
+    // Inclusive day-number range (see GamblingSession::dateToDayNumber)
+    DayTotals totals(long long fromDay, long long toDay) const;
+    DayTotals totals(const std::string& state, long long fromDay, long long toDay) const;
+
+    // Everything TaxCalculator::summarize needs for the range. Per-state
+    // reminders come out in state-code order rather than first-win order.
+    SessionAggregate aggregate(long long fromDay, long long toDay) const;
+
+    bool isEmpty() const { return firstDay > lastDay; }
+    long long getFirstDay() const { return firstDay; }
+    long long getLastDay() const { return lastDay; }
+    size_t getUndatedCount() const { return undated; }
+
+private:
+    // Fenwick tree over day positions (tree[0] unused). Single days are
+    // recovered as prefix differences, so no separate per-day array is kept.
+    struct Series
+    {
+        std::vector<DayTotals> tree;
+
+        void update(size_t position, const DayTotals& delta, bool subtract);
+        DayTotals prefix(size_t count) const;  // Sum of positions [0, count)
+        void relocate(size_t offset, size_t newCapacity);  // Shift everything up by offset
+    };
+
+    const TaxCalculator& calculator;
+    long long baseDay;      // Day number of position 0
+    size_t capacity;        // Days covered by every series
+    long long firstDay;     // Earliest and latest day seen
+    long long lastDay;
+    size_t undated;
+
+    Series global;
+    std::map<std::string, Series> states;
+
+    DayTotals sessionTotals(const GamblingSession& session) const;
+    static DayTotals batchTotals(const TicketBatch& batch);
+    bool locate(const std::string& date, size_t& position);
+    void apply(const std::string& date, const std::string& state, const DayTotals& delta, bool subtract);
+    void grow(long long day);
+    DayTotals rangeOf(const Series& series, long long fromDay, long long toDay) const;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// When each startup step ran, relative to process start. Steps are always
+// recorded (a handful of entries); --profile-startup prints them once the
+// first menu is on screen.
+class StartupProfile
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static void markProcessStart();     // First thing in main()
+    static void enable();
+    static bool isEnabled();
+
+    static void record(const std::string& step, Clock::time_point start, Clock::time_point end);
+    static void noteDeferred(const std::string& step);     // Listed as skipped at startup
+
+    // Prints the breakdown to stderr the first time it is called, if enabled
+    static void firstMenuDrawn();
+    static std::string generateReport(Clock::time_point firstMenu);
+};
+
+// Runs independent startup steps (rule files, the user profile) on their own
+// threads. Each step must write only state no other step touches; wait()
+// joins them all and rethrows the first exception a step threw. The owner
+// declares the scheduler after the objects its steps fill, so on any failure
+// path the destructor joins the steps before their targets are destroyed.
+class StartupScheduler
+{
+public:
+    StartupScheduler() {}
+    ~StartupScheduler();
+
+    StartupScheduler(const StartupScheduler&) = delete;
+    StartupScheduler& operator=(const StartupScheduler&) = delete;
+
+    void start(const std::string& step, std::function<void()> work);
+    void runHere(const std::string& step, const std::function<void()>& work);  // On the calling thread, timed
+    void wait();    // Also prints what the steps wrote to output(), in start order
+
+    // Where step code prints: a buffer while a started step runs, std::cout otherwise
+    static std::ostream& output();
+
+private:
+    std::vector<std::thread> threads;
+    std::vector<std::string> stepOutput;    // By start order; filled as each step finishes
+    std::mutex errorMutex;                  // Guards firstError and stepOutput
+    std::exception_ptr firstError;
+
+    void flushOutput();
+};
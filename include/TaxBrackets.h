@@ -0,0 +1,62 @@
+#pragma once
+#include "UserProfile.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// One progressive rate schedule compiled to flat arrays. Thresholds are padded
+// with +infinity up to a power of two so the bracket search is a fixed number
+// of compare-and-add steps with no data-dependent branches.
+class BracketSchedule
+{
+public:
+    BracketSchedule();
+
+    // Brackets as (lower threshold, rate) pairs; the first threshold is treated as 0
+    void compile(std::vector<std::pair<double, double>> brackets);
+
+    bool isEmpty() const { return bracketCount == 0; }
+    size_t getBracketCount() const { return bracketCount; }
+
+    double totalTax(double income) const;
+    double marginalRate(double income) const;
+
+    // Batch forms for planning sweeps; taxes/rates are resized to match incomes
+    void totalTax(const std::vector<double>& incomes, std::vector<double>& taxes) const;
+    void marginalRate(const std::vector<double>& incomes, std::vector<double>& rates) const;
+
+private:
+    size_t bracketCount;
+    std::vector<double> thresholds;  // Padded to a power of two
+    std::vector<double> rates;
+    std::vector<double> baseTax;     // Tax owed on income up to thresholds[i]
+
+    size_t findBracket(double income) const;
+};
+
+// All bracket schedules from tax_brackets.cfg, keyed by jurisdiction ("FEDERAL"
+// or a state code), tax year and filing status.
+//
+// Lookups fall back to the latest year at or before the requested one (or the
+// earliest year on file), and to the single schedule when a jurisdiction has
+// no separate schedule for the requested filing status.
+class TaxBracketTable
+{
+public:
+    static const std::string FEDERAL;
+
+    bool load(const std::string& path);
+
+    const BracketSchedule* find(const std::string& jurisdiction, int year, FilingStatus status) const;
+
+    size_t getScheduleCount() const;
+
+    static bool parseFilingStatus(const std::string& text, FilingStatus& status);
+
+private:
+    // "JURISDICTION/status" -> year -> schedule
+    std::map<std::string, std::map<int, BracketSchedule>> schedules;
+
+    static std::string scheduleKey(const std::string& jurisdiction, FilingStatus status);
+    const BracketSchedule* findYear(const std::string& key, int year) const;
+};
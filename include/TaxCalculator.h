@@ -1,5 +1,9 @@
 #pragma once
 #include "GamblingSession.h"
+#include "SessionAggregate.h"
+#include "SessionChunks.h"
+#include "SessionFileReader.h"
+#include "TicketBatch.h"
 #include "TaxRulesConfig.h"
 #include <vector>
 #include <string>
@@ -13,12 +17,15 @@ struct TaxSummary {
     double netFederalResult;        // Can be negative
     double deductibleLosses;        // Limited to winnings amount and percentage
     double federalTaxableIncome;    // Winnings (losses deducted separately)
+    double estimatedFederalTax;     // Bracket tax on gambling income alone, after deductions
+    double federalMarginalRate;
     
     // State totals (per state)
     std::map<std::string, double> stateWinnings;
     std::map<std::string, double> stateLosses;
     std::map<std::string, double> stateDeductibleLosses;  // Considering state percentages
     std::map<std::string, double> stateNetResults;
+    std::map<std::string, double> stateTaxes;             // Estimated liability on stateNetResults
     
     // Withholding tracking
     double totalWithheld;
@@ -40,27 +47,60 @@ class TaxCalculator {
 private:
     TaxRulesConfig taxRules;
     bool professionalGambler;  // Different rules for professionals
+    FilingStatus filingStatus; // Selects the bracket schedules and standard deduction
     
 public:
-    TaxCalculator(bool isProfessional = false, const std::string& configDir = "config");
+    TaxCalculator(bool isProfessional = false, const std::string& configDir = "config",
+                  bool deferLoad = false);  // See TaxRulesConfig
+    void loadRules(StartupScheduler* startup = nullptr);
     
     // Main calculation function
     TaxSummary calculateTaxes(const std::vector<GamblingSession>& sessions) const;
+    TaxSummary calculateTaxes(const std::vector<GamblingSession>& sessions,
+                              const std::vector<TicketBatch>& ticketBatches) const;
+    TaxSummary calculateTaxes(const SessionChunks& sessions,
+                              const std::vector<TicketBatch>& ticketBatches) const;  // Reuses cached chunk totals
+    
+    // Two-step form of calculateTaxes: aggregate the sessions once, then
+    // summarize the aggregate under the current rules (as often as needed)
+    SessionAggregate aggregate(const std::vector<GamblingSession>& sessions,
+                               const std::vector<TicketBatch>& ticketBatches) const;
+    SessionAggregate aggregate(const SessionChunks& sessions,
+                               const std::vector<TicketBatch>& ticketBatches) const;
+    void addSession(SessionAggregate& totals, const GamblingSession& session) const;
+    TaxSummary summarize(const SessionAggregate& totals) const;
+    
+    // calculateTaxes over every record in a session file, totalled as the file
+    // is read rather than loaded first, so memory grows with the number of
+    // states instead of sessions. Game types are canonicalized as a load does;
+    // duplicates are not skipped. Records are summed in file order, while the
+    // loaded sessions are summed chunk by chunk, so the totals agree with
+    // calculateTaxes on the loaded file to the cent but not necessarily in the
+    // last bits. Throws, with no totals, if the file is malformed or truncated
+    // (see SessionFileReader).
+    TaxSummary calculateTaxesFromFile(const std::string& filename, TaskProgress& progress,
+                                      const SessionFileReader::WarningCallback& onWarning) const;
     
     // Rule access (now dynamic)
     bool triggersWithholding(const std::string& gameType, double winnings) const;
+    bool triggersWithholding(const GamblingSession& session) const;  // Also applies the odds test
     double getWithholdingThreshold(const std::string& gameType) const;
     
     // Professional vs casual gambler settings
     void setProfessionalMode(bool isProfessional) { professionalGambler = isProfessional; }
     bool isProfessionalMode() const { return professionalGambler; }
     
+    void setFilingStatus(FilingStatus status) { filingStatus = status; }
+    FilingStatus getFilingStatus() const { return filingStatus; }
+    
     // Configuration access
     const TaxRulesConfig& getTaxRules() const { return taxRules; }
     TaxRulesConfig& getTaxRules() { return taxRules; }
     
     // State-specific calculations (now using dynamic rules)
     double calculateStateTax(const std::string& stateCode, double winnings, double losses) const;
+    double calculateStateTaxOnTaxable(const std::string& stateCode, double taxableAmount) const;
+    double calculateFederalTax(double taxableIncome) const;
     
     // Utility functions
     std::string generateTaxReport(const TaxSummary& summary) const;
@@ -72,7 +112,7 @@ public:
     int getTaxYear() const;
     
 private:
-    void calculateFederalTotals(const std::vector<GamblingSession>& sessions, TaxSummary& summary) const;
-    void calculateStateTotals(const std::vector<GamblingSession>& sessions, TaxSummary& summary) const;
-    void generateReminders(const std::vector<GamblingSession>& sessions, TaxSummary& summary) const;
+    void calculateFederalTotals(const SessionAggregate& totals, TaxSummary& summary) const;
+    void calculateStateTotals(const SessionAggregate& totals, TaxSummary& summary) const;
+    void generateReminders(const SessionAggregate& totals, TaxSummary& summary) const;
 };
\ No newline at end of file
@@ -1,4 +1,9 @@
 #pragma once
+#include "GameTypeDictionary.h"
+#include "StartupScheduler.h"
+#include "TaxBrackets.h"
+#include "UserProfile.h"
+#include "WithholdingClassifier.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -6,22 +11,18 @@
 
 struct FederalTaxRules {
     int taxYear;
-    double standardDeduction;
+    double standardDeduction;           // Single (and married filing separately)
+    double standardDeductionMarried;    // Married filing jointly
+    double standardDeductionHeadOfHousehold;
     double itemizationThreshold;
     bool allowsLossDeduction;
     double lossDeductionLimit;  // 1.0 = 100%, 0.9 = 90% (for 2026+ rules)
     std::map<std::string, double> withholdingThresholds;  // game_type -> amount
     
-    FederalTaxRules() : taxYear(2024), standardDeduction(14600), itemizationThreshold(1000),
-                       allowsLossDeduction(true), lossDeductionLimit(1.0)
-    {
-        // Default withholding thresholds
-        withholdingThresholds["Lottery"] = 5000.0;
-        withholdingThresholds["Slot Machine"] = 1200.0;
-        withholdingThresholds["Bingo"] = 1200.0;
-        withholdingThresholds["Keno"] = 1200.0;
-        withholdingThresholds["Poker Tournament"] = 5000.0;
-    }
+    FederalTaxRules() : taxYear(2024), standardDeduction(14600), standardDeductionMarried(29200),
+                       standardDeductionHeadOfHousehold(21900), itemizationThreshold(1000),
+                       allowsLossDeduction(true), lossDeductionLimit(1.0),
+                       withholdingThresholds(WithholdingClassifier::defaultThresholds()) {}
 };
 
 struct StateTaxRule {
@@ -40,19 +41,41 @@ struct StateTaxRule {
                     requiresNonResidentReturn(false), withholdingThreshold(5000.0) {}
 };
 
+// Federal and state rules, brackets and game types from the config directory.
+// State rules are parsed on first use, so a const TaxRulesConfig (like the
+// TaxCalculator holding it) is used by one thread at a time; background
+// work uses its own copy.
 class TaxRulesConfig
 {
 private:
     FederalTaxRules federalRules;
-    std::map<std::string, StateTaxRule> stateRules;
+    
+    // state_rules.cfg is only scanned for its [STATE] headers; a section is
+    // parsed the first time its state is looked up. The offsets are cached
+    // in state_rules.cfg.idx and rebuilt whenever the file changes.
+    std::string stateRulesFile;
+    mutable std::map<std::string, std::streamoff> stateSections;   // Code -> offset of its [CODE] line
+    mutable std::map<std::string, StateTaxRule> stateRules;         // Parsed so far, plus added rules
+    mutable bool stateRulesIndexed;
+    TaxBracketTable taxBrackets;
+    GameTypeDictionary gameTypes;
+    WithholdingClassifier withholdingClassifier;  // Compiled from federalRules.withholdingThresholds
     std::string configDirectory;
+    uint64_t rulesVersion;                        // See getRulesVersion
     
 public:
-    TaxRulesConfig(const std::string& configDir = "config");
+    // Loads the rule files unless deferLoad, in which case the owner calls load()
+    TaxRulesConfig(const std::string& configDir = "config", bool deferLoad = false);
+    
+    // With a scheduler the files load concurrently on it, and the rules must
+    // not be used until the caller's wait() returns
+    void load(StartupScheduler* startup = nullptr);
     
     // Load/Save configuration files
     bool loadFederalRules(const std::string& filename = "federal_rules.cfg");
     bool loadStateRules(const std::string& filename = "state_rules.cfg");
+    bool loadTaxBrackets(const std::string& filename = "tax_brackets.cfg");  // Optional; flat rates without it
+    bool loadGameTypes(const std::string& filename = "game_types.cfg");      // Optional; built-in names without it
     bool saveFederalRules(const std::string& filename = "federal_rules.cfg");
     bool saveStateRules(const std::string& filename = "state_rules.cfg");
     
@@ -61,30 +84,54 @@ public:
     
     // Federal rules access
     const FederalTaxRules& getFederalRules() const { return federalRules; }
-    void setFederalRules(const FederalTaxRules& rules) { federalRules = rules; }
+    void setFederalRules(const FederalTaxRules& rules);
     
     // State rules access
     const StateTaxRule* getStateRule(const std::string& stateCode) const;
     void addStateRule(const std::string& stateCode, const StateTaxRule& rule);
     std::vector<std::string> getAvailableStates() const;
     
+    // Progressive brackets (nullptr when none are configured for the jurisdiction)
+    const TaxBracketTable& getTaxBrackets() const { return taxBrackets; }
+    const BracketSchedule* getBrackets(const std::string& jurisdiction, FilingStatus status) const;
+    
+    // Canonical game type names and their aliases
+    const GameTypeDictionary& getGameTypes() const { return gameTypes; }
+    
     // Rule queries
     bool allowsLossDeduction(const std::string& stateCode) const;
     double getLossDeductionPercentage(const std::string& stateCode) const;
     double getStateTaxRate(const std::string& stateCode) const;
     double getWithholdingThreshold(const std::string& gameType) const;
+    const WithholdingClassifier& getWithholdingClassifier() const { return withholdingClassifier; }
+    
+    // Taken from a process-wide counter each time the withholding thresholds
+    // change, so equal versions mean equal thresholds, even across copies.
+    // Cached aggregates (SessionChunks, SessionPartitions) are keyed by it.
+    uint64_t getRulesVersion() const { return rulesVersion; }
+    
+    double getStandardDeduction(FilingStatus status) const;
     
     // Update rules for specific tax years
     void updateForTaxYear(int year);
+    static double lossDeductionLimitForYear(int year);
     
     // Utility functions
     std::string getConfigPath(const std::string& filename) const;
     void printCurrentRules() const;
     
 private:
+    void ensureStateIndex() const;
+    void ensureAllStateRules() const;
+    bool indexStateRules(bool useCache) const;
+    bool readStateIndexCache(const std::string& fingerprint) const;
+    void writeStateIndexCache(const std::string& fingerprint) const;
+    std::string stateRulesFingerprint() const;
+    bool parseStateSection(std::istream& file, const std::string& stateCode, StateTaxRule& rule) const;
+    
     // File parsing helpers
-    std::map<std::string, std::string> parseConfigLine(const std::string& line);
-    std::string trim(const std::string& str);
-    bool parseBool(const std::string& value);
-    double parseDouble(const std::string& value);
+    std::map<std::string, std::string> parseConfigLine(const std::string& line) const;
+    std::string trim(const std::string& str) const;
+    bool parseBool(const std::string& value) const;
+    double parseDouble(const std::string& value) const;
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+#include "GamblingSession.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A run of losing tickets bought on the same date at the same place.
+// Shared attributes are stored once and the ticket prices are packed as cents,
+// so a day of 5,000 scratch-offs costs ~20 KB instead of 5,000 full sessions.
+class TicketBatch
+{
+private:
+    std::string date;           // MM-DD-YYYY format
+    std::string location;
+    std::string state;
+    std::string gameType;
+    std::vector<uint32_t> ticketCents;  // Amount spent on each losing ticket
+    uint64_t totalCents;                // Running sum so aggregation is O(1) per batch
+
+public:
+    // Notes every bulk-entered ticket has always carried
+    static const char* const DOCUMENTATION_NOTE;
+    static const char* const NOTES;
+
+    TicketBatch();
+    TicketBatch(const std::string& date, const std::string& location,
+                const std::string& state, const std::string& gameType);
+
+    // Getters
+    std::string getDate() const { return date; }
+    std::string getLocation() const { return location; }
+    std::string getState() const { return state; }
+    std::string getGameType() const { return gameType; }
+    size_t getTicketCount() const { return ticketCents.size(); }
+    const std::vector<uint32_t>& getTicketCents() const { return ticketCents; }
+    double getTicketAmount(size_t index) const { return ticketCents[index] / 100.0; }
+    double getTotalLosses() const { return totalCents / 100.0; }
+    bool isEmpty() const { return ticketCents.empty(); }
+
+    // Setters
+    void setDate(const std::string& date) { this->date = date; }
+    void setLocation(const std::string& location) { this->location = location; }
+    void setState(const std::string& state) { this->state = state; }
+    void setGameType(const std::string& gameType) { this->gameType = gameType; }
+
+    void addTicket(double amount);
+    void removeTicket(size_t index);
+    void reserve(size_t ticketCount) { ticketCents.reserve(ticketCount); }
+
+    // Expands one ticket into the equivalent standalone losing session
+    GamblingSession ticketAsSession(size_t index) const;
+
+    // Utility functions
+    std::string toString() const;
+    std::string toCSV() const;
+
+    // Batches share the session CSV file as rows tagged BATCH:
+    // BATCH,date,location,state,gameType,count,amount;amount;...
+    static bool isBatchCSV(const std::string& csvLine);
+    static TicketBatch fromCSV(const std::string& csvLine);
+};
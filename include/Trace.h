@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Lightweight hot-path tracing. Spans are recorded into per-thread ring buffers
+// and dumped as Chrome trace-event JSON (loadable in chrome://tracing or Perfetto).
+//
+// Build with -DENABLE_TRACING=ON to compile spans in; otherwise TRACE_SCOPE expands
+// to nothing. At runtime tracing is enabled with --trace FILE or GAMBLING_TRACE=FILE.
+
+struct TraceEvent
+{
+    const char* name;       // Must be a string literal (stored by pointer)
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+class TraceRecorder
+{
+public:
+    static const size_t RING_CAPACITY = 16384;   // Events kept per thread (oldest overwritten)
+
+    // Turns recording on; the trace is written to outputFile at exit or on flush()
+    static void enable(const std::string& outputFile);
+    static void enableFromEnvironment();
+    static bool isEnabled();
+    static bool isCompiledIn();
+
+    static uint64_t nowNs();
+    static void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    // Writes every thread's buffered events; returns false if the file can't be written
+    static bool writeChromeTrace(const std::string& filename);
+    static void flush();
+};
+
+class TraceSpan
+{
+private:
+    const char* name;
+    uint64_t startNs;
+
+public:
+    explicit TraceSpan(const char* name);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#ifdef GAMBLING_ENABLE_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
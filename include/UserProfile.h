@@ -1,4 +1,5 @@
 #pragma once
+#include "StartupScheduler.h"
 #include <string>
 #include <map>
 
@@ -27,7 +28,11 @@ private:
     FilingStatus stringToFilingStatus(const std::string& status) const;
 
 public:
-    UserProfile(const std::string& configDir = "config");
+    // Reads the profile file unless deferLoad, in which case the owner calls load()
+    UserProfile(const std::string& configDir = "config", bool deferLoad = false);
+
+    // With a scheduler the profile file is read on it; wait() before using the profile
+    void load(StartupScheduler* startup = nullptr);
 
     // Profile management
     bool loadProfile();
@@ -0,0 +1,46 @@
+#pragma once
+#include "GamblingSession.h"
+#include "SessionChunks.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// W-2G withholding check compiled from a game type -> threshold map.
+//
+// Game type names are normalized (GameTypeDictionary::normalize) before lookup,
+// so the config's "Slot_Machine" and the menu's "Slot Machine" are the same
+// entry. Each known game type gets a small integer id indexing flat threshold
+// and odds tables; racing-style types additionally require 300-to-1 odds.
+class WithholdingClassifier
+{
+public:
+    WithholdingClassifier();    // IRS defaults (see defaultThresholds)
+    explicit WithholdingClassifier(const std::map<std::string, double>& thresholds);
+
+    double getThreshold(const std::string& gameType) const;
+
+    // wager is what was staked for the odds test; 0 skips it
+    bool triggers(const std::string& gameType, double winnings, double wager = 0.0) const;
+    bool triggers(const GamblingSession& session) const;
+
+    // One pass over many sessions: ids are resolved first, then a branch-free
+    // compare over flat arrays. flags[i] is 1 when session i reaches its threshold.
+    void classify(const std::vector<GamblingSession>& sessions, std::vector<uint8_t>& flags) const;
+    void classify(const SessionChunks& sessions, std::vector<uint8_t>& flags) const;
+
+    static std::map<std::string, double> defaultThresholds();
+
+private:
+    static const int UNKNOWN = -1;
+
+    std::unordered_map<std::string, int> ids;   // Normalized name -> id
+    std::vector<double> thresholds;             // By id
+    std::vector<double> oddsRatios;             // By id; 0 = no odds requirement
+
+    int lookup(const std::string& gameType) const;
+    bool triggers(int id, double winnings, double wager) const;
+    template <class Sessions>
+    void classifyAll(const Sessions& sessions, std::vector<uint8_t>& flags) const;    // Defined in the .cpp
+};
@@ -0,0 +1,173 @@
+#include "../include/BackgroundTasks.h"
+#include "../include/Trace.h"
+#include <algorithm>
+
+int TaskProgress::getPercent() const
+{
+    uint64_t units = total;
+    if (units == 0)
+    {
+        return -1;
+    }
+    uint64_t finished = done;
+    return static_cast<int>(std::min<uint64_t>(100, finished * 100 / units));
+}
+
+bool BackgroundTasks::Task::isFinished() const
+{
+    State current = state;
+    return current == State::DONE || current == State::CANCELLED || current == State::FAILED;
+}
+
+BackgroundTasks::BackgroundTasks()
+    : nextId(1), stopping(false)
+{
+    worker = std::thread(&BackgroundTasks::workerLoop, this);
+}
+
+BackgroundTasks::~BackgroundTasks()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for (const auto& task : queue)
+        {
+            task->progress.cancel();
+            task->state = State::CANCELLED;
+        }
+        queue.clear();
+    }
+    wakeWorker.notify_all();
+    worker.join();
+}
+
+BackgroundTasks::Handle BackgroundTasks::submit(const std::string& name, std::function<void(TaskProgress&)> work,
+                                                std::function<void(const Task&)> onComplete)
+{
+    Handle task = std::make_shared<Task>();
+    task->name = name;
+    task->work = std::move(work);
+    task->onComplete = std::move(onComplete);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task->id = nextId++;
+        queue.push_back(task);
+    }
+    wakeWorker.notify_one();
+    return task;
+}
+
+void BackgroundTasks::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wakeWorker.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty())
+        {
+            return;     // Stopping
+        }
+
+        Handle task = queue.front();
+        queue.pop_front();
+        running = task;
+        lock.unlock();
+
+        State outcome = State::DONE;
+        if (task->progress.isCancelled())
+        {
+            outcome = State::CANCELLED;
+        }
+        else
+        {
+            task->state = State::RUNNING;
+            try
+            {
+                TRACE_SCOPE("BackgroundTasks::run");
+                task->work(task->progress);
+                if (task->progress.isCancelled()) outcome = State::CANCELLED;
+            }
+            catch (const TaskCancelled&)
+            {
+                outcome = State::CANCELLED;
+            }
+            catch (const std::exception& e)
+            {
+                task->error = e.what();
+                outcome = State::FAILED;
+            }
+        }
+        task->work = nullptr;   // Drop the snapshot it captured before the completion runs
+
+        lock.lock();
+        task->state = outcome;
+        running.reset();
+        finished.push_back(task);
+        taskFinished.notify_all();
+    }
+}
+
+bool BackgroundTasks::waitFor(const Handle& task, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return taskFinished.wait_for(lock, timeout, [&task] { return task->isFinished(); });
+}
+
+void BackgroundTasks::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    taskFinished.wait(lock, [this] { return queue.empty() && !running; });
+}
+
+size_t BackgroundTasks::runCompletions()
+{
+    std::vector<Handle> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(finished);
+    }
+
+    for (const auto& task : ready)
+    {
+        if (task->onComplete) task->onComplete(*task);
+    }
+    return ready.size();
+}
+
+std::vector<BackgroundTasks::Handle> BackgroundTasks::getPending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Handle> pending;
+    if (running) pending.push_back(running);
+    pending.insert(pending.end(), queue.begin(), queue.end());
+    return pending;
+}
+
+bool BackgroundTasks::isIdle() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.empty() && !running;
+}
+
+void BackgroundTasks::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) running->progress.cancel();
+    for (const auto& task : queue)
+    {
+        task->progress.cancel();
+    }
+}
+
+const char* BackgroundTasks::stateName(State state)
+{
+    switch (state)
+    {
+        case State::QUEUED: return "queued";
+        case State::RUNNING: return "running";
+        case State::DONE: return "done";
+        case State::CANCELLED: return "cancelled";
+        case State::FAILED: return "failed";
+    }
+    return "unknown";
+}
@@ -0,0 +1,67 @@
+#include "../include/Checksum.h"
+#include <cstring>
+
+namespace
+{
+    const uint32_t CRC32C_POLYNOMIAL = 0x82F63B78u;   // Reflected Castagnoli polynomial
+
+    // Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zero bytes
+    struct Crc32cTables
+    {
+        uint32_t table[8][256];
+
+        Crc32cTables()
+        {
+            for (uint32_t b = 0; b < 256; b++)
+            {
+                uint32_t crc = b;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLYNOMIAL : 0);
+                }
+                table[0][b] = crc;
+            }
+            for (uint32_t b = 0; b < 256; b++)
+            {
+                for (int k = 1; k < 8; k++)
+                {
+                    table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+                }
+            }
+        }
+    };
+
+    const Crc32cTables& tables()
+    {
+        static const Crc32cTables instance;
+        return instance;
+    }
+}
+
+uint32_t Checksum::crc32c(const void* data, size_t length, uint32_t crc)
+{
+    const uint32_t (*table)[256] = tables().table;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+
+    // Eight bytes per step (assumes a little-endian host)
+    while (length >= 8)
+    {
+        uint32_t low, high;
+        std::memcpy(&low, bytes, 4);
+        std::memcpy(&high, bytes + 4, 4);
+        low ^= crc;
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^
+              table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+              table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^
+              table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+        bytes += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0)
+    {
+        crc = (crc >> 8) ^ table[0][(crc ^ *bytes++) & 0xFF];
+    }
+    return ~crc;
+}
@@ -1,4 +1,13 @@
 #include "../include/ConsoleInterface.h"
+#include "../include/MemoryAccounting.h"
+#include "../include/PivotEngine.h"
+#include "../include/ScenarioEngine.h"
+#include "../include/SessionArchive.h"
+#include "../include/SessionFileReader.h"
+#include "../include/SessionSorter.h"
+#include "../include/SessionJson.h"
+#include "../include/SessionStatistics.h"
+#include "../include/Trace.h"
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -10,13 +19,237 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 
-ConsoleInterface::ConsoleInterface() : calculator(false)
+namespace
 {
+    // A task that finishes this quickly is reported as if it ran in the foreground
+    const std::chrono::milliseconds FOREGROUND_WAIT(250);
+    const size_t PROGRESS_INTERVAL = 4096;  // Records between progress updates and cancellation checks
+    
+    // Warnings from a background file task: the first few are kept and the
+    // rest counted, so a badly damaged file can't grow memory with its size
+    struct CappedWarnings
+    {
+        static const size_t MAX_KEPT = 20;
+        std::vector<std::string> kept;
+        size_t dropped = 0;
+        
+        void add(const std::string& message)
+        {
+            if (kept.size() < MAX_KEPT) kept.push_back(message);
+            else dropped++;
+        }
+        
+        void print() const
+        {
+            for (const auto& warning : kept)
+            {
+                std::cout << warning << "\n";
+            }
+            if (dropped > 0)
+            {
+                std::cout << "... and " << dropped << " more warnings.\n";
+            }
+        }
+    };
+}
+
+ConsoleInterface::ConsoleInterface(bool autosave)
+    : calculator(false, "config", true), timeIndex(calculator), userProfile("config", true),
+      locationRewrites(0), dataVersion(0), lastTotalsVersion(0), summaryTaskVersion(0)
+{
+    calculator.loadRules(&startup);
+    userProfile.load(&startup);
+    // Optional; locations kept as entered without it
+    startup.start("venues", [this]() { venues.load(calculator.getTaxRules().getConfigPath("venues.cfg")); });
+    startup.wait();
+    
     // Check if user profile exists, run setup wizard if needed
     if (!userProfile.hasProfile()) {
         userProfile.runSetupWizard();
     }
+    calculator.setFilingStatus(userProfile.getFilingStatus());
+    
+    if (autosave)
+    {
+        startup.runHere("autosave recovery", [this]()
+        {
+            journal.reset(new SessionJournal("gambling_sessions"));
+            recoverAutosave();
+        });
+        startup.wait();
+    }
+}
+
+void ConsoleInterface::recoverAutosave()
+{
+    MEMORY_SCOPE(MemoryTag::SESSION_STORAGE);
+    SessionJournal::RecoveryStats stats;
+    if (journal->recover(sessions, ticketBatches, stats) && (!sessions.empty() || !ticketBatches.empty()))
+    {
+        for (const auto& session : sessions)
+        {
+            sessionIndex.add(SessionHashIndex::hashSession(session));
+            timeIndex.add(session);
+        }
+        for (const auto& batch : ticketBatches)
+        {
+            sessionIndex.add(SessionHashIndex::hashBatch(batch));
+            timeIndex.add(batch);
+        }
+        textIndex.rebuild(sessions);
+        partitions.rebuild(sessions, ticketBatches);
+        
+        std::cout << "Restored " << sessions.size() << " sessions";
+        if (!ticketBatches.empty())
+        {
+            std::cout << " and " << ticketBatches.size() << " ticket batches";
+        }
+        std::cout << " from the last run (" << stats.journalRecords << " journaled changes replayed).\n";
+    }
+    if (stats.tornTail)
+    {
+        std::cout << "⚠️  The autosave journal ended in an incomplete record; changes up to it were recovered.\n";
+    }
+    if (!journal->isOpen())
+    {
+        std::cout << "⚠️  Could not open " << journal->getJournalPath() << "; autosave is off for this run.\n";
+    }
+}
+
+void ConsoleInterface::snapshotAutosave()
+{
+    if (journal && !journal->compact(sessions, ticketBatches))
+    {
+        std::cout << "⚠️  Could not write the autosave snapshot.\n";
+    }
+}
+
+std::shared_ptr<const ConsoleInterface::SessionSnapshot> ConsoleInterface::takeSnapshot() const
+{
+    TRACE_SCOPE("takeSnapshot");
+    std::shared_ptr<SessionSnapshot> snapshot = std::make_shared<SessionSnapshot>();
+    snapshot->sessions = sessions.snapshot();
+    if (!sharedBatches)
+    {
+        sharedBatches = std::make_shared<const std::vector<TicketBatch>>(ticketBatches);
+    }
+    snapshot->ticketBatches = sharedBatches;
+    return snapshot;
+}
+
+void ConsoleInterface::refreshSummary()
+{
+    if (summaryTask && summaryTaskVersion == dataVersion)
+    {
+        return;     // Already calculating these sessions
+    }
+    if (summaryTask)
+    {
+        summaryTask->progress.cancel();     // Superseded by the newer data
+    }
+
+    std::shared_ptr<const SessionSnapshot> snapshot = takeSnapshot();
+    std::shared_ptr<const TaxCalculator> rules = std::make_shared<TaxCalculator>(calculator);
+    std::shared_ptr<SessionAggregate> totals = std::make_shared<SessionAggregate>();
+    uint64_t version = dataVersion;
+    summaryTaskVersion = version;
+    summaryTask = tasks.submit("Recalculate tax summary",
+        [snapshot, rules, totals](TaskProgress&)
+        {
+            *totals = rules->aggregate(snapshot->sessions, *snapshot->ticketBatches);
+        },
+        [this, totals, version](const BackgroundTasks::Task& task)
+        {
+            // Tasks finish in submission order, so a completed one is never older than lastTotals
+            if (task.state == BackgroundTasks::State::DONE)
+            {
+                lastTotals = totals;
+                lastTotalsVersion = version;
+            }
+            if (summaryTask.get() == &task)
+            {
+                summaryTask.reset();
+            }
+        });
+}
+
+bool ConsoleInterface::finishInForeground(const BackgroundTasks::Handle& task, const std::string& pendingMessage)
+{
+    bool finished = tasks.waitFor(task, FOREGROUND_WAIT);
+    tasks.runCompletions();
+    if (!finished)
+    {
+        std::cout << "⏳ " << pendingMessage << " in the background. The menu shows when it is done;\n"
+                  << "   Background Tasks (26) shows progress and can cancel it.\n";
+    }
+    return finished;
+}
+
+void ConsoleInterface::showTaskProgress(const BackgroundTasks::Task& task)
+{
+    std::cout << task.name << ": " << BackgroundTasks::stateName(task.state);
+    int percent = task.progress.getPercent();
+    if (task.state == BackgroundTasks::State::RUNNING && percent >= 0)
+    {
+        std::cout << ", " << percent << "%";
+    }
+    if (task.progress.isCancelled() && !task.isFinished())
+    {
+        std::cout << " (cancelling)";
+    }
+    std::cout << "\n";
+}
+
+void ConsoleInterface::showBackgroundTasks()
+{
+    showHeader("BACKGROUND TASKS");
+    if (tasks.runCompletions() > 0) std::cout << "\n";
+
+    if (!lastTotals)
+    {
+        std::cout << "Tax summary: not calculated yet\n\n";
+    }
+    else if (lastTotalsVersion == dataVersion)
+    {
+        std::cout << "Tax summary: up to date\n\n";
+    }
+    else
+    {
+        std::cout << "Tax summary: " << (dataVersion - lastTotalsVersion) << " changes behind\n\n";
+    }
+
+    std::vector<BackgroundTasks::Handle> pending = tasks.getPending();
+    if (pending.empty())
+    {
+        std::cout << "No background tasks are running.\n";
+        return;
+    }
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        std::cout << (i + 1) << ". ";
+        showTaskProgress(*pending[i]);
+    }
+
+    std::cout << "\nTask number to cancel (0 to leave them running): ";
+    int choice = getUserChoice();
+    if (choice <= 0 || static_cast<size_t>(choice) > pending.size())
+    {
+        return;
+    }
+
+    const BackgroundTasks::Handle& task = pending[choice - 1];
+    task->progress.cancel();
+    tasks.waitFor(task, FOREGROUND_WAIT);
+    tasks.runCompletions();
+    if (!task->isFinished())
+    {
+        std::cout << "Cancelling " << task->name << "; it stops at its next checkpoint.\n";
+    }
 }
 
 void ConsoleInterface::run()
@@ -28,6 +261,7 @@ void ConsoleInterface::run()
     while (running)
     {
         showMainMenu();
+        StartupProfile::firstMenuDrawn();
         int choice = getUserChoice();
         
         switch (choice)
@@ -51,7 +285,7 @@ void ConsoleInterface::run()
                 saveToFile("gambling_sessions.csv");
                 break;
             case 7:
-                loadFromFile("gambling_sessions.csv");
+                promptAndLoadFromFile("gambling_sessions.csv");
                 break;
             case 8:
                 showUserProfile();
@@ -68,14 +302,85 @@ void ConsoleInterface::run()
             case 12:
                 clearAllSessions();
                 break;
+            case 13:
+                exportToJson("gambling_sessions.json", "tax_summary.json");
+                break;
+            case 14:
+                promptAndLoadFromFile("gambling_sessions.json");
+                break;
+            case 15:
+                editSession();
+                break;
+            case 16:
+                deleteSession();
+                break;
+            case 17:
+                saveToFile("gambling_sessions.gsa");
+                break;
+            case 18:
+                promptAndLoadFromFile("gambling_sessions.gsa");
+                break;
+            case 19:
+                compareTaxScenarios();
+                break;
+            case 20:
+                showDateRangeSummary();
+                break;
+            case 21:
+                showPivotReport();
+                break;
+            case 22:
+                showSessionStatistics();
+                break;
+            case 23:
+                showUnknownGameTypes();
+                break;
+            case 24:
+                showLocationMatches();
+                break;
+            case 25:
+                searchSessions();
+                break;
+            case 26:
+                showBackgroundTasks();
+                break;
+            case 27:
+                calculateTaxesFromFile();
+                break;
+            case 28:
+                mergeSessionFiles();
+                break;
+            case 29:
+                showTaxYearSummary();
+                break;
+            case 30:
+                editTicketBatch();
+                break;
             case 0:
                 running = false;
+                if (summaryTask) summaryTask->progress.cancel();
+                if (!tasks.isIdle())
+                {
+                    std::cout << "Waiting for background tasks to finish...\n";
+                    tasks.waitIdle();
+                }
+                tasks.runCompletions();
                 std::cout << "Thank you for using Gambling Tax Calculator!\n";
                 break;
             default:
                 std::cout << "Invalid choice. Please try again.\n";
         }
         
+        if (journal)
+        {
+            // Group commit: whatever this action journaled becomes durable now
+            journal->sync();
+            if (journal->shouldCompact(sessions.size() + ticketBatches.size()))
+            {
+                snapshotAutosave();
+            }
+        }
+        
         if (running) pauseForUser();
     }
 }
@@ -84,7 +389,26 @@ void ConsoleInterface::showMainMenu()
 {
     clearScreen();
     showHeader("MAIN MENU");
-    std::cout << "Sessions loaded: " << sessions.size() << "\n\n";
+    
+    // Loads and saves that finished since the last menu report here
+    if (tasks.runCompletions() > 0) std::cout << "\n";
+    std::cout << "Sessions loaded: " << sessions.size();
+    if (!ticketBatches.empty())
+    {
+        size_t tickets = 0;
+        for (const auto& batch : ticketBatches)
+        {
+            tickets += batch.getTicketCount();
+        }
+        std::cout << " (+ " << tickets << " losing tickets in " << ticketBatches.size() << " batches)";
+    }
+    std::cout << "\n";
+    for (const auto& task : tasks.getPending())
+    {
+        std::cout << "⏳ ";
+        showTaskProgress(*task);
+    }
+    std::cout << "\n";
     
     std::cout << "1.  Add Single Gambling Session\n";
     std::cout << "2.  Bulk Add Losing Tickets (Quick Entry)\n";
@@ -98,6 +422,24 @@ void ConsoleInterface::showMainMenu()
     std::cout << "10. View Tax Rules & Configuration\n";
     std::cout << "11. Toggle Professional Gambler Mode\n";
     std::cout << "12. Clear All Sessions\n";
+    std::cout << "13. Export to JSON (sessions + tax summary)\n";
+    std::cout << "14. Import Sessions from JSON\n";
+    std::cout << "15. Edit a Session\n";
+    std::cout << "16. Delete a Session\n";
+    std::cout << "17. Save Compressed Archive\n";
+    std::cout << "18. Load Compressed Archive\n";
+    std::cout << "19. Compare Tax Scenarios\n";
+    std::cout << "20. Date Range Summary\n";
+    std::cout << "21. Pivot Report (group by state, game, location, date)\n";
+    std::cout << "22. Session Statistics (largest wins/losses, percentiles)\n";
+    std::cout << "23. Unknown Game Types Report\n";
+    std::cout << "24. Location Matches Report\n";
+    std::cout << "25. Search Sessions (location and notes)\n";
+    std::cout << "26. Background Tasks (progress, cancel)\n";
+    std::cout << "27. Calculate Taxes from a File (without loading it)\n";
+    std::cout << "28. Merge Session Files by Date\n";
+    std::cout << "29. Tax Year Summary (by year and state)\n";
+    std::cout << "30. Edit or Delete a Ticket Batch\n";
     std::cout << "0.  Exit\n\n";
     std::cout << "Choose an option: ";
 }
@@ -146,7 +488,20 @@ void ConsoleInterface::addSingleSession()
     GamblingSession session(date, location, state, gameType, buyIn, cashOut,
                            taxWithheld, withheldAmount, docNote, notes);
     
-    sessions.push_back(session);
+    if (sessionIndex.add(SessionHashIndex::hashSession(session)) > 0)
+    {
+        std::cout << "\n⚠️  This session matches one already recorded (same date, place, game and amounts).\n";
+    }
+    
+    {
+        MEMORY_SCOPE(MemoryTag::SESSION_STORAGE);
+        SessionId id = sessions.insert(session);
+        dataVersion++;
+        timeIndex.add(session);
+        partitions.add(id, session);
+        textIndex.add(id, session);
+        if (journal) journal->logAdd(id, session);
+    }
     
     std::cout << "\n✅ Session added successfully!\n";
     std::cout << "Net result: $" << std::fixed << std::setprecision(2) 
@@ -167,36 +522,604 @@ void ConsoleInterface::addBulkLosingSessions()
     
     std::cout << "\nNow enter losing amounts (Enter 0 to finish):\n";
     
-    int count = 0;
+    // All tickets share one batch record instead of one session each
+    MEMORY_SCOPE(MemoryTag::SESSION_STORAGE);
+    TicketBatch batch(defaultDate, defaultLocation, defaultState, defaultGameType);
     while (true)
     {
         double amount = getDoubleInput("Losing ticket amount $");
         if (amount <= 0) break;
         
-        // Create losing session (buyIn = amount, cashOut = 0)
-        GamblingSession session(defaultDate, defaultLocation, defaultState, 
-                               defaultGameType, amount, 0.0, false, 0.0, 
-                               "Keep losing ticket", "Bulk entry loss");
-        sessions.push_back(session);
-        count++;
+        batch.addTicket(amount);
+        
+        std::cout << "Added loss #" << batch.getTicketCount() << ": $" << std::fixed << std::setprecision(2) << amount << "\n";
+    }
+    
+    std::cout << "\n✅ Added " << batch.getTicketCount() << " losing tickets totaling $"
+              << std::fixed << std::setprecision(2) << batch.getTotalLosses() << "\n";
+    
+    if (!batch.isEmpty())
+    {
+        sessionIndex.add(SessionHashIndex::hashBatch(batch));
+        timeIndex.add(batch);
+        partitions.add(ticketBatches.size(), batch);
+        dataVersion++;
+        if (journal) journal->logBatch(batch);
+        ticketBatches.push_back(std::move(batch));
+        sharedBatches.reset();
+    }
+}
+
+void ConsoleInterface::viewAllSessions()
+{
+    showHeader("ALL GAMBLING SESSIONS");
+    
+    if (sessions.empty() && ticketBatches.empty())
+    {
+        std::cout << "No sessions recorded yet.\n";
+        return;
+    }
+    
+    double totalWinnings = 0, totalLosses = 0;
+    
+    // One batch pass over the configured thresholds, as TaxCalculator does
+    std::vector<uint8_t> thresholdReached;
+    calculator.getTaxRules().getWithholdingClassifier().classify(sessions.sessions(), thresholdReached);
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        std::cout << "\n--- Session " << (i + 1) << " ---\n";
+        std::cout << sessions[i].toString(thresholdReached[i] != 0);
+        
+        if (sessions[i].isWin())
+        {
+            totalWinnings += sessions[i].getNetResult();
+        }
+        else if (sessions[i].isLoss())
+        {
+            totalLosses += std::abs(sessions[i].getNetResult());
+        }
+    }
+    
+    size_t totalTickets = 0;
+    for (size_t i = 0; i < ticketBatches.size(); i++)
+    {
+        std::cout << "\n--- Ticket Batch " << (i + 1) << " ---\n";
+        std::cout << ticketBatches[i].toString();
+        totalLosses += ticketBatches[i].getTotalLosses();
+        totalTickets += ticketBatches[i].getTicketCount();
+    }
+    
+    std::cout << "\n" << std::string(50, '=') << "\n";
+    std::cout << "SUMMARY:\n";
+    std::cout << "Total Sessions: " << sessions.size() << "\n";
+    if (totalTickets > 0)
+    {
+        std::cout << "Bulk Losing Tickets: " << totalTickets << " in " << ticketBatches.size() << " batches\n";
+    }
+    std::cout << "Total Winnings: $" << std::fixed << std::setprecision(2) << totalWinnings << "\n";
+    std::cout << "Total Losses: $" << totalLosses << "\n";
+    std::cout << "Net Result: $" << (totalWinnings - totalLosses) << "\n";
+}
+
+SessionId ConsoleInterface::chooseSession(const std::string& action)
+{
+    if (sessions.empty())
+    {
+        std::cout << "No sessions recorded yet.\n";
+        return SessionId();
+    }
+    
+    std::cout << "Session number to " << action << " (1-" << sessions.size()
+              << ", as shown in View All Sessions; 0 to cancel): ";
+    int choice = getUserChoice();
+    if (choice <= 0 || static_cast<size_t>(choice) > sessions.size())
+    {
+        if (choice != 0)
+        {
+            std::cout << "No session with that number.\n";
+        }
+        return SessionId();
+    }
+    
+    SessionId id = sessions.idAt(static_cast<size_t>(choice - 1));
+    const GamblingSession& session = *sessions.find(id);
+    std::cout << "\n" << session.toString(calculator.triggersWithholding(session)) << "\n";
+    return id;
+}
+
+void ConsoleInterface::editSession()
+{
+    showHeader("EDIT SESSION");
+    
+    SessionId id = chooseSession("edit");
+    if (!id.isValid()) return;
+    
+    GamblingSession edited = *sessions.find(id);
+    std::cout << "Press Enter to keep the current value.\n\n";
+    
+    while (true)
+    {
+        std::string date = getStringInput("Date [" + edited.getDate() + "]: ");
+        if (date.empty()) break;
+        if (isValidDate(date))
+        {
+            edited.setDate(date);
+            break;
+        }
+        std::cout << "Invalid date format. Please enter date as MM-DD-YYYY (e.g., 01-15-2024).\n";
+    }
+    
+    std::string location = getLocationInput("Location [" + edited.getLocation() + "]: ", true);
+    if (!location.empty()) edited.setLocation(location);
+    
+    if (getBoolInput("Change state (" + edited.getState() + ")? (y/n): "))
+    {
+        edited.setState(getStateCode());
+    }
+    if (getBoolInput("Change game type (" + edited.getGameType() + ")? (y/n): "))
+    {
+        edited.setGameType(getGameType());
+    }
+    
+    if (getBoolInput("Change amounts? (y/n): "))
+    {
+        edited.setBuyIn(getDoubleInput("Amount spent/wagered: $"));
+        edited.setCashOut(getDoubleInput("Amount won/received: $"));
         
-        std::cout << "Added loss #" << count << ": $" << std::fixed << std::setprecision(2) << amount << "\n";
+        bool taxWithheld = false;
+        double withheldAmount = 0.0;
+        if (edited.getCashOut() > edited.getBuyIn())
+        {
+            taxWithheld = getBoolInput("Was tax withheld? (y/n): ");
+            if (taxWithheld)
+            {
+                withheldAmount = getDoubleInput("Amount withheld: $");
+            }
+        }
+        edited.setTaxWithheld(taxWithheld);
+        edited.setWithheldAmount(withheldAmount);
+    }
+    
+    std::string docNote = getStringInput("Documentation note [" + edited.getDocumentationNote() + "]: ");
+    if (!docNote.empty()) edited.setDocumentationNote(docNote);
+    std::string notes = getStringInput("Additional notes [" + edited.getNotes() + "]: ");
+    if (!notes.empty()) edited.setNotes(notes);
+    
+    // Keep the dedup, date and partition indexes in step with the session's new content
+    sessionIndex.remove(SessionHashIndex::hashSession(*sessions.find(id)));
+    sessionIndex.add(SessionHashIndex::hashSession(edited));
+    timeIndex.remove(*sessions.find(id));
+    timeIndex.add(edited);
+    partitions.remove(id, *sessions.find(id));
+    partitions.add(id, edited);
+    textIndex.update(id, edited);
+    sessions.update(id, edited);
+    dataVersion++;
+    if (journal) journal->logUpdate(id, edited);
+    
+    std::cout << "\n✅ Session updated.\n";
+}
+
+void ConsoleInterface::deleteSession()
+{
+    showHeader("DELETE SESSION");
+    
+    SessionId id = chooseSession("delete");
+    if (!id.isValid()) return;
+    
+    if (!getBoolInput("Delete this session? (y/n): "))
+    {
+        std::cout << "Cancelled.\n";
+        return;
+    }
+    
+    sessionIndex.remove(SessionHashIndex::hashSession(*sessions.find(id)));
+    timeIndex.remove(*sessions.find(id));
+    partitions.remove(id, *sessions.find(id));
+    textIndex.remove(id);
+    sessions.erase(id);
+    dataVersion++;
+    if (textIndex.needsCompaction()) textIndex.rebuild(sessions);
+    if (journal) journal->logDelete(id);
+    std::cout << "✅ Session deleted. The last session now takes its number in the list.\n";
+}
+
+void ConsoleInterface::editTicketBatch()
+{
+    showHeader("EDIT TICKET BATCH");
+    
+    if (ticketBatches.empty())
+    {
+        std::cout << "No ticket batches recorded yet.\n";
+        return;
+    }
+    
+    std::cout << "Batch number (1-" << ticketBatches.size() << ", as shown in View All Sessions; 0 to cancel): ";
+    int choice = getUserChoice();
+    if (choice <= 0 || static_cast<size_t>(choice) > ticketBatches.size())
+    {
+        if (choice != 0) std::cout << "No batch with that number.\n";
+        return;
+    }
+    size_t index = static_cast<size_t>(choice - 1);
+    TicketBatch edited = ticketBatches[index];
+    std::cout << "\n" << edited.toString() << "\n";
+    
+    std::cout << "1. Change date, location, state or game type\n";
+    std::cout << "2. Remove one ticket\n";
+    std::cout << "3. Delete the whole batch\n";
+    std::cout << "0. Cancel\n";
+    std::cout << "Choose an option: ";
+    int action = getUserChoice();
+    
+    if (action == 1)
+    {
+        std::cout << "Press Enter to keep the current value.\n\n";
+        while (true)
+        {
+            std::string date = getStringInput("Date [" + edited.getDate() + "]: ");
+            if (date.empty()) break;
+            if (isValidDate(date))
+            {
+                edited.setDate(date);
+                break;
+            }
+            std::cout << "Invalid date format. Please enter date as MM-DD-YYYY (e.g., 01-15-2024).\n";
+        }
+        std::string location = getLocationInput("Location [" + edited.getLocation() + "]: ", true);
+        if (!location.empty()) edited.setLocation(location);
+        if (getBoolInput("Change state (" + edited.getState() + ")? (y/n): "))
+        {
+            edited.setState(getStateCode());
+        }
+        if (getBoolInput("Change game type (" + edited.getGameType() + ")? (y/n): "))
+        {
+            edited.setGameType(getGameType());
+        }
+    }
+    else if (action == 2)
+    {
+        for (size_t i = 0; i < edited.getTicketCount(); i++)
+        {
+            std::cout << (i + 1) << ". $" << std::fixed << std::setprecision(2) << edited.getTicketAmount(i) << "\n";
+        }
+        std::cout << "Ticket to remove (0 to cancel): ";
+        int ticket = getUserChoice();
+        if (ticket <= 0 || static_cast<size_t>(ticket) > edited.getTicketCount())
+        {
+            std::cout << "Cancelled.\n";
+            return;
+        }
+        edited.removeTicket(static_cast<size_t>(ticket - 1));
+    }
+    else if (action != 3)
+    {
+        std::cout << "Cancelled.\n";
+        return;
+    }
+    
+    bool remove = action == 3 || edited.isEmpty();
+    if (remove && !getBoolInput("Delete this batch? (y/n): "))
+    {
+        std::cout << "Cancelled.\n";
+        return;
+    }
+    
+    // Keep the dedup and date indexes in step with the batch's new content
+    const TicketBatch& old = ticketBatches[index];
+    sessionIndex.remove(SessionHashIndex::hashBatch(old));
+    timeIndex.remove(old);
+    if (remove)
+    {
+        ticketBatches.erase(ticketBatches.begin() + static_cast<std::ptrdiff_t>(index));
+        sharedBatches.reset();
+        if (journal) journal->logBatchDelete(index);
+    }
+    else
+    {
+        sessionIndex.add(SessionHashIndex::hashBatch(edited));
+        timeIndex.add(edited);
+        ticketBatches[index] = edited;
+        sharedBatches.reset();
+        if (journal) journal->logBatchUpdate(index, edited);
+    }
+    // Partitions list batches by position, which a delete shifts; batch edits are rare enough to rebuild
+    partitions.rebuild(sessions, ticketBatches);
+    dataVersion++;
+    
+    std::cout << (remove ? "✅ Batch deleted. Later batches move up one number.\n" : "✅ Batch updated.\n");
+}
+
+void ConsoleInterface::calculateAndShowTaxes()
+{
+    showHeader("TAX CALCULATION");
+    
+    if (sessions.empty() && ticketBatches.empty())
+    {
+        std::cout << "No sessions to calculate. Add some gambling sessions first.\n";
+        return;
+    }
+    
+    // The last completed totals show at once; a fresh set is computed in the
+    // background when anything changed since
+    if (!lastTotals || lastTotalsVersion != dataVersion)
+    {
+        refreshSummary();
+        tasks.waitFor(summaryTask, FOREGROUND_WAIT);
+        tasks.runCompletions();
+    }
+    if (!lastTotals)
+    {
+        std::cout << "⏳ ";
+        showTaskProgress(*summaryTask);
+        std::cout << "The summary will be ready shortly; choose this option again to see it.\n";
+        return;
+    }
+    
+    TaxSummary summary = calculator.summarize(*lastTotals);
+    std::cout << calculator.generateTaxReport(summary) << "\n";
+    if (lastTotalsVersion != dataVersion)
+    {
+        std::cout << "⏳ These totals are from before your latest " << (dataVersion - lastTotalsVersion)
+                  << " changes; an updated summary is being calculated in the background.\n";
+    }
+    
+    // Show any important reminders
+    if (!summary.documentationReminders.empty())
+    {
+        std::cout << "\nIMPORTANT REMINDERS:\n";
+        for (const auto& reminder : summary.documentationReminders)
+        {
+            std::cout << "• " << reminder << "\n";
+        }
+    }
+}
+
+void ConsoleInterface::calculateTaxesFromFile()
+{
+    showHeader("TAX CALCULATION FROM FILE");
+    std::cout << "Sessions are totalled as the file is read, without loading them, so this\n"
+              << "works for files too large to load. Duplicates in the file are all counted.\n\n";
+    
+    std::string filename = getStringInput("File to calculate (.csv, .json or .gsa): ");
+    if (filename.empty())
+    {
+        return;
+    }
+    
+    std::shared_ptr<const TaxCalculator> rules = std::make_shared<TaxCalculator>(calculator);
+    std::shared_ptr<TaxSummary> summary = std::make_shared<TaxSummary>();
+    std::shared_ptr<CappedWarnings> warnings = std::make_shared<CappedWarnings>();
+    BackgroundTasks::Handle task = tasks.submit("Calculate taxes from " + filename,
+        [rules, summary, warnings, filename](TaskProgress& progress)
+        {
+            *summary = rules->calculateTaxesFromFile(filename, progress,
+                [&warnings](const std::string& message) { warnings->add(message); });
+        },
+        [rules, summary, warnings, filename](const BackgroundTasks::Task& task)
+        {
+            warnings->print();
+            
+            if (task.state == BackgroundTasks::State::CANCELLED)
+            {
+                std::cout << "Calculation from " << filename << " cancelled.\n";
+                return;
+            }
+            if (task.state == BackgroundTasks::State::FAILED)
+            {
+                std::cout << "❌ Error: " << task.error << "\n";
+                return;
+            }
+            
+            std::cout << "\nTotals for " << filename << ":\n";
+            std::cout << rules->generateTaxReport(*summary) << "\n";
+            if (!summary->documentationReminders.empty())
+            {
+                std::cout << "\nIMPORTANT REMINDERS:\n";
+                for (const auto& reminder : summary->documentationReminders)
+                {
+                    std::cout << "• " << reminder << "\n";
+                }
+            }
+        });
+    finishInForeground(task, "Calculating taxes from " + filename);
+}
+
+void ConsoleInterface::compareTaxScenarios()
+{
+    showHeader("TAX SCENARIO COMPARISON");
+    
+    if (sessions.empty() && ticketBatches.empty())
+    {
+        std::cout << "No sessions to compare. Add some gambling sessions first.\n";
+        return;
+    }
+    
+    ScenarioEngine engine(calculator);
+    SessionAggregate totals = calculator.aggregate(sessions.snapshot(), ticketBatches);
+    std::vector<ScenarioResult> results = engine.evaluate(totals, ScenarioEngine::standardSweep(calculator.getTaxYear()));
+    std::cout << ScenarioEngine::generateComparisonTable(results) << "\n";
+    std::cout << "Your profile: " << userProfile.getFilingStatusString()
+              << (calculator.isProfessionalMode() ? ", professional" : ", casual") << " gambler\n";
+}
+
+void ConsoleInterface::showDateRangeSummary()
+{
+    showHeader("DATE RANGE SUMMARY");
+    
+    if (timeIndex.isEmpty())
+    {
+        std::cout << "No dated sessions yet. Add some gambling sessions first.\n";
+        return;
+    }
+    
+    std::string firstDate = GamblingSession::dayNumberToDate(timeIndex.getFirstDay());
+    std::string lastDate = GamblingSession::dayNumberToDate(timeIndex.getLastDay());
+    std::cout << "Sessions span " << firstDate << " to " << lastDate << ".\n\n";
+    
+    std::string fromDate = firstDate;
+    std::string toDate = lastDate;
+    getOptionalDateInput("From (MM-DD-YYYY) [Enter for " + firstDate + "]: ", fromDate);
+    getOptionalDateInput("To (MM-DD-YYYY) [Enter for " + lastDate + "]: ", toDate);
+    
+    long long fromDay = GamblingSession::dateToDayNumber(fromDate);
+    long long toDay = GamblingSession::dateToDayNumber(toDate);
+    SessionAggregate totals = timeIndex.aggregate(fromDay, toDay);
+    if (totals.isEmpty())
+    {
+        std::cout << "\nNo sessions between " << fromDate << " and " << toDate << ".\n";
+        return;
+    }
+    
+    std::cout << "\n" << totals.sessionCount << " sessions";
+    if (totals.ticketCount > 0)
+    {
+        std::cout << " and " << totals.ticketCount << " losing tickets";
+    }
+    std::cout << " from " << fromDate << " to " << toDate << "\n\n";
+    std::cout << calculator.generateTaxReport(calculator.summarize(totals)) << "\n";
+    
+    if (timeIndex.getUndatedCount() > 0)
+    {
+        std::cout << "Note: " << timeIndex.getUndatedCount() << " entries without a valid date are not included.\n";
+    }
+}
+
+void ConsoleInterface::showTaxYearSummary()
+{
+    showHeader("TAX YEAR SUMMARY");
+    
+    std::vector<int> years = partitions.getTaxYears();
+    if (years.empty())
+    {
+        std::cout << "No sessions yet. Add some gambling sessions first.\n";
+        return;
+    }
+    
+    std::cout << std::left << std::setw(10) << "Year" << std::setw(25) << "Dates"
+              << std::right << std::setw(10) << "Sessions" << std::setw(10) << "Tickets"
+              << std::setw(15) << "Winnings" << std::setw(15) << "Losses" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (int year : years)
+    {
+        ZoneMap zone = partitions.getZoneMap(year);
+        std::string dates = year == SessionPartitions::UNDATED_YEAR ? "(no valid date)"
+            : GamblingSession::dayNumberToDate(zone.firstDay) + " to " + GamblingSession::dayNumberToDate(zone.lastDay);
+        std::cout << std::left << std::setw(10) << (year == SessionPartitions::UNDATED_YEAR ? "-" : std::to_string(year))
+                  << std::setw(25) << dates << std::right << std::setw(10) << zone.sessions
+                  << std::setw(10) << zone.tickets << std::setw(15) << zone.winningsCents / 100.0
+                  << std::setw(15) << zone.lossesCents / 100.0 << "\n";
+    }
+    std::cout << "\n";
+    
+    int year = years.back();
+    std::string yearText = getStringInput("Tax year [Enter for " + std::to_string(year) + "]: ");
+    if (!yearText.empty()) year = std::atoi(yearText.c_str());
+    if (partitions.getZoneMap(year).isEmpty())
+    {
+        std::cout << "No sessions in " << year << ".\n";
+        return;
+    }
+    
+    std::string state = getStringInput("State code [Enter for all]: ");
+    std::transform(state.begin(), state.end(), state.begin(), ::toupper);
+    ZoneMap zone = partitions.getZoneMap(year, state);
+    if (zone.isEmpty())
+    {
+        std::cout << "No sessions in " << state << " in " << year << ".\n";
+        return;
+    }
+    
+    // Each year is summarized under its own rules; partitions unchanged since last time come from cache
+    TaxCalculator yearCalculator = calculator;
+    if (year != SessionPartitions::UNDATED_YEAR) yearCalculator.setTaxYear(year);
+    PartitionScan scan;
+    SessionAggregate totals = partitions.aggregate(year, state, sessions, ticketBatches, yearCalculator, &scan);
+    
+    std::cout << "\n" << zone.sessions << " sessions";
+    if (zone.tickets > 0)
+    {
+        std::cout << " and " << zone.tickets << " losing tickets";
+    }
+    std::cout << " in " << (year == SessionPartitions::UNDATED_YEAR ? "undated entries" : std::to_string(year))
+              << (state.empty() ? "" : " (" + state + ")") << "\n\n";
+    std::cout << yearCalculator.generateTaxReport(yearCalculator.summarize(totals)) << "\n";
+    std::cout << "Partitions read: " << scan.read << " (" << scan.reused << " from cache), skipped: "
+              << scan.skipped << "\n";
+}
+
+void ConsoleInterface::showPivotReport()
+{
+    showHeader("PIVOT REPORT");
+    
+    if (sessions.empty() && ticketBatches.empty())
+    {
+        std::cout << "No sessions to report on. Add some gambling sessions first.\n";
+        return;
+    }
+    
+    static const PivotKey KEYS[] = {
+        PivotKey::STATE, PivotKey::GAME_TYPE, PivotKey::LOCATION,
+        PivotKey::YEAR, PivotKey::MONTH, PivotKey::DATE
+    };
+    
+    std::cout << "Group by one or more fields, in order:\n";
+    for (size_t i = 0; i < 6; i++)
+    {
+        std::cout << (i + 1) << ". " << PivotEngine::keyName(KEYS[i]) << "\n";
+    }
+    
+    PivotQuery query;
+    std::istringstream fields(getStringInput("Fields (e.g. 1 2 5): "));
+    int field = 0;
+    while (fields >> field)
+    {
+        if (field >= 1 && field <= 6)
+        {
+            query.keys.push_back(KEYS[field - 1]);
+        }
+    }
+    if (query.keys.empty())
+    {
+        query.keys.push_back(PivotKey::STATE);
     }
+    query.measures = {
+        PivotMeasure::WINNINGS, PivotMeasure::LOSSES, PivotMeasure::NET,
+        PivotMeasure::COUNT, PivotMeasure::MAX_WIN, PivotMeasure::MAX_LOSS
+    };
     
-    std::cout << "\n✅ Added " << count << " losing sessions totaling $";
-    
-    double totalLosses = 0;
-    for (int i = sessions.size() - count; i < sessions.size(); i++)
+    // A tax year limits the report to that year's partitions
+    std::string yearText = getStringInput("Tax year [Enter for all]: ");
+    PivotResult result;
+    if (yearText.empty())
+    {
+        result = PivotEngine::run(sessions.sessions(), ticketBatches, query);
+    }
+    else
     {
-        totalLosses += std::abs(sessions[i].getNetResult());
+        std::vector<GamblingSession> yearSessions;
+        std::vector<TicketBatch> yearBatches;
+        partitions.select(std::atoi(yearText.c_str()), "", sessions, ticketBatches, yearSessions, yearBatches);
+        result = PivotEngine::run(yearSessions, yearBatches, query);
     }
+    std::cout << "\n" << PivotEngine::generateReport(result) << "\n";
     
-    std::cout << std::fixed << std::setprecision(2) << totalLosses << "\n";
+    if (getBoolInput("Export to pivot_report.csv? (y/n): "))
+    {
+        std::ofstream file("pivot_report.csv");
+        if (!file.is_open())
+        {
+            std::cout << "❌ Error: Could not write pivot_report.csv\n";
+            return;
+        }
+        PivotEngine::writeCSV(file, result);
+        std::cout << "✅ Exported " << result.rows.size() << " rows to pivot_report.csv\n";
+    }
 }
 
-void ConsoleInterface::viewAllSessions()
+void ConsoleInterface::showSessionStatistics()
 {
-    showHeader("ALL GAMBLING SESSIONS");
+    showHeader("SESSION STATISTICS");
     
     if (sessions.empty())
     {
@@ -204,52 +1127,116 @@ void ConsoleInterface::viewAllSessions()
         return;
     }
     
-    double totalWinnings = 0, totalLosses = 0;
-    
-    for (size_t i = 0; i < sessions.size(); i++)
+    std::cout << SessionStatistics::compute(sessions.sessions()).generateReport() << "\n";
+    std::cout << "Percentiles are estimates from a t-digest sketch; totals and largest amounts are exact.\n";
+}
+
+void ConsoleInterface::showUnknownGameTypes()
+{
+    showHeader("UNKNOWN GAME TYPES");
+    std::cout << calculator.getTaxRules().getGameTypes().generateUnknownReport(unknownGameTypes) << "\n";
+}
+
+void ConsoleInterface::showLocationMatches()
+{
+    showHeader("LOCATION MATCHES");
+    if (venues.getVenueCount() == 0)
     {
-        std::cout << "\n--- Session " << (i + 1) << " ---\n";
-        std::cout << sessions[i].toString();
-        
-        if (sessions[i].isWin())
-        {
-            totalWinnings += sessions[i].getNetResult();
-        }
-        else if (sessions[i].isLoss())
-        {
-            totalLosses += std::abs(sessions[i].getNetResult());
-        }
+        std::cout << "No venues configured. List them in config/venues.cfg to merge location spellings.\n";
+        return;
     }
-    
-    std::cout << "\n" << std::string(50, '=') << "\n";
-    std::cout << "SUMMARY:\n";
-    std::cout << "Total Sessions: " << sessions.size() << "\n";
-    std::cout << "Total Winnings: $" << std::fixed << std::setprecision(2) << totalWinnings << "\n";
-    std::cout << "Total Losses: $" << totalLosses << "\n";
-    std::cout << "Net Result: $" << (totalWinnings - totalLosses) << "\n";
+    std::cout << venues.generateReport() << "\n";
 }
 
-void ConsoleInterface::calculateAndShowTaxes()
+void ConsoleInterface::searchSessions()
 {
-    showHeader("TAX CALCULATION");
-    
+    showHeader("SEARCH SESSIONS");
+
     if (sessions.empty())
     {
-        std::cout << "No sessions to calculate. Add some gambling sessions first.\n";
+        std::cout << "No sessions recorded yet.\n";
         return;
     }
-    
-    TaxSummary summary = calculator.calculateTaxes(sessions);
-    std::cout << calculator.generateTaxReport(summary) << "\n";
-    
-    // Show any important reminders
-    if (!summary.documentationReminders.empty())
+
+    std::cout << "Searches location, notes and documentation notes. Words must all match;\n"
+              << "OR separates alternatives and a trailing * matches a prefix\n"
+              << "(e.g. \"mohegan sun w2g\", \"bellagio OR wynn\", \"receipt*\").\n\n";
+    std::string query = getStringInput("Search for: ");
+    if (query.find_first_not_of(" \t") == std::string::npos)
     {
-        std::cout << "\nIMPORTANT REMINDERS:\n";
-        for (const auto& reminder : summary.documentationReminders)
+        std::cout << "Nothing to search for.\n";
+        return;
+    }
+
+    // Optional filters narrow the matches further
+    std::string fromDate, toDate;
+    bool fromSet = getOptionalDateInput("From (MM-DD-YYYY) [Enter for any]: ", fromDate);
+    bool toSet = getOptionalDateInput("To (MM-DD-YYYY) [Enter for any]: ", toDate);
+    std::string state = getStringInput("State code [Enter for any]: ");
+    std::transform(state.begin(), state.end(), state.begin(), ::toupper);
+    long long fromDay = fromSet ? GamblingSession::dateToDayNumber(fromDate) : 0;
+    long long toDay = toSet ? GamblingSession::dateToDayNumber(toDate) : 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SessionId> hits = textIndex.search(query);
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Display numbers, as in View All Sessions
+    std::vector<size_t> positions;
+    for (SessionId id : hits)
+    {
+        const GamblingSession* session = sessions.find(id);
+        if (!session) continue;
+        if (!state.empty() && session->getState() != state) continue;
+        if (fromSet || toSet)
         {
-            std::cout << "• " << reminder << "\n";
+            if (!GamblingSession::isValidDate(session->getDate())) continue;   // Undated never matches a range
+            long long day = GamblingSession::dateToDayNumber(session->getDate());
+            if ((fromSet && day < fromDay) || (toSet && day > toDay)) continue;
+        }
+        positions.push_back(sessions.positionOf(id));
+    }
+    std::sort(positions.begin(), positions.end());
+
+    const size_t MAX_SHOWN = 50;
+    double totalWinnings = 0, totalLosses = 0, totalWithheld = 0;
+    std::vector<GamblingSession> shown;
+    for (size_t i = 0; i < positions.size() && i < MAX_SHOWN; i++)
+    {
+        shown.push_back(sessions[positions[i]]);
+    }
+    std::vector<uint8_t> thresholdReached;
+    calculator.getTaxRules().getWithholdingClassifier().classify(shown, thresholdReached);
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        const GamblingSession& session = sessions[positions[i]];
+        if (i < MAX_SHOWN)
+        {
+            std::cout << "\n--- Session " << (positions[i] + 1) << " ---\n";
+            std::cout << session.toString(thresholdReached[i] != 0);
         }
+        if (session.isWin()) totalWinnings += session.getNetResult();
+        else if (session.isLoss()) totalLosses += std::abs(session.getNetResult());
+        totalWithheld += session.getWithheldAmount();
+    }
+
+    std::cout << "\n" << std::string(50, '=') << "\n";
+    std::cout << positions.size() << " matching sessions";
+    if (hits.size() != positions.size())
+    {
+        std::cout << " (" << hits.size() << " before the date/state filter)";
+    }
+    std::cout << ", found in " << std::fixed << std::setprecision(1) << elapsedMs << " ms\n";
+    if (positions.size() > MAX_SHOWN)
+    {
+        std::cout << "Showing the first " << MAX_SHOWN << "; narrow the search to see the rest.\n";
+    }
+    if (!positions.empty())
+    {
+        std::cout << "Total Winnings: $" << std::setprecision(2) << totalWinnings << "\n";
+        std::cout << "Total Losses: $" << totalLosses << "\n";
+        std::cout << "Net Result: $" << (totalWinnings - totalLosses) << "\n";
+        std::cout << "Tax Withheld: $" << totalWithheld << "\n";
     }
 }
 
@@ -261,60 +1248,451 @@ void ConsoleInterface::showDocumentationReminders()
 
 void ConsoleInterface::saveToFile(const std::string& filename)
 {
-    std::ofstream file(filename);
+    saveSnapshot(filename, takeSnapshot());
+}
+
+void ConsoleInterface::saveSnapshot(const std::string& filename, const std::shared_ptr<const SessionSnapshot>& snapshot)
+{
+    size_t sessionCount = snapshot->sessions.size();
+    size_t batchCount = snapshot->ticketBatches->size();
+    BackgroundTasks::Handle task = tasks.submit("Save " + filename,
+        [snapshot, filename](TaskProgress& progress)
+        {
+            writeSessionFile(filename, *snapshot, progress);
+        },
+        [filename, sessionCount, batchCount](const BackgroundTasks::Task& task)
+        {
+            if (task.state == BackgroundTasks::State::DONE)
+            {
+                std::cout << "✅ Saved " << sessionCount << " sessions";
+                if (batchCount > 0)
+                {
+                    std::cout << " and " << batchCount << " ticket batches";
+                }
+                std::cout << " to " << filename << "\n";
+            }
+            else if (task.state == BackgroundTasks::State::CANCELLED)
+            {
+                std::cout << "Save to " << filename << " cancelled; the file was left as it was.\n";
+            }
+            else
+            {
+                std::cout << "❌ Error: " << task.error << "\n";
+            }
+        });
+    finishInForeground(task, "Saving " + filename);
+}
+
+void ConsoleInterface::writeSessionFile(const std::string& filename, const SessionSnapshot& snapshot, TaskProgress& progress)
+{
+    TRACE_SCOPE("saveToFile");
+    
+    // Written beside the target and renamed over it, so a cancelled or failed
+    // save leaves the previous file intact
+    std::string tempName = filename + ".tmp";
+    bool archive = SessionFileReader::hasExtension(filename, ".gsa");
+    std::ofstream file(tempName, archive ? std::ios::out | std::ios::binary : std::ios::out);
     if (!file.is_open())
     {
-        std::cout << "❌ Error: Could not save to file " << filename << "\n";
-        return;
+        throw std::runtime_error("Could not save to file " + filename);
+    }
+    
+    try
+    {
+        if (SessionFileReader::hasExtension(filename, ".json"))
+        {
+            SessionJson::writeSessions(file, snapshot.sessions, *snapshot.ticketBatches);
+        }
+        else if (archive)
+        {
+            progress.setTotal(snapshot.sessions.size() + snapshot.ticketBatches->size());
+            ArchiveWriter writer(file);
+            for (size_t i = 0; i < snapshot.sessions.size(); i++)
+            {
+                if (i % PROGRESS_INTERVAL == 0)
+                {
+                    progress.checkCancelled();
+                    progress.setDone(i);
+                }
+                writer.add(snapshot.sessions[i]);
+            }
+            for (const auto& batch : *snapshot.ticketBatches)
+            {
+                writer.add(batch);
+            }
+            writer.finish();
+        }
+        else
+        {
+            writeCSV(file, snapshot, progress);
+        }
+        
+        progress.checkCancelled();
+        file.close();
+        if (!file || std::rename(tempName.c_str(), filename.c_str()) != 0)
+        {
+            throw std::runtime_error("Could not save to file " + filename);
+        }
+    }
+    catch (...)
+    {
+        file.close();
+        std::remove(tempName.c_str());
+        throw;
     }
+}
+
+void ConsoleInterface::writeCSV(std::ostream& file, const SessionSnapshot& snapshot, TaskProgress& progress)
+{
+    progress.setTotal(snapshot.sessions.size() + snapshot.ticketBatches->size());
     
     // Write CSV header
-    file << "Date,Location,State,GameType,BuyIn,CashOut,TaxWithheld,WithheldAmount,DocumentationNote,Notes\n";
+    file << SessionFileReader::CSV_HEADER << "\n";
     
     // Write sessions
-    for (const auto& session : sessions)
+    for (size_t i = 0; i < snapshot.sessions.size(); i++)
     {
-        file << session.toCSV() << "\n";
+        if (i % PROGRESS_INTERVAL == 0)
+        {
+            progress.checkCancelled();
+            progress.setDone(i);
+        }
+        file << snapshot.sessions[i].toCSV() << "\n";
     }
     
-    file.close();
-    std::cout << "✅ Saved " << sessions.size() << " sessions to " << filename << "\n";
+    for (const auto& batch : *snapshot.ticketBatches)
+    {
+        file << batch.toCSV() << "\n";
+    }
 }
 
-void ConsoleInterface::loadFromFile(const std::string& filename)
+void ConsoleInterface::exportToJson(const std::string& sessionsFile, const std::string& summaryFile)
 {
-    std::ifstream file(filename);
-    if (!file.is_open())
+    std::shared_ptr<const SessionSnapshot> snapshot = takeSnapshot();
+    saveSnapshot(sessionsFile, snapshot);
+    
+    // The summary uses the settings in effect now, even if they change before it runs
+    std::shared_ptr<const TaxCalculator> rules = std::make_shared<TaxCalculator>(calculator);
+    BackgroundTasks::Handle task = tasks.submit("Export tax summary to " + summaryFile,
+        [snapshot, rules, summaryFile](TaskProgress& progress)
+        {
+            TaxSummary summary = rules->calculateTaxes(snapshot->sessions, *snapshot->ticketBatches);
+            progress.checkCancelled();
+            
+            std::string tempName = summaryFile + ".tmp";
+            std::ofstream file(tempName);
+            if (!file.is_open())
+            {
+                throw std::runtime_error("Could not save to file " + summaryFile);
+            }
+            SessionJson::writeTaxSummary(file, summary);
+            file.close();
+            if (!file || std::rename(tempName.c_str(), summaryFile.c_str()) != 0)
+            {
+                std::remove(tempName.c_str());
+                throw std::runtime_error("Could not save to file " + summaryFile);
+            }
+        },
+        [summaryFile](const BackgroundTasks::Task& task)
+        {
+            if (task.state == BackgroundTasks::State::DONE)
+            {
+                std::cout << "✅ Saved tax summary to " << summaryFile << "\n";
+            }
+            else if (task.state == BackgroundTasks::State::FAILED)
+            {
+                std::cout << "❌ Error: " << task.error << "\n";
+            }
+        });
+    finishInForeground(task, "Exporting the tax summary");
+}
+
+void ConsoleInterface::mergeSessionFiles()
+{
+    showHeader("MERGE SESSION FILES BY DATE");
+    std::cout << "Combines session files (CSV, JSON or .gsa, each in any order) into one CSV in\n"
+              << "date order. Files too large for memory are sorted on disk in pieces.\n\n";
+    
+    std::string list = getStringInput("Files separated by commas, or a directory of them: ");
+    std::vector<std::string> sources;
+    std::istringstream names(list);
+    std::string name;
+    while (std::getline(names, name, ','))
     {
-        std::cout << "❌ Error: Could not load from file " << filename << "\n";
+        size_t start = name.find_first_not_of(" \t");
+        if (start == std::string::npos) continue;
+        sources.push_back(name.substr(start, name.find_last_not_of(" \t") - start + 1));
+    }
+    std::error_code error;
+    if (sources.size() == 1 && std::filesystem::is_directory(sources[0], error))
+    {
+        sources = SessionSorter::listSessionFiles(sources[0]);
+    }
+    if (sources.empty())
+    {
+        std::cout << "No session files to merge.\n";
         return;
     }
     
-    sessions.clear();
-    std::string line;
+    std::string output = getStringInput("Output file (Enter for merged_sessions.csv): ");
+    if (output.empty()) output = "merged_sessions.csv";
+    if (std::find(sources.begin(), sources.end(), output) != sources.end())
+    {
+        std::cout << "❌ The output file can't also be one of the files being merged.\n";
+        return;
+    }
     
-    // Skip header line
-    std::getline(file, line);
+    SortOptions options;
+    options.removeDuplicates = getBoolInput("Drop sessions an earlier file already has? (y/n): ");
     
-    int loaded = 0;
-    while (std::getline(file, line))
+    std::shared_ptr<SortStats> stats = std::make_shared<SortStats>();
+    std::shared_ptr<CappedWarnings> warnings = std::make_shared<CappedWarnings>();
+    size_t fileCount = sources.size();
+    BackgroundTasks::Handle task = tasks.submit("Merge " + std::to_string(fileCount) + " files into " + output,
+        [sources, output, options, stats, warnings](TaskProgress& progress)
+        {
+            *stats = SessionSorter::sortFiles(sources, output, options, progress,
+                [&warnings](const std::string& message) { warnings->add(message); });
+        },
+        [output, fileCount, stats, warnings](const BackgroundTasks::Task& task)
+        {
+            warnings->print();
+            if (task.state == BackgroundTasks::State::CANCELLED)
+            {
+                std::cout << "Merging into " << output << " cancelled; it was not changed.\n";
+                return;
+            }
+            if (task.state == BackgroundTasks::State::FAILED)
+            {
+                std::cout << "❌ Error: " << task.error << "\n";
+                return;
+            }
+            
+            std::cout << "✅ Wrote " << stats->written << " records from " << fileCount
+                      << " files to " << output << " in date order\n";
+            if (stats->duplicates > 0)
+            {
+                std::cout << "Dropped " << stats->duplicates << " sessions an earlier file already had.\n";
+            }
+            if (stats->runs > 0)
+            {
+                std::cout << "Sorted on disk in " << stats->runs << " pieces (" << stats->mergePasses
+                          << " merge passes).\n";
+            }
+        });
+    finishInForeground(task, "Merging into " + output);
+}
+
+void ConsoleInterface::promptAndLoadFromFile(const std::string& filename)
+{
+    if (sessions.empty() && ticketBatches.empty())
+    {
+        loadFromFile(filename);
+        return;
+    }
+    
+    std::cout << sessions.size() << " sessions are already loaded.\n";
+    bool merge = getBoolInput("Merge the file into them instead of replacing? (y/n): ");
+    if (!merge)
     {
-        if (!line.empty())
+        loadFromFile(filename);
+        return;
+    }
+    
+    std::cout << "\nSessions matching one already loaded:\n";
+    std::cout << "1. Skip duplicates\n";
+    std::cout << "2. Keep but flag them in the notes\n";
+    std::cout << "3. Keep them unchanged\n";
+    std::cout << "Choose (1-3): ";
+    
+    int choice = getUserChoice();
+    DuplicateMode mode = choice == 2 ? DuplicateMode::FLAG
+                       : choice == 3 ? DuplicateMode::KEEP
+                       : DuplicateMode::SKIP;
+    loadFromFile(filename, true, mode);
+}
+
+void ConsoleInterface::loadFromFile(const std::string& filename, bool merge, DuplicateMode duplicateMode)
+{
+    // Parsing runs in the background; the records are admitted here, on the
+    // console thread, once it completes
+    std::shared_ptr<ImportBuffer> import = std::make_shared<ImportBuffer>();
+    uint64_t versionAtSubmit = dataVersion;
+    BackgroundTasks::Handle task = tasks.submit("Load " + filename,
+        [import, filename](TaskProgress& progress)
+        {
+            readSessionFile(filename, *import, progress);
+        },
+        [this, import, filename, merge, duplicateMode, versionAtSubmit](const BackgroundTasks::Task& task)
         {
-            try
+            if (task.state == BackgroundTasks::State::DONE)
+            {
+                bool replace = !merge;
+                if (replace && dataVersion != versionAtSubmit)
+                {
+                    // Replacing would drop whatever was added, edited or deleted while the file loaded
+                    std::cout << "\nSessions were changed while " << filename << " was loading.\n";
+                    replace = getBoolInput("Replace them with the file anyway, discarding those changes? (y/n): ");
+                    if (!replace)
+                    {
+                        std::cout << "Merging the file into them instead; duplicates are skipped.\n";
+                    }
+                }
+                applyImport(filename, *import, !replace, replace ? duplicateMode : DuplicateMode::SKIP);
+            }
+            else if (task.state == BackgroundTasks::State::CANCELLED)
             {
-                sessions.push_back(GamblingSession::fromCSV(line));
-                loaded++;
+                std::cout << "Loading " << filename << " cancelled; no sessions were changed.\n";
             }
-            catch (const std::exception& e)
+            else
             {
-                std::cout << "Warning: Skipped invalid line: " << line << "\n";
+                std::cout << "❌ Error: " << task.error << "\n";
             }
-        }
+        });
+    finishInForeground(task, "Loading " + filename);
+}
+
+void ConsoleInterface::readSessionFile(const std::string& filename, ImportBuffer& import, TaskProgress& progress)
+{
+    TRACE_SCOPE("loadFromFile");
+    MEMORY_SCOPE(MemoryTag::IMPORT_BUFFERS);
+    SessionFileReader::read(filename,
+        [&import](GamblingSession& session)
+        {
+            MEMORY_SCOPE(MemoryTag::SESSION_STORAGE);
+            import.sessions.push_back(std::move(session));
+        },
+        [&import](TicketBatch& batch)
+        {
+            MEMORY_SCOPE(MemoryTag::SESSION_STORAGE);
+            import.ticketBatches.push_back(std::move(batch));
+        },
+        [&import](const std::string& message)
+        {
+            import.messages.push_back(message);
+        },
+        progress);
+}
+
+void ConsoleInterface::applyImport(const std::string& filename, ImportBuffer& import, bool merge, DuplicateMode duplicateMode)
+{
+    TRACE_SCOPE("applyImport");
+    for (const auto& message : import.messages)
+    {
+        std::cout << message << "\n";
+    }
+    
+    if (!merge)
+    {
+        sessions.clear();
+        ticketBatches.clear();
+        sharedBatches.reset();
+        sessionIndex.clear();
+        timeIndex.clear();
+        partitions.clear();
+        textIndex.clear();
+        dataVersion++;
+    }
+    
+    size_t batchesBefore = ticketBatches.size();
+    size_t unknownBefore = 0;
+    for (const auto& entry : unknownGameTypes) unknownBefore += entry.second;
+    size_t rewritesBefore = locationRewrites;
+    MergeStats stats;
+    sessionIndex.beginImport();
+    
+    int loaded = 0;
+    sessions.reserve(sessions.size() + import.sessions.size());
+    for (auto& session : import.sessions)
+    {
+        if (admitSession(session, duplicateMode, stats)) loaded++;
+    }
+    for (auto& batch : import.ticketBatches)
+    {
+        admitBatch(batch, duplicateMode, stats);
+    }
+    import = ImportBuffer();
+    
+    std::cout << "✅ Loaded " << loaded << " sessions";
+    if (ticketBatches.size() > batchesBefore)
+    {
+        std::cout << " and " << (ticketBatches.size() - batchesBefore) << " ticket batches";
+    }
+    std::cout << " from " << filename << "\n";
+    
+    if (stats.skipped > 0)
+    {
+        std::cout << "Skipped " << stats.skipped << " duplicate entries.\n";
+    }
+    if (stats.flagged > 0)
+    {
+        std::cout << "Flagged " << stats.flagged << " possible duplicates (see session notes).\n";
+    }
+    
+    if (locationRewrites > rewritesBefore)
+    {
+        std::cout << (locationRewrites - rewritesBefore) << " locations matched to venue names "
+                  << "(see Location Matches Report).\n";
+    }
+    
+    size_t unknownAfter = 0;
+    for (const auto& entry : unknownGameTypes) unknownAfter += entry.second;
+    if (unknownAfter > unknownBefore)
+    {
+        std::cout << (unknownAfter - unknownBefore) << " records have game types not in config/game_types.cfg "
+                  << "(see Unknown Game Types Report).\n";
     }
     
-    file.close();
-    std::cout << "✅ Loaded " << loaded << " sessions from " << filename << "\n";
+    snapshotAutosave();
+    
+    // Have the summary for the new data ready by the time it is asked for
+    refreshSummary();
+}
+
+bool ConsoleInterface::admitSession(GamblingSession& session, DuplicateMode duplicateMode, MergeStats& stats)
+{
+    MEMORY_SCOPE(MemoryTag::SESSION_STORAGE);
+    session.setGameType(canonicalGameType(session.getGameType()));
+    std::string location = session.getLocation();
+    if (venues.normalize(location) && location != session.getLocation())
+    {
+        // The spelling on the statement stays in the notes
+        std::string entered = "Location entered as " + session.getLocation();
+        session.setNotes(session.getNotes().empty() ? entered : session.getNotes() + " | " + entered);
+        session.setLocation(location);
+        locationRewrites++;
+    }
+    if (!sessionIndex.admit(session, duplicateMode, stats))
+    {
+        return false;
+    }
+    timeIndex.add(session);
+    dataVersion++;
+    SessionId id = sessions.insert(std::move(session));
+    partitions.add(id, *sessions.find(id));
+    textIndex.add(id, *sessions.find(id));
+    return true;
+}
+
+void ConsoleInterface::admitBatch(TicketBatch& batch, DuplicateMode duplicateMode, MergeStats& stats)
+{
+    MEMORY_SCOPE(MemoryTag::SESSION_STORAGE);
+    batch.setGameType(canonicalGameType(batch.getGameType()));
+    std::string location = batch.getLocation();
+    if (venues.normalize(location) && location != batch.getLocation())
+    {
+        // Batches have no notes; the Location Matches Report lists the spelling
+        batch.setLocation(location);
+        locationRewrites++;
+    }
+    if (sessionIndex.admit(batch, duplicateMode, stats))
+    {
+        timeIndex.add(batch);
+        partitions.add(ticketBatches.size(), batch);
+        dataVersion++;
+        ticketBatches.push_back(std::move(batch));
+        sharedBatches.reset();
+    }
 }
 
 // Helper functions implementation continues...
@@ -327,7 +1705,7 @@ std::string ConsoleInterface::getStringInput(const std::string& prompt)
     return input;
 }
 
-std::string ConsoleInterface::getLocationInput(const std::string& prompt)
+std::string ConsoleInterface::getLocationInput(const std::string& prompt, bool allowEmpty)
 {
     std::string input;
     const size_t MAX_LENGTH = 100;  // Reasonable maximum for location names
@@ -343,6 +1721,10 @@ std::string ConsoleInterface::getLocationInput(const std::string& prompt)
 
         if (input.empty())
         {
+            if (allowEmpty)
+            {
+                return input;
+            }
             std::cout << "Location cannot be empty. Please enter a location name.\n";
             continue;
         }
@@ -371,6 +1753,12 @@ std::string ConsoleInterface::getLocationInput(const std::string& prompt)
             continue;
         }
 
+        std::string venue = input;
+        if (venues.normalize(venue) && venue != input &&
+            getBoolInput("Did you mean " + venue + "? (y/n, Enter keeps it as typed): "))
+        {
+            return venue;
+        }
         return input;
     }
 }
@@ -399,6 +1787,28 @@ std::string ConsoleInterface::getDateInput(const std::string& prompt)
     }
 }
 
+bool ConsoleInterface::getOptionalDateInput(const std::string& prompt, std::string& date)
+{
+    std::string input;
+    while (true)
+    {
+        std::cout << prompt;
+        std::getline(std::cin, input);
+        
+        if (input.empty())
+        {
+            return false;
+        }
+        if (isValidDate(input))
+        {
+            date = input;
+            return true;
+        }
+        
+        std::cout << "Invalid date format. Please enter date as MM-DD-YYYY (e.g., 01-15-2024).\n";
+    }
+}
+
 double ConsoleInterface::getDoubleInput(const std::string& prompt)
 {
     double value;
@@ -477,11 +1887,21 @@ std::string ConsoleInterface::getGameType()
         case 3: return "Poker";
         case 4: return "Blackjack";
         case 5: return "Sports Betting";
-        case 6: return getStringInput("Enter game type: ");
+        case 6: return canonicalGameType(getStringInput("Enter game type: "));
         default: return "Other";
     }
 }
 
+std::string ConsoleInterface::canonicalGameType(const std::string& gameType)
+{
+    std::string canonical = gameType;
+    if (!calculator.getTaxRules().getGameTypes().canonicalize(canonical))
+    {
+        unknownGameTypes[gameType]++;
+    }
+    return canonical;
+}
+
 std::string ConsoleInterface::getStateCode()
 {
     std::string homeState = userProfile.getHomeState();
@@ -655,18 +2075,31 @@ void ConsoleInterface::setProfessionalMode()
 
 void ConsoleInterface::clearAllSessions()
 {
-    if (sessions.empty())
+    if (sessions.empty() && ticketBatches.empty())
     {
         std::cout << "No sessions to clear.\n";
         return;
     }
     
-    std::cout << "This will delete all " << sessions.size() << " sessions.\n";
+    std::cout << "This will delete all " << sessions.size() << " sessions";
+    if (!ticketBatches.empty())
+    {
+        std::cout << " and " << ticketBatches.size() << " ticket batches";
+    }
+    std::cout << ".\n";
     bool confirm = getBoolInput("Are you sure? (y/n): ");
     
     if (confirm)
     {
         sessions.clear();
+        ticketBatches.clear();
+        sharedBatches.reset();
+        sessionIndex.clear();
+        timeIndex.clear();
+        partitions.clear();
+        textIndex.clear();
+        dataVersion++;
+        snapshotAutosave();
         std::cout << "✅ All sessions cleared.\n";
     }
     else
@@ -692,6 +2125,7 @@ void ConsoleInterface::editUserProfile()
     bool confirm = getBoolInput("Continue with profile setup? (y/n): ");
     if (confirm) {
         userProfile.runSetupWizard();
+        calculator.setFilingStatus(userProfile.getFilingStatus());
         std::cout << "\n✅ Profile updated successfully!\n";
     } else {
         std::cout << "Profile edit cancelled.\n";
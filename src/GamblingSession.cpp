@@ -3,6 +3,7 @@
 #include <iomanip>
 #include <stdexcept>
 #include <cctype>
+#include <cstdio>
 
 // Default constructor
 GamblingSession::GamblingSession()
@@ -23,33 +24,7 @@ GamblingSession::GamblingSession(const std::string& date, const std::string& loc
 {
 }
 
-bool GamblingSession::triggersWithholding() const
-{
-    double winnings = getNetResult();
-    if (winnings <= 0) return false;
-    
-    // IRS withholding thresholds by game type
-    if (gameType == "Lottery" || gameType == "Sweepstakes")
-    {
-        return winnings >= 5000.0;  // $5,000+ for lottery/sweepstakes
-    }
-    else if (gameType == "Slot Machine" || gameType == "Bingo" || gameType == "Keno")
-    {
-        return winnings >= 1200.0;  // $1,200+ for slots/bingo/keno
-    }
-    else if (gameType == "Poker Tournament")
-    {
-        return winnings >= 5000.0;  // $5,000+ for poker tournaments
-    }
-    else if (gameType == "Horse Racing" || gameType == "Dog Racing")
-    {
-        return winnings >= 600.0 && (winnings >= buyIn * 300); // $600+ and 300-to-1 odds
-    }
-    
-    return false; // Default: no withholding required
-}
-
-std::string GamblingSession::toString() const
+std::string GamblingSession::toString(bool thresholdReached) const
 {
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(2);
@@ -66,7 +41,7 @@ std::string GamblingSession::toString() const
         oss << "Tax Withheld: $" << withheldAmount << "\n";
     }
     
-    if (triggersWithholding() && !taxWithheld)
+    if (thresholdReached && !taxWithheld)
     {
         oss << "⚠️  WARNING: This win may require tax withholding!\n";
     }
@@ -158,4 +133,52 @@ bool GamblingSession::isValidDate(const std::string& date)
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+long long GamblingSession::dateToDayNumber(int year, int month, int day)
+{
+    // Civil-from-days inverse (H. Hinnant's algorithm), valid for any Gregorian date
+    year -= month <= 2 ? 1 : 0;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    long long yearOfEra = year - era * 400;
+    long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+long long GamblingSession::dateToDayNumber(const std::string& date)
+{
+    // Shape check only (callers on hot paths have already run isValidDate)
+    bool wellFormed = date.length() == 10 && date[2] == '-' && date[5] == '-';
+    for (size_t i = 0; wellFormed && i < 10; i++)
+    {
+        if (i != 2 && i != 5 && !std::isdigit(static_cast<unsigned char>(date[i]))) wellFormed = false;
+    }
+    if (!wellFormed)
+    {
+        throw std::invalid_argument("Invalid date: " + date + " (expected MM-DD-YYYY)");
+    }
+
+    int month = (date[0] - '0') * 10 + (date[1] - '0');
+    int day = (date[3] - '0') * 10 + (date[4] - '0');
+    int year = (date[6] - '0') * 1000 + (date[7] - '0') * 100 + (date[8] - '0') * 10 + (date[9] - '0');
+    return dateToDayNumber(year, month, day);
+}
+
+std::string GamblingSession::dayNumberToDate(long long dayNumber)
+{
+    dayNumber += 719468;
+    long long era = (dayNumber >= 0 ? dayNumber : dayNumber - 146096) / 146097;
+    long long dayOfEra = dayNumber - era * 146097;
+    long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    long long monthIndex = (5 * dayOfYear + 2) / 153;
+    int day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    int month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    long long year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+    // Room for any int month/day and long long year, so nothing is ever cut off
+    char text[48];
+    std::snprintf(text, sizeof(text), "%02d-%02d-%04lld", month, day, year);
+    return std::string(text);
+}
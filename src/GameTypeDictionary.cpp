@@ -0,0 +1,339 @@
+#include "../include/GameTypeDictionary.h"
+#include "../include/StartupScheduler.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    const char* const BUILT_IN_TYPES[] = {
+        "Lottery", "Sweepstakes", "Slot Machine", "Bingo", "Keno", "Poker", "Poker Tournament",
+        "Blackjack", "Roulette", "Craps", "Baccarat", "Sports Betting", "Horse Racing", "Dog Racing", "Other"
+    };
+
+    const int SEEDS_PER_SIZE = 64;
+    const uint64_t MAX_TABLE_SIZE = 1u << 22;
+
+    // Lower-case form of each byte; 0 marks a separator (space, '_', '-', tab, CR, LF)
+    struct FoldTable
+    {
+        unsigned char fold[256];
+
+        FoldTable()
+        {
+            for (int c = 0; c < 256; c++)
+            {
+                fold[c] = static_cast<unsigned char>(std::tolower(c));
+            }
+            for (unsigned char separator : {' ', '_', '-', '\t', '\r', '\n'})
+            {
+                fold[separator] = 0;
+            }
+            fold[0] = 0;
+        }
+    };
+
+    const unsigned char* foldTable()
+    {
+        static const FoldTable table;
+        return table.fold;
+    }
+
+    // Yields the normalized form of a string one character at a time:
+    // lower case, separators collapsed to one space, none leading or trailing
+    class NormalizedReader
+    {
+    public:
+        explicit NormalizedReader(const std::string& text)
+            : fold(foldTable()), current(text.data()), end(text.data() + text.size()),
+              emitted(false), pendingSpace(false) {}
+
+        int next()
+        {
+            while (current != end)
+            {
+                unsigned char c = fold[static_cast<unsigned char>(*current)];
+                if (c == 0)
+                {
+                    pendingSpace = emitted;
+                    current++;
+                    continue;
+                }
+                if (pendingSpace)
+                {
+                    pendingSpace = false;
+                    return ' ';
+                }
+                current++;
+                emitted = true;
+                return c;
+            }
+            return -1;
+        }
+
+    private:
+        const unsigned char* fold;
+        const char* current;
+        const char* end;
+        bool emitted;
+        bool pendingSpace;
+    };
+
+    std::string trim(const std::string& str)
+    {
+        size_t start = str.find_first_not_of(" \t\r");
+        if (start == std::string::npos) return "";
+
+        size_t end = str.find_last_not_of(" \t\r");
+        return str.substr(start, end - start + 1);
+    }
+}
+
+GameTypeDictionary::GameTypeDictionary()
+    : seed(0), mask(0)
+{
+    for (const char* name : BUILT_IN_TYPES)
+    {
+        addName(name);
+    }
+    compile();
+}
+
+std::string GameTypeDictionary::normalize(const std::string& gameType)
+{
+    std::string normalized;
+    normalized.reserve(gameType.size());
+    NormalizedReader reader(gameType);
+    for (int c = reader.next(); c >= 0; c = reader.next())
+    {
+        normalized += static_cast<char>(c);
+    }
+    return normalized;
+}
+
+uint64_t GameTypeDictionary::hash(const std::string& gameType, uint64_t hashSeed) const
+{
+    // FNV-1a over the normalized characters, finished with a mix so the low
+    // bits used for the slot depend on every character
+    uint64_t h = 14695981039346656037ULL ^ (hashSeed * 0x9E3779B97F4A7C15ULL);
+    NormalizedReader reader(gameType);
+    for (int c = reader.next(); c >= 0; c = reader.next())
+    {
+        h ^= static_cast<uint64_t>(c);
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+}
+
+int GameTypeDictionary::findEntry(const std::string& normalized) const
+{
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].first == normalized) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int GameTypeDictionary::addName(const std::string& canonical)
+{
+    std::string normalized = normalize(canonical);
+    if (normalized.empty())
+    {
+        return UNKNOWN;
+    }
+
+    // Already known, either as a name or as an alias of one
+    int entry = findEntry(normalized);
+    if (entry >= 0)
+    {
+        return entries[entry].second;
+    }
+
+    int id = static_cast<int>(names.size());
+    names.push_back(canonical);
+    entries.push_back(std::make_pair(normalized, id));
+    return id;
+}
+
+bool GameTypeDictionary::insertAlias(const std::string& canonical, const std::string& alias)
+{
+    int id = addName(canonical);
+    std::string normalized = normalize(alias);
+    if (id == UNKNOWN || normalized.empty())
+    {
+        return id != UNKNOWN;
+    }
+
+    int entry = findEntry(normalized);
+    if (entry >= 0)
+    {
+        return entries[entry].second == id;
+    }
+    entries.push_back(std::make_pair(normalized, id));
+    return true;
+}
+
+bool GameTypeDictionary::addAlias(const std::string& canonical, const std::string& alias)
+{
+    bool added = insertAlias(canonical, alias);
+    compile();
+    return added;
+}
+
+void GameTypeDictionary::compile()
+{
+    // Smallest power of two at least twice the spelling count, growing only
+    // when no seed in a batch places every spelling in its own slot
+    uint64_t size = 8;
+    while (size < 2 * entries.size())
+    {
+        size <<= 1;
+    }
+
+    for (; size <= MAX_TABLE_SIZE; size <<= 1)
+    {
+        for (int attempt = 1; attempt <= SEEDS_PER_SIZE; attempt++)
+        {
+            table.assign(size, -1);
+            bool placed = true;
+            for (size_t i = 0; i < entries.size() && placed; i++)
+            {
+                int32_t& slot = table[hash(entries[i].first, attempt) & (size - 1)];
+                placed = slot < 0;
+                slot = static_cast<int32_t>(i);
+            }
+            if (placed)
+            {
+                seed = attempt;
+                mask = size - 1;
+                return;
+            }
+        }
+    }
+    throw std::runtime_error("Could not compile the game type dictionary");
+}
+
+int GameTypeDictionary::find(const std::string& gameType) const
+{
+    int32_t entry = table[hash(gameType, seed) & mask];
+    if (entry < 0)
+    {
+        return UNKNOWN;
+    }
+
+    // The slot holds the only spelling that can match; compare it
+    const std::string& key = entries[entry].first;
+    NormalizedReader reader(gameType);
+    for (char expected : key)
+    {
+        if (reader.next() != static_cast<unsigned char>(expected)) return UNKNOWN;
+    }
+    return reader.next() < 0 ? entries[entry].second : UNKNOWN;
+}
+
+bool GameTypeDictionary::canonicalize(std::string& gameType) const
+{
+    int id = find(gameType);
+    if (id == UNKNOWN)
+    {
+        return false;
+    }
+    if (gameType != names[id])
+    {
+        gameType = names[id];
+    }
+    return true;
+}
+
+bool GameTypeDictionary::load(const std::string& path)
+{
+    TRACE_SCOPE("GameTypeDictionary::load");
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = trim(line);
+
+        // Skip empty lines and comments
+        if (line.empty() || line[0] == '#') continue;
+
+        // Canonical Name = alias, alias, ...
+        size_t equalPos = line.find('=');
+        std::string canonical = trim(line.substr(0, equalPos));
+        if (canonical.empty()) continue;
+        addName(canonical);
+        if (equalPos == std::string::npos) continue;
+
+        std::istringstream aliases(line.substr(equalPos + 1));
+        std::string alias;
+        while (std::getline(aliases, alias, ','))
+        {
+            alias = trim(alias);
+            if (!alias.empty() && !insertAlias(canonical, alias))
+            {
+                int owner = entries[findEntry(normalize(alias))].second;
+                StartupScheduler::output() << "Warning: game type alias '" << alias << "' already names "
+                          << names[owner] << "; ignored for " << canonical << "\n";
+            }
+        }
+    }
+
+    compile();
+    return true;
+}
+
+std::string GameTypeDictionary::generateUnknownReport(const std::map<std::string, size_t>& unknownCounts) const
+{
+    std::ostringstream report;
+    report << "=== UNKNOWN GAME TYPES ===\n";
+    report << "Dictionary: " << names.size() << " game types, " << entries.size() << " spellings\n\n";
+
+    if (unknownCounts.empty())
+    {
+        report << "Every game type entered or imported this run matched the dictionary.\n";
+        return report.str();
+    }
+
+    std::vector<std::pair<std::string, size_t>> sorted(unknownCounts.begin(), unknownCounts.end());
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, size_t>& a,
+                                               const std::pair<std::string, size_t>& b)
+    {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    size_t records = 0;
+    for (const auto& entry : sorted)
+    {
+        records += entry.second;
+    }
+    report << sorted.size() << " unrecognized spellings on " << records << " records (kept as entered):\n";
+    for (const auto& entry : sorted)
+    {
+        std::string text = entry.first.empty() ? "(blank)" : entry.first;
+        report << "  " << std::left << std::setw(32) << text.substr(0, 31)
+               << std::right << std::setw(10) << entry.second << "\n";
+    }
+
+    report << "\nThese are grouped separately and get no W-2G threshold. Map them to a\n"
+           << "known type in config/game_types.cfg, e.g. \"Slot Machine = Slots, Video Slots\".\n"
+           << "Known types:";
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        report << (i == 0 ? " " : ", ") << names[i];
+    }
+    report << "\n";
+    return report.str();
+}
@@ -0,0 +1,495 @@
+#include "../include/JsonStream.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+JsonWriter::JsonWriter(std::ostream& out) : out(out), afterKey(false)
+{
+    buffer.reserve(BUFFER_SIZE + 256);
+}
+
+JsonWriter::~JsonWriter()
+{
+    flush();
+}
+
+void JsonWriter::separator()
+{
+    if (afterKey)
+    {
+        afterKey = false;
+        return;
+    }
+    if (!needsComma.empty())
+    {
+        if (needsComma.back())
+        {
+            buffer += ',';
+        }
+        needsComma.back() = true;
+    }
+}
+
+void JsonWriter::flushIfFull()
+{
+    if (buffer.size() >= BUFFER_SIZE)
+    {
+        flush();
+    }
+}
+
+void JsonWriter::flush()
+{
+    if (!buffer.empty())
+    {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+void JsonWriter::appendEscaped(const std::string& text)
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    buffer += '"';
+    for (unsigned char c : text)
+    {
+        switch (c)
+        {
+            case '"': buffer += "\\\""; break;
+            case '\\': buffer += "\\\\"; break;
+            case '\n': buffer += "\\n"; break;
+            case '\r': buffer += "\\r"; break;
+            case '\t': buffer += "\\t"; break;
+            default:
+                if (c < 0x20)
+                {
+                    buffer += "\\u00";
+                    buffer += HEX[c >> 4];
+                    buffer += HEX[c & 0x0F];
+                }
+                else
+                {
+                    buffer += static_cast<char>(c);
+                }
+        }
+    }
+    buffer += '"';
+}
+
+void JsonWriter::beginObject()
+{
+    separator();
+    buffer += '{';
+    needsComma.push_back(false);
+}
+
+void JsonWriter::endObject()
+{
+    buffer += '}';
+    needsComma.pop_back();
+    flushIfFull();
+}
+
+void JsonWriter::beginArray()
+{
+    separator();
+    buffer += '[';
+    needsComma.push_back(false);
+}
+
+void JsonWriter::endArray()
+{
+    buffer += ']';
+    needsComma.pop_back();
+    flushIfFull();
+}
+
+void JsonWriter::key(const std::string& name)
+{
+    separator();
+    appendEscaped(name);
+    buffer += ':';
+    afterKey = true;
+}
+
+void JsonWriter::value(const std::string& text)
+{
+    separator();
+    appendEscaped(text);
+    flushIfFull();
+}
+
+void JsonWriter::value(const char* text)
+{
+    value(std::string(text));
+}
+
+void JsonWriter::value(double number)
+{
+    separator();
+    if (!std::isfinite(number))
+    {
+        buffer += "null";   // JSON has no NaN/Infinity
+        return;
+    }
+
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.15g", number);
+    buffer += text;
+}
+
+void JsonWriter::value(long long number)
+{
+    separator();
+    buffer += std::to_string(number);
+}
+
+void JsonWriter::value(bool flag)
+{
+    separator();
+    buffer += flag ? "true" : "false";
+}
+
+void JsonWriter::nullValue()
+{
+    separator();
+    buffer += "null";
+}
+
+void JsonWriter::moneyValue(double amount)
+{
+    separator();
+
+    // Integer cents formatting: exact, and much faster than printf for bulk exports
+    long long cents = std::llround(amount * 100.0);
+    if (cents < 0)
+    {
+        buffer += '-';
+        cents = -cents;
+    }
+    buffer += std::to_string(cents / 100);
+    buffer += '.';
+    buffer += static_cast<char>('0' + (cents % 100) / 10);
+    buffer += static_cast<char>('0' + cents % 10);
+}
+
+JsonReader::JsonReader(std::istream& in)
+    : in(in), chunk(CHUNK_SIZE), position(0), available(0), consumed(0)
+{
+}
+
+bool JsonReader::fill()
+{
+    consumed += available;
+    in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    available = static_cast<size_t>(in.gcount());
+    position = 0;
+    return available > 0;
+}
+
+int JsonReader::peek()
+{
+    if (position >= available && !fill())
+    {
+        return EOF;
+    }
+    return static_cast<unsigned char>(chunk[position]);
+}
+
+int JsonReader::get()
+{
+    int c = peek();
+    if (c != EOF)
+    {
+        position++;
+    }
+    return c;
+}
+
+void JsonReader::fail(const std::string& message)
+{
+    throw std::runtime_error("JSON error at byte " + std::to_string(consumed + position) + ": " + message);
+}
+
+void JsonReader::skipWhitespace()
+{
+    while (true)
+    {
+        int c = peek();
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+        {
+            return;
+        }
+        position++;
+    }
+}
+
+void JsonReader::expect(const char* literal)
+{
+    for (const char* p = literal; *p; p++)
+    {
+        if (get() != static_cast<unsigned char>(*p))
+        {
+            fail(std::string("expected '") + literal + "'");
+        }
+    }
+}
+
+void JsonReader::parse(JsonHandler& handler)
+{
+    skipWhitespace();
+    parseValue(handler, 0);
+    skipWhitespace();
+    if (peek() != EOF)
+    {
+        fail("unexpected data after document");
+    }
+}
+
+void JsonReader::parseValue(JsonHandler& handler, size_t depth)
+{
+    if (depth > MAX_DEPTH)
+    {
+        fail("nesting too deep");
+    }
+
+    int c = peek();
+    switch (c)
+    {
+        case '{':
+            parseObject(handler, depth + 1);
+            break;
+        case '[':
+            parseArray(handler, depth + 1);
+            break;
+        case '"':
+            parseString();
+            handler.stringValue(token);
+            break;
+        case 't':
+            expect("true");
+            handler.boolValue(true);
+            break;
+        case 'f':
+            expect("false");
+            handler.boolValue(false);
+            break;
+        case 'n':
+            expect("null");
+            handler.nullValue();
+            break;
+        default:
+            if (c == '-' || (c >= '0' && c <= '9'))
+            {
+                parseNumber();
+                handler.numberValue(std::strtod(token.c_str(), nullptr));
+            }
+            else
+            {
+                fail(c == EOF ? "unexpected end of input" : "unexpected character");
+            }
+    }
+}
+
+void JsonReader::parseObject(JsonHandler& handler, size_t depth)
+{
+    get();  // '{'
+    handler.startObject();
+    skipWhitespace();
+
+    if (peek() == '}')
+    {
+        get();
+        handler.endObject();
+        return;
+    }
+
+    while (true)
+    {
+        skipWhitespace();
+        if (peek() != '"')
+        {
+            fail("expected object key");
+        }
+        parseString();
+        handler.key(token);
+
+        skipWhitespace();
+        if (get() != ':')
+        {
+            fail("expected ':'");
+        }
+        skipWhitespace();
+        parseValue(handler, depth);
+        skipWhitespace();
+
+        int c = get();
+        if (c == '}')
+        {
+            break;
+        }
+        if (c != ',')
+        {
+            fail("expected ',' or '}'");
+        }
+    }
+    handler.endObject();
+}
+
+void JsonReader::parseArray(JsonHandler& handler, size_t depth)
+{
+    get();  // '['
+    handler.startArray();
+    skipWhitespace();
+
+    if (peek() == ']')
+    {
+        get();
+        handler.endArray();
+        return;
+    }
+
+    while (true)
+    {
+        skipWhitespace();
+        parseValue(handler, depth);
+        skipWhitespace();
+
+        int c = get();
+        if (c == ']')
+        {
+            break;
+        }
+        if (c != ',')
+        {
+            fail("expected ',' or ']'");
+        }
+    }
+    handler.endArray();
+}
+
+void JsonReader::appendUtf8(uint32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        token += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        token += static_cast<char>(0xC0 | (codePoint >> 6));
+        token += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        token += static_cast<char>(0xE0 | (codePoint >> 12));
+        token += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        token += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        token += static_cast<char>(0xF0 | (codePoint >> 18));
+        token += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        token += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        token += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+void JsonReader::parseString()
+{
+    get();  // opening quote
+    token.clear();
+
+    while (true)
+    {
+        // Copy runs of plain characters straight out of the chunk
+        size_t start = position;
+        while (position < available)
+        {
+            char c = chunk[position];
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20)
+            {
+                break;
+            }
+            position++;
+        }
+        token.append(chunk.data() + start, position - start);
+
+        int c = get();
+        if (c == '"')
+        {
+            return;
+        }
+        if (c == EOF)
+        {
+            fail("unterminated string");
+        }
+        if (c == '\\')
+        {
+            int escape = get();
+            switch (escape)
+            {
+                case '"': token += '"'; break;
+                case '\\': token += '\\'; break;
+                case '/': token += '/'; break;
+                case 'b': token += '\b'; break;
+                case 'f': token += '\f'; break;
+                case 'n': token += '\n'; break;
+                case 'r': token += '\r'; break;
+                case 't': token += '\t'; break;
+                case 'u':
+                {
+                    uint32_t codePoint = 0;
+                    for (int i = 0; i < 4; i++)
+                    {
+                        int h = get();
+                        codePoint <<= 4;
+                        if (h >= '0' && h <= '9') codePoint |= h - '0';
+                        else if (h >= 'a' && h <= 'f') codePoint |= h - 'a' + 10;
+                        else if (h >= 'A' && h <= 'F') codePoint |= h - 'A' + 10;
+                        else fail("bad \\u escape");
+                    }
+                    appendUtf8(codePoint);
+                    break;
+                }
+                default:
+                    fail("bad escape sequence");
+            }
+        }
+        else if (c < 0x20)
+        {
+            fail("control character in string");
+        }
+        else
+        {
+            // The run stopped at a chunk boundary; get() already refilled
+            token += static_cast<char>(c);
+        }
+    }
+}
+
+void JsonReader::parseNumber()
+{
+    token.clear();
+    while (true)
+    {
+        int c = peek();
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+        {
+            token += static_cast<char>(c);
+            position++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    char* end = nullptr;
+    std::strtod(token.c_str(), &end);
+    if (token.empty() || end != token.c_str() + token.size())
+    {
+        fail("malformed number");
+    }
+}
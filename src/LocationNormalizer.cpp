@@ -0,0 +1,447 @@
+#include "../include/LocationNormalizer.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace
+{
+    const size_t MAX_PATTERN_LENGTH = 64;   // One machine word of Myers state
+    const int MAX_EDITS = 3;
+    const size_t MIN_COMMON_POSTINGS = 32;  // Posting lists this short are always walked
+
+    // Folded text uses 37 symbols (space, a-z, 0-9), so a trigram indexes a
+    // flat table directly
+    const uint32_t SYMBOLS = 37;
+    const uint32_t TRIGRAM_CODES = SYMBOLS * SYMBOLS * SYMBOLS;
+
+    uint32_t symbolCode(char c)
+    {
+        if (c >= 'a' && c <= 'z') return 1 + (c - 'a');
+        if (c >= '0' && c <= '9') return 27 + (c - '0');
+        return 0;
+    }
+
+    std::string trim(const std::string& str)
+    {
+        size_t start = str.find_first_not_of(" \t\r");
+        if (start == std::string::npos) return "";
+
+        size_t end = str.find_last_not_of(" \t\r");
+        return str.substr(start, end - start + 1);
+    }
+}
+
+LocationNormalizer::LocationNormalizer()
+    : commonLimit(0), indexDirty(false)
+{
+}
+
+std::string LocationNormalizer::fold(const std::string& location)
+{
+    // "BELLAGIO - Las Vegas, NV" -> "bellagio las vegas nv"
+    std::string folded;
+    folded.reserve(location.size());
+    bool pendingSpace = false;
+    for (char c : location)
+    {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (!std::isalnum(byte))
+        {
+            pendingSpace = !folded.empty();
+            continue;
+        }
+        if (pendingSpace)
+        {
+            folded += ' ';
+            pendingSpace = false;
+        }
+        folded += static_cast<char>(std::tolower(byte));
+    }
+    return folded;
+}
+
+namespace
+{
+    // Myers (1999): pv/mv hold the +1/-1 vertical deltas of one DP column, so
+    // a whole column advances per text character. column(i, score) gets the
+    // edits turning the first m pattern characters into text ending at i.
+    template <typename Column>
+    void scanEdits(const std::string& pattern, size_t m, const char* text, size_t length, bool substring,
+                   Column column)
+    {
+        // Bit i of peq[c] is set when pattern[i] == c
+        uint64_t peq[256] = {};
+        for (size_t i = 0; i < m; i++)
+        {
+            peq[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+        }
+
+        uint64_t pv = ~uint64_t(0);
+        uint64_t mv = 0;
+        const uint64_t high = uint64_t(1) << (m - 1);
+        int score = static_cast<int>(m);
+        for (size_t i = 0; i < length; i++)
+        {
+            uint64_t eq = peq[static_cast<unsigned char>(text[i])];
+            uint64_t xv = eq | mv;
+            uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+            if (ph & high) score++;
+            else if (mh & high) score--;
+
+            // A match may start anywhere in the text unless the whole text must match
+            ph = (ph << 1) | (substring ? 0 : 1);
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+            column(i, score);
+        }
+    }
+}
+
+int LocationNormalizer::editDistance(const std::string& pattern, const std::string& text, bool substring)
+{
+    size_t m = std::min(pattern.size(), MAX_PATTERN_LENGTH);
+    if (m == 0)
+    {
+        return substring ? 0 : static_cast<int>(text.size());
+    }
+
+    int score = static_cast<int>(m);
+    int best = score;
+    scanEdits(pattern, m, text.data(), text.size(), substring, [&](size_t, int column)
+    {
+        score = column;
+        best = std::min(best, column);
+    });
+    return substring ? best : score;
+}
+
+int LocationNormalizer::wordDistance(const std::string& pattern, const std::string& text)
+{
+    size_t m = std::min(pattern.size(), MAX_PATTERN_LENGTH);
+    int best = static_cast<int>(std::max(m, text.size()));
+    if (m == 0)
+    {
+        return best;
+    }
+
+    // One anchored pass per word start, read at every word end
+    for (size_t start = 0; start < text.size(); start++)
+    {
+        if (start > 0 && text[start - 1] != ' ') continue;
+        scanEdits(pattern, m, text.data() + start, text.size() - start, false, [&](size_t i, int score)
+        {
+            size_t end = start + i + 1;
+            if (end == text.size() || text[end] == ' ') best = std::min(best, score);
+        });
+    }
+    return best;
+}
+
+int LocationNormalizer::allowedEdits(size_t length)
+{
+    // A typo per 6 characters; shorter names are never fuzzy candidates
+    return std::min(MAX_EDITS, static_cast<int>(length / 6));
+}
+
+void LocationNormalizer::trigramsOf(const std::string& folded, std::vector<uint32_t>& grams)
+{
+    // Padded with a space at each end so word edges form trigrams too
+    grams.clear();
+    uint32_t previous = 0;
+    uint32_t current = 0;
+    for (size_t i = 0; i <= folded.size(); i++)
+    {
+        uint32_t next = i < folded.size() ? symbolCode(folded[i]) : 0;
+        if (i > 0) grams.push_back((previous * SYMBOLS + current) * SYMBOLS + next);
+        previous = current;
+        current = next;
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+}
+
+void LocationNormalizer::addPattern(const std::string& text, int venue)
+{
+    std::string folded = fold(text);
+    if (folded.empty() || exact.count(folded))
+    {
+        return;     // First mapping of a spelling wins
+    }
+
+    // Short names and abbreviations ("Parx", "Hard Rock AC") are too close to
+    // unrelated words to allow edits, so they only match the whole location.
+    // Left out of the trigram index, they are never fuzzy candidates.
+    bool fuzzy = folded.size() >= 6;
+    size_t wordStart = 0;
+    while (fuzzy && wordStart < folded.size())
+    {
+        size_t wordEnd = folded.find(' ', wordStart);
+        if (wordEnd == std::string::npos) wordEnd = folded.size();
+        if (wordEnd - wordStart < 3) fuzzy = false;
+        wordStart = wordEnd + 1;
+    }
+
+    uint32_t index = static_cast<uint32_t>(patterns.size());
+    if (fuzzy)
+    {
+        trigramsOf(folded, gramScratch);
+        for (uint32_t gram : gramScratch)
+        {
+            gramPatterns.push_back(std::make_pair(gram, index));
+        }
+    }
+    exact[folded] = venue;
+    patterns.push_back(Pattern{folded, venue, fuzzy});
+    indexDirty = true;
+}
+
+void LocationNormalizer::refreshIndex()
+{
+    postingStart.assign(TRIGRAM_CODES + 1, 0);
+    for (const auto& entry : gramPatterns)
+    {
+        postingStart[entry.first + 1]++;
+    }
+    for (uint32_t code = 0; code < TRIGRAM_CODES; code++)
+    {
+        postingStart[code + 1] += postingStart[code];
+    }
+    postings.resize(gramPatterns.size());
+    std::vector<uint32_t> fill(postingStart.begin(), postingStart.end() - 1);
+    for (const auto& entry : gramPatterns)
+    {
+        postings[fill[entry.first]++] = entry.second;
+    }
+
+    // Trigrams shared by a large share of venues ("cas", "ino" from "Casino")
+    // would make every lookup visit every venue. They are skipped and counted
+    // as shared instead, which keeps the filter a valid lower bound.
+    commonLimit = std::max(MIN_COMMON_POSTINGS, patterns.size() / 16);
+    sharedNeeded.assign(patterns.size(), 0);
+    std::vector<int32_t> trigramCount(patterns.size(), 0);
+    for (const auto& entry : gramPatterns)
+    {
+        trigramCount[entry.second]++;
+        if (postingStart[entry.first + 1] - postingStart[entry.first] > commonLimit)
+        {
+            sharedNeeded[entry.second]--;
+        }
+    }
+
+    alwaysCheck.clear();
+    for (uint32_t index = 0; index < patterns.size(); index++)
+    {
+        if (!patterns[index].fuzzy) continue;
+
+        // Each edit destroys at most 3 trigrams, and the two padded edge
+        // trigrams need not occur inside a longer location
+        size_t length = std::min(patterns[index].folded.size(), MAX_PATTERN_LENGTH);
+        int32_t required = std::max(1, trigramCount[index] - 3 * allowedEdits(length) - 2);
+        sharedNeeded[index] += required;
+        if (sharedNeeded[index] <= 0)
+        {
+            alwaysCheck.push_back(index);
+        }
+    }
+    sharedCounts.assign(patterns.size(), 0);
+    indexDirty = false;
+}
+
+void LocationNormalizer::addVenue(const std::string& name, const std::vector<std::string>& aliases)
+{
+    std::string folded = fold(name);
+    if (folded.empty())
+    {
+        return;
+    }
+
+    auto it = exact.find(folded);
+    int venue = it != exact.end() ? it->second : static_cast<int>(venues.size());
+    if (venue == static_cast<int>(venues.size()))
+    {
+        venues.push_back(name);
+    }
+    addPattern(name, venue);
+    for (const auto& alias : aliases)
+    {
+        addPattern(alias, venue);
+    }
+
+    // Earlier decisions may have missed the new venue
+    decisions.clear();
+}
+
+bool LocationNormalizer::load(const std::string& path)
+{
+    TRACE_SCOPE("LocationNormalizer::load");
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = trim(line);
+
+        // Skip empty lines and comments
+        if (line.empty() || line[0] == '#') continue;
+
+        // Canonical Venue = alias, alias, ...
+        size_t equalPos = line.find('=');
+        std::vector<std::string> aliases;
+        if (equalPos != std::string::npos)
+        {
+            std::istringstream list(line.substr(equalPos + 1));
+            std::string alias;
+            while (std::getline(list, alias, ','))
+            {
+                alias = trim(alias);
+                if (!alias.empty()) aliases.push_back(alias);
+            }
+        }
+        addVenue(trim(line.substr(0, equalPos)), aliases);
+    }
+    return true;
+}
+
+int LocationNormalizer::search(const std::string& folded)
+{
+    auto exactMatch = exact.find(folded);
+    if (exactMatch != exact.end())
+    {
+        return exactMatch->second;
+    }
+    if (folded.empty() || patterns.empty())
+    {
+        return NO_MATCH;
+    }
+
+    if (indexDirty)
+    {
+        refreshIndex();
+    }
+
+    // Count shared trigrams per pattern, touching only patterns that share an uncommon one
+    candidates.clear();
+    trigramsOf(folded, gramScratch);
+    for (uint32_t gram : gramScratch)
+    {
+        uint32_t begin = postingStart[gram];
+        uint32_t end = postingStart[gram + 1];
+        if (end - begin > commonLimit) continue;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            if (sharedCounts[postings[i]]++ == 0) candidates.push_back(postings[i]);
+        }
+    }
+    size_t counted = candidates.size();
+    candidates.insert(candidates.end(), alwaysCheck.begin(), alwaysCheck.end());
+
+    int bestVenue = NO_MATCH;
+    int bestScore = 0;
+    int bestEdits = 0;
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        uint32_t index = candidates[i];
+        if (i < counted)
+        {
+            int32_t shared = static_cast<int32_t>(sharedCounts[index]);
+            sharedCounts[index] = 0;
+            if (shared < sharedNeeded[index]) continue;
+        }
+
+        const Pattern& pattern = patterns[index];
+        size_t length = std::min(pattern.folded.size(), MAX_PATTERN_LENGTH);
+        int distance = wordDistance(pattern.folded, folded);
+        if (distance > allowedEdits(length))
+        {
+            continue;
+        }
+
+        // Prefer the longest name matched, then the closest
+        int score = static_cast<int>(length) - distance;
+        if (bestVenue == NO_MATCH || score > bestScore || (score == bestScore && distance < bestEdits))
+        {
+            bestVenue = pattern.venue;
+            bestScore = score;
+            bestEdits = distance;
+        }
+    }
+    return bestVenue;
+}
+
+int LocationNormalizer::match(const std::string& location)
+{
+    auto it = decisions.find(location);
+    if (it != decisions.end())
+    {
+        it->second.uses++;
+        return it->second.venue;
+    }
+
+    int venue = search(fold(location));
+    decisions.emplace(location, Decision{venue, 1});
+    return venue;
+}
+
+bool LocationNormalizer::normalize(std::string& location)
+{
+    int venue = match(location);
+    if (venue == NO_MATCH)
+    {
+        return false;
+    }
+    if (location != venues[venue])
+    {
+        location = venues[venue];
+    }
+    return true;
+}
+
+std::string LocationNormalizer::generateReport() const
+{
+    std::ostringstream report;
+    report << "=== LOCATION MATCHES ===\n";
+    report << "Venues: " << venues.size() << ", distinct locations seen: " << decisions.size() << "\n\n";
+
+    // Venue -> spellings rewritten to it
+    std::map<std::string, std::vector<std::pair<std::string, size_t>>> byVenue;
+    size_t unmatched = 0;
+    for (const auto& entry : decisions)
+    {
+        if (entry.second.venue == NO_MATCH)
+        {
+            unmatched++;
+        }
+        else if (entry.first != venues[entry.second.venue])
+        {
+            byVenue[venues[entry.second.venue]].push_back(std::make_pair(entry.first, entry.second.uses));
+        }
+    }
+
+    if (byVenue.empty())
+    {
+        report << "No locations have been rewritten to a venue name.\n";
+    }
+    for (auto& venue : byVenue)
+    {
+        std::sort(venue.second.begin(), venue.second.end());
+        report << venue.first << ":\n";
+        for (const auto& spelling : venue.second)
+        {
+            report << "  " << std::left << std::setw(40) << spelling.first.substr(0, 39)
+                   << std::right << std::setw(8) << spelling.second << "\n";
+        }
+    }
+    report << "\n" << unmatched << " distinct locations matched no venue and were kept as entered.\n";
+    return report.str();
+}
@@ -0,0 +1,257 @@
+#include "../include/MemoryAccounting.h"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+namespace
+{
+    const size_t TAG_COUNT = static_cast<size_t>(MemoryTag::COUNT);
+
+    // Plain arrays of atomics: constant-initialized, so usable before static constructors run
+    std::atomic<uint64_t> allocationCounts[TAG_COUNT];
+    std::atomic<uint64_t> deallocationCounts[TAG_COUNT];
+    std::atomic<uint64_t> bytesAllocated[TAG_COUNT];
+    std::atomic<uint64_t> liveBytes[TAG_COUNT];
+    std::atomic<uint64_t> peakLiveBytes[TAG_COUNT];
+
+    thread_local MemoryTag activeTag = MemoryTag::UNTAGGED;
+
+    void updatePeak(std::atomic<uint64_t>& peak, uint64_t candidate)
+    {
+        uint64_t current = peak.load(std::memory_order_relaxed);
+        while (candidate > current && !peak.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    std::string formatBytes(uint64_t bytes)
+    {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1);
+        if (bytes >= (1ULL << 30)) oss << bytes / double(1ULL << 30) << " GB";
+        else if (bytes >= (1ULL << 20)) oss << bytes / double(1ULL << 20) << " MB";
+        else if (bytes >= (1ULL << 10)) oss << bytes / double(1ULL << 10) << " KB";
+        else oss << bytes << " B";
+        return oss.str();
+    }
+}
+
+bool MemoryAccounting::isCompiledIn()
+{
+#ifdef GAMBLING_MEMORY_ACCOUNTING
+    return true;
+#else
+    return false;
+#endif
+}
+
+MemoryTag MemoryAccounting::currentTag()
+{
+    return activeTag;
+}
+
+MemoryTag MemoryAccounting::exchangeTag(MemoryTag tag)
+{
+    MemoryTag previous = activeTag;
+    activeTag = tag;
+    return previous;
+}
+
+void MemoryAccounting::recordAllocation(MemoryTag tag, uint64_t bytes)
+{
+    size_t index = static_cast<size_t>(tag);
+    allocationCounts[index].fetch_add(1, std::memory_order_relaxed);
+    bytesAllocated[index].fetch_add(bytes, std::memory_order_relaxed);
+    uint64_t live = liveBytes[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    updatePeak(peakLiveBytes[index], live);
+}
+
+void MemoryAccounting::recordDeallocation(MemoryTag tag, uint64_t bytes)
+{
+    size_t index = static_cast<size_t>(tag);
+    deallocationCounts[index].fetch_add(1, std::memory_order_relaxed);
+    liveBytes[index].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+MemoryStats MemoryAccounting::getStats(MemoryTag tag)
+{
+    size_t index = static_cast<size_t>(tag);
+    MemoryStats stats;
+    stats.allocations = allocationCounts[index].load(std::memory_order_relaxed);
+    stats.deallocations = deallocationCounts[index].load(std::memory_order_relaxed);
+    stats.bytesAllocated = bytesAllocated[index].load(std::memory_order_relaxed);
+    stats.liveBytes = liveBytes[index].load(std::memory_order_relaxed);
+    stats.peakLiveBytes = peakLiveBytes[index].load(std::memory_order_relaxed);
+    return stats;
+}
+
+MemoryStats MemoryAccounting::getTotalStats()
+{
+    // Peak of the total is approximated by the sum of per-tag peaks (upper bound)
+    MemoryStats total = {0, 0, 0, 0, 0};
+    for (size_t i = 0; i < TAG_COUNT; i++)
+    {
+        MemoryStats stats = getStats(static_cast<MemoryTag>(i));
+        total.allocations += stats.allocations;
+        total.deallocations += stats.deallocations;
+        total.bytesAllocated += stats.bytesAllocated;
+        total.liveBytes += stats.liveBytes;
+        total.peakLiveBytes += stats.peakLiveBytes;
+    }
+    return total;
+}
+
+const char* MemoryAccounting::tagName(MemoryTag tag)
+{
+    switch (tag)
+    {
+        case MemoryTag::SESSION_STORAGE: return "session_storage";
+        case MemoryTag::RULES: return "rules";
+        case MemoryTag::SUMMARY: return "summary";
+        case MemoryTag::REPORTS: return "reports";
+        case MemoryTag::IMPORT_BUFFERS: return "import_buffers";
+        case MemoryTag::UNTAGGED:
+        default: return "untagged";
+    }
+}
+
+bool MemoryAccounting::parseTag(const std::string& name, MemoryTag& tag)
+{
+    for (size_t i = 0; i < TAG_COUNT; i++)
+    {
+        if (name == tagName(static_cast<MemoryTag>(i)))
+        {
+            tag = static_cast<MemoryTag>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string MemoryAccounting::generateReport()
+{
+    std::ostringstream report;
+    report << "=== MEMORY REPORT ===\n";
+    if (!isCompiledIn())
+    {
+        report << "Memory accounting is not compiled in (configure with -DENABLE_MEMORY_ACCOUNTING=ON).\n";
+        return report.str();
+    }
+
+    report << std::left << std::setw(18) << "Subsystem"
+           << std::right << std::setw(12) << "Allocs"
+           << std::setw(12) << "Frees"
+           << std::setw(14) << "Allocated"
+           << std::setw(12) << "Live"
+           << std::setw(12) << "Peak" << "\n";
+
+    for (size_t i = 0; i < TAG_COUNT; i++)
+    {
+        MemoryTag tag = static_cast<MemoryTag>(i);
+        MemoryStats stats = getStats(tag);
+        report << std::left << std::setw(18) << tagName(tag)
+               << std::right << std::setw(12) << stats.allocations
+               << std::setw(12) << stats.deallocations
+               << std::setw(14) << formatBytes(stats.bytesAllocated)
+               << std::setw(12) << formatBytes(stats.liveBytes)
+               << std::setw(12) << formatBytes(stats.peakLiveBytes) << "\n";
+    }
+
+    MemoryStats total = getTotalStats();
+    report << std::left << std::setw(18) << "TOTAL"
+           << std::right << std::setw(12) << total.allocations
+           << std::setw(12) << total.deallocations
+           << std::setw(14) << formatBytes(total.bytesAllocated)
+           << std::setw(12) << formatBytes(total.liveBytes)
+           << std::setw(12) << formatBytes(total.peakLiveBytes) << "\n";
+    return report.str();
+}
+
+bool MemoryAccounting::checkBudget(MemoryTag tag, uint64_t maxPeakBytes, std::string& message)
+{
+    MemoryStats stats = getStats(tag);
+    if (stats.peakLiveBytes <= maxPeakBytes)
+    {
+        return true;
+    }
+
+    std::ostringstream oss;
+    oss << "Memory budget exceeded for " << tagName(tag) << ": peak "
+        << stats.peakLiveBytes << " bytes > budget " << maxPeakBytes << " bytes";
+    message = oss.str();
+    return false;
+}
+
+#ifdef GAMBLING_MEMORY_ACCOUNTING
+
+namespace
+{
+    // Each block carries its size and tag so frees are charged to the allocating subsystem.
+    // 16 bytes keeps the user pointer aligned for any fundamental type.
+    struct alignas(16) BlockHeader
+    {
+        uint64_t size;
+        MemoryTag tag;
+    };
+
+    void* countedAllocate(size_t size) noexcept
+    {
+        void* raw = std::malloc(sizeof(BlockHeader) + size);
+        if (!raw)
+        {
+            return nullptr;
+        }
+
+        BlockHeader* header = static_cast<BlockHeader*>(raw);
+        header->size = size;
+        header->tag = activeTag;
+        MemoryAccounting::recordAllocation(header->tag, size);
+        return header + 1;
+    }
+
+    void countedFree(void* pointer) noexcept
+    {
+        if (!pointer)
+        {
+            return;
+        }
+
+        BlockHeader* header = static_cast<BlockHeader*>(pointer) - 1;
+        MemoryAccounting::recordDeallocation(header->tag, header->size);
+        std::free(header);
+    }
+
+    void* throwingAllocate(size_t size)
+    {
+        while (true)
+        {
+            void* pointer = countedAllocate(size);
+            if (pointer)
+            {
+                return pointer;
+            }
+
+            std::new_handler handler = std::get_new_handler();
+            if (!handler)
+            {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+}
+
+void* operator new(size_t size) { return throwingAllocate(size); }
+void* operator new[](size_t size) { return throwingAllocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void operator delete(void* pointer) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+
+#endif
@@ -0,0 +1,372 @@
+#include "../include/PivotEngine.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+    const char KEY_SEPARATOR = '\x1f';
+    const size_t MIN_RECORDS_PER_THREAD = 16384;
+
+    typedef std::unordered_map<std::string, std::vector<double>> GroupTable;
+
+    void appendDatePart(std::string& key, const std::string& date, PivotKey part)
+    {
+        // MM-DD-YYYY; anything else is grouped under its raw text
+        if (date.size() != 10)
+        {
+            key += date;
+            return;
+        }
+        key.append(date, 6, 4);
+        if (part == PivotKey::YEAR) return;
+        key += '-';
+        key.append(date, 0, 2);
+        if (part == PivotKey::MONTH) return;
+        key += '-';
+        key.append(date, 3, 2);
+    }
+
+    // Sessions and ticket batches share these getters
+    template <class Record>
+    void buildKey(const Record& record, const std::vector<PivotKey>& keys, std::string& key)
+    {
+        key.clear();
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if (i > 0) key += KEY_SEPARATOR;
+            switch (keys[i])
+            {
+                case PivotKey::STATE: key += record.getState(); break;
+                case PivotKey::GAME_TYPE: key += record.getGameType(); break;
+                case PivotKey::LOCATION: key += record.getLocation(); break;
+                default: appendDatePart(key, record.getDate(), keys[i]); break;
+            }
+        }
+    }
+
+    void accumulate(std::vector<double>& values, const std::vector<PivotMeasure>& measures, double netResult)
+    {
+        double win = std::max(netResult, 0.0);
+        double loss = std::max(-netResult, 0.0);
+        for (size_t i = 0; i < measures.size(); i++)
+        {
+            switch (measures[i])
+            {
+                case PivotMeasure::WINNINGS: values[i] += win; break;
+                case PivotMeasure::LOSSES: values[i] += loss; break;
+                case PivotMeasure::NET: values[i] += netResult; break;
+                case PivotMeasure::COUNT: values[i] += 1.0; break;
+                case PivotMeasure::MAX_WIN: values[i] = std::max(values[i], win); break;
+                case PivotMeasure::MAX_LOSS: values[i] = std::max(values[i], loss); break;
+            }
+        }
+    }
+
+    void combine(std::vector<double>& into, const std::vector<double>& from, const std::vector<PivotMeasure>& measures)
+    {
+        for (size_t i = 0; i < measures.size(); i++)
+        {
+            bool isMax = measures[i] == PivotMeasure::MAX_WIN || measures[i] == PivotMeasure::MAX_LOSS;
+            into[i] = isMax ? std::max(into[i], from[i]) : into[i] + from[i];
+        }
+    }
+
+    double netResult(const GamblingSession& session)
+    {
+        return session.getNetResult();
+    }
+
+    double netResult(const TicketBatch& batch)
+    {
+        return -batch.getTotalLosses();
+    }
+
+    // Phase 1 for one worker: aggregate a slice into one table per partition
+    template <class Records>
+    void aggregateSlice(const Records& records, size_t begin, size_t end, const PivotQuery& query,
+                        std::vector<GroupTable>& partitions)
+    {
+        std::hash<std::string> hasher;
+        std::string key;
+        for (size_t i = begin; i < end; i++)
+        {
+            buildKey(records[i], query.keys, key);
+            GroupTable& table = partitions[hasher(key) % partitions.size()];
+            auto it = table.find(key);
+            if (it == table.end())
+            {
+                it = table.emplace(key, std::vector<double>(query.measures.size(), 0.0)).first;
+            }
+            accumulate(it->second, query.measures, netResult(records[i]));
+        }
+    }
+
+    std::vector<std::string> splitKey(const std::string& key, size_t parts)
+    {
+        std::vector<std::string> fields;
+        if (parts == 0)
+        {
+            return fields;
+        }
+        fields.reserve(parts);
+        size_t start = 0;
+        for (size_t i = 0; i + 1 < parts; i++)
+        {
+            size_t end = key.find(KEY_SEPARATOR, start);
+            fields.push_back(key.substr(start, end - start));
+            start = end + 1;
+        }
+        fields.push_back(key.substr(start));
+        return fields;
+    }
+
+    std::string csvField(const std::string& text)
+    {
+        if (text.find_first_of(",\"") == std::string::npos)
+        {
+            return text;
+        }
+        std::string quoted = "\"";
+        for (char c : text)
+        {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    std::string formatValue(PivotMeasure measure, double value)
+    {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(measure == PivotMeasure::COUNT ? 0 : 2) << value;
+        return oss.str();
+    }
+
+    // Sessions is anything with size() and operator[]
+    template <class Sessions>
+    PivotResult runPivot(const Sessions& sessions, const std::vector<TicketBatch>& ticketBatches,
+                         const PivotQuery& query, unsigned threads)
+    {
+        TRACE_SCOPE("PivotEngine::run");
+        PivotResult result;
+        result.query = query;
+        result.total.values.assign(query.measures.size(), 0.0);
+
+        size_t records = sessions.size() + ticketBatches.size();
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        size_t workerCount = std::max<size_t>(1, std::min<size_t>(threads, records / MIN_RECORDS_PER_THREAD));
+
+        // Phase 1: every worker scans its own slice of sessions and batches
+        std::vector<std::vector<GroupTable>> local(workerCount, std::vector<GroupTable>(workerCount));
+
+        auto scan = [&](size_t worker)
+        {
+            size_t sessionBegin = sessions.size() * worker / workerCount;
+            size_t sessionEnd = sessions.size() * (worker + 1) / workerCount;
+            size_t batchBegin = ticketBatches.size() * worker / workerCount;
+            size_t batchEnd = ticketBatches.size() * (worker + 1) / workerCount;
+            aggregateSlice(sessions, sessionBegin, sessionEnd, query, local[worker]);
+            aggregateSlice(ticketBatches, batchBegin, batchEnd, query, local[worker]);
+        };
+
+        // Phase 2: worker p owns partition p and folds in every other worker's copy
+        auto merge = [&](size_t partition)
+        {
+            GroupTable& target = local[0][partition];
+            for (size_t worker = 1; worker < workerCount; worker++)
+            {
+                for (auto& entry : local[worker][partition])
+                {
+                    auto it = target.find(entry.first);
+                    if (it == target.end())
+                    {
+                        target.emplace(entry.first, std::move(entry.second));
+                    }
+                    else
+                    {
+                        combine(it->second, entry.second, query.measures);
+                    }
+                }
+                GroupTable().swap(local[worker][partition]);
+            }
+        };
+
+        auto runParallel = [workerCount](const std::function<void(size_t)>& task)
+        {
+            std::vector<std::thread> pool;
+            for (size_t worker = 1; worker < workerCount; worker++)
+            {
+                pool.emplace_back(task, worker);
+            }
+            task(0);
+            for (auto& thread : pool)
+            {
+                thread.join();
+            }
+        };
+
+        runParallel(scan);
+        runParallel(merge);
+
+        for (auto& table : local[0])
+        {
+            for (auto& entry : table)
+            {
+                PivotRow row;
+                row.key = splitKey(entry.first, query.keys.size());
+                row.values = std::move(entry.second);
+                combine(result.total.values, row.values, query.measures);
+                result.rows.push_back(std::move(row));
+            }
+        }
+
+        std::sort(result.rows.begin(), result.rows.end(), [](const PivotRow& a, const PivotRow& b)
+        {
+            return a.key < b.key;
+        });
+        return result;
+    }
+}
+
+PivotResult PivotEngine::run(const std::vector<GamblingSession>& sessions,
+                             const std::vector<TicketBatch>& ticketBatches,
+                             const PivotQuery& query, unsigned threads)
+{
+    return runPivot(sessions, ticketBatches, query, threads);
+}
+
+PivotResult PivotEngine::run(const SessionChunks& sessions, const std::vector<TicketBatch>& ticketBatches,
+                             const PivotQuery& query, unsigned threads)
+{
+    return runPivot(sessions, ticketBatches, query, threads);
+}
+
+std::string PivotEngine::keyName(PivotKey key)
+{
+    switch (key)
+    {
+        case PivotKey::STATE: return "State";
+        case PivotKey::GAME_TYPE: return "Game Type";
+        case PivotKey::LOCATION: return "Location";
+        case PivotKey::YEAR: return "Year";
+        case PivotKey::MONTH: return "Month";
+        case PivotKey::DATE: return "Date";
+    }
+    return "";
+}
+
+std::string PivotEngine::measureName(PivotMeasure measure)
+{
+    switch (measure)
+    {
+        case PivotMeasure::WINNINGS: return "Winnings";
+        case PivotMeasure::LOSSES: return "Losses";
+        case PivotMeasure::NET: return "Net";
+        case PivotMeasure::COUNT: return "Count";
+        case PivotMeasure::MAX_WIN: return "Max Win";
+        case PivotMeasure::MAX_LOSS: return "Max Loss";
+    }
+    return "";
+}
+
+std::string PivotEngine::generateReport(const PivotResult& result)
+{
+    const PivotQuery& query = result.query;
+
+    // Key columns are as wide as their longest value; measures get a fixed width
+    std::vector<size_t> widths;
+    for (size_t i = 0; i < query.keys.size(); i++)
+    {
+        size_t width = std::max<size_t>(keyName(query.keys[i]).size(), 5);
+        for (const auto& row : result.rows)
+        {
+            width = std::max(width, row.key[i].size());
+        }
+        widths.push_back(std::min<size_t>(width, 32) + 2);
+    }
+    const int valueWidth = 14;
+
+    std::ostringstream report;
+    report << "=== PIVOT REPORT ===\n";
+    for (size_t i = 0; i < query.keys.size(); i++)
+    {
+        report << std::left << std::setw(static_cast<int>(widths[i])) << keyName(query.keys[i]);
+    }
+    for (PivotMeasure measure : query.measures)
+    {
+        report << std::right << std::setw(valueWidth) << measureName(measure);
+    }
+    report << "\n";
+
+    size_t lineWidth = query.measures.size() * valueWidth;
+    for (size_t width : widths) lineWidth += width;
+    report << std::string(lineWidth, '-') << "\n";
+
+    auto printValues = [&](const PivotRow& row)
+    {
+        for (size_t i = 0; i < query.measures.size(); i++)
+        {
+            report << std::right << std::setw(valueWidth) << formatValue(query.measures[i], row.values[i]);
+        }
+        report << "\n";
+    };
+
+    for (const auto& row : result.rows)
+    {
+        for (size_t i = 0; i < query.keys.size(); i++)
+        {
+            std::string text = row.key[i].size() > 32 ? row.key[i].substr(0, 29) + "..." : row.key[i];
+            report << std::left << std::setw(static_cast<int>(widths[i])) << text;
+        }
+        printValues(row);
+    }
+
+    report << std::string(lineWidth, '-') << "\n";
+    size_t keyWidth = 0;
+    for (size_t width : widths) keyWidth += width;
+    report << std::left << std::setw(static_cast<int>(keyWidth)) << "TOTAL";
+    printValues(result.total);
+    report << result.rows.size() << " groups\n";
+    return report.str();
+}
+
+void PivotEngine::writeCSV(std::ostream& out, const PivotResult& result)
+{
+    const PivotQuery& query = result.query;
+    bool first = true;
+    for (PivotKey key : query.keys)
+    {
+        out << (first ? "" : ",") << keyName(key);
+        first = false;
+    }
+    for (PivotMeasure measure : query.measures)
+    {
+        out << (first ? "" : ",") << measureName(measure);
+        first = false;
+    }
+    out << "\n";
+
+    for (const auto& row : result.rows)
+    {
+        first = true;
+        for (const auto& field : row.key)
+        {
+            out << (first ? "" : ",") << csvField(field);
+            first = false;
+        }
+        for (size_t i = 0; i < query.measures.size(); i++)
+        {
+            out << (first ? "" : ",") << formatValue(query.measures[i], row.values[i]);
+            first = false;
+        }
+        out << "\n";
+    }
+}
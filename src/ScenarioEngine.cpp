@@ -0,0 +1,171 @@
+#include "../include/ScenarioEngine.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+ScenarioEngine::ScenarioEngine(const TaxCalculator& calculator)
+    : calculator(calculator)
+{
+}
+
+std::vector<ScenarioResult> ScenarioEngine::evaluate(const SessionAggregate& totals,
+                                                     const std::vector<TaxScenario>& scenarios) const
+{
+    TRACE_SCOPE("ScenarioEngine::evaluate");
+    const TaxRulesConfig& rules = calculator.getTaxRules();
+    const size_t count = scenarios.size();
+
+    // State tax depends only on the per-state totals, so it is shared by every scenario
+    double stateTax = 0.0;
+    for (const auto& entry : totals.states)
+    {
+        stateTax += calculator.calculateStateTax(entry.first, entry.second.winnings, entry.second.losses);
+    }
+
+    // Scenario inputs as columns, so the loop below is straight-line arithmetic
+    std::vector<double> limit(count);
+    std::vector<double> standard(count);
+    std::vector<double> professional(count);
+    std::vector<const BracketSchedule*> brackets(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const TaxScenario& scenario = scenarios[i];
+        limit[i] = scenario.lossDeductionLimit >= 0.0 ? scenario.lossDeductionLimit
+                                                       : TaxRulesConfig::lossDeductionLimitForYear(scenario.taxYear);
+        standard[i] = rules.getStandardDeduction(scenario.filingStatus);
+        professional[i] = scenario.professional ? 1.0 : 0.0;
+        brackets[i] = rules.getTaxBrackets().find(TaxBracketTable::FEDERAL, scenario.taxYear, scenario.filingStatus);
+    }
+
+    const double cappedLosses = std::min(totals.totalLosses, totals.totalWinnings);
+    std::vector<double> deductible(count);
+    std::vector<double> effective(count);
+    std::vector<double> itemize(count);
+    std::vector<double> taxable(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        double allowed = cappedLosses * limit[i];
+        double casualBenefit = std::max(0.0, allowed - standard[i]);
+        deductible[i] = allowed;
+        effective[i] = professional[i] * allowed + (1.0 - professional[i]) * casualBenefit;
+        itemize[i] = (1.0 - professional[i]) * static_cast<double>(allowed > standard[i]);
+        taxable[i] = std::max(0.0, totals.totalWinnings - effective[i] - standard[i]);
+    }
+
+    std::vector<double> federalTax(count, 0.0);
+    std::vector<double> marginalRate(count, 0.0);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (brackets[i])
+        {
+            federalTax[i] = brackets[i]->totalTax(taxable[i]);
+            marginalRate[i] = brackets[i]->marginalRate(taxable[i]);
+        }
+    }
+
+    std::vector<ScenarioResult> results(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        ScenarioResult& result = results[i];
+        result.name = scenarios[i].name;
+        result.taxYear = scenarios[i].taxYear;
+        result.professional = scenarios[i].professional;
+        result.filingStatus = scenarios[i].filingStatus;
+        result.lossDeductionLimit = limit[i];
+        result.deductibleLosses = deductible[i];
+        result.standardDeduction = standard[i];
+        result.itemize = itemize[i] > 0.0;
+        result.effectiveLossDeduction = effective[i];
+        result.netTaxableGambling = totals.totalWinnings - effective[i];
+        result.federalTax = federalTax[i];
+        result.marginalRate = marginalRate[i];
+        result.stateTax = stateTax;
+    }
+    return results;
+}
+
+std::vector<TaxScenario> ScenarioEngine::standardSweep(int baseYear)
+{
+    static const FilingStatus STATUSES[] = {
+        FilingStatus::SINGLE, FilingStatus::MARRIED_FILING_JOINTLY,
+        FilingStatus::MARRIED_FILING_SEPARATELY, FilingStatus::HEAD_OF_HOUSEHOLD
+    };
+
+    std::vector<int> years = {baseYear};
+    if (baseYear < 2026)
+    {
+        years.push_back(2026);
+    }
+
+    std::vector<TaxScenario> scenarios;
+    for (int year : years)
+    {
+        for (int professional = 0; professional < 2; professional++)
+        {
+            for (FilingStatus status : STATUSES)
+            {
+                TaxScenario scenario;
+                scenario.taxYear = year;
+                scenario.professional = professional != 0;
+                scenario.filingStatus = status;
+                scenario.name = std::to_string(year) + " " + (scenario.professional ? "Pro" : "Casual") +
+                                " " + filingStatusLabel(status);
+                scenarios.push_back(scenario);
+            }
+        }
+    }
+    return scenarios;
+}
+
+std::string ScenarioEngine::filingStatusLabel(FilingStatus status)
+{
+    switch (status)
+    {
+        case FilingStatus::MARRIED_FILING_JOINTLY: return "MFJ";
+        case FilingStatus::MARRIED_FILING_SEPARATELY: return "MFS";
+        case FilingStatus::HEAD_OF_HOUSEHOLD: return "HOH";
+        default: return "Single";
+    }
+}
+
+std::string ScenarioEngine::generateComparisonTable(const std::vector<ScenarioResult>& results)
+{
+    std::ostringstream table;
+    table << std::fixed << std::setprecision(2);
+
+    table << "=== TAX SCENARIO COMPARISON ===\n";
+    table << std::left << std::setw(22) << "Scenario" << std::right
+          << std::setw(6) << "Limit"
+          << std::setw(14) << "Deductible"
+          << std::setw(12) << "Std Ded"
+          << std::setw(9) << "Itemize"
+          << std::setw(14) << "Loss Benefit"
+          << std::setw(16) << "Net Taxable"
+          << std::setw(14) << "Federal Tax"
+          << std::setw(6) << "Rate"
+          << std::setw(12) << "State Tax" << "\n";
+    table << std::string(125, '-') << "\n";
+
+    for (const auto& result : results)
+    {
+        table << std::left << std::setw(22) << result.name << std::right
+              << std::setw(5) << std::setprecision(0) << (result.lossDeductionLimit * 100) << "%"
+              << std::setprecision(2)
+              << std::setw(14) << result.deductibleLosses
+              << std::setw(12) << result.standardDeduction
+              << std::setw(9) << (result.professional ? "n/a" : (result.itemize ? "yes" : "no"))
+              << std::setw(14) << result.effectiveLossDeduction
+              << std::setw(16) << result.netTaxableGambling
+              << std::setw(14) << result.federalTax
+              << std::setw(5) << std::setprecision(0) << (result.marginalRate * 100) << "%"
+              << std::setprecision(2)
+              << std::setw(12) << result.stateTax << "\n";
+    }
+
+    table << "\nLoss Benefit: how much the gambling losses reduce taxable income. Casual gamblers\n";
+    table << "only benefit from losses beyond the standard deduction (Schedule A); professionals\n";
+    table << "deduct them against winnings on Schedule C. Federal Tax treats gambling as the\n";
+    table << "only income; years past the last bracket table reuse the latest one.\n";
+    return table.str();
+}
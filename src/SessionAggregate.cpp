@@ -0,0 +1,80 @@
+#include "../include/SessionAggregate.h"
+#include <cmath>
+
+SessionAggregate::SessionAggregate()
+    : totalWinnings(0.0), totalLosses(0.0), totalWithheld(0.0), sessionCount(0), ticketCount(0),
+      missedWithholding(false)
+{
+}
+
+void SessionAggregate::addSession(const GamblingSession& session, bool thresholdReached)
+{
+    double netResult = session.getNetResult();
+    sessionCount++;
+    totalWithheld += session.getWithheldAmount();
+
+    if (netResult > 0)
+    {
+        std::string state = session.getState();
+        totalWinnings += netResult;
+        states[state].winnings += netResult;
+
+        if (winningStateSet.insert(state).second)
+        {
+            winningStates.push_back(state);
+        }
+        if (thresholdReached && !session.getTaxWithheld())
+        {
+            missedWithholding = true;
+        }
+    }
+    else if (netResult < 0)
+    {
+        totalLosses += std::abs(netResult);
+        states[session.getState()].losses += std::abs(netResult);
+    }
+}
+
+void SessionAggregate::addBatch(const TicketBatch& batch)
+{
+    ticketCount += batch.getTicketCount();
+    totalLosses += batch.getTotalLosses();
+    states[batch.getState()].losses += batch.getTotalLosses();
+}
+
+void SessionAggregate::addStateTotals(const std::string& state, double winnings, double losses)
+{
+    StateTotals& totals = states[state];
+    totals.winnings += winnings;
+    totals.losses += losses;
+
+    if (winnings > 0 && winningStateSet.insert(state).second)
+    {
+        winningStates.push_back(state);
+    }
+}
+
+void SessionAggregate::merge(const SessionAggregate& other)
+{
+    totalWinnings += other.totalWinnings;
+    totalLosses += other.totalLosses;
+    totalWithheld += other.totalWithheld;
+    sessionCount += other.sessionCount;
+    ticketCount += other.ticketCount;
+    missedWithholding = missedWithholding || other.missedWithholding;
+
+    for (const auto& entry : other.states)
+    {
+        StateTotals& totals = states[entry.first];
+        totals.winnings += entry.second.winnings;
+        totals.losses += entry.second.losses;
+    }
+
+    for (const auto& state : other.winningStates)
+    {
+        if (winningStateSet.insert(state).second)
+        {
+            winningStates.push_back(state);
+        }
+    }
+}
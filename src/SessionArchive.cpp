@@ -0,0 +1,798 @@
+#include "../include/SessionArchive.h"
+#include "../include/Checksum.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+    const char FILE_MAGIC[8] = {'G', 'S', 'A', 'R', 'C', 'H', '\x01', '\0'};   // Last two: version, reserved
+    const char BLOCK_MAGIC[3] = {'B', 'L', 'K'};
+    const char KIND_SESSIONS = 'S';
+    const char KIND_BATCHES = 'T';
+    const char KIND_END = 'E';
+
+    const uint8_t MODE_VARINT = 0;
+    const uint8_t MODE_PACKED = 1;
+
+    uint64_t zigzag(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    void putVarint(std::string& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out += static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    size_t varintLength(uint64_t value)
+    {
+        size_t length = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            length++;
+        }
+        return length;
+    }
+
+    void putUint32(std::string& out, uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            out += static_cast<char>((value >> (i * 8)) & 0xFF);
+        }
+    }
+
+    int64_t toCents(double amount)
+    {
+        return std::llround(amount * 100.0);
+    }
+
+    // Bounds-checked reader over one decoded column payload
+    class ByteCursor
+    {
+    private:
+        const std::string& data;
+        size_t position;
+
+    public:
+        explicit ByteCursor(const std::string& data) : data(data), position(0) {}
+
+        uint8_t byte()
+        {
+            if (position >= data.size())
+            {
+                throw std::runtime_error("Archive column is truncated");
+            }
+            return static_cast<uint8_t>(data[position++]);
+        }
+
+        uint64_t varint()
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                uint8_t b = byte();
+                value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if ((b & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+            throw std::runtime_error("Archive varint is malformed");
+        }
+
+        const char* take(size_t length)
+        {
+            if (length > data.size() - position)
+            {
+                throw std::runtime_error("Archive column is truncated");
+            }
+            const char* start = data.data() + position;
+            position += length;
+            return start;
+        }
+    };
+
+    unsigned bitsNeeded(uint64_t value)
+    {
+        unsigned bits = 0;
+        while (value != 0)
+        {
+            bits++;
+            value >>= 1;
+        }
+        return bits;
+    }
+
+    // Integer sequences: reference (minimum) + either varints or fixed-width bit packing
+    void encodeInts(const int64_t* values, size_t count, std::string& out)
+    {
+        int64_t minimum = 0;
+        int64_t maximum = 0;
+        if (count > 0)
+        {
+            minimum = maximum = values[0];
+            for (size_t i = 1; i < count; i++)
+            {
+                if (values[i] < minimum) minimum = values[i];
+                if (values[i] > maximum) maximum = values[i];
+            }
+        }
+
+        unsigned width = bitsNeeded(static_cast<uint64_t>(maximum) - static_cast<uint64_t>(minimum));
+        size_t packedBytes = (count * width + 7) / 8;
+        size_t varintBytes = 0;
+        for (size_t i = 0; i < count && varintBytes <= packedBytes; i++)
+        {
+            varintBytes += varintLength(static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(minimum));
+        }
+
+        if (varintBytes < packedBytes)
+        {
+            out += static_cast<char>(MODE_VARINT);
+            putVarint(out, zigzag(minimum));
+            for (size_t i = 0; i < count; i++)
+            {
+                putVarint(out, static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(minimum));
+            }
+            return;
+        }
+
+        out += static_cast<char>(MODE_PACKED);
+        putVarint(out, zigzag(minimum));
+        out += static_cast<char>(width);
+
+        uint64_t accumulator = 0;
+        unsigned filled = 0;
+        for (size_t i = 0; i < count && width > 0; i++)
+        {
+            uint64_t value = static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(minimum);
+            accumulator |= value << filled;
+            if (filled + width >= 64)
+            {
+                for (int b = 0; b < 8; b++)
+                {
+                    out += static_cast<char>((accumulator >> (b * 8)) & 0xFF);
+                }
+                unsigned spill = filled + width - 64;
+                accumulator = spill ? value >> (width - spill) : 0;
+                filled = spill;
+            }
+            else
+            {
+                filled += width;
+            }
+        }
+        for (unsigned b = 0; b * 8 < filled; b++)
+        {
+            out += static_cast<char>((accumulator >> (b * 8)) & 0xFF);
+        }
+    }
+
+    void decodeInts(ByteCursor& cursor, size_t count, std::vector<int64_t>& values)
+    {
+        values.resize(count);
+        uint8_t mode = cursor.byte();
+        uint64_t minimum = static_cast<uint64_t>(unzigzag(cursor.varint()));
+
+        if (mode == MODE_VARINT)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                values[i] = static_cast<int64_t>(minimum + cursor.varint());
+            }
+            return;
+        }
+        if (mode != MODE_PACKED)
+        {
+            throw std::runtime_error("Unknown archive integer encoding");
+        }
+
+        unsigned width = cursor.byte();
+        if (width > 64)
+        {
+            throw std::runtime_error("Archive bit width is invalid");
+        }
+
+        size_t packedBytes = (count * width + 7) / 8;
+        const char* packed = cursor.take(packedBytes);
+        uint64_t mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint64_t value = 0;
+            if (width > 0)
+            {
+                // Gather up to nine bytes around the value; the tail of the buffer is short
+                size_t bitPosition = i * width;
+                size_t first = bitPosition / 8;
+                unsigned shift = bitPosition % 8;
+                unsigned char window[9] = {0};
+                std::memcpy(window, packed + first, std::min<size_t>(9, packedBytes - first));
+
+                uint64_t low;
+                std::memcpy(&low, window, 8);
+                value = low >> shift;
+                if (shift + width > 64)
+                {
+                    value |= static_cast<uint64_t>(window[8]) << (64 - shift);
+                }
+                value &= mask;
+            }
+            values[i] = static_cast<int64_t>(minimum + value);
+        }
+    }
+
+    void encodeStrings(const std::vector<std::string>& values, std::string& out)
+    {
+        std::unordered_map<std::string, int64_t> dictionary;
+        std::vector<const std::string*> entries;
+        std::vector<int64_t> codes;
+        codes.reserve(values.size());
+
+        for (const auto& value : values)
+        {
+            auto inserted = dictionary.emplace(value, static_cast<int64_t>(entries.size()));
+            if (inserted.second)
+            {
+                entries.push_back(&inserted.first->first);
+            }
+            codes.push_back(inserted.first->second);
+        }
+
+        putVarint(out, entries.size());
+        for (const std::string* entry : entries)
+        {
+            putVarint(out, entry->size());
+            out += *entry;
+        }
+        encodeInts(codes.data(), codes.size(), out);
+    }
+
+    struct StringColumn
+    {
+        std::vector<std::string> dictionary;
+        std::vector<int64_t> codes;
+
+        const std::string& at(size_t row) const
+        {
+            if (row >= codes.size())
+            {
+                static const std::string empty;
+                return empty;
+            }
+            return dictionary[static_cast<size_t>(codes[row])];
+        }
+    };
+
+    void decodeStrings(ByteCursor& cursor, size_t count, StringColumn& column)
+    {
+        size_t entries = static_cast<size_t>(cursor.varint());
+        column.dictionary.clear();
+        for (size_t i = 0; i < entries; i++)
+        {
+            size_t length = static_cast<size_t>(cursor.varint());
+            column.dictionary.emplace_back(cursor.take(length), length);
+        }
+
+        decodeInts(cursor, count, column.codes);
+        for (int64_t code : column.codes)
+        {
+            if (code < 0 || static_cast<size_t>(code) >= entries)
+            {
+                throw std::runtime_error("Archive dictionary code out of range");
+            }
+        }
+    }
+
+    // Dates: first day number, then deltas (zero for same-day rows in sorted data)
+    void encodeDates(const std::vector<std::string>& dates, std::string& out)
+    {
+        std::vector<int64_t> deltas;
+        deltas.reserve(dates.size());
+        int64_t previous = 0;
+        for (size_t i = 0; i < dates.size(); i++)
+        {
+            int64_t day = GamblingSession::dateToDayNumber(dates[i]);
+            if (i == 0)
+            {
+                putVarint(out, zigzag(day));
+            }
+            else
+            {
+                deltas.push_back(day - previous);
+            }
+            previous = day;
+        }
+        encodeInts(deltas.data(), deltas.size(), out);
+    }
+
+    void decodeDates(ByteCursor& cursor, size_t count, std::vector<int64_t>& days)
+    {
+        if (count == 0)
+        {
+            days.clear();
+            return;
+        }
+
+        int64_t first = unzigzag(cursor.varint());
+        decodeInts(cursor, count - 1, days);
+        days.insert(days.begin(), first);
+        for (size_t i = 1; i < count; i++)
+        {
+            days[i] += days[i - 1];
+        }
+    }
+
+    struct ColumnEntry
+    {
+        uint8_t id;
+        uint64_t length;
+        uint32_t crc;
+    };
+
+    struct BlockHeader
+    {
+        char kind;
+        uint64_t rows;
+        std::vector<ColumnEntry> columns;
+    };
+
+    void writeBlock(std::ostream& out, char kind, uint64_t rows,
+                    const std::vector<std::pair<ArchiveColumn, std::string>>& columns)
+    {
+        std::string header(BLOCK_MAGIC, sizeof(BLOCK_MAGIC));
+        header += kind;
+        putVarint(header, rows);
+        putVarint(header, columns.size());
+        for (const auto& column : columns)
+        {
+            header += static_cast<char>(column.first);
+            putVarint(header, column.second.size());
+            putUint32(header, Checksum::crc32c(column.second.data(), column.second.size()));
+        }
+        putUint32(header, Checksum::crc32c(header.data(), header.size()));
+
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        for (const auto& column : columns)
+        {
+            out.write(column.second.data(), static_cast<std::streamsize>(column.second.size()));
+        }
+    }
+
+    // Reads a block header byte by byte, keeping the bytes for its checksum
+    class HeaderReader
+    {
+    private:
+        std::istream& in;
+        std::string bytes;
+
+    public:
+        explicit HeaderReader(std::istream& in) : in(in) {}
+
+        uint8_t byte()
+        {
+            int c = in.get();
+            if (c == EOF)
+            {
+                throw std::runtime_error("Archive is truncated (missing end marker)");
+            }
+            bytes += static_cast<char>(c);
+            return static_cast<uint8_t>(c);
+        }
+
+        uint64_t varint()
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                uint8_t b = byte();
+                value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if ((b & 0x80) == 0) return value;
+            }
+            throw std::runtime_error("Archive block header is malformed");
+        }
+
+        uint32_t uint32()
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                value |= static_cast<uint32_t>(byte()) << (i * 8);
+            }
+            return value;
+        }
+
+        const std::string& consumed() const { return bytes; }
+    };
+
+    BlockHeader readBlockHeader(std::istream& in)
+    {
+        HeaderReader reader(in);
+        for (char expected : BLOCK_MAGIC)
+        {
+            if (static_cast<char>(reader.byte()) != expected)
+            {
+                throw std::runtime_error("Archive block is corrupt (bad magic)");
+            }
+        }
+
+        BlockHeader header;
+        header.kind = static_cast<char>(reader.byte());
+        header.rows = reader.varint();
+        uint64_t columnCount = reader.varint();
+        if (columnCount > static_cast<uint64_t>(ArchiveColumn::COUNT))
+        {
+            throw std::runtime_error("Archive block is corrupt (column count)");
+        }
+        for (uint64_t i = 0; i < columnCount; i++)
+        {
+            ColumnEntry entry;
+            entry.id = reader.byte();
+            entry.length = reader.varint();
+            entry.crc = reader.uint32();
+            header.columns.push_back(entry);
+        }
+
+        uint32_t expectedCrc = Checksum::crc32c(reader.consumed().data(), reader.consumed().size());
+        if (reader.uint32() != expectedCrc)
+        {
+            throw std::runtime_error("Archive block header failed its checksum");
+        }
+        return header;
+    }
+
+    void readColumn(std::istream& in, const ColumnEntry& entry, std::string& payload)
+    {
+        payload.resize(static_cast<size_t>(entry.length));
+        if (!in.read(&payload[0], static_cast<std::streamsize>(entry.length)) && entry.length > 0)
+        {
+            throw std::runtime_error("Archive is truncated inside a column");
+        }
+        if (Checksum::crc32c(payload.data(), payload.size()) != entry.crc)
+        {
+            throw std::runtime_error("Archive column failed its checksum");
+        }
+    }
+
+    void skipColumn(std::istream& in, const ColumnEntry& entry)
+    {
+        in.seekg(static_cast<std::streamoff>(entry.length), std::ios::cur);
+        if (!in)
+        {
+            throw std::runtime_error("Archive is truncated inside a column");
+        }
+    }
+
+    // Day number -> MM-DD-YYYY, memoized for runs of the same date
+    class DateFormatter
+    {
+    private:
+        int64_t lastDay;
+        std::string lastText;
+
+    public:
+        DateFormatter() : lastDay(INT64_MIN) {}
+
+        const std::string& format(int64_t day)
+        {
+            if (day != lastDay)
+            {
+                lastDay = day;
+                lastText = GamblingSession::dayNumberToDate(day);
+            }
+            return lastText;
+        }
+    };
+}
+
+ArchiveWriter::ArchiveWriter(std::ostream& out, size_t blockRows)
+    : out(out), blockRows(blockRows == 0 ? DEFAULT_BLOCK_ROWS : blockRows), finished(false),
+      sessionCount(0), batchCount(0), pendingSessions(0), pendingBatches(0)
+{
+    out.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+    if (!finished)
+    {
+        finish();
+    }
+}
+
+void ArchiveWriter::add(const GamblingSession& session)
+{
+    if (!GamblingSession::isValidDate(session.getDate()))
+    {
+        throw std::invalid_argument("Cannot archive session with invalid date: " + session.getDate());
+    }
+
+    sessionText[0].push_back(session.getDate());
+    sessionText[1].push_back(session.getLocation());
+    sessionText[2].push_back(session.getState());
+    sessionText[3].push_back(session.getGameType());
+    sessionAmounts[0].push_back(toCents(session.getBuyIn()));
+    sessionAmounts[1].push_back(toCents(session.getCashOut()));
+    sessionAmounts[2].push_back(toCents(session.getWithheldAmount()));
+    sessionWithheld.push_back(session.getTaxWithheld() ? 1 : 0);
+    sessionNotes[0].push_back(session.getDocumentationNote());
+    sessionNotes[1].push_back(session.getNotes());
+
+    sessionCount++;
+    if (++pendingSessions >= blockRows)
+    {
+        flushSessions();
+    }
+}
+
+void ArchiveWriter::add(const TicketBatch& batch)
+{
+    if (!GamblingSession::isValidDate(batch.getDate()))
+    {
+        throw std::invalid_argument("Cannot archive ticket batch with invalid date: " + batch.getDate());
+    }
+
+    batchText[0].push_back(batch.getDate());
+    batchText[1].push_back(batch.getLocation());
+    batchText[2].push_back(batch.getState());
+    batchText[3].push_back(batch.getGameType());
+    batchCounts.push_back(static_cast<int64_t>(batch.getTicketCount()));
+    for (uint32_t cents : batch.getTicketCents())
+    {
+        batchTickets.push_back(cents);
+    }
+
+    batchCount++;
+    if (++pendingBatches >= blockRows || batchTickets.size() >= blockRows * 16)
+    {
+        flushBatches();
+    }
+}
+
+void ArchiveWriter::flushSessions()
+{
+    if (pendingSessions == 0) return;
+
+    std::vector<std::pair<ArchiveColumn, std::string>> columns(10);
+    columns[0].first = ArchiveColumn::DATE;
+    encodeDates(sessionText[0], columns[0].second);
+    columns[1].first = ArchiveColumn::LOCATION;
+    encodeStrings(sessionText[1], columns[1].second);
+    columns[2].first = ArchiveColumn::STATE;
+    encodeStrings(sessionText[2], columns[2].second);
+    columns[3].first = ArchiveColumn::GAME_TYPE;
+    encodeStrings(sessionText[3], columns[3].second);
+    columns[4].first = ArchiveColumn::BUY_IN;
+    encodeInts(sessionAmounts[0].data(), pendingSessions, columns[4].second);
+    columns[5].first = ArchiveColumn::CASH_OUT;
+    encodeInts(sessionAmounts[1].data(), pendingSessions, columns[5].second);
+    columns[6].first = ArchiveColumn::TAX_WITHHELD;
+    encodeInts(sessionWithheld.data(), pendingSessions, columns[6].second);
+    columns[7].first = ArchiveColumn::WITHHELD_AMOUNT;
+    encodeInts(sessionAmounts[2].data(), pendingSessions, columns[7].second);
+    columns[8].first = ArchiveColumn::DOCUMENTATION_NOTE;
+    encodeStrings(sessionNotes[0], columns[8].second);
+    columns[9].first = ArchiveColumn::NOTES;
+    encodeStrings(sessionNotes[1], columns[9].second);
+
+    writeBlock(out, KIND_SESSIONS, pendingSessions, columns);
+
+    for (auto& column : sessionText) column.clear();
+    for (auto& column : sessionNotes) column.clear();
+    for (auto& column : sessionAmounts) column.clear();
+    sessionWithheld.clear();
+    pendingSessions = 0;
+}
+
+void ArchiveWriter::flushBatches()
+{
+    if (pendingBatches == 0) return;
+
+    std::vector<std::pair<ArchiveColumn, std::string>> columns(6);
+    columns[0].first = ArchiveColumn::DATE;
+    encodeDates(batchText[0], columns[0].second);
+    columns[1].first = ArchiveColumn::LOCATION;
+    encodeStrings(batchText[1], columns[1].second);
+    columns[2].first = ArchiveColumn::STATE;
+    encodeStrings(batchText[2], columns[2].second);
+    columns[3].first = ArchiveColumn::GAME_TYPE;
+    encodeStrings(batchText[3], columns[3].second);
+    columns[4].first = ArchiveColumn::TICKET_COUNT;
+    encodeInts(batchCounts.data(), batchCounts.size(), columns[4].second);
+    columns[5].first = ArchiveColumn::TICKET_AMOUNTS;
+    putVarint(columns[5].second, batchTickets.size());
+    encodeInts(batchTickets.data(), batchTickets.size(), columns[5].second);
+
+    writeBlock(out, KIND_BATCHES, pendingBatches, columns);
+
+    for (auto& column : batchText) column.clear();
+    batchCounts.clear();
+    batchTickets.clear();
+    pendingBatches = 0;
+}
+
+void ArchiveWriter::finish()
+{
+    if (finished) return;
+
+    flushSessions();
+    flushBatches();
+    writeBlock(out, KIND_END, sessionCount + batchCount, {});
+    out.flush();
+    finished = true;
+}
+
+ArchiveReader::ArchiveReader(std::istream& in) : in(in)
+{
+    if (!isArchive(in))
+    {
+        throw std::runtime_error("Not a session archive (bad file header)");
+    }
+    in.ignore(sizeof(FILE_MAGIC));
+    dataStart = in.tellg();
+}
+
+bool ArchiveReader::isArchive(std::istream& in)
+{
+    std::streampos start = in.tellg();
+    char magic[sizeof(FILE_MAGIC)];
+    bool match = static_cast<bool>(in.read(magic, sizeof(magic))) &&
+                 std::memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0;
+    in.clear();
+    in.seekg(start);
+    return match;
+}
+
+void ArchiveReader::read(const SessionCallback& onSession, const BatchCallback& onBatch)
+{
+    in.clear();
+    in.seekg(dataStart);
+    uint64_t records = 0;
+    std::string payload;
+    DateFormatter dates;
+
+    while (true)
+    {
+        BlockHeader header = readBlockHeader(in);
+        if (header.kind == KIND_END)
+        {
+            if (header.rows != records)
+            {
+                throw std::runtime_error("Archive record count does not match its end marker");
+            }
+            return;
+        }
+
+        size_t rows = static_cast<size_t>(header.rows);
+        std::vector<int64_t> days, counts, tickets;
+        std::vector<int64_t> amounts[3], withheld;
+        StringColumn text[4], notes[2];
+
+        for (const ColumnEntry& entry : header.columns)
+        {
+            readColumn(in, entry, payload);
+            ByteCursor cursor(payload);
+
+            switch (static_cast<ArchiveColumn>(entry.id))
+            {
+                case ArchiveColumn::DATE: decodeDates(cursor, rows, days); break;
+                case ArchiveColumn::LOCATION: decodeStrings(cursor, rows, text[1]); break;
+                case ArchiveColumn::STATE: decodeStrings(cursor, rows, text[2]); break;
+                case ArchiveColumn::GAME_TYPE: decodeStrings(cursor, rows, text[3]); break;
+                case ArchiveColumn::BUY_IN: decodeInts(cursor, rows, amounts[0]); break;
+                case ArchiveColumn::CASH_OUT: decodeInts(cursor, rows, amounts[1]); break;
+                case ArchiveColumn::WITHHELD_AMOUNT: decodeInts(cursor, rows, amounts[2]); break;
+                case ArchiveColumn::TAX_WITHHELD: decodeInts(cursor, rows, withheld); break;
+                case ArchiveColumn::DOCUMENTATION_NOTE: decodeStrings(cursor, rows, notes[0]); break;
+                case ArchiveColumn::NOTES: decodeStrings(cursor, rows, notes[1]); break;
+                case ArchiveColumn::TICKET_COUNT: decodeInts(cursor, rows, counts); break;
+                case ArchiveColumn::TICKET_AMOUNTS:
+                    decodeInts(cursor, static_cast<size_t>(cursor.varint()), tickets);
+                    break;
+                default:
+                    break;  // Columns added by later versions are ignored
+            }
+        }
+
+        if (days.size() != rows)
+        {
+            throw std::runtime_error("Archive block is missing its date column");
+        }
+
+        if (header.kind == KIND_SESSIONS)
+        {
+            auto cents = [&](const std::vector<int64_t>& column, size_t row)
+            {
+                return row < column.size() ? column[row] / 100.0 : 0.0;
+            };
+
+            for (size_t row = 0; row < rows; row++)
+            {
+                GamblingSession session(dates.format(days[row]), text[1].at(row), text[2].at(row),
+                                        text[3].at(row), cents(amounts[0], row), cents(amounts[1], row),
+                                        row < withheld.size() && withheld[row] != 0, cents(amounts[2], row),
+                                        notes[0].at(row), notes[1].at(row));
+                onSession(session);
+            }
+        }
+        else if (header.kind == KIND_BATCHES)
+        {
+            size_t next = 0;
+            for (size_t row = 0; row < rows; row++)
+            {
+                TicketBatch batch(dates.format(days[row]), text[1].at(row), text[2].at(row), text[3].at(row));
+                size_t count = row < counts.size() ? static_cast<size_t>(counts[row]) : 0;
+                if (count > tickets.size() - next)
+                {
+                    throw std::runtime_error("Archive ticket amounts do not match ticket counts");
+                }
+                batch.reserve(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    batch.addTicket(tickets[next++] / 100.0);
+                }
+                onBatch(batch);
+            }
+        }
+        records += rows;
+    }
+}
+
+void ArchiveReader::scanColumn(ArchiveColumn column, const std::function<void(const std::vector<int64_t>&)>& onBlock)
+{
+    if (column == ArchiveColumn::LOCATION || column == ArchiveColumn::STATE || column == ArchiveColumn::GAME_TYPE ||
+        column == ArchiveColumn::DOCUMENTATION_NOTE || column == ArchiveColumn::NOTES)
+    {
+        throw std::invalid_argument("scanColumn only supports integer columns");
+    }
+
+    in.clear();
+    in.seekg(dataStart);
+    std::string payload;
+    std::vector<int64_t> values;
+
+    while (true)
+    {
+        BlockHeader header = readBlockHeader(in);
+        if (header.kind == KIND_END)
+        {
+            return;
+        }
+
+        for (const ColumnEntry& entry : header.columns)
+        {
+            if (header.kind != KIND_SESSIONS || entry.id != static_cast<uint8_t>(column))
+            {
+                skipColumn(in, entry);
+                continue;
+            }
+
+            readColumn(in, entry, payload);
+            ByteCursor cursor(payload);
+            if (column == ArchiveColumn::DATE)
+            {
+                decodeDates(cursor, static_cast<size_t>(header.rows), values);
+            }
+            else
+            {
+                decodeInts(cursor, static_cast<size_t>(header.rows), values);
+            }
+            onBlock(values);
+        }
+    }
+}
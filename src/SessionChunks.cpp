@@ -0,0 +1,116 @@
+#include "../include/SessionChunks.h"
+#include "../include/TaxCalculator.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <utility>
+
+SessionChunks::SessionChunks() : table(std::make_shared<Table>())
+{
+}
+
+SessionChunks::Table& SessionChunks::writableTable()
+{
+    // A count above one may be a snapshot on its way out; copying then is harmless
+    if (table.use_count() > 1)
+    {
+        table = std::make_shared<Table>(*table);
+    }
+    return *table;
+}
+
+SessionChunks::Chunk& SessionChunks::writableChunk(size_t index)
+{
+    Table& writable = writableTable();
+    std::shared_ptr<Chunk>& chunk = writable.chunks[index];
+    if (chunk.use_count() > 1)
+    {
+        std::shared_ptr<Chunk> copy = std::make_shared<Chunk>();
+        copy->sessions.reserve(CHUNK_SIZE);
+        copy->sessions = chunk->sessions;
+        chunk = std::move(copy);
+    }
+    else
+    {
+        std::atomic_store(&chunk->cached, std::shared_ptr<const CachedTotals>());
+    }
+    return *chunk;
+}
+
+void SessionChunks::pushBack(GamblingSession&& session)
+{
+    Table& writable = writableTable();
+    if (writable.size % CHUNK_SIZE == 0)
+    {
+        writable.chunks.push_back(std::make_shared<Chunk>());
+        writable.chunks.back()->sessions.reserve(CHUNK_SIZE);
+    }
+    writableChunk(writable.chunks.size() - 1).sessions.push_back(std::move(session));
+    writable.size++;
+}
+
+void SessionChunks::set(size_t position, const GamblingSession& session)
+{
+    writableChunk(position / CHUNK_SIZE).sessions[position % CHUNK_SIZE] = session;
+}
+
+void SessionChunks::popBack()
+{
+    Table& writable = writableTable();
+    Chunk& last = writableChunk(writable.chunks.size() - 1);
+    last.sessions.pop_back();
+    if (last.sessions.empty())
+    {
+        writable.chunks.pop_back();
+    }
+    writable.size--;
+}
+
+void SessionChunks::swapRemove(size_t position)
+{
+    size_t last = table->size - 1;
+    if (position != last)
+    {
+        // The last chunk is made writable first, so the session can be moved out of it
+        GamblingSession moved = std::move(writableChunk(last / CHUNK_SIZE).sessions.back());
+        writableChunk(position / CHUNK_SIZE).sessions[position % CHUNK_SIZE] = std::move(moved);
+    }
+    popBack();
+}
+
+void SessionChunks::clear()
+{
+    // Copies taken earlier keep the old table
+    table = std::make_shared<Table>();
+}
+
+size_t SessionChunks::sharedChunks(const SessionChunks& other) const
+{
+    size_t shared = 0;
+    size_t count = std::min(table->chunks.size(), other.table->chunks.size());
+    for (size_t i = 0; i < count; i++)
+    {
+        if (table->chunks[i] == other.table->chunks[i]) shared++;
+    }
+    return shared;
+}
+
+SessionAggregate SessionChunks::aggregate(const TaxCalculator& calculator) const
+{
+    TRACE_SCOPE("SessionChunks::aggregate");
+    static const std::vector<TicketBatch> noTicketBatches;
+    uint64_t rulesVersion = calculator.getTaxRules().getRulesVersion();
+    SessionAggregate totals;
+    for (const auto& chunk : table->chunks)
+    {
+        // Two snapshots aggregating the same chunk at once both fill the cache with equal totals
+        std::shared_ptr<const CachedTotals> cached = std::atomic_load(&chunk->cached);
+        if (!cached || cached->rulesVersion != rulesVersion)
+        {
+            cached = std::make_shared<const CachedTotals>(
+                CachedTotals{rulesVersion, calculator.aggregate(chunk->sessions, noTicketBatches)});
+            std::atomic_store(&chunk->cached, cached);
+        }
+        totals.merge(cached->totals);
+    }
+    return totals;
+}
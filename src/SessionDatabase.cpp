@@ -0,0 +1,174 @@
+#include "../include/SessionDatabase.h"
+#include <utility>
+
+SessionDatabase::SessionDatabase() : freeHead(NO_SLOT), freeListStale(false)
+{
+}
+
+void SessionDatabase::rebuildFreeList()
+{
+    freeHead = NO_SLOT;
+    for (size_t i = slots.size(); i-- > 0;)
+    {
+        if ((slots[i].generation & 1) == 0)
+        {
+            slots[i].target = freeHead;
+            freeHead = static_cast<uint32_t>(i);
+        }
+    }
+    freeListStale = false;
+}
+
+const SessionDatabase::Slot* SessionDatabase::resolve(SessionId id) const
+{
+    if (id.slot >= slots.size())
+    {
+        return nullptr;
+    }
+
+    const Slot& slot = slots[id.slot];
+    if (slot.generation != id.generation || (slot.generation & 1) == 0)
+    {
+        return nullptr;
+    }
+    return &slot;
+}
+
+SessionId SessionDatabase::insert(const GamblingSession& session)
+{
+    return insert(GamblingSession(session));
+}
+
+SessionId SessionDatabase::insert(GamblingSession&& session)
+{
+    if (freeListStale)
+    {
+        rebuildFreeList();
+    }
+
+    uint32_t slotIndex;
+    if (freeHead != NO_SLOT)
+    {
+        slotIndex = freeHead;
+        freeHead = slots[slotIndex].target;
+    }
+    else
+    {
+        slotIndex = static_cast<uint32_t>(slots.size());
+        slots.push_back(Slot{0, 0});
+    }
+
+    Slot& slot = slots[slotIndex];
+    slot.target = static_cast<uint32_t>(dense.size());
+    slot.generation++;
+
+    dense.pushBack(std::move(session));
+    denseToSlot.push_back(slotIndex);
+    return SessionId(slotIndex, slot.generation);
+}
+
+bool SessionDatabase::insertWithId(SessionId id, GamblingSession&& session)
+{
+    // Only occupied (odd) generations name a live session
+    if ((id.generation & 1) == 0)
+    {
+        return false;
+    }
+    if (id.slot >= slots.size())
+    {
+        slots.resize(static_cast<size_t>(id.slot) + 1, Slot{NO_SLOT, 0});
+    }
+
+    Slot& slot = slots[id.slot];
+    if ((slot.generation & 1) != 0 || slot.generation > id.generation)
+    {
+        return false;
+    }
+
+    slot.target = static_cast<uint32_t>(dense.size());
+    slot.generation = id.generation;
+    dense.pushBack(std::move(session));
+    denseToSlot.push_back(id.slot);
+    freeListStale = true;
+    return true;
+}
+
+bool SessionDatabase::erase(SessionId id)
+{
+    if (!resolve(id))
+    {
+        return false;
+    }
+
+    Slot& slot = slots[id.slot];
+    uint32_t position = slot.target;
+    uint32_t last = static_cast<uint32_t>(dense.size() - 1);
+
+    // Swap-remove keeps the dense list hole-free; only the moved session's slot changes
+    dense.swapRemove(position);
+    if (position != last)
+    {
+        denseToSlot[position] = denseToSlot[last];
+        slots[denseToSlot[position]].target = position;
+    }
+    denseToSlot.pop_back();
+
+    slot.generation++;
+    slot.target = freeHead;
+    freeHead = id.slot;
+    return true;
+}
+
+bool SessionDatabase::update(SessionId id, const GamblingSession& session)
+{
+    const Slot* slot = resolve(id);
+    if (!slot)
+    {
+        return false;
+    }
+    dense.set(slot->target, session);
+    return true;
+}
+
+const GamblingSession* SessionDatabase::find(SessionId id) const
+{
+    const Slot* slot = resolve(id);
+    return slot ? &dense[slot->target] : nullptr;
+}
+
+SessionId SessionDatabase::idAt(size_t position) const
+{
+    if (position >= dense.size())
+    {
+        return SessionId();
+    }
+
+    uint32_t slotIndex = denseToSlot[position];
+    return SessionId(slotIndex, slots[slotIndex].generation);
+}
+
+size_t SessionDatabase::positionOf(SessionId id) const
+{
+    const Slot* slot = resolve(id);
+    return slot ? slot->target : dense.size();
+}
+
+void SessionDatabase::reserve(size_t count)
+{
+    denseToSlot.reserve(count);
+    slots.reserve(count);
+}
+
+void SessionDatabase::clear()
+{
+    // Slots are kept (not shrunk) so their generations keep old IDs from resolving
+    for (uint32_t slotIndex : denseToSlot)
+    {
+        Slot& slot = slots[slotIndex];
+        slot.generation++;
+        slot.target = freeHead;
+        freeHead = slotIndex;
+    }
+    dense.clear();
+    denseToSlot.clear();
+}
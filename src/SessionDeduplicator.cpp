@@ -0,0 +1,366 @@
+#include "../include/SessionDeduplicator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const uint64_t FNV_OFFSET = 0xCBF29CE484222325ULL;
+    const uint64_t FNV_PRIME = 0x100000001B3ULL;
+
+    uint64_t mix(uint64_t h)
+    {
+        // MurmurHash3 finalizer: spreads FNV output over all 64 bits
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    void hashWord(uint64_t& h, uint64_t word)
+    {
+        h = (h ^ word) * FNV_PRIME;
+        h ^= h >> 29;
+    }
+
+    // Case-folded with surrounding whitespace dropped and inner runs collapsed,
+    // so "Mohegan  Sun " and "MOHEGAN SUN" hash the same. Normalized bytes are
+    // packed eight to a word so the multiply chain runs per word, not per byte.
+    void hashText(uint64_t& h, const std::string& text)
+    {
+        // Work on locals: h and the text bytes may alias, which would force a
+        // store/reload of h on every character
+        uint64_t state = h;
+        uint64_t word = 0;
+        int filled = 0;
+        bool pendingSpace = false;
+        bool started = false;
+
+        auto put = [&](uint64_t byte)
+        {
+            word |= byte << (filled * 8);
+            if (++filled == 8)
+            {
+                hashWord(state, word);
+                word = 0;
+                filled = 0;
+            }
+        };
+
+        for (unsigned char c : text)
+        {
+            // ASCII folding inline; the <cctype> versions go through the locale per byte
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            {
+                pendingSpace = started;
+                continue;
+            }
+            if (pendingSpace)
+            {
+                put(' ');
+                pendingSpace = false;
+            }
+            put((c >= 'a' && c <= 'z') ? c - 32 : c);
+            started = true;
+        }
+
+        put(0x1F);   // Field separator
+        if (filled > 0)
+        {
+            hashWord(state, word);
+        }
+        h = state;
+    }
+
+    void hashCents(uint64_t& h, double amount)
+    {
+        // Plain rounding instead of std::llround, which is an out-of-line libm call
+        double scaled = amount * 100.0;
+        hashWord(h, static_cast<uint64_t>(static_cast<int64_t>(scaled + (scaled >= 0.0 ? 0.5 : -0.5))));
+    }
+
+    uint64_t nonZero(uint64_t hash)
+    {
+        return hash == 0 ? 1 : hash;   // 0 marks an empty slot
+    }
+
+    size_t roundUpPowerOfTwo(size_t value)
+    {
+        size_t power = 1;
+        while (power < value) power <<= 1;
+        return power;
+    }
+}
+
+BloomFilter::BloomFilter(size_t expectedItems)
+{
+    // ~12 bits per item keeps the false-positive rate near 1% even with blocking
+    size_t blockCount = roundUpPowerOfTwo(std::max<size_t>(expectedItems * 12 / 512, 16));
+    bits.assign(blockCount * 8, 0);
+    blockMask = blockCount - 1;
+}
+
+void BloomFilter::add(uint64_t hash)
+{
+    // High bits pick the block (slot lookups use the low bits); a second mix supplies the probes
+    uint64_t* block = &bits[((hash >> 40) & blockMask) * 8];
+    uint64_t probes = mix(hash ^ 0x9E3779B97F4A7C15ULL);
+    for (int i = 0; i < PROBE_COUNT; i++)
+    {
+        uint64_t bit = (probes >> (i * 8)) & 511;
+        block[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+bool BloomFilter::mayContain(uint64_t hash) const
+{
+    const uint64_t* block = &bits[((hash >> 40) & blockMask) * 8];
+    uint64_t probes = mix(hash ^ 0x9E3779B97F4A7C15ULL);
+    for (int i = 0; i < PROBE_COUNT; i++)
+    {
+        uint64_t bit = (probes >> (i * 8)) & 511;
+        if (!(block[bit >> 6] & (1ULL << (bit & 63))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BloomFilter::clear()
+{
+    std::fill(bits.begin(), bits.end(), 0);
+}
+
+const double SessionHashIndex::MAX_LOAD_FACTOR = 0.6;
+const char* const SessionHashIndex::DUPLICATE_NOTE = "Possible duplicate import";
+
+SessionHashIndex::SessionHashIndex(size_t expectedSessions)
+    : bloom(expectedSessions), bloomCapacity(expectedSessions), entryCount(0), sessionCount(0), importEpoch(1)
+{
+    slots.assign(roundUpPowerOfTwo(std::max<size_t>(16, expectedSessions * 2)), Entry{0, 0, 0, 0, 0});
+}
+
+uint64_t SessionHashIndex::hashSession(const GamblingSession& session)
+{
+    uint64_t h = FNV_OFFSET;
+    hashText(h, session.getDate());
+    hashText(h, session.getLocation());
+    hashText(h, session.getState());
+    hashText(h, session.getGameType());
+    hashCents(h, session.getBuyIn());
+    hashCents(h, session.getCashOut());
+    hashCents(h, session.getWithheldAmount());
+    return nonZero(mix(h));
+}
+
+uint64_t SessionHashIndex::hashBatch(const TicketBatch& batch)
+{
+    uint64_t h = FNV_OFFSET;
+    hashWord(h, 'B');
+    hashText(h, batch.getDate());
+    hashText(h, batch.getLocation());
+    hashText(h, batch.getState());
+    hashText(h, batch.getGameType());
+    for (uint32_t cents : batch.getTicketCents())
+    {
+        hashCents(h, cents / 100.0);
+    }
+    return nonZero(mix(h));
+}
+
+SessionHashIndex::Entry* SessionHashIndex::findEntry(uint64_t hash)
+{
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask; slots[i].hash != 0; i = (i + 1) & mask)
+    {
+        if (slots[i].hash == hash)
+        {
+            return &slots[i];
+        }
+    }
+    return nullptr;
+}
+
+const SessionHashIndex::Entry* SessionHashIndex::findEntry(uint64_t hash) const
+{
+    return const_cast<SessionHashIndex*>(this)->findEntry(hash);
+}
+
+SessionHashIndex::Entry& SessionHashIndex::findOrCreateEntry(uint64_t hash)
+{
+    // The Bloom filter answers "never seen" without walking the probe chain's keys
+    if (bloom.mayContain(hash))
+    {
+        Entry* existing = findEntry(hash);
+        if (existing)
+        {
+            return *existing;
+        }
+    }
+
+    if (entryCount + 1 > slots.size() * MAX_LOAD_FACTOR)
+    {
+        growTable();
+    }
+
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].hash != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    slots[i] = Entry{hash, 0, 0, 0, 0};
+    entryCount++;
+
+    // Past its sizing the filter saturates and stops saving probes; rebuild it larger
+    if (entryCount > bloomCapacity)
+    {
+        rebuildBloom(bloomCapacity * 2);
+    }
+    else
+    {
+        bloom.add(hash);
+    }
+    return slots[i];
+}
+
+void SessionHashIndex::growTable()
+{
+    std::vector<Entry> old;
+    old.swap(slots);
+    slots.assign(old.size() * 2, Entry{0, 0, 0, 0, 0});
+
+    size_t mask = slots.size() - 1;
+    for (const Entry& entry : old)
+    {
+        if (entry.hash == 0) continue;
+
+        size_t i = entry.hash & mask;
+        while (slots[i].hash != 0)
+        {
+            i = (i + 1) & mask;
+        }
+        slots[i] = entry;
+    }
+}
+
+void SessionHashIndex::rebuildBloom(size_t capacity)
+{
+    bloom = BloomFilter(capacity);
+    bloomCapacity = capacity;
+    for (const Entry& entry : slots)
+    {
+        if (entry.hash != 0) bloom.add(entry.hash);
+    }
+}
+
+uint32_t SessionHashIndex::count(uint64_t hash) const
+{
+    if (!bloom.mayContain(hash))
+    {
+        return 0;
+    }
+    const Entry* entry = findEntry(hash);
+    return entry ? entry->count : 0;
+}
+
+uint32_t SessionHashIndex::add(uint64_t hash)
+{
+    Entry& entry = findOrCreateEntry(hash);
+    sessionCount++;
+    return entry.count++;
+}
+
+void SessionHashIndex::remove(uint64_t hash)
+{
+    // Entries stay in the table with a zero count; the Bloom filter cannot forget
+    Entry* entry = findEntry(hash);
+    if (entry && entry->count > 0)
+    {
+        entry->count--;
+        sessionCount--;
+    }
+}
+
+void SessionHashIndex::reserve(size_t expectedSessions)
+{
+    while (expectedSessions > slots.size() * MAX_LOAD_FACTOR)
+    {
+        growTable();
+    }
+    if (expectedSessions > bloomCapacity)
+    {
+        rebuildBloom(expectedSessions);
+    }
+}
+
+void SessionHashIndex::clear()
+{
+    std::fill(slots.begin(), slots.end(), Entry{0, 0, 0, 0, 0});
+    bloom.clear();
+    entryCount = 0;
+    sessionCount = 0;
+}
+
+void SessionHashIndex::beginImport()
+{
+    importEpoch++;
+}
+
+bool SessionHashIndex::admitHash(uint64_t hash, DuplicateMode mode, MergeStats& stats)
+{
+    Entry& entry = findOrCreateEntry(hash);
+    if (entry.epoch != importEpoch)
+    {
+        entry.epoch = importEpoch;
+        entry.matched = 0;
+        entry.added = 0;
+    }
+
+    // Copies that existed before this import and haven't been matched yet
+    uint32_t loadedBefore = entry.count - entry.added;
+    bool duplicate = entry.matched < loadedBefore;
+    if (duplicate)
+    {
+        entry.matched++;
+        if (mode == DuplicateMode::SKIP)
+        {
+            stats.skipped++;
+            return false;
+        }
+        if (mode == DuplicateMode::FLAG)
+        {
+            stats.flagged++;
+        }
+    }
+
+    entry.count++;
+    entry.added++;
+    sessionCount++;
+    stats.added++;
+    return true;
+}
+
+bool SessionHashIndex::admit(GamblingSession& session, DuplicateMode mode, MergeStats& stats)
+{
+    size_t flaggedBefore = stats.flagged;
+    if (!admitHash(hashSession(session), mode, stats))
+    {
+        return false;
+    }
+
+    if (stats.flagged != flaggedBefore)
+    {
+        session.setNotes(session.getNotes().empty() ? DUPLICATE_NOTE
+                                                    : session.getNotes() + " | " + DUPLICATE_NOTE);
+    }
+    return true;
+}
+
+bool SessionHashIndex::admit(const TicketBatch& batch, DuplicateMode mode, MergeStats& stats)
+{
+    // Batches have no notes field; flagged batches are kept and only counted
+    return admitHash(hashBatch(batch), mode, stats);
+}
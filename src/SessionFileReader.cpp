@@ -0,0 +1,169 @@
+#include "../include/SessionFileReader.h"
+#include "../include/SessionArchive.h"
+#include "../include/SessionJson.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+
+const char* const SessionFileReader::CSV_HEADER =
+    "Date,Location,State,GameType,BuyIn,CashOut,TaxWithheld,WithheldAmount,DocumentationNote,Notes";
+
+namespace
+{
+    const size_t PROGRESS_INTERVAL = 4096;  // Records between progress updates and cancellation checks
+
+    // Counts records and, every PROGRESS_INTERVAL of them, reports the read
+    // position and polls for cancellation
+    class ProgressTicker
+    {
+    public:
+        ProgressTicker(std::istream& file, TaskProgress& progress) : file(file), progress(progress), records(0) {}
+
+        void tick()
+        {
+            if (++records % PROGRESS_INTERVAL == 0)
+            {
+                progress.checkCancelled();
+                progress.setDone(static_cast<uint64_t>(std::max<std::streamoff>(0, file.tellg())));
+            }
+        }
+
+    private:
+        std::istream& file;
+        TaskProgress& progress;
+        size_t records;
+    };
+}
+
+void SessionFileReader::read(const std::string& filename, const SessionCallback& onSession,
+                             const BatchCallback& onBatch, const WarningCallback& onWarning, TaskProgress& progress)
+{
+    TRACE_SCOPE("SessionFileReader::read");
+    std::ifstream file(filename, hasExtension(filename, ".gsa") ? std::ios::in | std::ios::binary : std::ios::in);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Could not load from file " + filename);
+    }
+    
+    // Progress is measured in bytes read
+    file.seekg(0, std::ios::end);
+    progress.setTotal(static_cast<uint64_t>(std::max<std::streamoff>(0, file.tellg())));
+    file.seekg(0, std::ios::beg);
+    
+    if (hasExtension(filename, ".json"))
+    {
+        readJson(file, onSession, onBatch, onWarning, progress);
+    }
+    else if (hasExtension(filename, ".gsa"))
+    {
+        readArchive(file, onSession, onBatch, progress);
+    }
+    else
+    {
+        readCSV(file, onSession, onBatch, onWarning, progress);
+    }
+    progress.setDone(progress.getTotal());
+}
+
+bool SessionFileReader::hasExtension(const std::string& filename, const std::string& extension)
+{
+    if (filename.size() < extension.size())
+    {
+        return false;
+    }
+    
+    std::string tail = filename.substr(filename.size() - extension.size());
+    std::transform(tail.begin(), tail.end(), tail.begin(), ::tolower);
+    return tail == extension;
+}
+
+void SessionFileReader::readCSV(std::istream& file, const SessionCallback& onSession, const BatchCallback& onBatch,
+                                const WarningCallback& onWarning, TaskProgress& progress)
+{
+    ProgressTicker ticker(file, progress);
+    std::string line;
+    
+    // Skip header line
+    std::getline(file, line);
+    
+    while (std::getline(file, line))
+    {
+        ticker.tick();
+        if (line.empty()) continue;
+        
+        // Only parse errors skip the line; whatever the callbacks throw propagates
+        if (TicketBatch::isBatchCSV(line))
+        {
+            TicketBatch batch;
+            try
+            {
+                batch = TicketBatch::fromCSV(line);
+            }
+            catch (const std::exception&)
+            {
+                onWarning("Warning: Skipped invalid line: " + line);
+                continue;
+            }
+            onBatch(batch);
+        }
+        else
+        {
+            GamblingSession session;
+            try
+            {
+                session = GamblingSession::fromCSV(line);
+            }
+            catch (const std::exception&)
+            {
+                onWarning("Warning: Skipped invalid line: " + line);
+                continue;
+            }
+            onSession(session);
+        }
+    }
+}
+
+void SessionFileReader::readJson(std::istream& file, const SessionCallback& onSession, const BatchCallback& onBatch,
+                                 const WarningCallback& onWarning, TaskProgress& progress)
+{
+    // A malformed or truncated document throws; only records that don't
+    // describe a session are skipped
+    ProgressTicker ticker(file, progress);
+    SessionJson::ReadStats readStats = SessionJson::readSessions(file,
+        [&](GamblingSession& session)
+        {
+            onSession(session);
+            ticker.tick();
+        },
+        [&](TicketBatch& batch)
+        {
+            onBatch(batch);
+            ticker.tick();
+        });
+    
+    if (readStats.invalid > 0)
+    {
+        onWarning("Warning: Skipped " + std::to_string(readStats.invalid) + " invalid records");
+    }
+}
+
+void SessionFileReader::readArchive(std::istream& file, const SessionCallback& onSession, const BatchCallback& onBatch,
+                                    TaskProgress& progress)
+{
+    // A damaged header or block (bad checksum, truncation) throws
+    ProgressTicker ticker(file, progress);
+    ArchiveReader reader(file);
+    reader.read(
+        [&](GamblingSession& session)
+        {
+            onSession(session);
+            ticker.tick();
+        },
+        [&](TicketBatch& batch)
+        {
+            onBatch(batch);
+            ticker.tick();
+        });
+}
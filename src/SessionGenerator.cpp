@@ -0,0 +1,443 @@
+#include "../include/SessionGenerator.h"
+#include "../include/GamblingSession.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const double MAX_AMOUNT = 999999.99;   // Same ceiling ConsoleInterface enforces on input
+    const size_t FLUSH_THRESHOLD = 1 << 20;
+
+    // States ordered roughly by gambling volume; weights fall off Zipf-style
+    const char* const STATES_BY_VOLUME[] = {
+        "NV", "NJ", "PA", "NY", "MI", "CA", "IL", "OH", "IN", "LA",
+        "MS", "FL", "MA", "CT", "MD", "AZ", "CO", "MO", "IA", "TN",
+        "VA", "NC", "KS", "KY", "WV", "DE", "RI", "NH", "WA", "OK",
+        "MN", "WI", "OR", "SD", "NM", "ME", "MT", "ND", "NE", "WY",
+        "GA", "SC", "TX", "AL", "AR", "ID", "UT", "VT", "AK", "HI",
+        "DC"
+    };
+
+    struct WeightedGame
+    {
+        const char* gameType;
+        double weight;
+    };
+
+    const WeightedGame CASUAL_GAMES[] = {
+        {"Lottery", 25}, {"Slot Machine", 30}, {"Blackjack", 12}, {"Sports Betting", 15},
+        {"Poker", 5}, {"Keno", 4}, {"Bingo", 4}, {"Horse Racing", 3},
+        {"Poker Tournament", 1}, {"Sweepstakes", 1}
+    };
+
+    const WeightedGame PROFESSIONAL_GAMES[] = {
+        {"Poker", 30}, {"Poker Tournament", 25}, {"Sports Betting", 20}, {"Blackjack", 10},
+        {"Horse Racing", 10}, {"Slot Machine", 3}, {"Lottery", 2}
+    };
+
+    const WeightedGame LOTTERY_POOL_GAMES[] = {
+        {"Lottery", 85}, {"Sweepstakes", 5}, {"Keno", 5}, {"Bingo", 5}
+    };
+
+    struct ProfileShape
+    {
+        double homeStateShare;      // Fraction of sessions played in the home state
+        double w2gShare;            // Fraction of events that are W-2G-sized wins
+        double bulkShare;           // Fraction of events that are bulk losing ticket clusters
+        uint64_t bulkMin;
+        uint64_t bulkMax;
+        double stakeMedian;
+        double stakeSigma;
+        double winProbability;
+    };
+
+    ProfileShape shapeFor(GeneratorProfile profile)
+    {
+        switch (profile)
+        {
+            case GeneratorProfile::PROFESSIONAL:
+                return {0.30, 0.10, 0.02, 2, 10, 800.0, 1.0, 0.47};
+            case GeneratorProfile::LOTTERY_POOL:
+                return {0.90, 0.01, 0.75, 20, 400, 10.0, 0.6, 0.05};
+            case GeneratorProfile::CASUAL:
+            default:
+                return {0.65, 0.02, 0.12, 3, 15, 60.0, 0.9, 0.35};
+        }
+    }
+
+    double roundToCents(double amount)
+    {
+        amount = std::min(std::max(amount, 0.0), MAX_AMOUNT);
+        return std::round(amount * 100.0) / 100.0;
+    }
+}
+
+GeneratorRandom::GeneratorRandom(uint64_t seed)
+{
+    // SplitMix64 expands the seed so nearby seeds produce unrelated streams
+    for (int i = 0; i < 4; i++)
+    {
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        state[i] = z ^ (z >> 31);
+    }
+}
+
+uint64_t GeneratorRandom::next()
+{
+    auto rotl = [](uint64_t x, int k) { return (x << k) | (x >> (64 - k)); };
+
+    uint64_t result = rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+}
+
+double GeneratorRandom::uniform()
+{
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+uint64_t GeneratorRandom::below(uint64_t bound)
+{
+    return bound == 0 ? 0 : next() % bound;
+}
+
+double GeneratorRandom::pareto(double scale, double alpha)
+{
+    return scale / std::pow(1.0 - uniform(), 1.0 / alpha);
+}
+
+double GeneratorRandom::logNormal(double median, double sigma)
+{
+    // Box-Muller; only one of the pair is used to keep the stream simple
+    double u1 = 1.0 - uniform();
+    double u2 = uniform();
+    double normal = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    return median * std::exp(sigma * normal);
+}
+
+SessionGenerator::SessionGenerator(const GeneratorOptions& options, const FederalTaxRules& rules)
+    : options(options), random(options.seed), cachedDayOffset(-1), rowsWritten(0)
+{
+    buildStateTable();
+    buildGameTable(rules);
+
+    // Home state is drawn from the busier half of the table so profiles look plausible
+    homeState = states[random.below(20)];
+
+    firstDay = GamblingSession::dateToDayNumber(options.startYear, 1, 1);
+    dayCount = GamblingSession::dateToDayNumber(options.endYear + 1, 1, 1) - firstDay;
+    if (dayCount < 1) dayCount = 1;
+}
+
+void SessionGenerator::buildStateTable()
+{
+    double total = 0.0;
+    int rank = 1;
+    for (const char* state : STATES_BY_VOLUME)
+    {
+        states.push_back(state);
+        total += 1.0 / std::pow(static_cast<double>(rank++), 1.1);
+        stateWeights.push_back(total);
+    }
+}
+
+void SessionGenerator::buildGameTable(const FederalTaxRules& rules)
+{
+    const WeightedGame* table = CASUAL_GAMES;
+    size_t count = sizeof(CASUAL_GAMES) / sizeof(CASUAL_GAMES[0]);
+    if (options.profile == GeneratorProfile::PROFESSIONAL)
+    {
+        table = PROFESSIONAL_GAMES;
+        count = sizeof(PROFESSIONAL_GAMES) / sizeof(PROFESSIONAL_GAMES[0]);
+    }
+    else if (options.profile == GeneratorProfile::LOTTERY_POOL)
+    {
+        table = LOTTERY_POOL_GAMES;
+        count = sizeof(LOTTERY_POOL_GAMES) / sizeof(LOTTERY_POOL_GAMES[0]);
+    }
+
+    // Config files spell keys with underscores (Slot_Machine); the classifier accepts either form
+    WithholdingClassifier classifier(rules.withholdingThresholds);
+    double total = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        GameChoice choice;
+        choice.gameType = table[i].gameType;
+        choice.withholdingThreshold = classifier.getThreshold(choice.gameType);
+
+        games.push_back(choice);
+        total += table[i].weight;
+        gameWeights.push_back(total);
+    }
+}
+
+size_t SessionGenerator::pickWeighted(const std::vector<double>& cumulative)
+{
+    double target = random.uniform() * cumulative.back();
+    auto it = std::upper_bound(cumulative.begin(), cumulative.end(), target);
+    size_t index = static_cast<size_t>(it - cumulative.begin());
+    return std::min(index, cumulative.size() - 1);
+}
+
+std::string SessionGenerator::pickState()
+{
+    if (random.uniform() < shapeFor(options.profile).homeStateShare)
+    {
+        return homeState;
+    }
+    return states[pickWeighted(stateWeights)];
+}
+
+std::string SessionGenerator::pickLocation(const std::string& state, const std::string& gameType)
+{
+    static const char* const NEVADA[] = {"Bellagio", "MGM Grand", "Caesars Palace", "Wynn Las Vegas", "Circa"};
+    static const char* const NEW_JERSEY[] = {"Borgata", "Hard Rock Atlantic City", "Ocean Casino Resort"};
+    static const char* const PENNSYLVANIA[] = {"Parx Casino", "Rivers Casino Pittsburgh", "Mohegan Pennsylvania"};
+    static const char* const CONNECTICUT[] = {"Mohegan Sun", "Foxwoods"};
+    static const char* const MICHIGAN[] = {"MGM Grand Detroit", "MotorCity Casino"};
+    static const char* const SPORTSBOOKS[] = {"DraftKings", "FanDuel", "BetMGM", "Caesars Sportsbook"};
+
+    if (gameType == "Lottery" || gameType == "Sweepstakes")
+    {
+        return state + " Lottery Retailer " + std::to_string(1 + random.below(40));
+    }
+    if (gameType == "Sports Betting")
+    {
+        return SPORTSBOOKS[random.below(4)];
+    }
+    if (gameType == "Horse Racing" || gameType == "Dog Racing")
+    {
+        return random.uniform() < 0.5 ? std::string("TwinSpires") : state + " Racetrack";
+    }
+
+    if (state == "NV") return NEVADA[random.below(5)];
+    if (state == "NJ") return NEW_JERSEY[random.below(3)];
+    if (state == "PA") return PENNSYLVANIA[random.below(3)];
+    if (state == "CT") return CONNECTICUT[random.below(2)];
+    if (state == "MI") return MICHIGAN[random.below(2)];
+    return state + " Casino " + std::to_string(1 + random.below(6));
+}
+
+std::string SessionGenerator::dateForRow(uint64_t row)
+{
+    int64_t offset;
+    if (options.chronological)
+    {
+        offset = static_cast<int64_t>(row * static_cast<uint64_t>(dayCount) / options.rowCount);
+    }
+    else
+    {
+        offset = static_cast<int64_t>(random.below(static_cast<uint64_t>(dayCount)));
+    }
+
+    // Chronological files repeat each date for many rows; format it once
+    if (offset != cachedDayOffset)
+    {
+        cachedDayOffset = offset;
+        cachedDate = GamblingSession::dayNumberToDate(firstDay + offset);
+    }
+    return cachedDate;
+}
+
+void SessionGenerator::appendAmount(double amount)
+{
+    // Equivalent to std::fixed << std::setprecision(2) for non-negative amounts
+    long long cents = std::llround(amount * 100.0);
+    buffer += std::to_string(cents / 100);
+    buffer += '.';
+    buffer += static_cast<char>('0' + (cents % 100) / 10);
+    buffer += static_cast<char>('0' + cents % 10);
+}
+
+void SessionGenerator::writeSession(std::ostream& out, const std::string& date, const std::string& location,
+                                    const std::string& state, const std::string& gameType,
+                                    double buyIn, double cashOut, double withheld,
+                                    const std::string& documentationNote, const std::string& notes)
+{
+    buffer += date;
+    buffer += ',';
+    buffer += location;
+    buffer += ',';
+    buffer += state;
+    buffer += ',';
+    buffer += gameType;
+    buffer += ',';
+    appendAmount(buyIn);
+    buffer += ',';
+    appendAmount(cashOut);
+    buffer += withheld > 0.0 ? ",1," : ",0,";
+    appendAmount(withheld);
+    buffer += ',';
+    buffer += documentationNote;
+    buffer += ',';
+    buffer += notes;
+    buffer += '\n';
+
+    rowsWritten++;
+    flushIfFull(out);
+}
+
+void SessionGenerator::flushIfFull(std::ostream& out)
+{
+    if (buffer.size() >= FLUSH_THRESHOLD)
+    {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+void SessionGenerator::emitRegularSession(std::ostream& out, const std::string& date)
+{
+    ProfileShape shape = shapeFor(options.profile);
+    const GameChoice& game = games[pickWeighted(gameWeights)];
+    std::string state = pickState();
+
+    double buyIn = roundToCents(std::max(1.0, random.logNormal(shape.stakeMedian, shape.stakeSigma)));
+    double cashOut;
+    if (random.uniform() < shape.winProbability)
+    {
+        // Heavy tail: most wins are a fraction of the stake, a few are multiples of it
+        cashOut = roundToCents(buyIn + buyIn * random.pareto(0.1, 1.6));
+    }
+    else if (random.uniform() < 0.4)
+    {
+        cashOut = 0.0;
+    }
+    else
+    {
+        cashOut = roundToCents(buyIn * random.uniform() * 0.9);
+    }
+
+    std::string documentationNote = random.uniform() < 0.3 ? "Players club statement" : "";
+    writeSession(out, date, pickLocation(state, game.gameType), state, game.gameType,
+                 buyIn, cashOut, 0.0, documentationNote, "");
+}
+
+void SessionGenerator::emitW2GWin(std::ostream& out, const std::string& date)
+{
+    // Only games with a configured threshold can produce a W-2G
+    std::vector<size_t> eligible;
+    for (size_t i = 0; i < games.size(); i++)
+    {
+        if (games[i].withholdingThreshold > 0.0) eligible.push_back(i);
+    }
+    if (eligible.empty())
+    {
+        emitRegularSession(out, date);
+        return;
+    }
+
+    const GameChoice& game = games[eligible[random.below(eligible.size())]];
+    std::string state = pickState();
+    double net = roundToCents(game.withholdingThreshold * random.pareto(1.0, 1.5));
+
+    double buyIn;
+    if (game.gameType == "Horse Racing" || game.gameType == "Dog Racing")
+    {
+        buyIn = roundToCents(std::max(1.0, net / (300.0 + random.uniform() * 500.0)));
+    }
+    else if (game.gameType == "Poker Tournament")
+    {
+        buyIn = roundToCents(random.logNormal(1000.0, 0.8));
+    }
+    else
+    {
+        buyIn = roundToCents(1.0 + random.uniform() * 25.0);
+    }
+
+    double cashOut = roundToCents(buyIn + net);
+    double withheld = 0.0;
+    if (net > 5000.0 && game.gameType != "Slot Machine" && game.gameType != "Bingo" && game.gameType != "Keno")
+    {
+        withheld = roundToCents(net * 0.24);
+    }
+
+    writeSession(out, date, pickLocation(state, game.gameType), state, game.gameType,
+                 buyIn, cashOut, withheld, "W-2G issued", "");
+}
+
+void SessionGenerator::emitBulkLosingCluster(std::ostream& out, const std::string& date, uint64_t maxRows)
+{
+    static const double TICKET_PRICES[] = {1.0, 2.0, 2.0, 5.0, 5.0, 10.0, 20.0, 30.0};
+
+    ProfileShape shape = shapeFor(options.profile);
+    uint64_t count = shape.bulkMin + random.below(shape.bulkMax - shape.bulkMin + 1);
+    count = std::min(count, maxRows);
+
+    std::string state = pickState();
+    std::string gameType = options.profile == GeneratorProfile::LOTTERY_POOL || random.uniform() < 0.7
+                               ? "Lottery" : "Keno";
+    std::string location = pickLocation(state, gameType);
+
+    // Same shape ConsoleInterface::addBulkLosingSessions produces
+    for (uint64_t i = 0; i < count; i++)
+    {
+        double amount = TICKET_PRICES[random.below(8)];
+        writeSession(out, date, location, state, gameType, amount, 0.0, 0.0,
+                     "Keep losing ticket", "Bulk entry loss");
+    }
+}
+
+uint64_t SessionGenerator::generate(std::ostream& out)
+{
+    ProfileShape shape = shapeFor(options.profile);
+
+    buffer.clear();
+    buffer.reserve(FLUSH_THRESHOLD + 4096);
+    buffer += "Date,Location,State,GameType,BuyIn,CashOut,TaxWithheld,WithheldAmount,DocumentationNote,Notes\n";
+    rowsWritten = 0;
+
+    while (rowsWritten < options.rowCount)
+    {
+        std::string date = dateForRow(rowsWritten);
+        double event = random.uniform();
+
+        if (event < shape.bulkShare)
+        {
+            emitBulkLosingCluster(out, date, options.rowCount - rowsWritten);
+        }
+        else if (event < shape.bulkShare + shape.w2gShare)
+        {
+            emitW2GWin(out, date);
+        }
+        else
+        {
+            emitRegularSession(out, date);
+        }
+    }
+
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    out.flush();
+    return rowsWritten;
+}
+
+bool SessionGenerator::parseProfile(const std::string& name, GeneratorProfile& profile)
+{
+    if (name == "casual")
+    {
+        profile = GeneratorProfile::CASUAL;
+    }
+    else if (name == "professional")
+    {
+        profile = GeneratorProfile::PROFESSIONAL;
+    }
+    else if (name == "lottery-pool")
+    {
+        profile = GeneratorProfile::LOTTERY_POOL;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
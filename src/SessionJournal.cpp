@@ -0,0 +1,431 @@
+#include "../include/SessionJournal.h"
+#include "../include/Checksum.h"
+#include "../include/Trace.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char OP_SNAPSHOT = 'S';
+    const char OP_JOURNAL = 'J';
+    const char OP_ADD = 'A';
+    const char OP_UPDATE = 'U';
+    const char OP_DELETE = 'D';
+    const char OP_BATCH = 'B';
+    const char OP_BATCH_UPDATE = 'C';
+    const char OP_BATCH_DELETE = 'R';
+
+    const size_t SNAPSHOT_BUFFER = 1 << 20;
+    const std::chrono::seconds MAX_SYNC_DELAY(1);
+
+    std::string idPayload(SessionId id, const std::string& csv)
+    {
+        std::string payload = std::to_string(id.toInteger());
+        if (!csv.empty())
+        {
+            payload += ' ';
+            payload += csv;
+        }
+        return payload;
+    }
+
+    bool splitNumber(const std::string& payload, uint64_t& value, std::string& rest)
+    {
+        size_t space = payload.find(' ');
+        std::string number = payload.substr(0, space);
+        if (number.empty() || number.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+
+        value = std::strtoull(number.c_str(), nullptr, 10);
+        rest = space == std::string::npos ? "" : payload.substr(space + 1);
+        return true;
+    }
+
+    bool splitId(const std::string& payload, SessionId& id, std::string& rest)
+    {
+        uint64_t value = 0;
+        if (!splitNumber(payload, value, rest))
+        {
+            return false;
+        }
+        id = SessionId::fromInteger(value);
+        return true;
+    }
+
+    // A batch position that names an existing batch
+    bool splitIndex(const std::string& payload, size_t count, size_t& index, std::string& rest)
+    {
+        uint64_t value = 0;
+        if (!splitNumber(payload, value, rest) || value >= count)
+        {
+            return false;
+        }
+        index = static_cast<size_t>(value);
+        return true;
+    }
+
+    void syncDirectory(const std::string& path)
+    {
+#ifndef _WIN32
+        // Makes the rename itself durable, not just the file contents
+        std::string directory = std::filesystem::path(path).parent_path().string();
+        int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            fsync(fd);
+            close(fd);
+        }
+#else
+        (void)path;
+#endif
+    }
+}
+
+SessionJournal::SessionJournal(const std::string& basePath)
+    : journalPath(basePath + ".journal"), snapshotPath(basePath + ".snapshot"), file(nullptr),
+      epoch(0), recordCount(0), pendingSync(0), lastSync(std::chrono::steady_clock::now())
+{
+}
+
+SessionJournal::~SessionJournal()
+{
+    closeJournal();
+}
+
+void SessionJournal::formatLine(std::string& out, char op, const std::string& payload)
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    std::string body;
+    body.reserve(payload.size() + 2);
+    body += op;
+    body += ' ';
+    body += payload;
+
+    // A record must stay on one line; CSV fields never legitimately contain newlines
+    for (char& c : body)
+    {
+        if (c == '\n' || c == '\r') c = ' ';
+    }
+
+    uint32_t crc = Checksum::crc32c(body.data(), body.size());
+    out.clear();
+    for (int shift = 28; shift >= 0; shift -= 4)
+    {
+        out += HEX[(crc >> shift) & 0xF];
+    }
+    out += ' ';
+    out += body;
+    out += '\n';
+}
+
+bool SessionJournal::parseLine(const std::string& text, char& op, std::string& payload)
+{
+    if (text.size() < 11 || text[8] != ' ' || text[10] != ' ')
+    {
+        return false;
+    }
+
+    char* end = nullptr;
+    std::string hex = text.substr(0, 8);
+    uint32_t expected = static_cast<uint32_t>(std::strtoul(hex.c_str(), &end, 16));
+    if (end != hex.c_str() + 8)
+    {
+        return false;
+    }
+
+    if (Checksum::crc32c(text.data() + 9, text.size() - 9) != expected)
+    {
+        return false;
+    }
+
+    op = text[9];
+    payload = text.substr(11);
+    return true;
+}
+
+bool SessionJournal::readHeader(std::istream& in, char expectedOp, uint64_t& headerEpoch)
+{
+    std::string text;
+    std::string payload;
+    char op = 0;
+    if (!std::getline(in, text) || !parseLine(text, op, payload) || op != expectedOp)
+    {
+        return false;
+    }
+    headerEpoch = std::strtoull(payload.c_str(), nullptr, 10);
+    return true;
+}
+
+bool SessionJournal::apply(char op, const std::string& payload, SessionDatabase& sessions,
+                           std::vector<TicketBatch>& ticketBatches)
+{
+    try
+    {
+        SessionId id;
+        size_t index = 0;
+        std::string csv;
+        switch (op)
+        {
+            case OP_ADD:
+                return splitId(payload, id, csv) && sessions.insertWithId(id, GamblingSession::fromCSV(csv));
+            case OP_UPDATE:
+                return splitId(payload, id, csv) && sessions.update(id, GamblingSession::fromCSV(csv));
+            case OP_DELETE:
+                return splitId(payload, id, csv) && sessions.erase(id);
+            case OP_BATCH:
+                ticketBatches.push_back(TicketBatch::fromCSV(payload));
+                return true;
+            case OP_BATCH_UPDATE:
+                if (!splitIndex(payload, ticketBatches.size(), index, csv)) return false;
+                ticketBatches[index] = TicketBatch::fromCSV(csv);
+                return true;
+            case OP_BATCH_DELETE:
+                if (!splitIndex(payload, ticketBatches.size(), index, csv)) return false;
+                ticketBatches.erase(ticketBatches.begin() + static_cast<std::ptrdiff_t>(index));
+                return true;
+            default:
+                return false;
+        }
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+bool SessionJournal::writeAll(std::FILE* out, const std::string& data)
+{
+    return std::fwrite(data.data(), 1, data.size(), out) == data.size();
+}
+
+bool SessionJournal::syncFile(std::FILE* out)
+{
+    if (std::fflush(out) != 0)
+    {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(out)) == 0;
+#else
+    return fsync(fileno(out)) == 0;
+#endif
+}
+
+bool SessionJournal::openJournal(bool truncate)
+{
+    closeJournal();
+    file = std::fopen(journalPath.c_str(), truncate ? "wb" : "ab");
+    if (!file)
+    {
+        return false;
+    }
+
+    if (truncate)
+    {
+        formatLine(line, OP_JOURNAL, std::to_string(epoch));
+        writeAll(file, line);
+        syncFile(file);
+        recordCount = 0;
+    }
+    pendingSync = 0;
+    lastSync = std::chrono::steady_clock::now();
+    return true;
+}
+
+void SessionJournal::closeJournal()
+{
+    if (file)
+    {
+        sync();
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+bool SessionJournal::recover(SessionDatabase& sessions, std::vector<TicketBatch>& ticketBatches,
+                             RecoveryStats& stats)
+{
+    TRACE_SCOPE("SessionJournal::recover");
+    std::string text;
+    std::string payload;
+    char op = 0;
+
+    std::ifstream snapshot(snapshotPath, std::ios::binary);
+    if (snapshot.is_open() && readHeader(snapshot, OP_SNAPSHOT, epoch))
+    {
+        // Snapshots are written to a temp file and renamed, so they are never torn
+        while (std::getline(snapshot, text) && parseLine(text, op, payload) &&
+               apply(op, payload, sessions, ticketBatches))
+        {
+            stats.snapshotRecords++;
+        }
+    }
+
+    uint64_t journalEpoch = 0;
+    std::ifstream journal(journalPath, std::ios::binary);
+    bool journalValid = journal.is_open() && readHeader(journal, OP_JOURNAL, journalEpoch) &&
+                        journalEpoch == epoch;
+    if (journalValid)
+    {
+        // A crash mid-append leaves a partial last line; everything before it is good
+        while (std::getline(journal, text))
+        {
+            if (journal.eof() || !parseLine(text, op, payload) || !apply(op, payload, sessions, ticketBatches))
+            {
+                stats.tornTail = true;
+                break;
+            }
+            stats.journalRecords++;
+        }
+    }
+    journal.close();
+
+    if (journalValid && !stats.tornTail)
+    {
+        openJournal(false);
+        recordCount = stats.journalRecords;
+    }
+    else
+    {
+        // Missing, stale (older epoch) or damaged journal: fold state into a new snapshot
+        compact(sessions, ticketBatches);
+    }
+
+    return stats.snapshotRecords + stats.journalRecords > 0;
+}
+
+void SessionJournal::append(char op, const std::string& payload)
+{
+    if (!file)
+    {
+        return;
+    }
+
+    formatLine(line, op, payload);
+    writeAll(file, line);
+    recordCount++;
+    pendingSync++;
+
+    auto now = std::chrono::steady_clock::now();
+    if (pendingSync >= SYNC_BATCH || now - lastSync >= MAX_SYNC_DELAY)
+    {
+        sync();
+    }
+}
+
+void SessionJournal::logAdd(SessionId id, const GamblingSession& session)
+{
+    append(OP_ADD, idPayload(id, session.toCSV()));
+}
+
+void SessionJournal::logUpdate(SessionId id, const GamblingSession& session)
+{
+    append(OP_UPDATE, idPayload(id, session.toCSV()));
+}
+
+void SessionJournal::logDelete(SessionId id)
+{
+    append(OP_DELETE, idPayload(id, ""));
+}
+
+void SessionJournal::logBatch(const TicketBatch& batch)
+{
+    append(OP_BATCH, batch.toCSV());
+}
+
+void SessionJournal::logBatchUpdate(size_t index, const TicketBatch& batch)
+{
+    append(OP_BATCH_UPDATE, std::to_string(index) + ' ' + batch.toCSV());
+}
+
+void SessionJournal::logBatchDelete(size_t index)
+{
+    append(OP_BATCH_DELETE, std::to_string(index));
+}
+
+void SessionJournal::sync()
+{
+    if (file && pendingSync > 0)
+    {
+        syncFile(file);
+        pendingSync = 0;
+        lastSync = std::chrono::steady_clock::now();
+    }
+}
+
+bool SessionJournal::shouldCompact(size_t liveRecords) const
+{
+    return recordCount >= MIN_COMPACT_RECORDS && recordCount >= liveRecords / 2;
+}
+
+bool SessionJournal::compact(const SessionDatabase& sessions, const std::vector<TicketBatch>& ticketBatches)
+{
+    TRACE_SCOPE("SessionJournal::compact");
+    std::string tempPath = snapshotPath + ".tmp";
+    std::FILE* out = std::fopen(tempPath.c_str(), "wb");
+    if (!out)
+    {
+        return false;
+    }
+
+    uint64_t nextEpoch = epoch + 1;
+    std::string buffer;
+    buffer.reserve(SNAPSHOT_BUFFER + 4096);
+    bool ok = true;
+
+    auto put = [&](char op, const std::string& payload)
+    {
+        formatLine(line, op, payload);
+        buffer += line;
+        if (buffer.size() >= SNAPSHOT_BUFFER)
+        {
+            ok = ok && writeAll(out, buffer);
+            buffer.clear();
+        }
+    };
+
+    put(OP_SNAPSHOT, std::to_string(nextEpoch));
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        put(OP_ADD, idPayload(sessions.idAt(i), sessions[i].toCSV()));
+    }
+    for (const auto& batch : ticketBatches)
+    {
+        put(OP_BATCH, batch.toCSV());
+    }
+
+    ok = ok && writeAll(out, buffer);
+    ok = syncFile(out) && ok;
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok)
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // The old journal belongs to the old epoch; once the rename lands it is ignored
+    closeJournal();
+    std::error_code error;
+    std::filesystem::rename(tempPath, snapshotPath, error);
+    if (error)
+    {
+        std::remove(tempPath.c_str());
+        openJournal(false);
+        return false;
+    }
+    syncDirectory(snapshotPath);
+
+    epoch = nextEpoch;
+    return openJournal(true);
+}
@@ -0,0 +1,495 @@
+#include "../include/SessionJson.h"
+#include <set>
+#include <stdexcept>
+
+const char* const SessionJson::SESSIONS_FORMAT = "gambling-sessions";
+const char* const SessionJson::SUMMARY_FORMAT = "gambling-tax-summary";
+
+namespace
+{
+    void checkHeader(const std::string& key, const std::string& text, const char* expectedFormat)
+    {
+        if (key == "format" && text != expectedFormat)
+        {
+            throw std::runtime_error("Unexpected JSON document format: " + text);
+        }
+    }
+
+    void checkVersion(const std::string& key, double version)
+    {
+        if (key == "version" && version > SessionJson::FORMAT_VERSION)
+        {
+            throw std::runtime_error("JSON document version " + std::to_string(static_cast<int>(version)) +
+                                     " is newer than this program supports");
+        }
+    }
+
+    // Depth counts open containers: 1 = document object, 2 = the sessions or
+    // ticketBatches array, 3 = one record, 4 = a batch's tickets array.
+    // Unknown keys (and anything nested under them) are ignored.
+    class SessionDocumentHandler : public JsonHandler
+    {
+    private:
+        enum class Section { NONE, SESSIONS, BATCHES };
+
+        const SessionJson::SessionCallback& onSession;
+        const SessionJson::BatchCallback& onBatch;
+        SessionJson::ReadStats& stats;
+
+        size_t depth;
+        Section section;
+        std::string currentKey;
+        std::string sectionKey;     // Top-level key the next container belongs to
+
+        bool inRecord;
+        bool inTickets;
+        bool recordValid;
+        GamblingSession session;
+        TicketBatch batch;
+
+        void setText(const std::string& text)
+        {
+            if (section == Section::SESSIONS)
+            {
+                if (currentKey == "date") session.setDate(text);
+                else if (currentKey == "location") session.setLocation(text);
+                else if (currentKey == "state") session.setState(text);
+                else if (currentKey == "gameType") session.setGameType(text);
+                else if (currentKey == "documentationNote") session.setDocumentationNote(text);
+                else if (currentKey == "notes") session.setNotes(text);
+            }
+            else
+            {
+                if (currentKey == "date") batch.setDate(text);
+                else if (currentKey == "location") batch.setLocation(text);
+                else if (currentKey == "state") batch.setState(text);
+                else if (currentKey == "gameType") batch.setGameType(text);
+            }
+        }
+
+        void finishRecord()
+        {
+            if (section == Section::SESSIONS)
+            {
+                if (recordValid && GamblingSession::isValidDate(session.getDate()))
+                {
+                    stats.sessions++;
+                    onSession(session);
+                }
+                else
+                {
+                    stats.invalid++;
+                }
+            }
+            else
+            {
+                if (recordValid && GamblingSession::isValidDate(batch.getDate()) && !batch.isEmpty())
+                {
+                    stats.ticketBatches++;
+                    onBatch(batch);
+                }
+                else
+                {
+                    stats.invalid++;
+                }
+            }
+        }
+
+    public:
+        SessionDocumentHandler(const SessionJson::SessionCallback& onSession,
+                               const SessionJson::BatchCallback& onBatch, SessionJson::ReadStats& stats)
+            : onSession(onSession), onBatch(onBatch), stats(stats), depth(0), section(Section::NONE),
+              inRecord(false), inTickets(false), recordValid(false)
+        {
+        }
+
+        void startObject() override
+        {
+            if (depth == 2 && section != Section::NONE)
+            {
+                inRecord = true;
+                recordValid = true;
+                session = GamblingSession();
+                batch = TicketBatch();
+            }
+            depth++;
+        }
+
+        void endObject() override
+        {
+            depth--;
+            if (depth == 2 && inRecord)
+            {
+                finishRecord();
+                inRecord = false;
+            }
+        }
+
+        void startArray() override
+        {
+            if (depth == 1)
+            {
+                section = sectionKey == "sessions" ? Section::SESSIONS
+                        : sectionKey == "ticketBatches" ? Section::BATCHES
+                        : Section::NONE;
+            }
+            else if (depth == 3 && inRecord && section == Section::BATCHES && currentKey == "tickets")
+            {
+                inTickets = true;
+            }
+            depth++;
+        }
+
+        void endArray() override
+        {
+            depth--;
+            if (depth == 1)
+            {
+                section = Section::NONE;
+            }
+            else if (depth == 3)
+            {
+                inTickets = false;
+            }
+        }
+
+        void key(const std::string& name) override
+        {
+            if (depth == 1)
+            {
+                sectionKey = name;
+            }
+            currentKey = name;
+        }
+
+        void stringValue(const std::string& text) override
+        {
+            if (depth == 1)
+            {
+                checkHeader(currentKey, text, SessionJson::SESSIONS_FORMAT);
+            }
+            else if (depth == 3 && inRecord)
+            {
+                setText(text);
+            }
+        }
+
+        void numberValue(double number) override
+        {
+            if (depth == 1)
+            {
+                checkVersion(currentKey, number);
+            }
+            else if (depth == 3 && inRecord && section == Section::SESSIONS)
+            {
+                if (currentKey == "buyIn") session.setBuyIn(number);
+                else if (currentKey == "cashOut") session.setCashOut(number);
+                else if (currentKey == "withheldAmount") session.setWithheldAmount(number);
+            }
+            else if (depth == 4 && inTickets)
+            {
+                try
+                {
+                    batch.addTicket(number);
+                }
+                catch (const std::invalid_argument&)
+                {
+                    recordValid = false;
+                }
+            }
+        }
+
+        void boolValue(bool flag) override
+        {
+            if (depth == 3 && inRecord && section == Section::SESSIONS && currentKey == "taxWithheld")
+            {
+                session.setTaxWithheld(flag);
+            }
+        }
+    };
+
+    // Depth 1 = summary object, 2 = "states" map or reminders array,
+    // 3 = one state's totals
+    class TaxSummaryHandler : public JsonHandler
+    {
+    private:
+        TaxSummary& summary;
+        size_t depth;
+        std::string currentKey;
+        std::string sectionKey;
+        std::string stateCode;
+
+    public:
+        explicit TaxSummaryHandler(TaxSummary& summary) : summary(summary), depth(0) {}
+
+        void startObject() override
+        {
+            if (depth == 2 && sectionKey == "states")
+            {
+                stateCode = currentKey;
+            }
+            depth++;
+        }
+
+        void endObject() override { depth--; }
+        void startArray() override { depth++; }
+        void endArray() override { depth--; }
+
+        void key(const std::string& name) override
+        {
+            if (depth == 1)
+            {
+                sectionKey = name;
+            }
+            currentKey = name;
+        }
+
+        void stringValue(const std::string& text) override
+        {
+            if (depth == 1)
+            {
+                checkHeader(currentKey, text, SessionJson::SUMMARY_FORMAT);
+                if (currentKey == "rulesVersion") summary.rulesVersion = text;
+            }
+            else if (depth == 2 && sectionKey == "documentationReminders")
+            {
+                summary.documentationReminders.push_back(text);
+            }
+        }
+
+        void numberValue(double number) override
+        {
+            if (depth == 1)
+            {
+                checkVersion(currentKey, number);
+                if (currentKey == "totalWinnings") summary.totalWinnings = number;
+                else if (currentKey == "totalLosses") summary.totalLosses = number;
+                else if (currentKey == "netFederalResult") summary.netFederalResult = number;
+                else if (currentKey == "deductibleLosses") summary.deductibleLosses = number;
+                else if (currentKey == "federalTaxableIncome") summary.federalTaxableIncome = number;
+                else if (currentKey == "totalWithheld") summary.totalWithheld = number;
+                else if (currentKey == "estimatedFederalTax") summary.estimatedFederalTax = number;
+                else if (currentKey == "federalMarginalRate") summary.federalMarginalRate = number;
+                else if (currentKey == "taxYear") summary.taxYear = static_cast<int>(number);
+            }
+            else if (depth == 3 && sectionKey == "states")
+            {
+                if (currentKey == "winnings") summary.stateWinnings[stateCode] = number;
+                else if (currentKey == "losses") summary.stateLosses[stateCode] = number;
+                else if (currentKey == "deductibleLosses") summary.stateDeductibleLosses[stateCode] = number;
+                else if (currentKey == "netResult") summary.stateNetResults[stateCode] = number;
+                else if (currentKey == "tax") summary.stateTaxes[stateCode] = number;
+            }
+        }
+
+        void boolValue(bool flag) override
+        {
+            if (depth == 1)
+            {
+                if (currentKey == "hasWinnings") summary.hasWinnings = flag;
+                else if (currentKey == "hasDeductibleLosses") summary.hasDeductibleLosses = flag;
+                else if (currentKey == "itemizingRecommended") summary.itemizingRecommended = flag;
+            }
+        }
+    };
+
+    void writeStateEntry(JsonWriter& writer, const char* name, const std::map<std::string, double>& values,
+                         const std::string& state)
+    {
+        auto it = values.find(state);
+        if (it != values.end())
+        {
+            writer.key(name);
+            writer.moneyValue(it->second);
+        }
+    }
+}
+
+void SessionJson::writeSession(JsonWriter& writer, const GamblingSession& session)
+{
+    writer.beginObject();
+    writer.key("date");
+    writer.value(session.getDate());
+    writer.key("location");
+    writer.value(session.getLocation());
+    writer.key("state");
+    writer.value(session.getState());
+    writer.key("gameType");
+    writer.value(session.getGameType());
+    writer.key("buyIn");
+    writer.moneyValue(session.getBuyIn());
+    writer.key("cashOut");
+    writer.moneyValue(session.getCashOut());
+    writer.key("taxWithheld");
+    writer.value(session.getTaxWithheld());
+    writer.key("withheldAmount");
+    writer.moneyValue(session.getWithheldAmount());
+    writer.key("documentationNote");
+    writer.value(session.getDocumentationNote());
+    writer.key("notes");
+    writer.value(session.getNotes());
+    writer.endObject();
+}
+
+void SessionJson::writeTicketBatch(JsonWriter& writer, const TicketBatch& batch)
+{
+    writer.beginObject();
+    writer.key("date");
+    writer.value(batch.getDate());
+    writer.key("location");
+    writer.value(batch.getLocation());
+    writer.key("state");
+    writer.value(batch.getState());
+    writer.key("gameType");
+    writer.value(batch.getGameType());
+    writer.key("tickets");
+    writer.beginArray();
+    for (uint32_t cents : batch.getTicketCents())
+    {
+        writer.moneyValue(cents / 100.0);
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+namespace
+{
+    // Same document for either session container
+    template <typename Sessions>
+    void writeSessionDocument(std::ostream& out, const Sessions& sessions, const std::vector<TicketBatch>& ticketBatches)
+    {
+        JsonWriter writer(out);
+        writer.beginObject();
+        writer.key("format");
+        writer.value(SessionJson::SESSIONS_FORMAT);
+        writer.key("version");
+        writer.value(static_cast<long long>(SessionJson::FORMAT_VERSION));
+
+        writer.key("sessions");
+        writer.beginArray();
+        for (const auto& session : sessions)
+        {
+            SessionJson::writeSession(writer, session);
+        }
+        writer.endArray();
+
+        writer.key("ticketBatches");
+        writer.beginArray();
+        for (const auto& batch : ticketBatches)
+        {
+            SessionJson::writeTicketBatch(writer, batch);
+        }
+        writer.endArray();
+
+        writer.endObject();
+        writer.flush();
+        out << "\n";
+    }
+}
+
+void SessionJson::writeSessions(std::ostream& out, const std::vector<GamblingSession>& sessions,
+                                const std::vector<TicketBatch>& ticketBatches)
+{
+    writeSessionDocument(out, sessions, ticketBatches);
+}
+
+void SessionJson::writeSessions(std::ostream& out, const SessionChunks& sessions,
+                                const std::vector<TicketBatch>& ticketBatches)
+{
+    writeSessionDocument(out, sessions, ticketBatches);
+}
+
+void SessionJson::writeTaxSummary(JsonWriter& writer, const TaxSummary& summary)
+{
+    writer.beginObject();
+    writer.key("format");
+    writer.value(SUMMARY_FORMAT);
+    writer.key("version");
+    writer.value(static_cast<long long>(FORMAT_VERSION));
+    writer.key("taxYear");
+    writer.value(static_cast<long long>(summary.taxYear));
+    writer.key("rulesVersion");
+    writer.value(summary.rulesVersion);
+
+    writer.key("totalWinnings");
+    writer.moneyValue(summary.totalWinnings);
+    writer.key("totalLosses");
+    writer.moneyValue(summary.totalLosses);
+    writer.key("netFederalResult");
+    writer.moneyValue(summary.netFederalResult);
+    writer.key("deductibleLosses");
+    writer.moneyValue(summary.deductibleLosses);
+    writer.key("federalTaxableIncome");
+    writer.moneyValue(summary.federalTaxableIncome);
+    writer.key("totalWithheld");
+    writer.moneyValue(summary.totalWithheld);
+    writer.key("estimatedFederalTax");
+    writer.moneyValue(summary.estimatedFederalTax);
+    writer.key("federalMarginalRate");
+    writer.value(summary.federalMarginalRate);
+
+    writer.key("hasWinnings");
+    writer.value(summary.hasWinnings);
+    writer.key("hasDeductibleLosses");
+    writer.value(summary.hasDeductibleLosses);
+    writer.key("itemizingRecommended");
+    writer.value(summary.itemizingRecommended);
+
+    // Every state that appears in any of the per-state maps
+    std::set<std::string> states;
+    for (const auto& entry : summary.stateWinnings) states.insert(entry.first);
+    for (const auto& entry : summary.stateLosses) states.insert(entry.first);
+    for (const auto& entry : summary.stateNetResults) states.insert(entry.first);
+
+    writer.key("states");
+    writer.beginObject();
+    for (const auto& state : states)
+    {
+        writer.key(state);
+        writer.beginObject();
+        writeStateEntry(writer, "winnings", summary.stateWinnings, state);
+        writeStateEntry(writer, "losses", summary.stateLosses, state);
+        writeStateEntry(writer, "deductibleLosses", summary.stateDeductibleLosses, state);
+        writeStateEntry(writer, "netResult", summary.stateNetResults, state);
+        writeStateEntry(writer, "tax", summary.stateTaxes, state);
+        writer.endObject();
+    }
+    writer.endObject();
+
+    writer.key("documentationReminders");
+    writer.beginArray();
+    for (const auto& reminder : summary.documentationReminders)
+    {
+        writer.value(reminder);
+    }
+    writer.endArray();
+
+    writer.endObject();
+}
+
+void SessionJson::writeTaxSummary(std::ostream& out, const TaxSummary& summary)
+{
+    JsonWriter writer(out);
+    writeTaxSummary(writer, summary);
+    writer.flush();
+    out << "\n";
+}
+
+SessionJson::ReadStats SessionJson::readSessions(std::istream& in, const SessionCallback& onSession,
+                                                 const BatchCallback& onBatch)
+{
+    ReadStats stats;
+    SessionDocumentHandler handler(onSession, onBatch, stats);
+    JsonReader reader(in);
+    reader.parse(handler);
+    return stats;
+}
+
+TaxSummary SessionJson::readTaxSummary(std::istream& in)
+{
+    TaxSummary summary = TaxSummary();
+    TaxSummaryHandler handler(summary);
+    JsonReader reader(in);
+    reader.parse(handler);
+    return summary;
+}
@@ -0,0 +1,238 @@
+#include "../include/SessionPartitions.h"
+#include "../include/TaxCalculator.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    int64_t toCents(double amount)
+    {
+        return static_cast<int64_t>(std::llround(amount * 100.0));
+    }
+}
+
+ZoneMap::ZoneMap()
+    : firstDay(std::numeric_limits<long long>::max()), lastDay(std::numeric_limits<long long>::min()),
+      sessions(0), tickets(0), winningsCents(0), lossesCents(0)
+{
+}
+
+ZoneMap& ZoneMap::operator+=(const ZoneMap& other)
+{
+    firstDay = std::min(firstDay, other.firstDay);
+    lastDay = std::max(lastDay, other.lastDay);
+    sessions += other.sessions;
+    tickets += other.tickets;
+    winningsCents += other.winningsCents;
+    lossesCents += other.lossesCents;
+    return *this;
+}
+
+SessionPartitions::SessionPartitions()
+{
+}
+
+int SessionPartitions::taxYearOf(const std::string& date)
+{
+    if (!GamblingSession::isValidDate(date))
+    {
+        return UNDATED_YEAR;
+    }
+    return (date[6] - '0') * 1000 + (date[7] - '0') * 100 + (date[8] - '0') * 10 + (date[9] - '0');
+}
+
+long long SessionPartitions::dayOf(const std::string& date)
+{
+    return GamblingSession::isValidDate(date) ? GamblingSession::dateToDayNumber(date) : 0;
+}
+
+SessionPartitions::Partition& SessionPartitions::partitionFor(const std::string& date, const std::string& state)
+{
+    Partition& partition = partitions[Key{taxYearOf(date), state}];
+    long long day = dayOf(date);
+    partition.zone.firstDay = std::min(partition.zone.firstDay, day);
+    partition.zone.lastDay = std::max(partition.zone.lastDay, day);
+    partition.version++;
+    return partition;
+}
+
+void SessionPartitions::add(SessionId id, const GamblingSession& session)
+{
+    Partition& partition = partitionFor(session.getDate(), session.getState());
+    double net = session.getNetResult();
+    partition.zone.sessions++;
+    if (net > 0) partition.zone.winningsCents += toCents(net);
+    else if (net < 0) partition.zone.lossesCents += toCents(-net);
+
+    if (members.size() <= id.slot)
+    {
+        members.resize(id.slot + 1, Member{nullptr, 0});
+    }
+    members[id.slot] = Member{&partition, static_cast<uint32_t>(partition.sessions.size())};
+    partition.sessions.push_back(id);
+}
+
+void SessionPartitions::remove(SessionId id, const GamblingSession& session)
+{
+    if (id.slot >= members.size() || !members[id.slot].partition)
+    {
+        return;
+    }
+
+    Member member = members[id.slot];
+    Partition& partition = *member.partition;
+    members[id.slot] = Member{nullptr, 0};
+
+    // Swap-remove; the member moved into the gap gets its new position
+    SessionId moved = partition.sessions.back();
+    partition.sessions[member.position] = moved;
+    partition.sessions.pop_back();
+    if (moved != id)
+    {
+        members[moved.slot].position = member.position;
+    }
+
+    double net = session.getNetResult();
+    partition.zone.sessions--;
+    if (net > 0) partition.zone.winningsCents -= toCents(net);
+    else if (net < 0) partition.zone.lossesCents -= toCents(-net);
+    partition.version++;
+
+    if (partition.zone.isEmpty())
+    {
+        partitions.erase(Key{taxYearOf(session.getDate()), session.getState()});
+    }
+}
+
+void SessionPartitions::add(size_t batchIndex, const TicketBatch& batch)
+{
+    Partition& partition = partitionFor(batch.getDate(), batch.getState());
+    partition.zone.tickets += batch.getTicketCount();
+    partition.zone.lossesCents += toCents(batch.getTotalLosses());
+    partition.ticketBatches.push_back(batchIndex);
+}
+
+void SessionPartitions::clear()
+{
+    partitions.clear();
+    members.clear();
+}
+
+void SessionPartitions::rebuild(const SessionDatabase& sessions, const std::vector<TicketBatch>& ticketBatches)
+{
+    TRACE_SCOPE("SessionPartitions::rebuild");
+    clear();
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        add(sessions.idAt(i), sessions[i]);
+    }
+    for (size_t i = 0; i < ticketBatches.size(); i++)
+    {
+        add(i, ticketBatches[i]);
+    }
+}
+
+std::vector<int> SessionPartitions::getTaxYears() const
+{
+    std::vector<int> years;
+    for (const auto& entry : partitions)
+    {
+        if (years.empty() || years.back() != entry.first.taxYear)
+        {
+            years.push_back(entry.first.taxYear);
+        }
+    }
+    return years;
+}
+
+std::vector<std::string> SessionPartitions::getStates(int taxYear) const
+{
+    std::vector<std::string> states;
+    forEachInScope(taxYear, "", nullptr, [&states](const Key& key, const Partition&)
+    {
+        states.push_back(key.state);
+    });
+    return states;
+}
+
+ZoneMap SessionPartitions::getZoneMap(int taxYear, const std::string& state) const
+{
+    ZoneMap zone;
+    forEachInScope(taxYear, state, nullptr, [&zone](const Key&, const Partition& partition)
+    {
+        zone += partition.zone;
+    });
+    return zone;
+}
+
+template <typename Visit>
+void SessionPartitions::forEachInScope(int taxYear, const std::string& state, PartitionScan* scan, Visit visit) const
+{
+    // The map is ordered by year, then state, so the scope is one contiguous range
+    size_t read = 0;
+    auto it = partitions.lower_bound(Key{taxYear, state});
+    for (; it != partitions.end() && it->first.taxYear == taxYear; ++it)
+    {
+        if (!state.empty() && it->first.state != state) break;
+        visit(it->first, it->second);
+        read++;
+    }
+    if (scan)
+    {
+        scan->read += read;
+        scan->skipped += partitions.size() - read;
+    }
+}
+
+SessionAggregate SessionPartitions::aggregate(int taxYear, const std::string& state, const SessionDatabase& sessions,
+                                              const std::vector<TicketBatch>& ticketBatches,
+                                              const TaxCalculator& calculator, PartitionScan* scan) const
+{
+    TRACE_SCOPE("SessionPartitions::aggregate");
+    uint64_t rulesVersion = calculator.getTaxRules().getRulesVersion();
+    SessionAggregate totals;
+    forEachInScope(taxYear, state, scan, [&](const Key&, const Partition& partition)
+    {
+        if (partition.cachedVersion != partition.version || partition.cachedRules != rulesVersion)
+        {
+            SessionAggregate fresh;
+            for (SessionId id : partition.sessions)
+            {
+                calculator.addSession(fresh, *sessions.find(id));
+            }
+            for (size_t index : partition.ticketBatches)
+            {
+                fresh.addBatch(ticketBatches[index]);
+            }
+            partition.cached = std::move(fresh);
+            partition.cachedVersion = partition.version;
+            partition.cachedRules = rulesVersion;
+        }
+        else if (scan)
+        {
+            scan->reused++;
+        }
+        totals.merge(partition.cached);
+    });
+    return totals;
+}
+
+void SessionPartitions::select(int taxYear, const std::string& state, const SessionDatabase& sessions,
+                               const std::vector<TicketBatch>& ticketBatches,
+                               std::vector<GamblingSession>& selectedSessions,
+                               std::vector<TicketBatch>& selectedBatches, PartitionScan* scan) const
+{
+    forEachInScope(taxYear, state, scan, [&](const Key&, const Partition& partition)
+    {
+        for (SessionId id : partition.sessions)
+        {
+            selectedSessions.push_back(*sessions.find(id));
+        }
+        for (size_t index : partition.ticketBatches)
+        {
+            selectedBatches.push_back(ticketBatches[index]);
+        }
+    });
+}
@@ -0,0 +1,548 @@
+#include "../include/SessionSorter.h"
+#include "../include/MemoryAccounting.h"
+#include "../include/SessionDeduplicator.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+    const size_t PROGRESS_INTERVAL = 4096;      // Records between progress updates and cancellation checks
+    const size_t READ_BUFFER_SIZE = 64 * 1024;  // Per merge input; 64 inputs take 4 MB
+
+    struct SortRecord
+    {
+        long long day;          // Sort key; undated records sort last
+        uint32_t source;        // Index of the source file, for stable order and duplicate detection
+        uint64_t hash;          // SessionHashIndex content hash
+        std::string line;       // The record as a CSV row
+    };
+
+    struct MergeInput
+    {
+        std::string path;
+        bool csv;               // A sorted CSV source; otherwise a run file
+        uint32_t source;        // CSV sources only; run records carry their own
+    };
+
+    long long sortDay(const std::string& date)
+    {
+        return GamblingSession::isValidDate(date) ? GamblingSession::dateToDayNumber(date)
+                                                  : std::numeric_limits<long long>::max();
+    }
+
+    SortRecord makeRecord(const GamblingSession& session, uint32_t source)
+    {
+        return SortRecord{sortDay(session.getDate()), source, SessionHashIndex::hashSession(session), session.toCSV()};
+    }
+
+    SortRecord makeRecord(const TicketBatch& batch, uint32_t source)
+    {
+        return SortRecord{sortDay(batch.getDate()), source, SessionHashIndex::hashBatch(batch), batch.toCSV()};
+    }
+
+    bool earlierDay(const SortRecord& a, const SortRecord& b)
+    {
+        return a.day < b.day;
+    }
+
+    uint64_t fileSize(const std::string& path)
+    {
+        std::error_code error;
+        uintmax_t size = std::filesystem::file_size(path, error);
+        return error ? 0 : static_cast<uint64_t>(size);
+    }
+
+    // Run files, removed when the sort finishes, fails or is cancelled
+    class RunFiles
+    {
+    public:
+        explicit RunFiles(const std::string& prefix) : prefix(prefix), nextId(0) {}
+
+        ~RunFiles()
+        {
+            for (const auto& path : paths)
+            {
+                std::remove(path.c_str());
+            }
+        }
+
+        std::string create()
+        {
+            paths.push_back(prefix + ".run" + std::to_string(nextId++) + ".tmp");
+            return paths.back();
+        }
+
+        void release(const std::string& path)
+        {
+            std::remove(path.c_str());
+            paths.erase(std::remove(paths.begin(), paths.end(), path), paths.end());
+        }
+
+    private:
+        std::string prefix;
+        size_t nextId;
+        std::vector<std::string> paths;
+    };
+
+    // Run file lines are day, source and hash, tab-separated, then the CSV row
+    void writeRunRecord(std::ostream& out, const SortRecord& record)
+    {
+        out << record.day << '\t' << record.source << '\t' << record.hash << '\t' << record.line << '\n';
+    }
+
+    void checkWritten(std::ofstream& file, const std::string& path)
+    {
+        file.close();
+        if (!file)
+        {
+            throw std::runtime_error("Could not write " + path);
+        }
+    }
+
+    // Reads records in order from a run file or from a CSV source already in date order
+    class RecordReader
+    {
+    public:
+        RecordReader(const MergeInput& input, const SessionFileReader::WarningCallback& onWarning)
+            : input(input), onWarning(onWarning), buffer(READ_BUFFER_SIZE),
+              lastDay(std::numeric_limits<long long>::min()), lineNumber(0)
+        {
+            file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            file.open(input.path, std::ios::in | std::ios::binary);
+            if (!file.is_open())
+            {
+                throw std::runtime_error("Could not load from file " + input.path);
+            }
+            if (input.csv)
+            {
+                std::getline(file, line);   // Header
+                lineNumber++;
+            }
+        }
+
+        bool next(SortRecord& record)
+        {
+            while (std::getline(file, line))
+            {
+                lineNumber++;
+                if (input.csv ? parseCSV(record) : parseRun(record))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        uint64_t position()
+        {
+            std::streamoff offset = file.tellg();
+            return offset < 0 ? fileSize(input.path) : static_cast<uint64_t>(offset);
+        }
+
+    private:
+        MergeInput input;
+        const SessionFileReader::WarningCallback& onWarning;
+        std::vector<char> buffer;
+        std::ifstream file;
+        std::string line;
+        long long lastDay;
+        size_t lineNumber;
+
+        // Run files are only written by this sorter, so a line that isn't three
+        // tab-terminated numbers and a row means the file was damaged
+        bool parseRun(SortRecord& record)
+        {
+            const char* text = line.c_str();
+            char* end;
+            record.day = std::strtoll(text, &end, 10);
+            const char* field = expectTab(text, end);
+            record.source = static_cast<uint32_t>(std::strtoul(field, &end, 10));
+            field = expectTab(field, end);
+            record.hash = std::strtoull(field, &end, 10);
+            field = expectTab(field, end);
+            record.line.assign(line, static_cast<size_t>(field - text), std::string::npos);
+            return true;
+        }
+
+        // The start of the next field, after a number that ran from start to end
+        const char* expectTab(const char* start, const char* end) const
+        {
+            if (end == start || *end != '\t')
+            {
+                throw std::runtime_error("Sort run file " + input.path + " is corrupt (line " +
+                                         std::to_string(lineNumber) + ")");
+            }
+            return end + 1;
+        }
+
+        bool parseCSV(SortRecord& record)
+        {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) return false;
+
+            try
+            {
+                if (TicketBatch::isBatchCSV(line))
+                {
+                    record = makeRecord(TicketBatch::fromCSV(line), input.source);
+                }
+                else
+                {
+                    record = makeRecord(GamblingSession::fromCSV(line), input.source);
+                }
+            }
+            catch (const std::exception&)
+            {
+                onWarning("Warning: Skipped invalid line: " + line);
+                return false;
+            }
+
+            if (record.day < lastDay)
+            {
+                throw std::runtime_error(input.path + " is not in date order (line " + std::to_string(lineNumber) +
+                                         "); sort it instead of merging it");
+            }
+            lastDay = record.day;
+            return true;
+        }
+    };
+
+    // Writes the merged records to the output CSV, dropping duplicates if asked.
+    // Records arrive grouped by day and, within a day, by source.
+    class OutputWriter
+    {
+    public:
+        OutputWriter(std::ostream& out, bool removeDuplicates, SortStats& stats)
+            : out(out), removeDuplicates(removeDuplicates), stats(stats),
+              day(std::numeric_limits<long long>::min()), source(0)
+        {
+            out << SessionFileReader::CSV_HEADER << "\n";
+        }
+
+        void write(const SortRecord& record)
+        {
+            if (removeDuplicates && !admit(record))
+            {
+                stats.duplicates++;
+                return;
+            }
+            out << record.line << '\n';
+            stats.written++;
+        }
+
+    private:
+        std::ostream& out;
+        bool removeDuplicates;
+        SortStats& stats;
+        long long day;
+        uint32_t source;
+        std::unordered_map<uint64_t, uint32_t> kept;    // Copies written for this day
+        std::unordered_map<uint64_t, uint32_t> seen;    // Copies this source has supplied for this day
+
+        // A source contributes copies beyond those earlier sources supplied.
+        // The hash covers the date, so only one day's hashes are ever held.
+        bool admit(const SortRecord& record)
+        {
+            if (record.day != day)
+            {
+                day = record.day;
+                kept.clear();
+                seen.clear();
+                source = record.source;
+            }
+            else if (record.source != source)
+            {
+                seen.clear();
+                source = record.source;
+            }
+
+            uint32_t copies = ++seen[record.hash];
+            uint32_t& written = kept[record.hash];
+            if (copies <= written)
+            {
+                return false;
+            }
+            written = copies;
+            return true;
+        }
+    };
+
+    // k-way merge in (day, source) order; ties go to the earlier input, which
+    // keeps each source's records in file order across its runs
+    void mergeInputs(const std::vector<MergeInput>& inputs, const std::function<void(const SortRecord&)>& sink,
+                     const SessionFileReader::WarningCallback& onWarning, TaskProgress& progress,
+                     const std::function<void(uint64_t)>& onBytesRead)
+    {
+        TRACE_SCOPE("SessionSorter::merge");
+        struct Head
+        {
+            long long day;
+            uint32_t source;
+            size_t input;
+
+            bool operator>(const Head& other) const
+            {
+                if (day != other.day) return day > other.day;
+                if (source != other.source) return source > other.source;
+                return input > other.input;
+            }
+        };
+
+        std::vector<std::unique_ptr<RecordReader>> readers;
+        std::vector<SortRecord> current(inputs.size());
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            readers.emplace_back(new RecordReader(inputs[i], onWarning));
+            if (readers[i]->next(current[i]))
+            {
+                heap.push(Head{current[i].day, current[i].source, i});
+            }
+        }
+
+        size_t merged = 0;
+        while (!heap.empty())
+        {
+            size_t input = heap.top().input;
+            heap.pop();
+            sink(current[input]);
+
+            if (++merged % PROGRESS_INTERVAL == 0)
+            {
+                progress.checkCancelled();
+                if (onBytesRead)
+                {
+                    uint64_t bytes = 0;
+                    for (const auto& reader : readers) bytes += reader->position();
+                    onBytesRead(bytes);
+                }
+            }
+            if (readers[input]->next(current[input]))
+            {
+                heap.push(Head{current[input].day, current[input].source, input});
+            }
+        }
+    }
+
+    // Merges the inputs into the output, in passes of at most maxFanIn files.
+    // Progress runs from progressBase to the task's total over the final pass.
+    void mergeAll(std::vector<MergeInput> inputs, OutputWriter& writer, RunFiles& runs, const SortOptions& options,
+                  TaskProgress& progress, uint64_t progressBase, const SessionFileReader::WarningCallback& onWarning,
+                  SortStats& stats)
+    {
+        size_t fanIn = std::max<size_t>(2, options.maxFanIn);
+        while (inputs.size() > fanIn)
+        {
+            std::vector<MergeInput> next;
+            for (size_t first = 0; first < inputs.size(); first += fanIn)
+            {
+                size_t last = std::min(inputs.size(), first + fanIn);
+                if (last - first == 1)
+                {
+                    next.push_back(inputs[first]);
+                    continue;
+                }
+
+                std::vector<MergeInput> group(inputs.begin() + first, inputs.begin() + last);
+                std::string path = runs.create();
+                {
+                    std::ofstream file(path, std::ios::out | std::ios::binary);
+                    mergeInputs(group, [&file](const SortRecord& record) { writeRunRecord(file, record); },
+                                onWarning, progress, std::function<void(uint64_t)>());
+                    checkWritten(file, path);
+                }
+                for (const auto& input : group)
+                {
+                    if (!input.csv) runs.release(input.path);
+                }
+                next.push_back(MergeInput{path, false, 0});
+            }
+            inputs.swap(next);
+            stats.mergePasses++;
+        }
+
+        uint64_t inputBytes = 0;
+        for (const auto& input : inputs) inputBytes += fileSize(input.path);
+        uint64_t span = progress.getTotal() > progressBase ? progress.getTotal() - progressBase : 0;
+        mergeInputs(inputs, [&writer](const SortRecord& record) { writer.write(record); }, onWarning, progress,
+            [&](uint64_t bytesRead)
+            {
+                if (inputBytes > 0) progress.setDone(progressBase + span * std::min(bytesRead, inputBytes) / inputBytes);
+            });
+        stats.mergePasses++;
+    }
+
+    // Writes to output.tmp and renames it over output once complete
+    void writeOutput(const std::string& output, const std::function<void(std::ostream&)>& write)
+    {
+        std::string tempName = output + ".tmp";
+        try
+        {
+            std::ofstream file(tempName, std::ios::out | std::ios::binary);
+            if (!file.is_open())
+            {
+                throw std::runtime_error("Could not save to file " + output);
+            }
+            write(file);
+            checkWritten(file, output);
+            if (std::rename(tempName.c_str(), output.c_str()) != 0)
+            {
+                throw std::runtime_error("Could not save to file " + output);
+            }
+        }
+        catch (...)
+        {
+            std::remove(tempName.c_str());
+            throw;
+        }
+    }
+}
+
+SortStats SessionSorter::sortFiles(const std::vector<std::string>& sources, const std::string& output,
+                                   const SortOptions& options, TaskProgress& progress,
+                                   const SessionFileReader::WarningCallback& onWarning)
+{
+    TRACE_SCOPE("SessionSorter::sortFiles");
+    MEMORY_SCOPE(MemoryTag::IMPORT_BUFFERS);
+    SortStats stats;
+    RunFiles runs(output);
+    std::vector<MergeInput> runInputs;
+    std::vector<SortRecord> buffer;
+    size_t bufferBytes = 0;
+
+    // Reading the sources is the first half of the progress, merging the second
+    uint64_t sourceBytes = 0;
+    for (const auto& source : sources) sourceBytes += fileSize(source);
+    progress.setTotal(2 * sourceBytes);
+
+    auto spill = [&]()
+    {
+        TRACE_SCOPE("SessionSorter::spill");
+        std::stable_sort(buffer.begin(), buffer.end(), earlierDay);
+        std::string path = runs.create();
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        for (const auto& record : buffer)
+        {
+            writeRunRecord(file, record);
+        }
+        checkWritten(file, path);
+        runInputs.push_back(MergeInput{path, false, 0});
+        buffer.clear();
+        bufferBytes = 0;
+        stats.runs++;
+    };
+
+    uint64_t bytesBefore = 0;
+    for (uint32_t source = 0; source < sources.size(); source++)
+    {
+        TaskProgress fileProgress;
+        auto add = [&](SortRecord&& record)
+        {
+            bufferBytes += sizeof(SortRecord) + record.line.capacity();
+            buffer.push_back(std::move(record));
+            if (++stats.records % PROGRESS_INTERVAL == 0)
+            {
+                progress.checkCancelled();
+                progress.setDone(bytesBefore + fileProgress.getDone());
+            }
+            if (bufferBytes >= options.memoryBudget)
+            {
+                spill();
+            }
+        };
+
+        // A source that doesn't read cleanly fails the sort before the output is touched
+        try
+        {
+            SessionFileReader::read(sources[source],
+                [&](GamblingSession& session) { add(makeRecord(session, source)); },
+                [&](TicketBatch& batch) { add(makeRecord(batch, source)); },
+                onWarning, fileProgress);
+        }
+        catch (const TaskCancelled&)
+        {
+            throw;
+        }
+        catch (const std::runtime_error& e)
+        {
+            throw std::runtime_error(sources[source] + ": " + e.what());
+        }
+        bytesBefore += fileProgress.getTotal();
+        progress.setDone(bytesBefore);
+    }
+
+    writeOutput(output, [&](std::ostream& out)
+    {
+        OutputWriter writer(out, options.removeDuplicates, stats);
+        if (runInputs.empty())
+        {
+            // Everything fit in memory
+            std::stable_sort(buffer.begin(), buffer.end(), earlierDay);
+            for (const auto& record : buffer)
+            {
+                writer.write(record);
+            }
+            return;
+        }
+
+        if (!buffer.empty()) spill();
+        std::vector<SortRecord>().swap(buffer);
+        mergeAll(runInputs, writer, runs, options, progress, bytesBefore, onWarning, stats);
+    });
+    progress.setDone(progress.getTotal());
+    return stats;
+}
+
+SortStats SessionSorter::mergeSortedFiles(const std::vector<std::string>& sources, const std::string& output,
+                                          const SortOptions& options, TaskProgress& progress,
+                                          const SessionFileReader::WarningCallback& onWarning)
+{
+    TRACE_SCOPE("SessionSorter::mergeSortedFiles");
+    MEMORY_SCOPE(MemoryTag::IMPORT_BUFFERS);
+    SortStats stats;
+    RunFiles runs(output);
+    std::vector<MergeInput> inputs;
+    uint64_t sourceBytes = 0;
+    for (uint32_t source = 0; source < sources.size(); source++)
+    {
+        inputs.push_back(MergeInput{sources[source], true, source});
+        sourceBytes += fileSize(sources[source]);
+    }
+    progress.setTotal(sourceBytes);
+
+    writeOutput(output, [&](std::ostream& out)
+    {
+        OutputWriter writer(out, options.removeDuplicates, stats);
+        mergeAll(inputs, writer, runs, options, progress, 0, onWarning, stats);
+    });
+    stats.records = stats.written + stats.duplicates;
+    progress.setDone(progress.getTotal());
+    return stats;
+}
+
+std::vector<std::string> SessionSorter::listSessionFiles(const std::string& directory)
+{
+    std::vector<std::string> files;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+    {
+        std::string path = it->path().string();
+        if (it->is_regular_file(error) &&
+            (SessionFileReader::hasExtension(path, ".csv") || SessionFileReader::hasExtension(path, ".json") ||
+             SessionFileReader::hasExtension(path, ".gsa")))
+        {
+            files.push_back(path);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
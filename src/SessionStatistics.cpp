@@ -0,0 +1,354 @@
+#include "../include/SessionStatistics.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+    const size_t MIN_SESSIONS_PER_THREAD = 16384;
+
+    bool smallerAmount(const RankedSession& a, const RankedSession& b)
+    {
+        // Min-heap order: the smallest kept amount sits at the front
+        return a.amount > b.amount;
+    }
+
+    std::string money(double amount)
+    {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << amount;
+        return oss.str();
+    }
+}
+
+TDigest::TDigest(double compression)
+    : compression(compression), totalWeight(0.0), bufferedWeight(0.0),
+      minValue(std::numeric_limits<double>::infinity()), maxValue(-std::numeric_limits<double>::infinity())
+{
+}
+
+void TDigest::add(double value)
+{
+    if (std::isnan(value)) return;
+    buffer.push_back(Centroid{value, 1.0});
+    bufferedWeight += 1.0;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+    if (buffer.size() >= static_cast<size_t>(compression * 5))
+    {
+        flush();
+    }
+}
+
+void TDigest::merge(const TDigest& other)
+{
+    other.flush();
+    buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+    bufferedWeight += other.totalWeight;
+    minValue = std::min(minValue, other.minValue);
+    maxValue = std::max(maxValue, other.maxValue);
+    flush();
+}
+
+size_t TDigest::getCentroidCount() const
+{
+    flush();
+    return centroids.size();
+}
+
+void TDigest::flush() const
+{
+    if (buffer.empty())
+    {
+        return;
+    }
+
+    buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+    std::sort(buffer.begin(), buffer.end(), [](const Centroid& a, const Centroid& b)
+    {
+        return a.mean < b.mean;
+    });
+
+    double total = totalWeight + bufferedWeight;
+    auto scale = [this](double q) { return compression / (2.0 * PI) * std::asin(2.0 * q - 1.0); };
+    auto inverse = [this](double k) { return (std::sin(k * 2.0 * PI / compression) + 1.0) / 2.0; };
+
+    // Adjacent centroids merge while the result stays within one unit of the
+    // scale function, which keeps centroids small near the tails
+    std::vector<Centroid> merged;
+    Centroid current = buffer[0];
+    double weightSoFar = 0.0;
+    double limit = total * inverse(scale(0.0) + 1.0);
+    for (size_t i = 1; i < buffer.size(); i++)
+    {
+        const Centroid& next = buffer[i];
+        if (weightSoFar + current.weight + next.weight <= limit)
+        {
+            current.mean += (next.mean - current.mean) * next.weight / (current.weight + next.weight);
+            current.weight += next.weight;
+        }
+        else
+        {
+            weightSoFar += current.weight;
+            merged.push_back(current);
+            limit = total * inverse(scale(weightSoFar / total) + 1.0);
+            current = next;
+        }
+    }
+    merged.push_back(current);
+
+    centroids.swap(merged);
+    buffer.clear();
+    totalWeight = total;
+    bufferedWeight = 0.0;
+}
+
+double TDigest::quantile(double q) const
+{
+    flush();
+    if (centroids.empty())
+    {
+        return 0.0;
+    }
+    if (centroids.size() == 1)
+    {
+        return centroids[0].mean;
+    }
+
+    q = std::min(std::max(q, 0.0), 1.0);
+    double index = q * totalWeight;
+
+    // Each centroid's mass is centred on its mean; interpolate between centres,
+    // and between the extreme centres and the observed min/max
+    double left = centroids[0].weight / 2.0;
+    if (index < left)
+    {
+        return minValue + (centroids[0].mean - minValue) * index / left;
+    }
+
+    double cumulative = 0.0;
+    for (size_t i = 0; i + 1 < centroids.size(); i++)
+    {
+        double centre = cumulative + centroids[i].weight / 2.0;
+        double nextCentre = cumulative + centroids[i].weight + centroids[i + 1].weight / 2.0;
+        if (index < nextCentre)
+        {
+            double fraction = (index - centre) / (nextCentre - centre);
+            return centroids[i].mean + (centroids[i + 1].mean - centroids[i].mean) * fraction;
+        }
+        cumulative += centroids[i].weight;
+    }
+
+    const Centroid& last = centroids.back();
+    double lastCentre = totalWeight - last.weight / 2.0;
+    double tail = totalWeight - lastCentre;
+    return last.mean + (maxValue - last.mean) * std::min(1.0, (index - lastCentre) / tail);
+}
+
+TopN::TopN(size_t limit)
+    : limit(limit)
+{
+}
+
+void TopN::push(const RankedSession& entry)
+{
+    if (heap.size() < limit)
+    {
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end(), smallerAmount);
+    }
+    else if (limit > 0 && entry.amount > heap.front().amount)
+    {
+        std::pop_heap(heap.begin(), heap.end(), smallerAmount);
+        heap.back() = entry;
+        std::push_heap(heap.begin(), heap.end(), smallerAmount);
+    }
+}
+
+void TopN::offer(double amount, const GamblingSession& session)
+{
+    // Cheap rejection first; most sessions never make the list
+    if (heap.size() >= limit && (limit == 0 || amount <= heap.front().amount))
+    {
+        return;
+    }
+    push(RankedSession{amount, session.getDate(), session.getLocation(), session.getState(), session.getGameType()});
+}
+
+void TopN::merge(const TopN& other)
+{
+    for (const auto& entry : other.heap)
+    {
+        push(entry);
+    }
+}
+
+std::vector<RankedSession> TopN::sorted() const
+{
+    std::vector<RankedSession> result = heap;
+    std::sort(result.begin(), result.end(), [](const RankedSession& a, const RankedSession& b)
+    {
+        return a.amount > b.amount;
+    });
+    return result;
+}
+
+void StatisticsGroup::add(const GamblingSession& session)
+{
+    double netResult = session.getNetResult();
+    sessions++;
+    results.add(netResult);
+    if (netResult > 0)
+    {
+        largestWins.offer(netResult, session);
+    }
+    else if (netResult < 0)
+    {
+        largestLosses.offer(-netResult, session);
+    }
+}
+
+void StatisticsGroup::merge(const StatisticsGroup& other)
+{
+    sessions += other.sessions;
+    largestWins.merge(other.largestWins);
+    largestLosses.merge(other.largestLosses);
+    results.merge(other.results);
+}
+
+SessionStatistics::SessionStatistics()
+{
+    overall.largestWins = TopN(10);
+    overall.largestLosses = TopN(10);
+}
+
+void SessionStatistics::add(const GamblingSession& session)
+{
+    overall.add(session);
+    byState[session.getState()].add(session);
+    byGameType[session.getGameType()].add(session);
+}
+
+void SessionStatistics::merge(const SessionStatistics& other)
+{
+    overall.merge(other.overall);
+    for (const auto& entry : other.byState)
+    {
+        byState[entry.first].merge(entry.second);
+    }
+    for (const auto& entry : other.byGameType)
+    {
+        byGameType[entry.first].merge(entry.second);
+    }
+}
+
+namespace
+{
+    // Sessions is anything with size() and operator[]
+    template <class Sessions>
+    SessionStatistics computeStatistics(const Sessions& sessions, unsigned threads)
+    {
+        TRACE_SCOPE("SessionStatistics::compute");
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        size_t workerCount = std::max<size_t>(1, std::min<size_t>(threads, sessions.size() / MIN_SESSIONS_PER_THREAD));
+
+        std::vector<SessionStatistics> partial(workerCount);
+        auto scan = [&](size_t worker)
+        {
+            size_t begin = sessions.size() * worker / workerCount;
+            size_t end = sessions.size() * (worker + 1) / workerCount;
+            for (size_t i = begin; i < end; i++)
+            {
+                partial[worker].add(sessions[i]);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t worker = 1; worker < workerCount; worker++)
+        {
+            pool.emplace_back(scan, worker);
+        }
+        scan(0);
+        for (auto& thread : pool)
+        {
+            thread.join();
+        }
+
+        for (size_t worker = 1; worker < workerCount; worker++)
+        {
+            partial[0].merge(partial[worker]);
+        }
+        return partial[0];
+    }
+}
+
+SessionStatistics SessionStatistics::compute(const std::vector<GamblingSession>& sessions, unsigned threads)
+{
+    return computeStatistics(sessions, threads);
+}
+
+SessionStatistics SessionStatistics::compute(const SessionChunks& sessions, unsigned threads)
+{
+    return computeStatistics(sessions, threads);
+}
+
+std::string SessionStatistics::generateReport() const
+{
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2);
+
+    report << "=== SESSION STATISTICS ===\n";
+    report << "Sessions: " << overall.sessions << "\n";
+    if (overall.sessions == 0)
+    {
+        return report.str();
+    }
+    report << "Median session result: $" << overall.results.quantile(0.5) << "\n";
+    report << "90th percentile result: $" << overall.results.quantile(0.9) << "\n";
+    report << "99th percentile loss: $" << std::max(0.0, -overall.results.quantile(0.01)) << "\n";
+
+    auto printRanked = [&](const char* title, const TopN& ranked)
+    {
+        report << "\n" << title << ":\n";
+        for (const auto& entry : ranked.sorted())
+        {
+            report << "  " << std::left << std::setw(12) << entry.date << std::setw(4) << entry.state
+                   << std::setw(16) << entry.gameType.substr(0, 15)
+                   << std::setw(26) << entry.location.substr(0, 25)
+                   << std::right << std::setw(14) << money(entry.amount) << "\n";
+        }
+    };
+    printRanked("LARGEST WINS", overall.largestWins);
+    printRanked("LARGEST LOSSES", overall.largestLosses);
+
+    auto printGroups = [&](const char* title, const std::map<std::string, StatisticsGroup>& groups)
+    {
+        report << "\n" << title << ":\n";
+        report << "  " << std::left << std::setw(18) << "" << std::right << std::setw(9) << "Sessions"
+               << std::setw(12) << "Median" << std::setw(14) << "P99 Loss" << std::setw(14) << "Max Win"
+               << std::setw(14) << "Max Loss" << "\n";
+        for (const auto& entry : groups)
+        {
+            const StatisticsGroup& group = entry.second;
+            report << "  " << std::left << std::setw(18) << entry.first.substr(0, 17) << std::right
+                   << std::setw(9) << group.sessions
+                   << std::setw(12) << money(group.results.quantile(0.5))
+                   << std::setw(14) << money(std::max(0.0, -group.results.quantile(0.01)))
+                   << std::setw(14) << money(std::max(0.0, group.results.getMax()))
+                   << std::setw(14) << money(std::max(0.0, -group.results.getMin())) << "\n";
+        }
+    };
+    printGroups("BY STATE", byState);
+    printGroups("BY GAME TYPE", byGameType);
+
+    return report.str();
+}
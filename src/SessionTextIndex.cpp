@@ -0,0 +1,375 @@
+#include "../include/SessionTextIndex.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <sstream>
+
+namespace
+{
+    const uint32_t SKIP_INTERVAL = 64;          // Postings between skip entries
+    const uint32_t NO_DOCUMENT = 0xFFFFFFFFu;
+    const size_t MIN_COMPACTION = 1024;         // Dead documents tolerated regardless of ratio
+}
+
+void SessionTextIndex::PostingList::append(uint32_t doc)
+{
+    // Documents arrive in increasing order, so each gap is positive
+    uint32_t gap = doc - lastDoc;
+    while (gap >= 0x80)
+    {
+        bytes.push_back(static_cast<uint8_t>(gap | 0x80));
+        gap >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(gap));
+    lastDoc = doc;
+    count++;
+
+    if (count % SKIP_INTERVAL == 0)
+    {
+        skips.push_back(Skip{doc, count, static_cast<uint32_t>(bytes.size())});
+    }
+}
+
+SessionTextIndex::Cursor::Cursor(const PostingList& list)
+    : list(list), index(0), offset(0), current(0), skip(0)
+{
+}
+
+bool SessionTextIndex::Cursor::next()
+{
+    if (index == list.count)
+    {
+        return false;
+    }
+
+    uint32_t gap = 0;
+    int shift = 0;
+    uint8_t byte = 0;
+    do
+    {
+        byte = list.bytes[offset++];
+        gap |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    current += gap;
+    index++;
+    return true;
+}
+
+bool SessionTextIndex::Cursor::seek(uint32_t target)
+{
+    if (index > 0 && current >= target)
+    {
+        return true;
+    }
+
+    // Jump over whole blocks that end before the target
+    while (skip < list.skips.size() && list.skips[skip].doc < target)
+    {
+        const Skip& entry = list.skips[skip++];
+        if (entry.index > index)
+        {
+            index = entry.index;
+            offset = entry.offset;
+            current = entry.doc;
+        }
+    }
+
+    while (next())
+    {
+        if (current >= target) return true;
+    }
+    return false;
+}
+
+SessionTextIndex::SessionTextIndex()
+    : deadCount(0)
+{
+}
+
+void SessionTextIndex::tokenize(const std::string& text, std::vector<std::string>& words)
+{
+    // "W-2G filed, Mohegan Sun" -> w, 2g, w2g, filed, mohegan, sun. Hyphenated
+    // words are also kept joined so "w2g" finds "W-2G".
+    std::string word;
+    std::string joined;
+    bool hyphenated = false;
+    for (size_t i = 0; i <= text.size(); i++)
+    {
+        unsigned char byte = i < text.size() ? static_cast<unsigned char>(text[i]) : 0;
+        if (std::isalnum(byte))
+        {
+            char folded = static_cast<char>(std::tolower(byte));
+            word += folded;
+            joined += folded;
+            continue;
+        }
+        if (word.empty())
+        {
+            continue;
+        }
+
+        words.push_back(word);
+        word.clear();
+        if (byte == '-' && i + 1 < text.size() && std::isalnum(static_cast<unsigned char>(text[i + 1])))
+        {
+            hyphenated = true;
+            continue;
+        }
+        if (hyphenated)
+        {
+            words.push_back(joined);
+        }
+        joined.clear();
+        hyphenated = false;
+    }
+}
+
+void SessionTextIndex::add(SessionId id, const GamblingSession& session)
+{
+    wordScratch.clear();
+    tokenize(session.getLocation(), wordScratch);
+    tokenize(session.getNotes(), wordScratch);
+    tokenize(session.getDocumentationNote(), wordScratch);
+    std::sort(wordScratch.begin(), wordScratch.end());
+    wordScratch.erase(std::unique(wordScratch.begin(), wordScratch.end()), wordScratch.end());
+
+    uint32_t doc = static_cast<uint32_t>(documents.size());
+    documents.push_back(id);
+    live.push_back(1);
+    if (id.slot >= slotDocument.size())
+    {
+        slotDocument.resize(id.slot + 1, NO_DOCUMENT);
+    }
+    slotDocument[id.slot] = doc;
+
+    for (const auto& word : wordScratch)
+    {
+        auto it = terms.find(word);
+        if (it == terms.end())
+        {
+            it = terms.emplace(word, PostingList()).first;
+            newTerms.push_back(&*it);
+        }
+        it->second.append(doc);
+    }
+}
+
+void SessionTextIndex::remove(SessionId id)
+{
+    if (id.slot >= slotDocument.size())
+    {
+        return;
+    }
+    uint32_t doc = slotDocument[id.slot];
+    if (doc == NO_DOCUMENT || documents[doc] != id)
+    {
+        return;
+    }
+
+    // Postings stay until the next rebuild; search skips dead documents
+    live[doc] = 0;
+    slotDocument[id.slot] = NO_DOCUMENT;
+    deadCount++;
+}
+
+void SessionTextIndex::clear()
+{
+    terms.clear();
+    documents.clear();
+    live.clear();
+    slotDocument.clear();
+    sortedTerms.clear();
+    newTerms.clear();
+    deadCount = 0;
+}
+
+bool SessionTextIndex::needsCompaction() const
+{
+    return deadCount > MIN_COMPACTION && deadCount > documents.size() - deadCount;
+}
+
+void SessionTextIndex::rebuild(const SessionDatabase& sessions)
+{
+    TRACE_SCOPE("SessionTextIndex::rebuild");
+    clear();
+    documents.reserve(sessions.size());
+    live.reserve(sessions.size());
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        add(sessions.idAt(i), sessions[i]);
+    }
+}
+
+void SessionTextIndex::decode(const PostingList& list, std::vector<uint32_t>& docs)
+{
+    Cursor cursor(list);
+    while (cursor.next())
+    {
+        docs.push_back(cursor.doc());
+    }
+}
+
+bool SessionTextIndex::resolve(const std::string& word, bool prefix, Term& term)
+{
+    term.list = nullptr;
+    term.docs.clear();
+    term.estimate = 0;
+
+    if (!prefix)
+    {
+        auto it = terms.find(word);
+        if (it == terms.end()) return false;
+        term.list = &it->second;
+        term.estimate = it->second.count;
+        return true;
+    }
+
+    if (!newTerms.empty())
+    {
+        // Words added since the last prefix query are sorted and merged in
+        auto byWord = [](const TermMap::value_type* a, const TermMap::value_type* b) { return a->first < b->first; };
+        std::sort(newTerms.begin(), newTerms.end(), byWord);
+        size_t middle = sortedTerms.size();
+        sortedTerms.insert(sortedTerms.end(), newTerms.begin(), newTerms.end());
+        std::inplace_merge(sortedTerms.begin(), sortedTerms.begin() + middle, sortedTerms.end(), byWord);
+        newTerms.clear();
+    }
+
+    auto first = std::lower_bound(sortedTerms.begin(), sortedTerms.end(), word,
+                                  [](const TermMap::value_type* entry, const std::string& key) { return entry->first < key; });
+    auto last = first;
+    while (last != sortedTerms.end() && (*last)->first.compare(0, word.size(), word) == 0)
+    {
+        last++;
+    }
+    if (first == last) return false;
+    if (last - first == 1)
+    {
+        term.list = &(*first)->second;
+        term.estimate = term.list->count;
+        return true;
+    }
+
+    // Several words share the prefix; merge their documents once
+    for (auto it = first; it != last; ++it)
+    {
+        decode((*it)->second, term.docs);
+    }
+    std::sort(term.docs.begin(), term.docs.end());
+    term.docs.erase(std::unique(term.docs.begin(), term.docs.end()), term.docs.end());
+    term.estimate = term.docs.size();
+    return true;
+}
+
+std::vector<uint32_t> SessionTextIndex::matchAll(std::vector<Term>& group)
+{
+    // Start from the rarest word and only probe the others for its documents
+    std::sort(group.begin(), group.end(), [](const Term& a, const Term& b) { return a.estimate < b.estimate; });
+
+    std::vector<uint32_t> matches;
+    if (group[0].list)
+    {
+        matches.reserve(group[0].estimate);
+        decode(*group[0].list, matches);
+    }
+    else
+    {
+        matches.swap(group[0].docs);
+    }
+
+    for (size_t t = 1; t < group.size() && !matches.empty(); t++)
+    {
+        size_t kept = 0;
+        if (group[t].list)
+        {
+            Cursor cursor(*group[t].list);
+            for (uint32_t doc : matches)
+            {
+                if (!cursor.seek(doc)) break;
+                if (cursor.doc() == doc) matches[kept++] = doc;
+            }
+        }
+        else
+        {
+            const std::vector<uint32_t>& docs = group[t].docs;
+            auto position = docs.begin();
+            for (uint32_t doc : matches)
+            {
+                position = std::lower_bound(position, docs.end(), doc);
+                if (position == docs.end()) break;
+                if (*position == doc) matches[kept++] = doc;
+            }
+        }
+        matches.resize(kept);
+    }
+    return matches;
+}
+
+std::vector<SessionId> SessionTextIndex::search(const std::string& query)
+{
+    TRACE_SCOPE("SessionTextIndex::search");
+
+    // Split into OR-separated groups of ANDed words
+    std::vector<std::vector<std::pair<std::string, bool>>> groups(1);
+    std::istringstream input(query);
+    std::string token;
+    while (input >> token)
+    {
+        if (token == "OR")
+        {
+            if (!groups.back().empty()) groups.emplace_back();
+            continue;
+        }
+        bool prefix = token.size() > 1 && token.back() == '*';
+        if (prefix)
+        {
+            // "w-2*" is matched against joined words ("w2g")
+            token.pop_back();
+            token.erase(std::remove(token.begin(), token.end(), '-'), token.end());
+        }
+        std::vector<std::string> words;
+        tokenize(token, words);
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            groups.back().push_back(std::make_pair(words[i], prefix && i + 1 == words.size()));
+        }
+    }
+
+    std::vector<uint32_t> docs;
+    for (const auto& group : groups)
+    {
+        if (group.empty()) continue;
+
+        std::vector<Term> resolved(group.size());
+        bool possible = true;
+        for (size_t i = 0; i < group.size() && possible; i++)
+        {
+            possible = resolve(group[i].first, group[i].second, resolved[i]);
+        }
+        if (!possible) continue;
+
+        std::vector<uint32_t> matches = matchAll(resolved);
+        if (docs.empty())
+        {
+            docs.swap(matches);
+        }
+        else
+        {
+            std::vector<uint32_t> merged;
+            merged.reserve(docs.size() + matches.size());
+            std::set_union(docs.begin(), docs.end(), matches.begin(), matches.end(), std::back_inserter(merged));
+            docs.swap(merged);
+        }
+    }
+
+    std::vector<SessionId> results;
+    results.reserve(docs.size());
+    for (uint32_t doc : docs)
+    {
+        if (live[doc]) results.push_back(documents[doc]);
+    }
+    return results;
+}
@@ -0,0 +1,283 @@
+#include "../include/SessionTimeIndex.h"
+#include "../include/MemoryAccounting.h"
+#include "../include/TaxCalculator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const size_t MIN_CAPACITY = 1024;   // A little under three years of days
+
+    int64_t toCents(double amount)
+    {
+        return static_cast<int64_t>(std::llround(amount * 100.0));
+    }
+}
+
+DayTotals& DayTotals::operator+=(const DayTotals& other)
+{
+    winningsCents += other.winningsCents;
+    lossesCents += other.lossesCents;
+    withheldCents += other.withheldCents;
+    sessions += other.sessions;
+    tickets += other.tickets;
+    missedWithholding += other.missedWithholding;
+    return *this;
+}
+
+DayTotals& DayTotals::operator-=(const DayTotals& other)
+{
+    winningsCents -= other.winningsCents;
+    lossesCents -= other.lossesCents;
+    withheldCents -= other.withheldCents;
+    sessions -= other.sessions;
+    tickets -= other.tickets;
+    missedWithholding -= other.missedWithholding;
+    return *this;
+}
+
+void SessionTimeIndex::Series::update(size_t position, const DayTotals& delta, bool subtract)
+{
+    for (size_t i = position + 1; i < tree.size(); i += i & (~i + 1))
+    {
+        if (subtract)
+        {
+            tree[i] -= delta;
+        }
+        else
+        {
+            tree[i] += delta;
+        }
+    }
+}
+
+DayTotals SessionTimeIndex::Series::prefix(size_t count) const
+{
+    DayTotals sum;
+    if (tree.empty())
+    {
+        return sum;
+    }
+    for (size_t i = std::min(count, tree.size() - 1); i > 0; i -= i & (~i + 1))
+    {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+void SessionTimeIndex::Series::relocate(size_t offset, size_t newCapacity)
+{
+    // Recover single days, place them at their new positions, then build the
+    // new tree bottom-up in linear time
+    std::vector<DayTotals> rebuilt(newCapacity + 1);
+    size_t oldCapacity = tree.empty() ? 0 : tree.size() - 1;
+    DayTotals previous;
+    for (size_t position = 0; position < oldCapacity; position++)
+    {
+        DayTotals current = prefix(position + 1);
+        DayTotals day = current;
+        day -= previous;
+        rebuilt[position + offset + 1] = day;
+        previous = current;
+    }
+
+    for (size_t i = 1; i <= newCapacity; i++)
+    {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= newCapacity)
+        {
+            rebuilt[parent] += rebuilt[i];
+        }
+    }
+    tree.swap(rebuilt);
+}
+
+SessionTimeIndex::SessionTimeIndex(const TaxCalculator& calculator)
+    : calculator(calculator), baseDay(0), capacity(0),
+      firstDay(std::numeric_limits<long long>::max()), lastDay(std::numeric_limits<long long>::min()),
+      undated(0)
+{
+}
+
+void SessionTimeIndex::clear()
+{
+    global = Series();
+    states.clear();
+    baseDay = 0;
+    capacity = 0;
+    firstDay = std::numeric_limits<long long>::max();
+    lastDay = std::numeric_limits<long long>::min();
+    undated = 0;
+}
+
+DayTotals SessionTimeIndex::sessionTotals(const GamblingSession& session) const
+{
+    DayTotals totals;
+    double netResult = session.getNetResult();
+    totals.sessions = 1;
+    totals.withheldCents = toCents(session.getWithheldAmount());
+    if (netResult > 0)
+    {
+        totals.winningsCents = toCents(netResult);
+        totals.missedWithholding = calculator.triggersWithholding(session) &&
+                                   !session.getTaxWithheld();
+    }
+    else if (netResult < 0)
+    {
+        totals.lossesCents = toCents(-netResult);
+    }
+    return totals;
+}
+
+DayTotals SessionTimeIndex::batchTotals(const TicketBatch& batch)
+{
+    DayTotals totals;
+    totals.lossesCents = toCents(batch.getTotalLosses());
+    totals.tickets = static_cast<int64_t>(batch.getTicketCount());
+    return totals;
+}
+
+void SessionTimeIndex::add(const GamblingSession& session)
+{
+    apply(session.getDate(), session.getState(), sessionTotals(session), false);
+}
+
+void SessionTimeIndex::remove(const GamblingSession& session)
+{
+    apply(session.getDate(), session.getState(), sessionTotals(session), true);
+}
+
+void SessionTimeIndex::add(const TicketBatch& batch)
+{
+    apply(batch.getDate(), batch.getState(), batchTotals(batch), false);
+}
+
+void SessionTimeIndex::remove(const TicketBatch& batch)
+{
+    apply(batch.getDate(), batch.getState(), batchTotals(batch), true);
+}
+
+bool SessionTimeIndex::locate(const std::string& date, size_t& position)
+{
+    if (!GamblingSession::isValidDate(date))
+    {
+        return false;
+    }
+
+    long long day = GamblingSession::dateToDayNumber(date);
+    if (capacity == 0 || day < baseDay || day >= baseDay + static_cast<long long>(capacity))
+    {
+        grow(day);
+    }
+    firstDay = std::min(firstDay, day);
+    lastDay = std::max(lastDay, day);
+    position = static_cast<size_t>(day - baseDay);
+    return true;
+}
+
+void SessionTimeIndex::apply(const std::string& date, const std::string& state, const DayTotals& delta,
+                             bool subtract)
+{
+    MEMORY_SCOPE(MemoryTag::SUMMARY);
+    size_t position = 0;
+    if (!locate(date, position))
+    {
+        undated = subtract ? undated - std::min<size_t>(undated, 1) : undated + 1;
+        return;
+    }
+
+    global.update(position, delta, subtract);
+
+    Series& series = states[state];
+    if (series.tree.empty())
+    {
+        series.tree.resize(capacity + 1);
+    }
+    series.update(position, delta, subtract);
+}
+
+void SessionTimeIndex::grow(long long day)
+{
+    size_t newCapacity = std::max(capacity * 2, MIN_CAPACITY);
+    long long newBase = 0;
+    if (capacity == 0)
+    {
+        // Room on both sides of the first date
+        newBase = day - static_cast<long long>(newCapacity / 2);
+    }
+    else
+    {
+        long long low = std::min(baseDay, day);
+        long long high = std::max(baseDay + static_cast<long long>(capacity), day + 1);
+        while (static_cast<long long>(newCapacity) < high - low)
+        {
+            newCapacity *= 2;
+        }
+        // The slack goes on the side that needed to grow
+        newBase = day < baseDay ? high - static_cast<long long>(newCapacity) : low;
+    }
+
+    size_t offset = capacity == 0 ? 0 : static_cast<size_t>(baseDay - newBase);
+    global.relocate(offset, newCapacity);
+    for (auto& entry : states)
+    {
+        entry.second.relocate(offset, newCapacity);
+    }
+    baseDay = newBase;
+    capacity = newCapacity;
+}
+
+DayTotals SessionTimeIndex::rangeOf(const Series& series, long long fromDay, long long toDay) const
+{
+    if (capacity == 0 || series.tree.empty())
+    {
+        return DayTotals();
+    }
+
+    long long lastPosition = static_cast<long long>(capacity) - 1;
+    long long from = std::max(fromDay - baseDay, 0LL);
+    long long to = std::min(toDay - baseDay, lastPosition);
+    if (from > to)
+    {
+        return DayTotals();
+    }
+
+    DayTotals result = series.prefix(static_cast<size_t>(to + 1));
+    result -= series.prefix(static_cast<size_t>(from));
+    return result;
+}
+
+DayTotals SessionTimeIndex::totals(long long fromDay, long long toDay) const
+{
+    return rangeOf(global, fromDay, toDay);
+}
+
+DayTotals SessionTimeIndex::totals(const std::string& state, long long fromDay, long long toDay) const
+{
+    auto it = states.find(state);
+    return it == states.end() ? DayTotals() : rangeOf(it->second, fromDay, toDay);
+}
+
+SessionAggregate SessionTimeIndex::aggregate(long long fromDay, long long toDay) const
+{
+    MEMORY_SCOPE(MemoryTag::SUMMARY);
+    SessionAggregate result;
+    DayTotals all = totals(fromDay, toDay);
+    result.totalWinnings = all.getWinnings();
+    result.totalLosses = all.getLosses();
+    result.totalWithheld = all.getWithheld();
+    result.sessionCount = static_cast<size_t>(all.sessions);
+    result.ticketCount = static_cast<size_t>(all.tickets);
+    result.missedWithholding = all.missedWithholding > 0;
+
+    for (const auto& entry : states)
+    {
+        DayTotals state = rangeOf(entry.second, fromDay, toDay);
+        if (state.winningsCents != 0 || state.lossesCents != 0)
+        {
+            result.addStateTotals(entry.first, state.getWinnings(), state.getLosses());
+        }
+    }
+    return result;
+}
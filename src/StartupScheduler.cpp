@@ -0,0 +1,177 @@
+#include "../include/StartupScheduler.h"
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    struct StepTiming
+    {
+        std::string step;
+        StartupProfile::Clock::time_point start;
+        StartupProfile::Clock::time_point end;
+        bool deferred;
+    };
+
+    std::mutex profileMutex;
+    std::vector<StepTiming> timings;
+    StartupProfile::Clock::time_point processStart = StartupProfile::Clock::now();
+    std::atomic<bool> profilingEnabled(false);
+    std::atomic<bool> reported(false);
+
+    // Set on a started step's thread for the step's duration
+    thread_local std::ostringstream* stepBuffer = nullptr;
+
+    double millisecondsBetween(StartupProfile::Clock::time_point from, StartupProfile::Clock::time_point to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+}
+
+void StartupProfile::markProcessStart()
+{
+    processStart = Clock::now();
+}
+
+void StartupProfile::enable()
+{
+    profilingEnabled = true;
+}
+
+bool StartupProfile::isEnabled()
+{
+    return profilingEnabled;
+}
+
+void StartupProfile::record(const std::string& step, Clock::time_point start, Clock::time_point end)
+{
+    std::lock_guard<std::mutex> lock(profileMutex);
+    timings.push_back(StepTiming{step, start, end, false});
+}
+
+void StartupProfile::noteDeferred(const std::string& step)
+{
+    std::lock_guard<std::mutex> lock(profileMutex);
+    timings.push_back(StepTiming{step, Clock::time_point(), Clock::time_point(), true});
+}
+
+void StartupProfile::firstMenuDrawn()
+{
+    if (!profilingEnabled || reported.exchange(true))
+    {
+        return;
+    }
+    std::cerr << generateReport(Clock::now());
+}
+
+std::string StartupProfile::generateReport(Clock::time_point firstMenu)
+{
+    std::lock_guard<std::mutex> lock(profileMutex);
+    std::ostringstream report;
+    report << "=== STARTUP PROFILE (ms from process start) ===\n";
+    report << std::left << std::setw(28) << "Step" << std::right << std::setw(10) << "Start"
+           << std::setw(10) << "End" << std::setw(10) << "Took" << "\n";
+    report << std::fixed << std::setprecision(2);
+
+    double busy = 0.0;
+    for (const auto& timing : timings)
+    {
+        report << std::left << std::setw(28) << timing.step.substr(0, 27) << std::right;
+        if (timing.deferred)
+        {
+            report << std::setw(30) << "deferred to first use" << "\n";
+            continue;
+        }
+        double took = millisecondsBetween(timing.start, timing.end);
+        busy += took;
+        report << std::setw(10) << millisecondsBetween(processStart, timing.start)
+               << std::setw(10) << millisecondsBetween(processStart, timing.end)
+               << std::setw(10) << took << "\n";
+    }
+
+    report << "First menu drawn at " << millisecondsBetween(processStart, firstMenu) << " ms ("
+           << busy << " ms of step time)\n";
+    return report.str();
+}
+
+StartupScheduler::~StartupScheduler()
+{
+    for (auto& thread : threads)
+    {
+        if (thread.joinable()) thread.join();
+    }
+    flushOutput();
+}
+
+std::ostream& StartupScheduler::output()
+{
+    return stepBuffer ? *stepBuffer : std::cout;
+}
+
+void StartupScheduler::start(const std::string& step, std::function<void()> work)
+{
+    size_t slot;
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        slot = stepOutput.size();
+        stepOutput.emplace_back();
+    }
+    threads.emplace_back([this, step, work, slot]()
+    {
+        std::ostringstream buffer;
+        stepBuffer = &buffer;
+        runHere(step, work);
+        stepBuffer = nullptr;
+
+        std::lock_guard<std::mutex> lock(errorMutex);
+        stepOutput[slot] = buffer.str();
+    });
+}
+
+void StartupScheduler::runHere(const std::string& step, const std::function<void()>& work)
+{
+    StartupProfile::Clock::time_point begin = StartupProfile::Clock::now();
+    try
+    {
+        work();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!firstError) firstError = std::current_exception();
+    }
+    StartupProfile::record(step, begin, StartupProfile::Clock::now());
+}
+
+void StartupScheduler::wait()
+{
+    for (auto& thread : threads)
+    {
+        if (thread.joinable()) thread.join();
+    }
+    threads.clear();
+    flushOutput();
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        error = firstError;
+        firstError = nullptr;
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void StartupScheduler::flushOutput()
+{
+    // Only called once the threads are joined
+    for (const auto& text : stepOutput)
+    {
+        std::cout << text;
+    }
+    std::cout.flush();
+    stepOutput.clear();
+}
@@ -0,0 +1,234 @@
+#include "../include/TaxBrackets.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+    std::string trim(const std::string& str)
+    {
+        size_t start = str.find_first_not_of(" \t\r");
+        if (start == std::string::npos) return "";
+
+        size_t end = str.find_last_not_of(" \t\r");
+        return str.substr(start, end - start + 1);
+    }
+
+    bool parseNumber(const std::string& text, double& number)
+    {
+        try
+        {
+            size_t used = 0;
+            number = std::stod(text, &used);
+            return used == text.size();
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+}
+
+const std::string TaxBracketTable::FEDERAL = "FEDERAL";
+
+BracketSchedule::BracketSchedule()
+    : bracketCount(0)
+{
+}
+
+void BracketSchedule::compile(std::vector<std::pair<double, double>> brackets)
+{
+    std::sort(brackets.begin(), brackets.end());
+    bracketCount = brackets.size();
+
+    size_t padded = 1;
+    while (padded < bracketCount)
+    {
+        padded <<= 1;
+    }
+
+    thresholds.assign(padded, std::numeric_limits<double>::infinity());
+    rates.assign(padded, 0.0);
+    baseTax.assign(padded, 0.0);
+
+    for (size_t i = 0; i < bracketCount; i++)
+    {
+        thresholds[i] = i == 0 ? 0.0 : brackets[i].first;
+        rates[i] = brackets[i].second;
+        if (i > 0)
+        {
+            baseTax[i] = baseTax[i - 1] + (thresholds[i] - thresholds[i - 1]) * rates[i - 1];
+        }
+    }
+}
+
+size_t BracketSchedule::findBracket(double income) const
+{
+    // Branchless binary search: the last threshold <= income. thresholds[0] is 0,
+    // so every non-negative income lands in a real bracket.
+    size_t index = 0;
+    for (size_t step = thresholds.size() / 2; step > 0; step >>= 1)
+    {
+        index += static_cast<size_t>(thresholds[index + step] <= income) * step;
+    }
+    return index;
+}
+
+double BracketSchedule::totalTax(double income) const
+{
+    if (bracketCount == 0) return 0.0;
+    income = std::max(income, 0.0);
+    size_t index = findBracket(income);
+    return baseTax[index] + (income - thresholds[index]) * rates[index];
+}
+
+double BracketSchedule::marginalRate(double income) const
+{
+    if (bracketCount == 0) return 0.0;
+    return rates[findBracket(std::max(income, 0.0))];
+}
+
+void BracketSchedule::totalTax(const std::vector<double>& incomes, std::vector<double>& taxes) const
+{
+    taxes.resize(incomes.size());
+    if (bracketCount == 0)
+    {
+        std::fill(taxes.begin(), taxes.end(), 0.0);
+        return;
+    }
+
+    for (size_t i = 0; i < incomes.size(); i++)
+    {
+        double income = std::max(incomes[i], 0.0);
+        size_t index = findBracket(income);
+        taxes[i] = baseTax[index] + (income - thresholds[index]) * rates[index];
+    }
+}
+
+void BracketSchedule::marginalRate(const std::vector<double>& incomes, std::vector<double>& result) const
+{
+    result.resize(incomes.size());
+    if (bracketCount == 0)
+    {
+        std::fill(result.begin(), result.end(), 0.0);
+        return;
+    }
+
+    for (size_t i = 0; i < incomes.size(); i++)
+    {
+        result[i] = rates[findBracket(std::max(incomes[i], 0.0))];
+    }
+}
+
+bool TaxBracketTable::parseFilingStatus(const std::string& text, FilingStatus& status)
+{
+    // Same spellings as the user profile file
+    if (text == "single") status = FilingStatus::SINGLE;
+    else if (text == "married_jointly") status = FilingStatus::MARRIED_FILING_JOINTLY;
+    else if (text == "married_separately") status = FilingStatus::MARRIED_FILING_SEPARATELY;
+    else if (text == "head_of_household") status = FilingStatus::HEAD_OF_HOUSEHOLD;
+    else return false;
+    return true;
+}
+
+std::string TaxBracketTable::scheduleKey(const std::string& jurisdiction, FilingStatus status)
+{
+    return jurisdiction + "/" + std::to_string(static_cast<int>(status));
+}
+
+bool TaxBracketTable::load(const std::string& path)
+{
+    TRACE_SCOPE("TaxBracketTable::load");
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::map<std::string, std::map<int, std::vector<std::pair<double, double>>>> pending;
+    std::vector<std::pair<double, double>>* current = nullptr;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = trim(line);
+
+        // Skip empty lines and comments
+        if (line.empty() || line[0] == '#') continue;
+
+        // [JURISDICTION YEAR FILING_STATUS]
+        if (line[0] == '[' && line.back() == ']')
+        {
+            std::istringstream header(line.substr(1, line.length() - 2));
+            std::string jurisdiction, statusText;
+            int year = 0;
+            FilingStatus status = FilingStatus::SINGLE;
+            current = nullptr;
+            if (header >> jurisdiction >> year >> statusText && parseFilingStatus(statusText, status))
+            {
+                current = &pending[scheduleKey(jurisdiction, status)][year];
+                current->clear();
+            }
+            continue;
+        }
+
+        // threshold = rate
+        size_t equalPos = line.find('=');
+        double threshold = 0.0;
+        double rate = 0.0;
+        if (current && equalPos != std::string::npos &&
+            parseNumber(trim(line.substr(0, equalPos)), threshold) &&
+            parseNumber(trim(line.substr(equalPos + 1)), rate))
+        {
+            current->push_back(std::make_pair(threshold, rate));
+        }
+    }
+
+    for (auto& jurisdiction : pending)
+    {
+        for (auto& year : jurisdiction.second)
+        {
+            if (year.second.empty()) continue;
+            schedules[jurisdiction.first][year.first].compile(year.second);
+        }
+    }
+    return true;
+}
+
+const BracketSchedule* TaxBracketTable::findYear(const std::string& key, int year) const
+{
+    auto it = schedules.find(key);
+    if (it == schedules.end() || it->second.empty())
+    {
+        return nullptr;
+    }
+
+    // Latest year at or before the requested one, else the earliest on file
+    auto yearIt = it->second.upper_bound(year);
+    if (yearIt != it->second.begin())
+    {
+        --yearIt;
+    }
+    return &yearIt->second;
+}
+
+const BracketSchedule* TaxBracketTable::find(const std::string& jurisdiction, int year, FilingStatus status) const
+{
+    const BracketSchedule* schedule = findYear(scheduleKey(jurisdiction, status), year);
+    if (!schedule && status != FilingStatus::SINGLE)
+    {
+        schedule = findYear(scheduleKey(jurisdiction, FilingStatus::SINGLE), year);
+    }
+    return schedule;
+}
+
+size_t TaxBracketTable::getScheduleCount() const
+{
+    size_t count = 0;
+    for (const auto& entry : schedules)
+    {
+        count += entry.second.size();
+    }
+    return count;
+}
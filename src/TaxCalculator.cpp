@@ -1,47 +1,125 @@
 #include "../include/TaxCalculator.h"
+#include "../include/MemoryAccounting.h"
+#include "../include/Trace.h"
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
 
-TaxCalculator::TaxCalculator(bool isProfessional, const std::string& configDir)
-    : taxRules(configDir), professionalGambler(isProfessional)
+TaxCalculator::TaxCalculator(bool isProfessional, const std::string& configDir, bool deferLoad)
+    : taxRules(configDir, deferLoad), professionalGambler(isProfessional), filingStatus(FilingStatus::SINGLE)
 {
 }
 
+void TaxCalculator::loadRules(StartupScheduler* startup)
+{
+    taxRules.load(startup);
+}
+
 TaxSummary TaxCalculator::calculateTaxes(const std::vector<GamblingSession>& sessions) const
 {
+    static const std::vector<TicketBatch> noTicketBatches;
+    return calculateTaxes(sessions, noTicketBatches);
+}
+
+TaxSummary TaxCalculator::calculateTaxes(const std::vector<GamblingSession>& sessions,
+                                         const std::vector<TicketBatch>& ticketBatches) const
+{
+    TRACE_SCOPE("calculateTaxes");
+    return summarize(aggregate(sessions, ticketBatches));
+}
+
+TaxSummary TaxCalculator::calculateTaxes(const SessionChunks& sessions,
+                                         const std::vector<TicketBatch>& ticketBatches) const
+{
+    TRACE_SCOPE("calculateTaxes");
+    return summarize(aggregate(sessions, ticketBatches));
+}
+
+SessionAggregate TaxCalculator::aggregate(const std::vector<GamblingSession>& sessions,
+                                          const std::vector<TicketBatch>& ticketBatches) const
+{
+    TRACE_SCOPE("aggregate");
+    MEMORY_SCOPE(MemoryTag::SUMMARY);
+    SessionAggregate totals;
+    std::vector<uint8_t> thresholdReached;
+    taxRules.getWithholdingClassifier().classify(sessions, thresholdReached);
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        totals.addSession(sessions[i], thresholdReached[i] != 0);
+    }
+    
+    // Ticket batches are all losses; their totals are kept up to date as tickets are added
+    for (const auto& batch : ticketBatches)
+    {
+        totals.addBatch(batch);
+    }
+    return totals;
+}
+
+SessionAggregate TaxCalculator::aggregate(const SessionChunks& sessions,
+                                          const std::vector<TicketBatch>& ticketBatches) const
+{
+    SessionAggregate totals = sessions.aggregate(*this);
+    for (const auto& batch : ticketBatches)
+    {
+        totals.addBatch(batch);
+    }
+    return totals;
+}
+
+void TaxCalculator::addSession(SessionAggregate& totals, const GamblingSession& session) const
+{
+    // The threshold lookup is only needed until the first missed withholding is found
+    bool thresholdReached = !totals.missedWithholding && session.getNetResult() > 0 &&
+                            triggersWithholding(session);
+    totals.addSession(session, thresholdReached);
+}
+
+TaxSummary TaxCalculator::calculateTaxesFromFile(const std::string& filename, TaskProgress& progress,
+                                                 const SessionFileReader::WarningCallback& onWarning) const
+{
+    TRACE_SCOPE("calculateTaxesFromFile");
+    MEMORY_SCOPE(MemoryTag::SUMMARY);
+    const GameTypeDictionary& gameTypes = taxRules.getGameTypes();
+    SessionAggregate totals;
+    std::string gameType;
+    SessionFileReader::read(filename,
+        [&](GamblingSession& session)
+        {
+            // The withholding threshold depends on the canonical game type
+            gameType = session.getGameType();
+            if (gameTypes.canonicalize(gameType)) session.setGameType(gameType);
+            addSession(totals, session);
+        },
+        [&](TicketBatch& batch)
+        {
+            totals.addBatch(batch);
+        },
+        onWarning, progress);
+    return summarize(totals);
+}
+
+TaxSummary TaxCalculator::summarize(const SessionAggregate& totals) const
+{
+    TRACE_SCOPE("summarize");
+    MEMORY_SCOPE(MemoryTag::SUMMARY);
     TaxSummary summary = {};
     summary.taxYear = taxRules.getFederalRules().taxYear;
     summary.rulesVersion = "Dynamic Config v1.0";
     
-    calculateFederalTotals(sessions, summary);
-    calculateStateTotals(sessions, summary);
-    generateReminders(sessions, summary);
+    calculateFederalTotals(totals, summary);
+    calculateStateTotals(totals, summary);
+    generateReminders(totals, summary);
     
     return summary;
 }
 
-void TaxCalculator::calculateFederalTotals(const std::vector<GamblingSession>& sessions, TaxSummary& summary) const
+void TaxCalculator::calculateFederalTotals(const SessionAggregate& totals, TaxSummary& summary) const
 {
-    summary.totalWinnings = 0.0;
-    summary.totalLosses = 0.0;
-    summary.totalWithheld = 0.0;
-    
-    for (const auto& session : sessions)
-    {
-        double netResult = session.getNetResult();
-        
-        if (netResult > 0)
-        {
-            summary.totalWinnings += netResult;
-        }
-        else if (netResult < 0)
-        {
-            summary.totalLosses += std::abs(netResult);
-        }
-        
-        summary.totalWithheld += session.getWithheldAmount();
-    }
+    TRACE_SCOPE("calculateFederalTotals");
+    summary.totalWinnings = totals.totalWinnings;
+    summary.totalLosses = totals.totalLosses;
+    summary.totalWithheld = totals.totalWithheld;
     
     // Federal rules: Apply loss deduction limit (e.g., 90% starting 2026)
     const FederalTaxRules& federalRules = taxRules.getFederalRules();
@@ -56,23 +134,29 @@ void TaxCalculator::calculateFederalTotals(const std::vector<GamblingSession>& s
     
     // Recommend itemizing if losses are significant
     summary.itemizingRecommended = summary.deductibleLosses >= federalRules.itemizationThreshold;
+    
+    // Liability as if gambling were the only income: the larger of the loss
+    // deduction and the standard deduction comes off the winnings
+    double deduction = std::max(summary.deductibleLosses, taxRules.getStandardDeduction(filingStatus));
+    double taxableIncome = std::max(0.0, summary.totalWinnings - deduction);
+    summary.estimatedFederalTax = calculateFederalTax(taxableIncome);
+    const BracketSchedule* brackets = taxRules.getBrackets(TaxBracketTable::FEDERAL, filingStatus);
+    summary.federalMarginalRate = brackets ? brackets->marginalRate(taxableIncome) : 0.0;
 }
 
-void TaxCalculator::calculateStateTotals(const std::vector<GamblingSession>& sessions, TaxSummary& summary) const
+void TaxCalculator::calculateStateTotals(const SessionAggregate& totals, TaxSummary& summary) const
 {
-    // First, calculate raw winnings and losses per state
-    for (const auto& session : sessions)
+    TRACE_SCOPE("calculateStateTotals");
+    // First, copy raw winnings and losses per state (only states that had any)
+    for (const auto& entry : totals.states)
     {
-        std::string state = session.getState();
-        double netResult = session.getNetResult();
-        
-        if (netResult > 0)
+        if (entry.second.winnings > 0)
         {
-            summary.stateWinnings[state] += netResult;
+            summary.stateWinnings[entry.first] = entry.second.winnings;
         }
-        else if (netResult < 0)
+        if (entry.second.losses > 0 || entry.second.winnings > 0)
         {
-            summary.stateLosses[state] += std::abs(netResult);
+            summary.stateLosses[entry.first] = entry.second.losses;
         }
     }
     
@@ -100,12 +184,14 @@ void TaxCalculator::calculateStateTotals(const std::vector<GamblingSession>& ses
             summary.stateDeductibleLosses[state] = 0.0;
             summary.stateNetResults[state] = winnings;
         }
+        
+        summary.stateTaxes[state] = calculateStateTaxOnTaxable(state, summary.stateNetResults[state]);
     }
 }
 
-void TaxCalculator::generateReminders(const std::vector<GamblingSession>& sessions, TaxSummary& summary) const
+void TaxCalculator::generateReminders(const SessionAggregate& totals, TaxSummary& summary) const
 {
-    std::set<std::string> addedReminders; // Avoid duplicates
+    TRACE_SCOPE("generateReminders");
     
     if (summary.hasWinnings)
     {
@@ -123,47 +209,31 @@ void TaxCalculator::generateReminders(const std::vector<GamblingSession>& sessio
         summary.documentationReminders.push_back("📋 Keep all W-2G forms from gambling establishments");
     }
     
-    // Check for states that don't allow loss deductions or have special rules
-    for (const auto& session : sessions)
+    // Check for states that don't allow loss deductions or have special rules,
+    // in the order each state first had a winning session
+    for (const auto& state : totals.winningStates)
     {
-        std::string state = session.getState();
         const StateTaxRule* stateRule = taxRules.getStateRule(state);
+        if (!stateRule) continue;
         
-        if (stateRule && session.isWin())
+        if (!stateRule->allowsLossDeduction)
         {
-            if (!stateRule->allowsLossDeduction)
-            {
-                std::string reminder = "⚠️  " + state + " does not allow gambling losses to offset winnings";
-                if (addedReminders.find(reminder) == addedReminders.end())
-                {
-                    summary.documentationReminders.push_back(reminder);
-                    addedReminders.insert(reminder);
-                }
-            }
-            else if (stateRule->lossDeductionPercentage < 1.0)
-            {
-                std::ostringstream oss;
-                oss << "⚠️  " << state << " only allows " 
-                    << std::fixed << std::setprecision(0) 
-                    << (stateRule->lossDeductionPercentage * 100) << "% of losses to be deducted";
-                std::string reminder = oss.str();
-                if (addedReminders.find(reminder) == addedReminders.end())
-                {
-                    summary.documentationReminders.push_back(reminder);
-                    addedReminders.insert(reminder);
-                }
-            }
+            summary.documentationReminders.push_back("⚠️  " + state + " does not allow gambling losses to offset winnings");
+        }
+        else if (stateRule->lossDeductionPercentage < 1.0)
+        {
+            std::ostringstream oss;
+            oss << "⚠️  " << state << " only allows " 
+                << std::fixed << std::setprecision(0) 
+                << (stateRule->lossDeductionPercentage * 100) << "% of losses to be deducted";
+            summary.documentationReminders.push_back(oss.str());
         }
     }
     
     // Check for withholding thresholds using dynamic rules
-    for (const auto& session : sessions)
+    if (totals.missedWithholding)
     {
-        if (triggersWithholding(session.getGameType(), session.getNetResult()) && !session.getTaxWithheld())
-        {
-            summary.documentationReminders.push_back("⚠️  Some winnings may have required withholding - check with establishment");
-            break; // Only show this once
-        }
+        summary.documentationReminders.push_back("⚠️  Some winnings may have required withholding - check with establishment");
     }
     
     // Add federal rule changes reminder
@@ -180,6 +250,8 @@ void TaxCalculator::generateReminders(const std::vector<GamblingSession>& sessio
 
 std::string TaxCalculator::generateTaxReport(const TaxSummary& summary) const
 {
+    TRACE_SCOPE("generateTaxReport");
+    MEMORY_SCOPE(MemoryTag::REPORTS);
     std::ostringstream report;
     report << std::fixed << std::setprecision(2);
     
@@ -203,6 +275,12 @@ std::string TaxCalculator::generateTaxReport(const TaxSummary& summary) const
     }
     report << "\n";
     report << "Net Result: $" << summary.netFederalResult << "\n";
+    if (summary.estimatedFederalTax > 0)
+    {
+        report << "Estimated Federal Tax: $" << summary.estimatedFederalTax
+               << " (gambling income alone, " << std::setprecision(0) << (summary.federalMarginalRate * 100)
+               << "% marginal rate)\n" << std::setprecision(2);
+    }
     
     if (summary.totalWithheld > 0)
     {
@@ -253,6 +331,12 @@ std::string TaxCalculator::generateTaxReport(const TaxSummary& summary) const
                 {
                     report << " (losses not deductible)";
                 }
+                
+                auto taxIt = summary.stateTaxes.find(state);
+                if (taxIt != summary.stateTaxes.end())
+                {
+                    report << " | Estimated tax: $" << taxIt->second;
+                }
             }
             report << "\n";
             
@@ -268,6 +352,7 @@ std::string TaxCalculator::generateTaxReport(const TaxSummary& summary) const
 
 std::string TaxCalculator::generateDocumentationChecklist() const
 {
+    MEMORY_SCOPE(MemoryTag::REPORTS);
     std::ostringstream checklist;
     
     checklist << "=== DOCUMENTATION CHECKLIST ===\n\n";
@@ -299,6 +384,7 @@ std::string TaxCalculator::generateDocumentationChecklist() const
 
 std::string TaxCalculator::generateRulesReport() const
 {
+    MEMORY_SCOPE(MemoryTag::REPORTS);
     std::ostringstream report;
     
     report << "=== CURRENT TAX RULES ===\n\n";
@@ -308,7 +394,10 @@ std::string TaxCalculator::generateRulesReport() const
     report << "• Loss Deduction Limit: " << std::fixed << std::setprecision(0) 
            << (federalRules.lossDeductionLimit * 100) << "%\n";
     report << "• Standard Deduction: $" << std::fixed << std::setprecision(0) 
-           << federalRules.standardDeduction << "\n";
+           << taxRules.getStandardDeduction(filingStatus) << "\n";
+    report << "• Bracket Schedules Loaded: " << taxRules.getTaxBrackets().getScheduleCount() << "\n";
+    report << "• Game Types Known: " << taxRules.getGameTypes().getTypeCount() << " ("
+           << taxRules.getGameTypes().getSpellingCount() << " spellings)\n";
     report << "• Itemization Threshold: $" << std::fixed << std::setprecision(0) 
            << federalRules.itemizationThreshold << "\n\n";
     
@@ -331,30 +420,17 @@ std::string TaxCalculator::generateRulesReport() const
 
 bool TaxCalculator::triggersWithholding(const std::string& gameType, double winnings) const
 {
-    if (winnings <= 0) return false;
-    
-    double threshold = getWithholdingThreshold(gameType);
-    return threshold > 0 && winnings >= threshold;
+    return taxRules.getWithholdingClassifier().triggers(gameType, winnings);
+}
+
+bool TaxCalculator::triggersWithholding(const GamblingSession& session) const
+{
+    return taxRules.getWithholdingClassifier().triggers(session);
 }
 
 double TaxCalculator::getWithholdingThreshold(const std::string& gameType) const
 {
-    const FederalTaxRules& federalRules = taxRules.getFederalRules();
-    
-    auto it = federalRules.withholdingThresholds.find(gameType);
-    if (it != federalRules.withholdingThresholds.end())
-    {
-        return it->second;
-    }
-    
-    // Try alternative names
-    if (gameType == "Lottery" || gameType == "Sweepstakes")
-    {
-        auto lotIt = federalRules.withholdingThresholds.find("Lottery");
-        return (lotIt != federalRules.withholdingThresholds.end()) ? lotIt->second : 5000.0;
-    }
-    
-    return 0.0; // No threshold found
+    return taxRules.getWithholdingClassifier().getThreshold(gameType);
 }
 
 void TaxCalculator::setTaxYear(int year)
@@ -382,5 +458,24 @@ double TaxCalculator::calculateStateTax(const std::string& stateCode, double win
         taxableAmount = winnings - deductibleLosses;
     }
     
-    return taxableAmount * rule->taxRate;
+    return calculateStateTaxOnTaxable(stateCode, taxableAmount);
+}
+
+double TaxCalculator::calculateStateTaxOnTaxable(const std::string& stateCode, double taxableAmount) const
+{
+    const StateTaxRule* rule = taxRules.getStateRule(stateCode);
+    if (!rule || !rule->hasIncomeTax)
+    {
+        return 0.0; // No state income tax
+    }
+    
+    // Progressive states use their bracket schedule; the rest use the flat rate
+    const BracketSchedule* brackets = taxRules.getBrackets(stateCode, filingStatus);
+    return brackets ? brackets->totalTax(taxableAmount) : taxableAmount * rule->taxRate;
+}
+
+double TaxCalculator::calculateFederalTax(double taxableIncome) const
+{
+    const BracketSchedule* brackets = taxRules.getBrackets(TaxBracketTable::FEDERAL, filingStatus);
+    return brackets ? brackets->totalTax(taxableIncome) : 0.0;
 }
\ No newline at end of file
@@ -1,39 +1,76 @@
 #include "../include/TaxRulesConfig.h"
+#include "../include/MemoryAccounting.h"
+#include "../include/Trace.h"
+#include <atomic>
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cstdio>
 #include <filesystem>
+#include <functional>
 
-TaxRulesConfig::TaxRulesConfig(const std::string& configDir) : configDirectory(configDir)
+namespace
 {
-    // Create config directory if it doesn't exist
-    try
+    std::atomic<uint64_t> nextRulesVersion(1);
+}
+
+TaxRulesConfig::TaxRulesConfig(const std::string& configDir, bool deferLoad)
+    : stateRulesFile("state_rules.cfg"), stateRulesIndexed(false), configDirectory(configDir),
+      rulesVersion(nextRulesVersion++)
+{
+    if (!deferLoad)
     {
-        std::filesystem::create_directories(configDirectory);
+        load();
     }
-    catch (const std::exception& e)
+}
+
+void TaxRulesConfig::load(StartupScheduler* startup)
+{
+    // Each file fills its own members, so the loads are independent
+    std::function<void()> federal = [this]()
     {
-        std::cout << "Warning: Could not create config directory: " << e.what() << std::endl;
-    }
+        MEMORY_SCOPE(MemoryTag::RULES);
+        
+        // Try to load existing configs, create defaults if they don't exist
+        if (!loadFederalRules())
+        {
+            createDefaultConfigs();
+            loadFederalRules();
+        }
+    };
+    std::function<void()> brackets = [this]()
+    {
+        MEMORY_SCOPE(MemoryTag::RULES);
+        loadTaxBrackets();
+    };
+    std::function<void()> games = [this]()
+    {
+        MEMORY_SCOPE(MemoryTag::RULES);
+        loadGameTypes();
+    };
     
-    // Try to load existing configs, create defaults if they don't exist
-    if (!loadFederalRules())
+    if (startup)
     {
-        createDefaultConfigs();
-        loadFederalRules();
+        startup->start("federal rules", federal);
+        startup->start("tax brackets", brackets);
+        startup->start("game types", games);
+        StartupProfile::noteDeferred("state rules");
     }
-    if (!loadStateRules())
+    else
     {
-        loadStateRules();  // Try again after creating defaults
+        federal();
+        brackets();
+        games();
     }
 }
 
 bool TaxRulesConfig::loadFederalRules(const std::string& filename)
 {
+    TRACE_SCOPE("TaxRulesConfig::loadFederalRules");
     std::ifstream file(getConfigPath(filename));
     if (!file.is_open())
     {
-        std::cout << "Could not load federal rules from " << filename << std::endl;
+        StartupScheduler::output() << "Could not load federal rules from " << filename << std::endl;
         return false;
     }
     
@@ -63,6 +100,8 @@ bool TaxRulesConfig::loadFederalRules(const std::string& filename)
         {
             if (key == "tax_year") federalRules.taxYear = std::stoi(value);
             else if (key == "standard_deduction_single") federalRules.standardDeduction = parseDouble(value);
+            else if (key == "standard_deduction_married") federalRules.standardDeductionMarried = parseDouble(value);
+            else if (key == "standard_deduction_head_of_household") federalRules.standardDeductionHeadOfHousehold = parseDouble(value);
             else if (key == "itemization_threshold") federalRules.itemizationThreshold = parseDouble(value);
         }
         else if (currentSection == "LOSS_DEDUCTIONS")
@@ -72,78 +111,227 @@ bool TaxRulesConfig::loadFederalRules(const std::string& filename)
         }
         else if (currentSection == "WITHHOLDING_THRESHOLDS")
         {
+            // The file's spelling (Slot_Machine) replaces the built-in one (Slot Machine)
+            std::map<std::string, double>& thresholds = federalRules.withholdingThresholds;
+            std::string name = GameTypeDictionary::normalize(key);
+            for (auto it = thresholds.begin(); it != thresholds.end();)
+            {
+                if (GameTypeDictionary::normalize(it->first) == name) it = thresholds.erase(it);
+                else ++it;
+            }
             federalRules.withholdingThresholds[key] = parseDouble(value);
         }
     }
     
     file.close();
+    withholdingClassifier = WithholdingClassifier(federalRules.withholdingThresholds);
+    rulesVersion = nextRulesVersion++;
     return true;
 }
 
 bool TaxRulesConfig::loadStateRules(const std::string& filename)
 {
-    std::ifstream file(getConfigPath(filename));
+    stateRulesFile = filename;
+    bool loaded = indexStateRules(true);
+    
+    // The file's sections replace rules parsed or added before it was loaded
+    for (const auto& section : stateSections)
+    {
+        stateRules.erase(section.first);
+    }
+    return loaded;
+}
+
+void TaxRulesConfig::ensureStateIndex() const
+{
+    if (!stateRulesIndexed)
+    {
+        indexStateRules(true);
+    }
+}
+
+void TaxRulesConfig::ensureAllStateRules() const
+{
+    ensureStateIndex();
+    std::vector<std::string> codes;     // Copied; a stale index is rebuilt while parsing
+    for (const auto& section : stateSections)
+    {
+        codes.push_back(section.first);
+    }
+    for (const auto& code : codes)
+    {
+        getStateRule(code);
+    }
+}
+
+bool TaxRulesConfig::indexStateRules(bool useCache) const
+{
+    TRACE_SCOPE("TaxRulesConfig::indexStateRules");
+    MEMORY_SCOPE(MemoryTag::RULES);
+    stateRulesIndexed = true;
+    stateSections.clear();
+    
+    std::string fingerprint = stateRulesFingerprint();
+    if (useCache && !fingerprint.empty() && readStateIndexCache(fingerprint))
+    {
+        return true;
+    }
+    
+    std::ifstream file(getConfigPath(stateRulesFile), std::ios::binary);
     if (!file.is_open())
     {
-        std::cout << "Could not load state rules from " << filename << std::endl;
+        std::cout << "Could not load state rules from " << stateRulesFile << std::endl;
         return false;
     }
     
-    std::string line, currentState;
-    StateTaxRule currentRule;
-    
+    // Only headers are looked at; a state listed twice keeps its last section
+    std::string line;
+    std::streamoff offset = 0;
     while (std::getline(file, line))
     {
+        std::streamoff lineStart = offset;
+        offset += static_cast<std::streamoff>(line.size()) + 1;
         line = trim(line);
+        if (line.size() > 2 && line[0] == '[' && line.back() == ']')
+        {
+            stateSections[line.substr(1, line.length() - 2)] = lineStart;
+        }
+    }
+    
+    file.close();
+    writeStateIndexCache(fingerprint);
+    return true;
+}
+
+std::string TaxRulesConfig::stateRulesFingerprint() const
+{
+    std::error_code error;
+    std::filesystem::path path(getConfigPath(stateRulesFile));
+    uintmax_t size = std::filesystem::file_size(path, error);
+    if (error) return "";
+    std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, error);
+    if (error) return "";
+    return std::to_string(size) + " " + std::to_string(modified.time_since_epoch().count());
+}
+
+bool TaxRulesConfig::readStateIndexCache(const std::string& fingerprint) const
+{
+    std::ifstream file(getConfigPath(stateRulesFile + ".idx"));
+    std::string comment, stamp;
+    if (!std::getline(file, comment) || !std::getline(file, stamp) || stamp != "fingerprint " + fingerprint)
+    {
+        return false;
+    }
+    
+    std::string code;
+    std::streamoff offset;
+    while (file >> code >> offset)
+    {
+        stateSections[code] = offset;
+    }
+    if (!file.eof())
+    {
+        stateSections.clear();      // Damaged; scan the file instead
+        return false;
+    }
+    return true;
+}
+
+void TaxRulesConfig::writeStateIndexCache(const std::string& fingerprint) const
+{
+    if (fingerprint.empty()) return;
+    
+    // Best effort: without it the next run just scans the file again
+    std::string indexPath = getConfigPath(stateRulesFile + ".idx");
+    std::string tempPath = indexPath + ".tmp";
+    {
+        std::ofstream file(tempPath);
+        if (!file.is_open()) return;
+        file << "# Section offsets in " << stateRulesFile << "; rebuilt whenever it changes\n";
+        file << "fingerprint " << fingerprint << "\n";
+        for (const auto& section : stateSections)
+        {
+            file << section.first << " " << section.second << "\n";
+        }
+        if (!file.good())
+        {
+            file.close();
+            std::remove(tempPath.c_str());
+            return;
+        }
+    }
+    if (std::rename(tempPath.c_str(), indexPath.c_str()) != 0)
+    {
+        std::remove(tempPath.c_str());
+    }
+}
 
+bool TaxRulesConfig::parseStateSection(std::istream& file, const std::string& stateCode, StateTaxRule& rule) const
+{
+    auto section = stateSections.find(stateCode);
+    if (section == stateSections.end()) return false;
+    
+    // The header must be where the index says; if not, the index is stale
+    std::string line;
+    file.clear();
+    file.seekg(section->second);
+    if (!std::getline(file, line) || trim(line) != "[" + stateCode + "]")
+    {
+        return false;
+    }
+    
+    rule = StateTaxRule();  // Defaults for keys the section leaves out
+    rule.stateCode = stateCode;
+    while (std::getline(file, line))
+    {
+        line = trim(line);
+        
         // Skip empty lines and comments
         if (line.empty() || line[0] == '#') continue;
         
-        // Check for state section headers [STATE_CODE]
-        if (line[0] == '[' && line.back() == ']')
-        {
-            // Save previous state if we have one
-            if (!currentState.empty())
-            {
-                stateRules[currentState] = currentRule;
-            }
-            
-            // Start new state
-            currentState = line.substr(1, line.length() - 2);
-            currentRule = StateTaxRule();  // Reset to defaults
-            currentRule.stateCode = currentState;
-            continue;
-        }
+        // The next state's header ends this one
+        if (line[0] == '[' && line.back() == ']') break;
         
-        // Parse key-value pairs for current state
         auto keyValue = parseConfigLine(line);
         if (keyValue.empty()) continue;
         
         std::string key = keyValue.begin()->first;
         std::string value = keyValue.begin()->second;
         
-        if (key == "state_name") currentRule.stateName = value;
-        else if (key == "has_income_tax") currentRule.hasIncomeTax = parseBool(value);
-        else if (key == "tax_rate") currentRule.taxRate = parseDouble(value);
-        else if (key == "allows_loss_deduction") currentRule.allowsLossDeduction = parseBool(value);
-        else if (key == "loss_deduction_percentage") currentRule.lossDeductionPercentage = parseDouble(value);
-        else if (key == "special_rules") currentRule.specialRules = value;
-        else if (key == "requires_nonresident_return") currentRule.requiresNonResidentReturn = parseBool(value);
-        else if (key == "withholding_threshold") currentRule.withholdingThreshold = parseDouble(value);
+        if (key == "state_name") rule.stateName = value;
+        else if (key == "has_income_tax") rule.hasIncomeTax = parseBool(value);
+        else if (key == "tax_rate") rule.taxRate = parseDouble(value);
+        else if (key == "allows_loss_deduction") rule.allowsLossDeduction = parseBool(value);
+        else if (key == "loss_deduction_percentage") rule.lossDeductionPercentage = parseDouble(value);
+        else if (key == "special_rules") rule.specialRules = value;
+        else if (key == "requires_nonresident_return") rule.requiresNonResidentReturn = parseBool(value);
+        else if (key == "withholding_threshold") rule.withholdingThreshold = parseDouble(value);
     }
-    
-    // Don't forget the last state
-    if (!currentState.empty())
-    {
-        stateRules[currentState] = currentRule;
-    }
-    
-    file.close();
     return true;
 }
 
+bool TaxRulesConfig::loadTaxBrackets(const std::string& filename)
+{
+    return taxBrackets.load(getConfigPath(filename));
+}
+
+bool TaxRulesConfig::loadGameTypes(const std::string& filename)
+{
+    return gameTypes.load(getConfigPath(filename));
+}
+
 void TaxRulesConfig::createDefaultConfigs()
 {
+    // Create config directory if it doesn't exist
+    try
+    {
+        std::filesystem::create_directories(configDirectory);
+    }
+    catch (const std::exception& e)
+    {
+        StartupScheduler::output() << "Warning: Could not create config directory: " << e.what() << std::endl;
+    }
+    
     // Create federal rules config file
     std::ofstream federalFile(getConfigPath("federal_rules.cfg"));
     if (federalFile.is_open())
@@ -153,6 +341,8 @@ void TaxRulesConfig::createDefaultConfigs()
         federalFile << "[GENERAL]\n";
         federalFile << "tax_year = 2024\n";
         federalFile << "standard_deduction_single = 14600\n";
+        federalFile << "standard_deduction_married = 29200\n";
+        federalFile << "standard_deduction_head_of_household = 21900\n";
         federalFile << "itemization_threshold = 1000\n\n";
         federalFile << "[LOSS_DEDUCTIONS]\n";
         federalFile << "allows_loss_deduction = true\n";
@@ -190,16 +380,33 @@ void TaxRulesConfig::createDefaultConfigs()
 
 const StateTaxRule* TaxRulesConfig::getStateRule(const std::string& stateCode) const {
     auto it = stateRules.find(stateCode);
-    return (it != stateRules.end()) ? &it->second : nullptr;
+    if (it != stateRules.end()) return &it->second;
+    
+    ensureStateIndex();
+    if (stateSections.find(stateCode) == stateSections.end()) return nullptr;
+    
+    MEMORY_SCOPE(MemoryTag::RULES);
+    StateTaxRule rule;
+    std::ifstream file(getConfigPath(stateRulesFile), std::ios::binary);
+    if (!parseStateSection(file, stateCode, rule))
+    {
+        // The file changed since it was indexed
+        if (!indexStateRules(false)) return nullptr;
+        file.close();
+        file.open(getConfigPath(stateRulesFile), std::ios::binary);
+        if (!parseStateSection(file, stateCode, rule)) return nullptr;
+    }
+    return &(stateRules[stateCode] = rule);
 }
 
 void TaxRulesConfig::addStateRule(const std::string& stateCode, const StateTaxRule& rule)
 {
-    stateRules[stateCode] = rule;
+    stateRules[stateCode] = rule;   // Looked up before the file, so the file can't override it
 }
 
 std::vector<std::string> TaxRulesConfig::getAvailableStates() const
 {
+    ensureAllStateRules();
     std::vector<std::string> states;
     for (const auto& pair : stateRules)
     {
@@ -228,25 +435,42 @@ double TaxRulesConfig::getStateTaxRate(const std::string& stateCode) const
 
 double TaxRulesConfig::getWithholdingThreshold(const std::string& gameType) const
 {
-    const FederalTaxRules& federalRules = getFederalRules();
-    auto it = federalRules.withholdingThresholds.find(gameType);
-    return (it != federalRules.withholdingThresholds.end()) ? it->second : 0.0;
+    return withholdingClassifier.getThreshold(gameType);
+}
+
+void TaxRulesConfig::setFederalRules(const FederalTaxRules& rules)
+{
+    federalRules = rules;
+    withholdingClassifier = WithholdingClassifier(federalRules.withholdingThresholds);
+    rulesVersion = nextRulesVersion++;
+}
+
+const BracketSchedule* TaxRulesConfig::getBrackets(const std::string& jurisdiction, FilingStatus status) const
+{
+    return taxBrackets.find(jurisdiction, federalRules.taxYear, status);
+}
+
+double TaxRulesConfig::getStandardDeduction(FilingStatus status) const
+{
+    switch (status)
+    {
+        case FilingStatus::MARRIED_FILING_JOINTLY: return federalRules.standardDeductionMarried;
+        case FilingStatus::HEAD_OF_HOUSEHOLD: return federalRules.standardDeductionHeadOfHousehold;
+        default: return federalRules.standardDeduction;
+    }
 }
 
 void TaxRulesConfig::updateForTaxYear(int year)
 {
     // This could automatically adjust rules based on the year
     federalRules.taxYear = year;
-    
+    federalRules.lossDeductionLimit = lossDeductionLimitForYear(year);
+}
+
+double TaxRulesConfig::lossDeductionLimitForYear(int year)
+{
     // Example: Apply 2026 rule changes
-    if (year >= 2026)
-    {
-        federalRules.lossDeductionLimit = 0.9; // 90% limit starting 2026
-    }
-    else
-    {
-        federalRules.lossDeductionLimit = 1.0; // 100% before 2026
-    }
+    return year >= 2026 ? 0.9 : 1.0; // 90% limit starting 2026, 100% before
 }
 
 std::string TaxRulesConfig::getConfigPath(const std::string& filename) const
@@ -254,7 +478,7 @@ std::string TaxRulesConfig::getConfigPath(const std::string& filename) const
     return configDirectory + "/" + filename;
 }
 
-std::map<std::string, std::string> TaxRulesConfig::parseConfigLine(const std::string& line)
+std::map<std::string, std::string> TaxRulesConfig::parseConfigLine(const std::string& line) const
 {
     std::map<std::string, std::string> result;
     
@@ -272,7 +496,7 @@ std::map<std::string, std::string> TaxRulesConfig::parseConfigLine(const std::st
     return result;
 }
 
-std::string TaxRulesConfig::trim(const std::string& str)
+std::string TaxRulesConfig::trim(const std::string& str) const
 {
     size_t start = str.find_first_not_of(" \t");
     if (start == std::string::npos) return "";
@@ -281,14 +505,14 @@ std::string TaxRulesConfig::trim(const std::string& str)
     return str.substr(start, end - start + 1);
 }
 
-bool TaxRulesConfig::parseBool(const std::string& value)
+bool TaxRulesConfig::parseBool(const std::string& value) const
 {
     std::string lower = value;
     std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
     return (lower == "true" || lower == "yes" || lower == "1");
 }
 
-double TaxRulesConfig::parseDouble(const std::string& value)
+double TaxRulesConfig::parseDouble(const std::string& value) const
 {
     try
     {
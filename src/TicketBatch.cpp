@@ -0,0 +1,130 @@
+#include "../include/TicketBatch.h"
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+const char* const TicketBatch::DOCUMENTATION_NOTE = "Keep losing ticket";
+const char* const TicketBatch::NOTES = "Bulk entry loss";
+
+TicketBatch::TicketBatch()
+    : date(""), location(""), state(""), gameType(""), totalCents(0)
+{
+}
+
+TicketBatch::TicketBatch(const std::string& date, const std::string& location,
+                         const std::string& state, const std::string& gameType)
+    : date(date), location(location), state(state), gameType(gameType), totalCents(0)
+{
+}
+
+void TicketBatch::addTicket(double amount)
+{
+    if (amount <= 0.0 || amount > 42949672.95)
+    {
+        throw std::invalid_argument("Ticket amount out of range");
+    }
+
+    uint32_t cents = static_cast<uint32_t>(std::llround(amount * 100.0));
+    ticketCents.push_back(cents);
+    totalCents += cents;
+}
+
+void TicketBatch::removeTicket(size_t index)
+{
+    totalCents -= ticketCents[index];
+    ticketCents.erase(ticketCents.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+GamblingSession TicketBatch::ticketAsSession(size_t index) const
+{
+    return GamblingSession(date, location, state, gameType, getTicketAmount(index), 0.0,
+                           false, 0.0, DOCUMENTATION_NOTE, NOTES);
+}
+
+std::string TicketBatch::toString() const
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "Date: " << date << "\n"
+        << "Location: " << location << " (" << state << ")\n"
+        << "Game: " << gameType << "\n"
+        << "Losing tickets: " << ticketCents.size() << "\n"
+        << "Total spent: $" << getTotalLosses() << "\n"
+        << "Net Result: $" << -getTotalLosses() << " (LOSS)\n";
+
+    // Show the individual amounts for small batches; large ones would flood the screen
+    const size_t MAX_LISTED = 20;
+    if (!ticketCents.empty() && ticketCents.size() <= MAX_LISTED)
+    {
+        oss << "Tickets:";
+        for (uint32_t cents : ticketCents)
+        {
+            oss << " $" << cents / 100.0;
+        }
+        oss << "\n";
+    }
+
+    oss << "Documentation: " << DOCUMENTATION_NOTE << "\n";
+    return oss.str();
+}
+
+std::string TicketBatch::toCSV() const
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "BATCH," << date << "," << location << "," << state << "," << gameType << ","
+        << ticketCents.size() << ",";
+
+    for (size_t i = 0; i < ticketCents.size(); i++)
+    {
+        if (i > 0) oss << ";";
+        oss << ticketCents[i] / 100.0;
+    }
+    return oss.str();
+}
+
+bool TicketBatch::isBatchCSV(const std::string& csvLine)
+{
+    return csvLine.compare(0, 6, "BATCH,") == 0;
+}
+
+TicketBatch TicketBatch::fromCSV(const std::string& csvLine)
+{
+    std::istringstream iss(csvLine);
+    std::string tag, date, location, state, gameType, countStr, amounts;
+
+    std::getline(iss, tag, ',');
+    std::getline(iss, date, ',');
+    std::getline(iss, location, ',');
+    std::getline(iss, state, ',');
+    std::getline(iss, gameType, ',');
+    std::getline(iss, countStr, ',');
+    std::getline(iss, amounts);
+
+    if (tag != "BATCH")
+    {
+        throw std::invalid_argument("Not a ticket batch row");
+    }
+    if (!GamblingSession::isValidDate(date))
+    {
+        throw std::invalid_argument("Invalid date format in CSV: " + date + " (expected MM-DD-YYYY)");
+    }
+
+    TicketBatch batch(date, location, state, gameType);
+    size_t expected = static_cast<size_t>(std::stoul(countStr));
+    batch.reserve(expected);
+
+    std::istringstream amountStream(amounts);
+    std::string amount;
+    while (std::getline(amountStream, amount, ';'))
+    {
+        batch.addTicket(std::stod(amount));
+    }
+
+    if (batch.getTicketCount() != expected)
+    {
+        throw std::invalid_argument("Ticket count mismatch in batch row");
+    }
+    return batch;
+}
@@ -0,0 +1,199 @@
+#include "../include/Trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // The owning thread holds the mutex while it writes an event and the
+    // dumper while it copies the ring, so a dump never sees a half-written
+    // event. Only the dumper ever contends for it.
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        TraceEvent events[TraceRecorder::RING_CAPACITY];
+        uint64_t written;
+        uint32_t threadId;
+
+        explicit ThreadBuffer(uint32_t id) : written(0), threadId(id) {}
+    };
+
+    std::atomic<bool> tracingEnabled(false);
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> registry;   // Keeps buffers alive after thread exit
+    std::string traceOutputFile;
+    bool exitHandlerInstalled = false;
+
+    ThreadBuffer& localBuffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (!buffer)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer = std::make_shared<ThreadBuffer>(static_cast<uint32_t>(registry.size() + 1));
+            registry.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    void writeTraceAtExit()
+    {
+        TraceRecorder::flush();
+    }
+
+    void appendEscaped(std::string& out, const char* text)
+    {
+        for (const char* p = text; *p; p++)
+        {
+            if (*p == '"' || *p == '\\') out += '\\';
+            out += *p;
+        }
+    }
+}
+
+void TraceRecorder::enable(const std::string& outputFile)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    traceOutputFile = outputFile;
+    tracingEnabled.store(true, std::memory_order_release);
+    if (!exitHandlerInstalled)
+    {
+        std::atexit(writeTraceAtExit);
+        exitHandlerInstalled = true;
+    }
+}
+
+void TraceRecorder::enableFromEnvironment()
+{
+    const char* path = std::getenv("GAMBLING_TRACE");
+    if (path && *path)
+    {
+        enable(path);
+    }
+}
+
+bool TraceRecorder::isEnabled()
+{
+    return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+bool TraceRecorder::isCompiledIn()
+{
+#ifdef GAMBLING_ENABLE_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t TraceRecorder::nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void TraceRecorder::record(const char* name, uint64_t startNs, uint64_t endNs)
+{
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    TraceEvent& event = buffer.events[buffer.written % RING_CAPACITY];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    buffer.written++;
+}
+
+bool TraceRecorder::writeChromeTrace(const std::string& filename)
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers = registry;
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char numbers[96];
+    std::vector<TraceEvent> events;
+
+    for (const auto& buffer : buffers)
+    {
+        // Copy the ring under its owner's lock, then format without holding it
+        events.clear();
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            uint64_t begin = buffer->written > RING_CAPACITY ? buffer->written - RING_CAPACITY : 0;
+            for (uint64_t i = begin; i < buffer->written; i++)
+            {
+                events.push_back(buffer->events[i % RING_CAPACITY]);
+            }
+        }
+
+        for (const TraceEvent& event : events)
+        {
+            out += first ? "\n" : ",\n";
+            first = false;
+
+            out += "{\"name\":\"";
+            appendEscaped(out, event.name);
+            std::snprintf(numbers, sizeof(numbers), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                          event.startNs / 1000.0, event.durationNs / 1000.0, buffer->threadId);
+            out += numbers;
+        }
+
+        if (out.size() > (1 << 20))
+        {
+            file.write(out.data(), static_cast<std::streamsize>(out.size()));
+            out.clear();
+        }
+    }
+
+    out += "\n]}\n";
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+void TraceRecorder::flush()
+{
+    std::string filename;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        filename = traceOutputFile;
+    }
+
+    if (isEnabled() && !filename.empty())
+    {
+        if (!writeChromeTrace(filename))
+        {
+            std::fprintf(stderr, "Warning: could not write trace file %s\n", filename.c_str());
+        }
+    }
+}
+
+TraceSpan::TraceSpan(const char* name) : name(name), startNs(0)
+{
+    if (TraceRecorder::isEnabled())
+    {
+        startNs = TraceRecorder::nowNs();
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (startNs != 0)
+    {
+        TraceRecorder::record(name, startNs, TraceRecorder::nowNs());
+    }
+}
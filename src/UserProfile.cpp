@@ -7,12 +7,27 @@
 #include <limits>
 #include <algorithm>
 
-UserProfile::UserProfile(const std::string& configDir)
+UserProfile::UserProfile(const std::string& configDir, bool deferLoad)
     : configDirectory(configDir), homeState(""), timezone(""),
       filingStatus(FilingStatus::SINGLE), profileExists(false)
 {
     initializeOptions();
-    profileExists = loadProfile();
+    if (!deferLoad)
+    {
+        load();
+    }
+}
+
+void UserProfile::load(StartupScheduler* startup)
+{
+    if (startup)
+    {
+        startup->start("user profile", [this]() { profileExists = loadProfile(); });
+    }
+    else
+    {
+        profileExists = loadProfile();
+    }
 }
 
 void UserProfile::initializeOptions()
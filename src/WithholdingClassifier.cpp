@@ -0,0 +1,145 @@
+#include "../include/WithholdingClassifier.h"
+#include "../include/GameTypeDictionary.h"
+
+namespace
+{
+    // Racing and other pari-mutuel style wagers only require a W-2G at 300-to-1 odds
+    const double RACING_ODDS = 300.0;
+    const char* const ODDS_GAME_TYPES[] = {"horse racing", "dog racing", "other gaming"};
+}
+
+std::map<std::string, double> WithholdingClassifier::defaultThresholds()
+{
+    // IRS Form W-2G thresholds (Topic 419)
+    std::map<std::string, double> thresholds;
+    thresholds["Lottery"] = 5000.0;
+    thresholds["Sweepstakes"] = 5000.0;
+    thresholds["Slot Machine"] = 1200.0;
+    thresholds["Bingo"] = 1200.0;
+    thresholds["Keno"] = 1500.0;
+    thresholds["Poker Tournament"] = 5000.0;
+    thresholds["Horse Racing"] = 600.0;
+    thresholds["Dog Racing"] = 600.0;
+    thresholds["Other Gaming"] = 600.0;
+    return thresholds;
+}
+
+WithholdingClassifier::WithholdingClassifier()
+    : WithholdingClassifier(defaultThresholds())
+{
+}
+
+WithholdingClassifier::WithholdingClassifier(const std::map<std::string, double>& table)
+{
+    for (const auto& entry : table)
+    {
+        std::string name = GameTypeDictionary::normalize(entry.first);
+        auto it = ids.find(name);
+        int id = 0;
+        if (it == ids.end())
+        {
+            id = static_cast<int>(thresholds.size());
+            ids[name] = id;
+            thresholds.push_back(entry.second);
+
+            double odds = 0.0;
+            for (const char* oddsType : ODDS_GAME_TYPES)
+            {
+                if (name == oddsType) odds = RACING_ODDS;
+            }
+            oddsRatios.push_back(odds);
+        }
+        else
+        {
+            // Two spellings of the same game in one table; the later one wins
+            id = it->second;
+            thresholds[id] = entry.second;
+        }
+
+        // Exact spellings skip normalization on lookup
+        ids[entry.first] = id;
+    }
+}
+
+int WithholdingClassifier::lookup(const std::string& gameType) const
+{
+    auto it = ids.find(gameType);
+    if (it == ids.end())
+    {
+        it = ids.find(GameTypeDictionary::normalize(gameType));
+    }
+    return it == ids.end() ? UNKNOWN : it->second;
+}
+
+double WithholdingClassifier::getThreshold(const std::string& gameType) const
+{
+    int id = lookup(gameType);
+    return id == UNKNOWN ? 0.0 : thresholds[id];
+}
+
+bool WithholdingClassifier::triggers(int id, double winnings, double wager) const
+{
+    if (id == UNKNOWN || winnings <= 0) return false;
+
+    double threshold = thresholds[id];
+    double odds = oddsRatios[id];
+    return threshold > 0 && winnings >= threshold && (odds == 0.0 || winnings >= wager * odds);
+}
+
+bool WithholdingClassifier::triggers(const std::string& gameType, double winnings, double wager) const
+{
+    return triggers(lookup(gameType), winnings, wager);
+}
+
+bool WithholdingClassifier::triggers(const GamblingSession& session) const
+{
+    return triggers(lookup(session.getGameType()), session.getNetResult(), session.getBuyIn());
+}
+
+void WithholdingClassifier::classify(const std::vector<GamblingSession>& sessions, std::vector<uint8_t>& flags) const
+{
+    classifyAll(sessions, flags);
+}
+
+void WithholdingClassifier::classify(const SessionChunks& sessions, std::vector<uint8_t>& flags) const
+{
+    classifyAll(sessions, flags);
+}
+
+template <class Sessions>
+void WithholdingClassifier::classifyAll(const Sessions& sessions, std::vector<uint8_t>& flags) const
+{
+    const size_t count = sessions.size();
+    std::vector<double> threshold(count);
+    std::vector<double> odds(count);
+    std::vector<double> winnings(count);
+    std::vector<double> wager(count);
+
+    // Resolve ids; consecutive sessions usually repeat the game type
+    std::string lastType;
+    int lastId = UNKNOWN;
+    bool haveLast = false;
+    for (size_t i = 0; i < count; i++)
+    {
+        const GamblingSession& session = sessions[i];
+        std::string gameType = session.getGameType();
+        if (!haveLast || gameType != lastType)
+        {
+            lastId = lookup(gameType);
+            lastType.swap(gameType);
+            haveLast = true;
+        }
+        threshold[i] = lastId == UNKNOWN ? 0.0 : thresholds[lastId];
+        odds[i] = lastId == UNKNOWN ? 0.0 : oddsRatios[lastId];
+        winnings[i] = session.getNetResult();
+        wager[i] = session.getBuyIn();
+    }
+
+    flags.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        bool reached = (threshold[i] > 0.0) & (winnings[i] > 0.0) & (winnings[i] >= threshold[i]);
+        bool oddsMet = (odds[i] == 0.0) | (winnings[i] >= wager[i] * odds[i]);
+        flags[i] = static_cast<uint8_t>(reached & oddsMet);
+    }
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include "SessionGenerator.h"
+#include "TaxRulesConfig.h"
+
+namespace
+{
+    void printUsage()
+    {
+        std::cerr << "Usage: gambling-gen [options]\n"
+                  << "  --rows N            Number of session rows to write (default 1000)\n"
+                  << "  --seed N            Random seed; same seed gives the same file (default 1)\n"
+                  << "  --profile NAME      casual | professional | lottery-pool (default casual)\n"
+                  << "  --years FROM-TO     Span of session dates (default 2019-2025)\n"
+                  << "  --unordered         Scatter dates instead of writing them chronologically\n"
+                  << "  --config DIR        Directory holding federal_rules.cfg (default config)\n"
+                  << "  --output FILE       Write to FILE instead of standard output\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    GeneratorOptions options;
+    std::string configDir = "config";
+    std::string outputFile;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        try
+        {
+            if (arg == "--rows" && hasValue)
+            {
+                options.rowCount = std::stoull(argv[++i]);
+            }
+            else if (arg == "--seed" && hasValue)
+            {
+                options.seed = std::stoull(argv[++i]);
+            }
+            else if (arg == "--profile" && hasValue)
+            {
+                if (!SessionGenerator::parseProfile(argv[++i], options.profile))
+                {
+                    std::cerr << "Unknown profile: " << argv[i] << "\n";
+                    return 1;
+                }
+            }
+            else if (arg == "--years" && hasValue)
+            {
+                std::string span = argv[++i];
+                size_t dash = span.find('-');
+                options.startYear = std::stoi(span.substr(0, dash));
+                options.endYear = dash == std::string::npos ? options.startYear : std::stoi(span.substr(dash + 1));
+            }
+            else if (arg == "--unordered")
+            {
+                options.chronological = false;
+            }
+            else if (arg == "--config" && hasValue)
+            {
+                configDir = argv[++i];
+            }
+            else if (arg == "--output" && hasValue)
+            {
+                outputFile = argv[++i];
+            }
+            else
+            {
+                printUsage();
+                return arg == "--help" ? 0 : 1;
+            }
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "Invalid value for " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (options.startYear < 1900 || options.endYear > 2100 || options.startYear > options.endYear)
+    {
+        std::cerr << "Year span must be within 1900-2100\n";
+        return 1;
+    }
+
+    // Keep CSV on the original stdout; config diagnostics go to stderr
+    std::ostream csvOut(std::cout.rdbuf());
+    std::streambuf* originalCout = std::cout.rdbuf(std::cerr.rdbuf());
+    TaxRulesConfig rules(configDir);
+    std::cout.rdbuf(originalCout);
+
+    SessionGenerator generator(options, rules.getFederalRules());
+    uint64_t written = 0;
+
+    if (outputFile.empty())
+    {
+        written = generator.generate(csvOut);
+    }
+    else
+    {
+        std::ofstream file(outputFile, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Could not open " << outputFile << " for writing\n";
+            return 1;
+        }
+        written = generator.generate(file);
+        if (!file)
+        {
+            std::cerr << "Write error on " << outputFile << "\n";
+            return 1;
+        }
+    }
+
+    std::cerr << "Generated " << written << " sessions\n";
+    return 0;
+}
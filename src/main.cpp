@@ -1,9 +1,118 @@
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 #include "ConsoleInterface.h"
+#include "MemoryAccounting.h"
+#include "StartupScheduler.h"
+#include "Trace.h"
 
-int main()
+namespace
 {
-    ConsoleInterface interface;
-    interface.run();
-    return 0;
-}
\ No newline at end of file
+    void printUsage()
+    {
+        std::cerr << "Usage: gambling-calc [options]\n"
+                  << "  --trace FILE              Write a Chrome trace of hot paths to FILE\n"
+                  << "  --mem-report              Print per-subsystem memory usage on exit\n"
+                  << "  --mem-budget TAG=BYTES    Exit with status 2 if TAG's peak exceeds BYTES\n"
+                  << "  --no-autosave             Start empty and don't journal changes to disk\n"
+                  << "  --profile-startup         Print how long each startup step took once the menu is up\n";
+    }
+
+    bool parseBudget(const std::string& spec, std::pair<MemoryTag, uint64_t>& budget)
+    {
+        size_t equals = spec.find('=');
+        if (equals == std::string::npos || !MemoryAccounting::parseTag(spec.substr(0, equals), budget.first))
+        {
+            return false;
+        }
+
+        try
+        {
+            budget.second = std::stoull(spec.substr(equals + 1));
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    StartupProfile::markProcessStart();
+    TraceRecorder::enableFromEnvironment();
+
+    bool memoryReport = false;
+    bool autosave = true;
+    std::vector<std::pair<MemoryTag, uint64_t>> memoryBudgets;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc)
+        {
+            TraceRecorder::enable(argv[++i]);
+        }
+        else if (arg.rfind("--trace=", 0) == 0)
+        {
+            TraceRecorder::enable(arg.substr(8));
+        }
+        else if (arg == "--no-autosave")
+        {
+            autosave = false;
+        }
+        else if (arg == "--profile-startup")
+        {
+            StartupProfile::enable();
+        }
+        else if (arg == "--mem-report")
+        {
+            memoryReport = true;
+        }
+        else if (arg == "--mem-budget" && i + 1 < argc)
+        {
+            std::pair<MemoryTag, uint64_t> budget;
+            if (!parseBudget(argv[++i], budget))
+            {
+                std::cerr << "Invalid memory budget: " << argv[i] << "\n";
+                return 1;
+            }
+            memoryBudgets.push_back(budget);
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (TraceRecorder::isEnabled() && !TraceRecorder::isCompiledIn())
+    {
+        std::cerr << "Note: built without ENABLE_TRACING; the trace will contain no spans.\n";
+    }
+
+    {
+        ConsoleInterface interface(autosave);
+        interface.run();
+    }
+
+    if (memoryReport)
+    {
+        std::cout << "\n" << MemoryAccounting::generateReport();
+    }
+
+    int status = 0;
+    for (const auto& budget : memoryBudgets)
+    {
+        std::string message;
+        if (!MemoryAccounting::checkBudget(budget.first, budget.second, message))
+        {
+            std::cerr << message << "\n";
+            status = 2;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,91 @@
+#include "TestRunner.h"
+#include "../include/GameTypeDictionary.h"
+#include <map>
+
+TEST(GameTypeDictionary, BuiltInNamesIgnoreCaseAndSeparators)
+{
+    GameTypeDictionary dictionary;
+    CHECK(dictionary.getTypeCount() == 15);
+    CHECK(dictionary.getSpellingCount() == 15);
+
+    int slots = dictionary.find("Slot Machine");
+    REQUIRE(slots != GameTypeDictionary::UNKNOWN);
+    CHECK(dictionary.getName(slots) == "Slot Machine");
+    CHECK(dictionary.find("slot_machine") == slots);
+    CHECK(dictionary.find("  SLOT--machine\r\n") == slots);
+    CHECK(dictionary.find("slotmachine") == GameTypeDictionary::UNKNOWN);
+    CHECK(dictionary.find("Slot Machines") == GameTypeDictionary::UNKNOWN);
+    CHECK(dictionary.find("Slot") == GameTypeDictionary::UNKNOWN);
+    CHECK(dictionary.find("") == GameTypeDictionary::UNKNOWN);
+
+    // "Poker" and "Poker Tournament" stay apart
+    CHECK(dictionary.find("poker") != dictionary.find("poker tournament"));
+
+    CHECK(GameTypeDictionary::normalize(" Horse_Racing - ") == "horse racing");
+    CHECK(GameTypeDictionary::normalize("__") == "");
+
+    std::string gameType = "sports-betting";
+    CHECK(dictionary.canonicalize(gameType));
+    CHECK(gameType == "Sports Betting");
+    gameType = "Pachinko";
+    CHECK(!dictionary.canonicalize(gameType));
+    CHECK(gameType == "Pachinko");
+}
+
+TEST(GameTypeDictionary, AliasesFromConfig)
+{
+    TestRunner::ScratchDir scratch;
+    TestRunner::writeFile(scratch.path("game_types.cfg"),
+        "# comment\n"
+        "Slot Machine = Slots, Video-Slots, slot_machine\n"
+        "Lottery = Scratch-off, Powerball\n"
+        "Pachinko\n"
+        "Keno = Slots\n"
+        " = orphan\n");
+
+    GameTypeDictionary dictionary;
+    CHECK(!dictionary.load(scratch.path("missing.cfg")));
+    REQUIRE(dictionary.load(scratch.path("game_types.cfg")));
+
+    // New canonical name; a repeated spelling and a conflicting alias are not added
+    CHECK(dictionary.getTypeCount() == 16);
+    CHECK(dictionary.getSpellingCount() == 20);
+    CHECK(dictionary.getName(dictionary.find("video slots")) == "Slot Machine");
+    CHECK(dictionary.getName(dictionary.find("SLOTS")) == "Slot Machine");
+    CHECK(dictionary.getName(dictionary.find("scratch off")) == "Lottery");
+    CHECK(dictionary.getName(dictionary.find("pachinko")) == "Pachinko");
+    CHECK(dictionary.find("orphan") == GameTypeDictionary::UNKNOWN);
+
+    CHECK(dictionary.addAlias("Keno", "Quick Keno"));
+    CHECK(!dictionary.addAlias("Keno", "Powerball"));
+    CHECK(dictionary.getName(dictionary.find("quick_keno")) == "Keno");
+    CHECK(dictionary.getName(dictionary.find("Powerball")) == "Lottery");
+
+    // Every spelling still lands in its own slot after growing the table
+    for (int i = 0; i < 200; i++)
+    {
+        CHECK(dictionary.addAlias("Other", "Alias " + std::to_string(i)));
+    }
+    for (int i = 0; i < 200; i++)
+    {
+        CHECK(dictionary.getName(dictionary.find("alias_" + std::to_string(i))) == "Other");
+    }
+    CHECK(dictionary.getName(dictionary.find("Slots")) == "Slot Machine");
+    CHECK(dictionary.find("alias 200") == GameTypeDictionary::UNKNOWN);
+}
+
+TEST(GameTypeDictionary, UnknownReportListsMostCommonFirst)
+{
+    GameTypeDictionary dictionary;
+    CHECK(dictionary.generateUnknownReport({}).find("matched the dictionary") != std::string::npos);
+
+    std::map<std::string, size_t> unknown = {{"Pachinko", 3}, {"", 1}, {"Mahjong", 12}};
+    std::string report = dictionary.generateUnknownReport(unknown);
+    CHECK(report.find("3 unrecognized spellings on 16 records") != std::string::npos);
+    size_t mahjong = report.find("Mahjong");
+    size_t pachinko = report.find("Pachinko");
+    size_t blank = report.find("(blank)");
+    REQUIRE(mahjong != std::string::npos && pachinko != std::string::npos && blank != std::string::npos);
+    CHECK(mahjong < pachinko && pachinko < blank);
+    CHECK(report.find("Known types: Lottery, Sweepstakes") != std::string::npos);
+}
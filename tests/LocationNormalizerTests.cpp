@@ -0,0 +1,86 @@
+#include "TestRunner.h"
+#include "../include/LocationNormalizer.h"
+
+namespace
+{
+    LocationNormalizer makeVenues()
+    {
+        LocationNormalizer venues;
+        venues.addVenue("Bellagio");
+        venues.addVenue("Circa", {"Circa Resort", "Circa Las Vegas"});
+        venues.addVenue("Hard Rock Atlantic City", {"Hard Rock AC"});
+        venues.addVenue("Parx Casino", {"Parx"});
+        venues.addVenue("Mohegan Sun");
+        venues.addVenue("Mohegan Pennsylvania", {"Mohegan Sun Pocono"});
+        venues.addVenue("Wynn Las Vegas", {"Wynn LV"});
+        return venues;
+    }
+
+    std::string normalized(LocationNormalizer& venues, std::string location)
+    {
+        venues.normalize(location);
+        return location;
+    }
+}
+
+TEST(LocationNormalizer, FoldIgnoresCaseAndPunctuation)
+{
+    CHECK(LocationNormalizer::fold("BELLAGIO - Las Vegas, NV") == "bellagio las vegas nv");
+    CHECK(LocationNormalizer::fold("  Wynn's   LV ") == "wynn s lv");
+    CHECK(LocationNormalizer::fold("...") == "");
+}
+
+TEST(LocationNormalizer, EditDistance)
+{
+    CHECK(LocationNormalizer::editDistance("bellagio", "belagio", false) == 1);
+    CHECK(LocationNormalizer::editDistance("bellagio", "bellagio las vegas", false) == 10);
+    CHECK(LocationNormalizer::editDistance("bellagio", "the belagio las vegas", true) == 1);
+    CHECK(LocationNormalizer::wordDistance("bellagio", "the belagio las vegas") == 1);
+
+    // Whole words only: a name inside a longer word is not found
+    CHECK(LocationNormalizer::editDistance("circa", "circadian lounge", true) == 0);
+    CHECK(LocationNormalizer::wordDistance("circa", "circadian lounge") > 0);
+    CHECK(LocationNormalizer::wordDistance("circa resort", "the circa resort spa") == 0);
+}
+
+TEST(LocationNormalizer, MatchesSpellingsOfListedVenues)
+{
+    LocationNormalizer venues = makeVenues();
+    CHECK(normalized(venues, "BELLAGIO LAS VEGAS") == "Bellagio");
+    CHECK(normalized(venues, "Belagio") == "Bellagio");
+    CHECK(normalized(venues, "Circa Resort & Casino") == "Circa");
+    CHECK(normalized(venues, "Hard Rock Atlantc City NJ") == "Hard Rock Atlantic City");
+    CHECK(normalized(venues, "hard rock ac") == "Hard Rock Atlantic City");
+    CHECK(normalized(venues, "PARX") == "Parx Casino");
+    CHECK(normalized(venues, "Wynn LV") == "Wynn Las Vegas");
+
+    // The longest name wins over one it contains
+    CHECK(normalized(venues, "Mohegan Sun Pocono Downs") == "Mohegan Pennsylvania");
+}
+
+TEST(LocationNormalizer, KeepsVenuesThatAreNotListed)
+{
+    LocationNormalizer venues = makeVenues();
+    std::string location = "Circadian Lounge";
+    CHECK(!venues.normalize(location));
+    CHECK(location == "Circadian Lounge");
+    CHECK(venues.match("Parxton Pub") == LocationNormalizer::NO_MATCH);
+    CHECK(venues.match("Hard Rock Hollywood") == LocationNormalizer::NO_MATCH);
+    CHECK(venues.match("Parx Pub") == LocationNormalizer::NO_MATCH);         // Short names match whole locations only
+    CHECK(venues.match("Wynn LA") == LocationNormalizer::NO_MATCH);          // Abbreviations allow no edits
+    CHECK(venues.match("Local Bar") == LocationNormalizer::NO_MATCH);
+}
+
+TEST(LocationNormalizer, CachesDecisionsPerSpelling)
+{
+    LocationNormalizer venues = makeVenues();
+    venues.match("Belagio");
+    venues.match("Belagio");
+    venues.match("Local Bar");
+    CHECK(venues.getCachedCount() == 2);
+
+    // A new venue clears decisions that may have missed it
+    venues.addVenue("Local Bar Casino");
+    CHECK(venues.getCachedCount() == 0);
+    CHECK(normalized(venues, "Local Bar Casino") == "Local Bar Casino");
+}
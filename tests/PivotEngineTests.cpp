@@ -0,0 +1,130 @@
+#include "TestRunner.h"
+#include "../include/PivotEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+
+namespace
+{
+    // Enough records that the engine splits the scan across several threads
+    std::vector<GamblingSession> makeSessions(size_t count)
+    {
+        const char* states[] = {"NV", "NJ", "PA", "MI"};
+        const char* games[] = {"Slot Machine", "Poker", "Blackjack"};
+        std::vector<GamblingSession> sessions;
+        for (size_t i = 0; i < count; i++)
+        {
+            std::string date = (i % 12 < 9 ? "0" : "") + std::to_string(1 + i % 12) + "-1" + std::to_string(i % 10) +
+                               "-20" + std::to_string(20 + i % 5);
+            sessions.push_back(GamblingSession(date, "Casino " + std::to_string(i % 7), states[i % 4], games[i % 3],
+                                               100.0, static_cast<double>((i * 37) % 251), false, 0.0, "", ""));
+        }
+        return sessions;
+    }
+
+    std::vector<TicketBatch> makeBatches()
+    {
+        std::vector<TicketBatch> batches;
+        for (int i = 0; i < 5; i++)
+        {
+            TicketBatch batch("02-1" + std::to_string(i) + "-2021", "Store", "NJ", "Lottery");
+            for (int t = 0; t <= i; t++) batch.addTicket(2.0 + t);
+            batches.push_back(batch);
+        }
+        return batches;
+    }
+
+    bool near(double a, double b)
+    {
+        return std::fabs(a - b) < 0.005;
+    }
+
+    // Group-by with a std::map, one record at a time
+    std::map<std::vector<std::string>, std::vector<double>> bruteForce(const std::vector<GamblingSession>& sessions,
+                                                                      const std::vector<TicketBatch>& batches)
+    {
+        std::map<std::vector<std::string>, std::vector<double>> groups;
+        auto add = [&groups](const std::string& state, const std::string& date, double net)
+        {
+            std::vector<std::string> key = {state, date.substr(6, 4) + "-" + date.substr(0, 2)};
+            std::vector<double>& values = groups[key];
+            values.resize(4, 0.0);
+            values[0] += net;
+            values[1] += 1;
+            values[2] = std::max(values[2], net);
+            values[3] = std::max(values[3], -net);
+        };
+        for (const auto& session : sessions) add(session.getState(), session.getDate(), session.getNetResult());
+        for (const auto& batch : batches) add(batch.getState(), batch.getDate(), -batch.getTotalLosses());
+        return groups;
+    }
+}
+
+TEST(PivotEngine, GroupsMatchAStraightGroupBy)
+{
+    std::vector<GamblingSession> sessions = makeSessions(40000);
+    std::vector<TicketBatch> batches = makeBatches();
+    PivotQuery query({PivotKey::STATE, PivotKey::MONTH},
+                     {PivotMeasure::NET, PivotMeasure::COUNT, PivotMeasure::MAX_WIN, PivotMeasure::MAX_LOSS});
+    auto expected = bruteForce(sessions, batches);
+
+    SessionChunks chunks;
+    for (const auto& session : sessions) chunks.pushBack(GamblingSession(session));
+
+    for (unsigned threads : {1u, 2u, 8u})
+    {
+        for (int chunked = 0; chunked < 2; chunked++)
+        {
+            PivotResult result = chunked ? PivotEngine::run(chunks, batches, query, threads)
+                                         : PivotEngine::run(sessions, batches, query, threads);
+            REQUIRE(result.rows.size() == expected.size());
+
+            // Rows come sorted by key, as the map is
+            size_t row = 0;
+            double count = 0;
+            for (const auto& group : expected)
+            {
+                CHECK(result.rows[row].key == group.first);
+                for (size_t i = 0; i < group.second.size(); i++)
+                {
+                    CHECK(near(result.rows[row].values[i], group.second[i]));
+                }
+                count += group.second[1];
+                row++;
+            }
+            CHECK(near(result.total.values[1], count));
+            CHECK(result.total.key.empty());
+        }
+    }
+}
+
+TEST(PivotEngine, DateKeysAndMeasures)
+{
+    std::vector<GamblingSession> sessions = {
+        GamblingSession("12-31-2023", "A", "NV", "Poker", 100.0, 400.0, false, 0.0, "", ""),
+        GamblingSession("01-02-2024", "A", "NV", "Poker", 100.0, 0.0, false, 0.0, "", ""),
+        GamblingSession("01-02-2024", "B", "NV", "Poker", 50.0, 80.0, false, 0.0, "", ""),
+        GamblingSession("", "C", "NV", "Poker", 10.0, 0.0, false, 0.0, "", ""),
+    };
+    PivotQuery query({PivotKey::DATE},
+                     {PivotMeasure::WINNINGS, PivotMeasure::LOSSES, PivotMeasure::NET, PivotMeasure::COUNT});
+    PivotResult result = PivotEngine::run(sessions, {}, query, 1);
+
+    // Chronological order; a record without a date is grouped under its raw text
+    REQUIRE(result.rows.size() == 3);
+    CHECK(result.rows[0].key[0] == "");
+    CHECK(result.rows[1].key[0] == "2023-12-31");
+    CHECK(result.rows[2].key[0] == "2024-01-02");
+    CHECK(near(result.rows[2].values[0], 30.0));
+    CHECK(near(result.rows[2].values[1], 100.0));
+    CHECK(near(result.rows[2].values[2], -70.0));
+    CHECK(near(result.rows[2].values[3], 2.0));
+    CHECK(near(result.total.values[0], 330.0));
+    CHECK(near(result.total.values[1], 110.0));
+
+    std::ostringstream csv;
+    PivotEngine::writeCSV(csv, result);
+    CHECK(csv.str().find("Date,Winnings,Losses,Net,Count\n") == 0);
+    CHECK(csv.str().find("\n2024-01-02,") != std::string::npos);
+}
@@ -0,0 +1,132 @@
+#include "TestRunner.h"
+#include "../include/ScenarioEngine.h"
+#include <cmath>
+
+namespace
+{
+    // Round numbers so the expected taxes can be worked out by hand
+    const char* BRACKETS =
+        "[FEDERAL 2024 single]\n"
+        "0 = 0.10\n"
+        "10000 = 0.20\n"
+        "[FEDERAL 2024 married_jointly]\n"
+        "0 = 0.10\n";
+
+    void useSimpleRules(TaxCalculator& calculator, const TestRunner::ScratchDir& scratch)
+    {
+        TestRunner::writeFile(scratch.path("tax_brackets.cfg"), BRACKETS);
+        calculator.getTaxRules().loadTaxBrackets();
+        FederalTaxRules rules = calculator.getTaxRules().getFederalRules();
+        rules.standardDeduction = 1000.0;
+        rules.standardDeductionMarried = 2000.0;
+        calculator.getTaxRules().setFederalRules(rules);
+    }
+
+    SessionAggregate makeTotals(double winnings, double losses)
+    {
+        SessionAggregate totals;
+        totals.totalWinnings = winnings;
+        totals.totalLosses = losses;
+        totals.addStateTotals("NJ", winnings, losses);
+        return totals;
+    }
+
+    TaxScenario makeScenario(int year, bool professional, FilingStatus status, double limit = -1.0)
+    {
+        TaxScenario scenario;
+        scenario.taxYear = year;
+        scenario.professional = professional;
+        scenario.filingStatus = status;
+        scenario.lossDeductionLimit = limit;
+        return scenario;
+    }
+
+    bool near(double a, double b)
+    {
+        return std::fabs(a - b) < 0.005;
+    }
+}
+
+TEST(ScenarioEngine, CasualAndProfessionalLossBenefit)
+{
+    TestRunner::ScratchDir scratch;
+    TaxCalculator calculator(false, scratch.str());
+    useSimpleRules(calculator, scratch);
+    ScenarioEngine engine(calculator);
+
+    std::vector<ScenarioResult> results = engine.evaluate(makeTotals(30000.0, 5000.0), {
+        makeScenario(2024, false, FilingStatus::SINGLE),
+        makeScenario(2024, true, FilingStatus::SINGLE),
+        makeScenario(2024, false, FilingStatus::SINGLE, 0.1),
+    });
+    REQUIRE(results.size() == 3);
+
+    // Casual: losses only help beyond the $1,000 standard deduction
+    CHECK(near(results[0].deductibleLosses, 5000.0));
+    CHECK(results[0].itemize);
+    CHECK(near(results[0].effectiveLossDeduction, 4000.0));
+    CHECK(near(results[0].netTaxableGambling, 26000.0));
+    CHECK(near(results[0].federalTax, 10000 * 0.10 + 15000 * 0.20));
+    CHECK(near(results[0].marginalRate, 0.20));
+
+    // Professional: every allowed dollar of loss counts
+    CHECK(near(results[1].effectiveLossDeduction, 5000.0));
+    CHECK(near(results[1].federalTax, 10000 * 0.10 + 14000 * 0.20));
+
+    // Losses under the standard deduction bring no benefit
+    CHECK(near(results[2].deductibleLosses, 500.0));
+    CHECK(!results[2].itemize);
+    CHECK(near(results[2].effectiveLossDeduction, 0.0));
+    CHECK(near(results[2].federalTax, 10000 * 0.10 + 19000 * 0.20));
+
+    // State tax does not depend on the scenario
+    double stateTax = calculator.calculateStateTax("NJ", 30000.0, 5000.0);
+    for (const auto& result : results)
+    {
+        CHECK(near(result.stateTax, stateTax));
+    }
+}
+
+TEST(ScenarioEngine, YearLimitStatusAndLossCap)
+{
+    TestRunner::ScratchDir scratch;
+    TaxCalculator calculator(false, scratch.str());
+    useSimpleRules(calculator, scratch);
+    ScenarioEngine engine(calculator);
+
+    std::vector<ScenarioResult> results = engine.evaluate(makeTotals(30000.0, 5000.0), {
+        makeScenario(2026, false, FilingStatus::SINGLE),
+        makeScenario(2024, false, FilingStatus::MARRIED_FILING_JOINTLY, 0.5),
+    });
+    REQUIRE(results.size() == 2);
+
+    // 2026 limits losses to 90%; the brackets fall back to 2024
+    CHECK(near(results[0].lossDeductionLimit, 0.9));
+    CHECK(near(results[0].deductibleLosses, 4500.0));
+    CHECK(near(results[0].federalTax, 10000 * 0.10 + 15500 * 0.20));
+
+    // An explicit limit overrides the year's; married uses its own deduction and schedule
+    CHECK(near(results[1].deductibleLosses, 2500.0));
+    CHECK(near(results[1].standardDeduction, 2000.0));
+    CHECK(near(results[1].effectiveLossDeduction, 500.0));
+    CHECK(near(results[1].federalTax, 27500 * 0.10));
+
+    // Losses beyond winnings are not deductible
+    std::vector<ScenarioResult> capped = engine.evaluate(makeTotals(3000.0, 9000.0),
+                                                         {makeScenario(2024, true, FilingStatus::SINGLE)});
+    CHECK(near(capped[0].deductibleLosses, 3000.0));
+    CHECK(near(capped[0].netTaxableGambling, 0.0));
+    CHECK(near(capped[0].federalTax, 0.0));
+}
+
+TEST(ScenarioEngine, StandardSweepCoversEveryStatus)
+{
+    std::vector<TaxScenario> sweep = ScenarioEngine::standardSweep(2024);
+    CHECK(sweep.size() == 16);    // 2024 and 2026, casual and professional, four statuses
+    CHECK(sweep.front().taxYear == 2024);
+    CHECK(sweep.back().taxYear == 2026);
+    CHECK(sweep.back().professional);
+    CHECK(sweep.front().name == "2024 Casual Single");
+
+    CHECK(ScenarioEngine::standardSweep(2026).size() == 8);
+}
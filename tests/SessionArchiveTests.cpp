@@ -0,0 +1,148 @@
+#include "TestRunner.h"
+#include "../include/SessionArchive.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    std::vector<GamblingSession> makeSessions(size_t count)
+    {
+        std::vector<GamblingSession> sessions;
+        for (size_t i = 0; i < count; i++)
+        {
+            sessions.push_back(GamblingSession("04-0" + std::to_string(1 + i % 9) + "-2024", "Casino " + std::to_string(i % 3),
+                                               "NV", i % 2 ? "Blackjack" : "Slot Machine", 20.0 + i, 10.0 * i,
+                                               false, 0.0, "", "row " + std::to_string(i)));
+        }
+        return sessions;
+    }
+
+    std::vector<TicketBatch> makeBatches()
+    {
+        TicketBatch batch("04-05-2024", "Store", "NV", "Lottery");
+        batch.addTicket(2.0);
+        batch.addTicket(5.0);
+        return std::vector<TicketBatch>{batch};
+    }
+
+    std::string archiveBytes(const std::vector<GamblingSession>& sessions, const std::vector<TicketBatch>& batches,
+                             size_t blockRows = 8)
+    {
+        std::ostringstream out;
+        {
+            ArchiveWriter writer(out, blockRows);
+            for (const auto& session : sessions) writer.add(session);
+            for (const auto& batch : batches) writer.add(batch);
+        }
+        return out.str();
+    }
+
+    size_t readArchive(const std::string& bytes)
+    {
+        std::istringstream in(bytes);
+        ArchiveReader reader(in);
+        size_t records = 0;
+        reader.read([&records](GamblingSession&) { records++; }, [&records](TicketBatch&) { records++; });
+        return records;
+    }
+
+    std::vector<std::string> archiveRows(const std::string& bytes)
+    {
+        std::istringstream in(bytes);
+        ArchiveReader reader(in);
+        std::vector<std::string> rows;
+        reader.read([&rows](GamblingSession& session) { rows.push_back(session.toCSV()); },
+                    [&rows](TicketBatch& batch) { rows.push_back(batch.toCSV()); });
+        return rows;
+    }
+}
+
+TEST(SessionArchive, RoundTripsAcrossBlocks)
+{
+    std::vector<GamblingSession> sessions = makeSessions(30);
+    std::vector<std::string> rows = archiveRows(archiveBytes(sessions, makeBatches()));
+    REQUIRE(rows.size() == 31);
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        CHECK(rows[i] == sessions[i].toCSV());
+    }
+    CHECK(rows.back() == makeBatches()[0].toCSV());
+}
+
+TEST(SessionArchive, RejectsEverySingleByteCorruption)
+{
+    std::string bytes = archiveBytes(makeSessions(20), makeBatches());
+    std::istringstream header(bytes);
+    ArchiveReader reader(header);
+    size_t dataStart = static_cast<size_t>(header.tellg());
+
+    size_t accepted = 0;
+    for (size_t i = dataStart; i < bytes.size(); i++)
+    {
+        std::string damaged = bytes;
+        damaged[i] = static_cast<char>(damaged[i] ^ 0x20);
+        try
+        {
+            readArchive(damaged);
+            accepted++;
+            TestRunner::fail(__FILE__, __LINE__, "corrupt byte " + std::to_string(i) + " was accepted");
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+    }
+    CHECK(accepted == 0);
+}
+
+TEST(SessionArchive, RejectsEveryTruncation)
+{
+    std::string bytes = archiveBytes(makeSessions(20), makeBatches());
+    for (size_t length = 0; length < bytes.size(); length++)
+    {
+        CHECK_THROWS(std::runtime_error, readArchive(bytes.substr(0, length)));
+    }
+    CHECK(readArchive(bytes) == 21);
+}
+
+TEST(SessionArchive, KeepsWideValueRanges)
+{
+    // Dates out of order and decades apart, amounts from a cent to millions,
+    // text repeated and unique, so deltas go negative and bit widths vary
+    std::vector<GamblingSession> sessions;
+    const char* dates[] = {"12-31-2030", "01-01-1990", "06-15-2024", "06-15-2024", "02-29-2000"};
+    for (size_t i = 0; i < 25; i++)
+    {
+        bool withheld = i % 4 == 0;
+        sessions.push_back(GamblingSession(dates[i % 5], i % 3 ? "Borgata" : "Caesars, Atlantic City", i % 2 ? "NJ" : "PA",
+                                           "Poker", i % 2 ? 0.01 : 2500000.0 + i, 0.07 * i * i * i, withheld,
+                                           withheld ? 24.0 * i : 0.0, i % 7 ? "" : "W-2G", "note " + std::to_string(i * 7919)));
+    }
+    std::vector<TicketBatch> batches;
+    for (size_t b = 0; b < 3; b++)
+    {
+        TicketBatch batch(dates[b], "Store " + std::to_string(b), "NY", "Lottery");
+        for (size_t t = 0; t < 40 * b; t++) batch.addTicket(t % 2 ? 1.0 : 30.0 + t);
+        batches.push_back(batch);
+    }
+
+    // Each kind keeps its order; sessions and batches are stored in separate blocks
+    for (size_t blockRows : {1, 4, 1000})
+    {
+        std::istringstream in(archiveBytes(sessions, batches, blockRows));
+        ArchiveReader reader(in);
+        std::vector<std::string> sessionRows, batchRows;
+        reader.read([&sessionRows](GamblingSession& session) { sessionRows.push_back(session.toCSV()); },
+                    [&batchRows](TicketBatch& batch) { batchRows.push_back(batch.toCSV()); });
+        REQUIRE(sessionRows.size() == sessions.size());
+        REQUIRE(batchRows.size() == batches.size());
+        for (size_t i = 0; i < sessions.size(); i++)
+        {
+            CHECK(sessionRows[i] == sessions[i].toCSV());
+        }
+        for (size_t b = 0; b < batches.size(); b++)
+        {
+            CHECK(batchRows[b] == batches[b].toCSV());
+        }
+    }
+    CHECK(readArchive(archiveBytes({}, {})) == 0);
+}
@@ -0,0 +1,116 @@
+#include "TestRunner.h"
+#include "../include/SessionDatabase.h"
+#include "../include/TaxCalculator.h"
+#include <cmath>
+
+namespace
+{
+    GamblingSession makeSession(size_t index, double net = 10.0)
+    {
+        return GamblingSession("03-01-2024", "Casino " + std::to_string(index), "NV", "Slot Machine",
+                               100.0, 100.0 + net, false, 0.0, "", "");
+    }
+
+    SessionChunks makeList(size_t count)
+    {
+        SessionChunks list;
+        for (size_t i = 0; i < count; i++) list.pushBack(makeSession(i));
+        return list;
+    }
+
+    bool sameCents(double a, double b)
+    {
+        return std::llround(a * 100.0) == std::llround(b * 100.0);
+    }
+}
+
+TEST(SessionChunks, SnapshotKeepsItsSessions)
+{
+    const size_t count = 3 * SessionChunks::CHUNK_SIZE + 7;
+    SessionChunks list = makeList(count);
+    SessionChunks snapshot = list;
+    CHECK(snapshot.sharedChunks(list) == list.chunkCount());
+
+    list.set(5, makeSession(99999));
+    list.pushBack(makeSession(count));
+    list.swapRemove(SessionChunks::CHUNK_SIZE + 1);
+    list.popBack();
+
+    REQUIRE(snapshot.size() == count);
+    for (size_t i = 0; i < count; i++)
+    {
+        CHECK(snapshot[i].getLocation() == "Casino " + std::to_string(i));
+    }
+    CHECK(list[5].getLocation() == "Casino 99999");
+    CHECK(list[SessionChunks::CHUNK_SIZE + 1].getLocation() == "Casino " + std::to_string(count));
+    CHECK(list.size() == count - 1);
+}
+
+TEST(SessionChunks, WriteCopiesOnlyTheChunkItChanges)
+{
+    SessionChunks list = makeList(4 * SessionChunks::CHUNK_SIZE);
+    SessionChunks snapshot = list;
+    list.set(2 * SessionChunks::CHUNK_SIZE, makeSession(7, 50.0));
+    CHECK(list.sharedChunks(snapshot) == list.chunkCount() - 1);
+
+    // Unshared now, so further writes to the same chunk copy nothing more
+    list.set(2 * SessionChunks::CHUNK_SIZE + 1, makeSession(8, 50.0));
+    CHECK(list.sharedChunks(snapshot) == list.chunkCount() - 1);
+}
+
+TEST(SessionChunks, ClearLeavesSnapshotsIntact)
+{
+    SessionChunks list = makeList(10);
+    SessionChunks snapshot = list;
+    list.clear();
+    CHECK(list.empty());
+    CHECK(snapshot.size() == 10);
+    CHECK(snapshot[9].getLocation() == "Casino 9");
+}
+
+TEST(SessionChunks, AggregateMatchesSequentialTotalsAfterEdits)
+{
+    TestRunner::ScratchDir scratch;
+    TaxCalculator calculator(false, scratch.str());
+    SessionDatabase sessions;
+    std::vector<SessionId> ids;
+    for (size_t i = 0; i < 2 * SessionChunks::CHUNK_SIZE + 100; i++)
+    {
+        ids.push_back(sessions.insert(makeSession(i, (i % 7) * 3.25 - 9.0)));
+    }
+    SessionAggregate before = calculator.aggregate(sessions.snapshot(), {});
+
+    sessions.erase(ids[10]);
+    sessions.update(ids[SessionChunks::CHUNK_SIZE + 3], makeSession(1, 2500.0));
+    SessionChunks snapshot = sessions.snapshot();
+    SessionAggregate cached = calculator.aggregate(snapshot, {});
+
+    std::vector<GamblingSession> flat(snapshot.begin(), snapshot.end());
+    SessionAggregate sequential = calculator.aggregate(flat, {});
+    CHECK(cached.sessionCount == sequential.sessionCount);
+    CHECK(sameCents(cached.totalWinnings, sequential.totalWinnings));
+    CHECK(sameCents(cached.totalLosses, sequential.totalLosses));
+    CHECK(cached.missedWithholding == sequential.missedWithholding);
+    CHECK(cached.sessionCount == before.sessionCount - 1);
+}
+
+TEST(SessionChunks, CachedTotalsFollowTheRulesVersion)
+{
+    TestRunner::ScratchDir scratch;
+    TaxCalculator calculator(false, scratch.str());
+    SessionChunks list = makeList(10);
+    list.set(3, makeSession(3, 1500.0));     // Over the $1,200 slot threshold, nothing withheld
+
+    uint64_t version = calculator.getTaxRules().getRulesVersion();
+    CHECK(list.aggregate(calculator).missedWithholding);
+
+    FederalTaxRules rules = calculator.getTaxRules().getFederalRules();
+    for (auto& threshold : rules.withholdingThresholds) threshold.second = 5000.0;
+    calculator.getTaxRules().setFederalRules(rules);
+    CHECK(calculator.getTaxRules().getRulesVersion() != version);
+    CHECK(!list.aggregate(calculator).missedWithholding);
+
+    // A copy of the calculator shares its rules, and so its version
+    TaxCalculator copy = calculator;
+    CHECK(copy.getTaxRules().getRulesVersion() == calculator.getTaxRules().getRulesVersion());
+}
@@ -0,0 +1,132 @@
+#include "TestRunner.h"
+#include "../include/SessionDatabase.h"
+
+namespace
+{
+    GamblingSession makeSession(int index)
+    {
+        return GamblingSession("01-15-2024", "Casino " + std::to_string(index), "NV", "Blackjack",
+                               100.0, 100.0 + index, false, 0.0, "", "");
+    }
+
+    // Every ID resolves to the session at its dense position
+    void checkConsistent(const SessionDatabase& sessions)
+    {
+        for (size_t i = 0; i < sessions.size(); i++)
+        {
+            SessionId id = sessions.idAt(i);
+            REQUIRE(sessions.find(id) != nullptr);
+            CHECK(sessions.find(id) == &sessions[i]);
+            CHECK(sessions.positionOf(id) == i);
+        }
+    }
+}
+
+TEST(SessionDatabase, StaleIdDoesNotResolveAfterSlotReuse)
+{
+    SessionDatabase sessions;
+    SessionId first = sessions.insert(makeSession(1));
+    REQUIRE(sessions.erase(first));
+    CHECK(!sessions.contains(first));
+    CHECK(!sessions.erase(first));
+
+    // The freed slot is reused with a new generation
+    SessionId second = sessions.insert(makeSession(2));
+    CHECK(second.slot == first.slot);
+    CHECK(second.generation != first.generation);
+    CHECK(!sessions.contains(first));
+    CHECK(sessions.find(first) == nullptr);
+    REQUIRE(sessions.find(second) != nullptr);
+    CHECK(sessions.find(second)->getLocation() == "Casino 2");
+    CHECK(!sessions.update(first, makeSession(3)));
+}
+
+TEST(SessionDatabase, FreeListReusesMostRecentlyFreedSlotFirst)
+{
+    SessionDatabase sessions;
+    std::vector<SessionId> ids;
+    for (int i = 0; i < 5; i++) ids.push_back(sessions.insert(makeSession(i)));
+
+    sessions.erase(ids[1]);
+    sessions.erase(ids[3]);
+    CHECK(sessions.insert(makeSession(10)).slot == ids[3].slot);
+    CHECK(sessions.insert(makeSession(11)).slot == ids[1].slot);
+    CHECK(sessions.insert(makeSession(12)).slot == 5);
+    CHECK(sessions.size() == 6);
+    checkConsistent(sessions);
+}
+
+TEST(SessionDatabase, EraseMovesLastSessionIntoTheGap)
+{
+    SessionDatabase sessions;
+    std::vector<SessionId> ids;
+    for (int i = 0; i < 4; i++) ids.push_back(sessions.insert(makeSession(i)));
+
+    REQUIRE(sessions.erase(ids[0]));
+    CHECK(sessions.size() == 3);
+    CHECK(sessions[0].getLocation() == "Casino 3");
+    CHECK(sessions.idAt(0) == ids[3]);
+    CHECK(sessions.find(ids[3])->getLocation() == "Casino 3");
+    checkConsistent(sessions);
+
+    // Erasing the last position moves nothing
+    REQUIRE(sessions.erase(ids[2]));
+    CHECK(sessions.size() == 2);
+    CHECK(sessions[1].getLocation() == "Casino 1");
+    checkConsistent(sessions);
+}
+
+TEST(SessionDatabase, InsertWithIdRebuildsTheFreeList)
+{
+    SessionDatabase sessions;
+    REQUIRE(sessions.insertWithId(SessionId(3, 1), makeSession(3)));
+    REQUIRE(sessions.insertWithId(SessionId(1, 5), makeSession(1)));
+    CHECK(!sessions.insertWithId(SessionId(3, 1), makeSession(9)));     // Slot taken
+    CHECK(!sessions.insertWithId(SessionId(0, 2), makeSession(9)));     // Even generation names no session
+
+    // Slots 0 and 2 are free; new inserts must not land on 1 or 3
+    SessionId a = sessions.insert(makeSession(10));
+    SessionId b = sessions.insert(makeSession(11));
+    CHECK(a.slot == 0);
+    CHECK(b.slot == 2);
+    CHECK(sessions.insert(makeSession(12)).slot == 4);
+    CHECK(sessions.find(SessionId(1, 5))->getLocation() == "Casino 1");
+    checkConsistent(sessions);
+}
+
+TEST(SessionDatabase, ClearInvalidatesEveryId)
+{
+    SessionDatabase sessions;
+    SessionId a = sessions.insert(makeSession(1));
+    SessionId b = sessions.insert(makeSession(2));
+    sessions.clear();
+    CHECK(sessions.empty());
+    CHECK(!sessions.contains(a));
+    CHECK(!sessions.contains(b));
+
+    SessionId c = sessions.insert(makeSession(3));
+    CHECK(c != a && c != b);
+    CHECK(!sessions.contains(a) && !sessions.contains(b));
+}
+
+TEST(SessionDatabase, PositionOfSpansChunks)
+{
+    // More sessions than one chunk holds, so positions cross chunk boundaries
+    SessionDatabase sessions;
+    std::vector<SessionId> ids;
+    for (int i = 0; i < 3000; i++) ids.push_back(sessions.insert(makeSession(i)));
+
+    CHECK(sessions.positionOf(ids[2500]) == 2500);
+    REQUIRE(sessions.erase(ids[10]));
+    CHECK(sessions.positionOf(ids[2999]) == 10);
+    CHECK(sessions.positionOf(ids[10]) == sessions.size());
+    CHECK(sessions.positionOf(SessionId()) == sessions.size());
+    checkConsistent(sessions);
+}
+
+TEST(SessionDatabase, PackedIdRoundTrips)
+{
+    SessionId id(0xABCDu, 0x1234567u);
+    CHECK(SessionId::fromInteger(id.toInteger()) == id);
+    CHECK(!SessionId().isValid());
+}
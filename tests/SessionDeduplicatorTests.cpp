@@ -0,0 +1,99 @@
+#include "TestRunner.h"
+#include "../include/SessionDeduplicator.h"
+
+namespace
+{
+    GamblingSession makeSession(double cashOut, const std::string& notes = "")
+    {
+        return GamblingSession("03-10-2024", "Borgata", "NJ", "Slots", 100.0, cashOut, false, 0.0, "", notes);
+    }
+}
+
+TEST(SessionDeduplicator, HashIgnoresNotesButNotAmounts)
+{
+    CHECK(SessionHashIndex::hashSession(makeSession(50.0)) == SessionHashIndex::hashSession(makeSession(50.0, "x")));
+    CHECK(SessionHashIndex::hashSession(makeSession(50.0)) != SessionHashIndex::hashSession(makeSession(50.01)));
+
+    TicketBatch batch("03-10-2024", "Borgata", "NJ", "Lottery");
+    batch.addTicket(5.0);
+    TicketBatch longer = batch;
+    longer.addTicket(5.0);
+    CHECK(SessionHashIndex::hashBatch(batch) != SessionHashIndex::hashBatch(longer));
+}
+
+TEST(SessionDeduplicator, ImportMatchesOnlyCopiesLoadedBeforeIt)
+{
+    SessionHashIndex index;
+    index.add(SessionHashIndex::hashSession(makeSession(50.0)));
+    index.add(SessionHashIndex::hashSession(makeSession(50.0)));
+
+    // Two copies were loaded, so the third identical incoming session is new
+    MergeStats stats;
+    index.beginImport();
+    for (int i = 0; i < 3; i++)
+    {
+        GamblingSession session = makeSession(50.0);
+        index.admit(session, DuplicateMode::SKIP, stats);
+    }
+    CHECK(stats.skipped == 2);
+    CHECK(stats.added == 1);
+    CHECK(index.count(SessionHashIndex::hashSession(makeSession(50.0))) == 3);
+
+    // Copies added by one import are matched by the next
+    MergeStats again;
+    index.beginImport();
+    for (int i = 0; i < 4; i++)
+    {
+        GamblingSession session = makeSession(50.0);
+        index.admit(session, DuplicateMode::SKIP, again);
+    }
+    CHECK(again.skipped == 3);
+    CHECK(again.added == 1);
+}
+
+TEST(SessionDeduplicator, FlagKeepsAndMarksDuplicates)
+{
+    SessionHashIndex index;
+    index.add(SessionHashIndex::hashSession(makeSession(50.0)));
+
+    MergeStats stats;
+    index.beginImport();
+    GamblingSession duplicate = makeSession(50.0, "from bank");
+    GamblingSession fresh = makeSession(75.0);
+    CHECK(index.admit(duplicate, DuplicateMode::FLAG, stats));
+    CHECK(index.admit(fresh, DuplicateMode::FLAG, stats));
+    CHECK(stats.flagged == 1);
+    CHECK(stats.added == 2);
+    CHECK(duplicate.getNotes() == std::string("from bank | ") + SessionHashIndex::DUPLICATE_NOTE);
+    CHECK(fresh.getNotes().empty());
+
+    MergeStats kept;
+    index.beginImport();
+    GamblingSession unchanged = makeSession(50.0);
+    CHECK(index.admit(unchanged, DuplicateMode::KEEP, kept));
+    CHECK(kept.flagged == 0 && kept.skipped == 0);
+    CHECK(unchanged.getNotes().empty());
+}
+
+TEST(SessionDeduplicator, RemoveAndGrowKeepCounts)
+{
+    // Far past the initial capacity, so the table and Bloom filter are rebuilt
+    SessionHashIndex index(16);
+    for (int i = 0; i < 20000; i++)
+    {
+        CHECK(index.add(SessionHashIndex::hashSession(makeSession(i))) == 0);
+    }
+    CHECK(index.size() == 20000);
+    for (int i = 0; i < 20000; i += 997)
+    {
+        CHECK(index.count(SessionHashIndex::hashSession(makeSession(i))) == 1);
+    }
+
+    uint64_t hash = SessionHashIndex::hashSession(makeSession(42.0));
+    CHECK(index.add(hash) == 1);
+    index.remove(hash);
+    index.remove(hash);
+    CHECK(index.count(hash) == 0);
+    CHECK(index.size() == 19999);
+    CHECK(index.count(SessionHashIndex::hashSession(makeSession(-1.0))) == 0);
+}
@@ -0,0 +1,159 @@
+#include "TestRunner.h"
+#include "../include/SessionArchive.h"
+#include "../include/SessionFileReader.h"
+#include "../include/SessionJson.h"
+#include "../include/TaxCalculator.h"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    std::vector<GamblingSession> makeSessions(size_t count)
+    {
+        std::vector<GamblingSession> sessions;
+        for (size_t i = 0; i < count; i++)
+        {
+            sessions.push_back(GamblingSession("04-0" + std::to_string(1 + i % 9) + "-2024", "Casino " + std::to_string(i % 3),
+                                               "NV", i % 2 ? "Blackjack" : "Slot Machine", 20.0 + i, 10.0 * i,
+                                               false, 0.0, "", "row " + std::to_string(i)));
+        }
+        return sessions;
+    }
+
+    std::vector<TicketBatch> makeBatches()
+    {
+        TicketBatch batch("04-05-2024", "Store", "NV", "Lottery");
+        batch.addTicket(2.0);
+        batch.addTicket(5.0);
+        return std::vector<TicketBatch>{batch};
+    }
+
+    std::string archiveBytes(const std::vector<GamblingSession>& sessions, const std::vector<TicketBatch>& batches)
+    {
+        std::ostringstream out;
+        {
+            ArchiveWriter writer(out, 8);   // Several blocks
+            for (const auto& session : sessions) writer.add(session);
+            for (const auto& batch : batches) writer.add(batch);
+        }
+        return out.str();
+    }
+
+    std::string sessionsJson(const std::vector<GamblingSession>& sessions, const std::vector<TicketBatch>& batches)
+    {
+        std::ostringstream out;
+        SessionJson::writeSessions(out, sessions, batches);
+        return out.str();
+    }
+
+    struct CallbackError {};
+
+    size_t readFile(const std::string& path, std::vector<std::string>* warnings = nullptr)
+    {
+        TaskProgress progress;
+        size_t records = 0;
+        SessionFileReader::read(path,
+            [&records](GamblingSession&) { records++; },
+            [&records](TicketBatch&) { records++; },
+            [warnings](const std::string& message) { if (warnings) warnings->push_back(message); },
+            progress);
+        return records;
+    }
+}
+
+TEST(SessionFiles, ReaderWarnsAboutBadCsvLinesAndKeepsGoing)
+{
+    TestRunner::ScratchDir scratch;
+    std::vector<GamblingSession> sessions = makeSessions(3);
+    std::string csv = std::string(SessionFileReader::CSV_HEADER) + "\n" + sessions[0].toCSV() + "\n" +
+                      "not,a,session\n" + sessions[1].toCSV() + "\n\n" + sessions[2].toCSV() + "\n";
+    TestRunner::writeFile(scratch.path("s.csv"), csv);
+
+    std::vector<std::string> warnings;
+    CHECK(readFile(scratch.path("s.csv"), &warnings) == 3);
+    REQUIRE(warnings.size() == 1);
+    CHECK(warnings[0].find("not,a,session") != std::string::npos);
+}
+
+TEST(SessionFiles, ReaderFailsOnTruncatedOrCorruptFiles)
+{
+    TestRunner::ScratchDir scratch;
+    std::string json = sessionsJson(makeSessions(10), makeBatches());
+    TestRunner::writeFile(scratch.path("truncated.json"), json.substr(0, json.size() / 2));
+    CHECK_THROWS(std::runtime_error, readFile(scratch.path("truncated.json")));
+
+    std::string archive = archiveBytes(makeSessions(10), makeBatches());
+    TestRunner::writeFile(scratch.path("truncated.gsa"), archive.substr(0, archive.size() - 3));
+    CHECK_THROWS(std::runtime_error, readFile(scratch.path("truncated.gsa")));
+
+    archive[archive.size() / 2] = static_cast<char>(archive[archive.size() / 2] ^ 0x01);
+    TestRunner::writeFile(scratch.path("corrupt.gsa"), archive);
+    CHECK_THROWS(std::runtime_error, readFile(scratch.path("corrupt.gsa")));
+
+    CHECK_THROWS(std::runtime_error, readFile(scratch.path("missing.csv")));
+}
+
+TEST(SessionFiles, ReaderPropagatesCallbackExceptions)
+{
+    TestRunner::ScratchDir scratch;
+    std::vector<GamblingSession> sessions = makeSessions(4);
+    TestRunner::writeFile(scratch.path("s.json"), sessionsJson(sessions, {}));
+    TestRunner::writeFile(scratch.path("s.gsa"), archiveBytes(sessions, {}));
+    TestRunner::writeFile(scratch.path("s.csv"),
+                          std::string(SessionFileReader::CSV_HEADER) + "\n" + sessions[0].toCSV() + "\n");
+
+    for (const char* name : {"s.json", "s.gsa", "s.csv"})
+    {
+        TaskProgress progress;
+        CHECK_THROWS(CallbackError, SessionFileReader::read(scratch.path(name),
+            [](GamblingSession&) { throw CallbackError(); },
+            [](TicketBatch&) {},
+            [](const std::string&) {},
+            progress));
+    }
+}
+
+TEST(SessionFiles, TaxesFromFileAgreeWithLoadedTotalsToTheCent)
+{
+    TestRunner::ScratchDir scratch;
+    TaxCalculator calculator(false, scratch.str());
+
+    // Amounts with cents, across several chunks and states
+    const char* states[] = {"NV", "NJ", "PA"};
+    std::vector<GamblingSession> sessions;
+    for (int i = 0; i < 5000; i++)
+    {
+        double buyIn = 20.0 + (i * 7919 % 100000) / 100.0;
+        double cashOut = (i * 104729 % 150000) / 100.0;
+        sessions.push_back(GamblingSession("05-1" + std::to_string(i % 10) + "-2024", "Casino", states[i % 3],
+                                           i % 2 ? "Blackjack" : "Slot Machine", buyIn, cashOut, false, 0.0, "", ""));
+    }
+    std::vector<TicketBatch> batches = makeBatches();
+    TestRunner::writeFile(scratch.path("s.gsa"), archiveBytes(sessions, batches));
+
+    SessionChunks loaded;
+    std::vector<TicketBatch> loadedBatches;
+    TaskProgress progress;
+    SessionFileReader::read(scratch.path("s.gsa"),
+        [&loaded](GamblingSession& session) { loaded.pushBack(std::move(session)); },
+        [&loadedBatches](TicketBatch& batch) { loadedBatches.push_back(batch); },
+        [](const std::string&) {},
+        progress);
+    REQUIRE(loaded.size() == sessions.size());
+
+    TaskProgress fileProgress;
+    TaxSummary streamed = calculator.calculateTaxesFromFile(scratch.path("s.gsa"), fileProgress,
+                                                            [](const std::string&) {});
+    TaxSummary summary = calculator.calculateTaxes(loaded, loadedBatches);
+    CHECK(std::llround(streamed.totalWinnings * 100) == std::llround(summary.totalWinnings * 100));
+    CHECK(std::llround(streamed.totalLosses * 100) == std::llround(summary.totalLosses * 100));
+    CHECK(std::llround(streamed.estimatedFederalTax * 100) == std::llround(summary.estimatedFederalTax * 100));
+    REQUIRE(streamed.stateWinnings.size() == summary.stateWinnings.size());
+    for (const auto& state : summary.stateWinnings)
+    {
+        CHECK(std::llround(streamed.stateWinnings[state.first] * 100) == std::llround(state.second * 100));
+        CHECK(std::llround(streamed.stateLosses[state.first] * 100) ==
+              std::llround(summary.stateLosses.at(state.first) * 100));
+    }
+}
@@ -0,0 +1,190 @@
+#include "TestRunner.h"
+#include "../include/SessionJournal.h"
+#include <filesystem>
+
+namespace
+{
+    GamblingSession makeSession(int index)
+    {
+        return GamblingSession("02-10-2024", "Casino " + std::to_string(index), "NV", "Craps",
+                               50.0, 50.0 + index, false, 0.0, "", "note " + std::to_string(index));
+    }
+
+    TicketBatch makeBatch(const std::string& location, double ticket)
+    {
+        TicketBatch batch("02-11-2024", location, "NV", "Lottery");
+        batch.addTicket(ticket);
+        batch.addTicket(ticket * 2);
+        return batch;
+    }
+
+    // Builds state through the journal the way the console does, then closes it
+    void writeHistory(const std::string& base, SessionDatabase& sessions, std::vector<TicketBatch>& batches)
+    {
+        SessionJournal journal(base);
+        SessionJournal::RecoveryStats stats;
+        journal.recover(sessions, batches, stats);
+
+        for (int i = 0; i < 4; i++)
+        {
+            SessionId id = sessions.insert(makeSession(i));
+            journal.logAdd(id, *sessions.find(id));
+        }
+        SessionId edited = sessions.idAt(1);
+        sessions.update(edited, makeSession(41));
+        journal.logUpdate(edited, makeSession(41));
+        SessionId removed = sessions.idAt(2);
+        sessions.erase(removed);
+        journal.logDelete(removed);
+
+        for (const char* location : {"Store A", "Store B", "Store C"})
+        {
+            batches.push_back(makeBatch(location, 2.0));
+            journal.logBatch(batches.back());
+        }
+        batches[0] = makeBatch("Store A2", 3.0);
+        journal.logBatchUpdate(0, batches[0]);
+        batches.erase(batches.begin() + 1);
+        journal.logBatchDelete(1);
+        journal.sync();
+    }
+
+    void checkSameState(const SessionDatabase& expected, const std::vector<TicketBatch>& expectedBatches,
+                        const SessionDatabase& actual, const std::vector<TicketBatch>& actualBatches)
+    {
+        REQUIRE(actual.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            SessionId id = expected.idAt(i);
+            REQUIRE(actual.contains(id));
+            CHECK(actual.find(id)->toCSV() == expected[i].toCSV());
+        }
+        REQUIRE(actualBatches.size() == expectedBatches.size());
+        for (size_t i = 0; i < expectedBatches.size(); i++)
+        {
+            CHECK(actualBatches[i].toCSV() == expectedBatches[i].toCSV());
+        }
+    }
+}
+
+TEST(SessionJournal, RecoveryReplaysEveryKindOfChange)
+{
+    TestRunner::ScratchDir scratch;
+    std::string base = scratch.path("autosave");
+    SessionDatabase sessions;
+    std::vector<TicketBatch> batches;
+    writeHistory(base, sessions, batches);
+
+    SessionDatabase recovered;
+    std::vector<TicketBatch> recoveredBatches;
+    SessionJournal journal(base);
+    SessionJournal::RecoveryStats stats;
+    CHECK(journal.recover(recovered, recoveredBatches, stats));
+    CHECK(!stats.tornTail);
+    CHECK(stats.journalRecords == 11);
+    checkSameState(sessions, batches, recovered, recoveredBatches);
+}
+
+TEST(SessionJournal, TornTailKeepsEverythingBeforeIt)
+{
+    TestRunner::ScratchDir scratch;
+    std::string base = scratch.path("autosave");
+    SessionDatabase sessions;
+    std::vector<TicketBatch> batches;
+    writeHistory(base, sessions, batches);
+
+    // A crash mid-append: the last line has no newline
+    std::string journalText = TestRunner::readFile(base + ".journal");
+    TestRunner::writeFile(base + ".journal", journalText + "0badc0de A 4294967299 02-12-2024,Half");
+
+    SessionDatabase recovered;
+    std::vector<TicketBatch> recoveredBatches;
+    {
+        SessionJournal journal(base);
+        SessionJournal::RecoveryStats stats;
+        CHECK(journal.recover(recovered, recoveredBatches, stats));
+        CHECK(stats.tornTail);
+        checkSameState(sessions, batches, recovered, recoveredBatches);
+    }
+
+    // Recovery folded the good records into a new snapshot, so the next run is clean
+    SessionDatabase again;
+    std::vector<TicketBatch> againBatches;
+    SessionJournal journal(base);
+    SessionJournal::RecoveryStats stats;
+    CHECK(journal.recover(again, againBatches, stats));
+    CHECK(!stats.tornTail);
+    CHECK(stats.journalRecords == 0);
+    checkSameState(sessions, batches, again, againBatches);
+}
+
+TEST(SessionJournal, CorruptRecordStopsReplay)
+{
+    TestRunner::ScratchDir scratch;
+    std::string base = scratch.path("autosave");
+    SessionDatabase sessions;
+    std::vector<TicketBatch> batches;
+    writeHistory(base, sessions, batches);
+
+    // Damage the payload of the third record (after the header); its checksum no longer matches
+    std::string journalText = TestRunner::readFile(base + ".journal");
+    size_t line = 0;
+    for (int i = 0; i < 3; i++) line = journalText.find('\n', line) + 1;
+    size_t digit = journalText.find("Casino", line);
+    REQUIRE(digit != std::string::npos);
+    journalText[digit] = 'K';
+    TestRunner::writeFile(base + ".journal", journalText);
+
+    SessionDatabase recovered;
+    std::vector<TicketBatch> recoveredBatches;
+    SessionJournal journal(base);
+    SessionJournal::RecoveryStats stats;
+    CHECK(journal.recover(recovered, recoveredBatches, stats));
+    CHECK(stats.tornTail);
+    CHECK(stats.journalRecords == 2);
+    CHECK(recovered.size() == 2);
+    CHECK(recoveredBatches.empty());
+}
+
+TEST(SessionJournal, CompactionFoldsTheJournalIntoASnapshot)
+{
+    TestRunner::ScratchDir scratch;
+    std::string base = scratch.path("autosave");
+    SessionDatabase sessions;
+    std::vector<TicketBatch> batches;
+    writeHistory(base, sessions, batches);
+    std::string oldJournal = TestRunner::readFile(base + ".journal");
+
+    {
+        SessionDatabase replayed;
+        std::vector<TicketBatch> replayedBatches;
+        SessionJournal journal(base);
+        SessionJournal::RecoveryStats stats;
+        journal.recover(replayed, replayedBatches, stats);
+        REQUIRE(journal.compact(replayed, replayedBatches));
+        SessionId id = replayed.insert(makeSession(7));
+        journal.logAdd(id, *replayed.find(id));
+        sessions.insertWithId(id, makeSession(7));
+    }
+
+    SessionDatabase recovered;
+    std::vector<TicketBatch> recoveredBatches;
+    {
+        SessionJournal journal(base);
+        SessionJournal::RecoveryStats stats;
+        CHECK(journal.recover(recovered, recoveredBatches, stats));
+        CHECK(stats.snapshotRecords == 3 + 2);
+        CHECK(stats.journalRecords == 1);
+        checkSameState(sessions, batches, recovered, recoveredBatches);
+    }
+
+    // A journal from before the compaction has an older epoch and is ignored
+    TestRunner::writeFile(base + ".journal", oldJournal);
+    SessionDatabase stale;
+    std::vector<TicketBatch> staleBatches;
+    SessionJournal journal(base);
+    SessionJournal::RecoveryStats stats;
+    CHECK(journal.recover(stale, staleBatches, stats));
+    CHECK(stats.journalRecords == 0);
+    CHECK(stale.size() == 3);
+}
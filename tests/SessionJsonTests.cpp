@@ -0,0 +1,152 @@
+#include "TestRunner.h"
+#include "../include/JsonStream.h"
+#include "../include/SessionJson.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    std::vector<GamblingSession> makeSessions(size_t count)
+    {
+        std::vector<GamblingSession> sessions;
+        for (size_t i = 0; i < count; i++)
+        {
+            sessions.push_back(GamblingSession("04-0" + std::to_string(1 + i % 9) + "-2024", "Casino " + std::to_string(i % 3),
+                                               "NV", i % 2 ? "Blackjack" : "Slot Machine", 20.0 + i, 10.0 * i,
+                                               false, 0.0, "", "row " + std::to_string(i)));
+        }
+        return sessions;
+    }
+
+    std::vector<TicketBatch> makeBatches()
+    {
+        TicketBatch batch("04-05-2024", "Store", "NV", "Lottery");
+        batch.addTicket(2.0);
+        batch.addTicket(5.0);
+        return std::vector<TicketBatch>{batch};
+    }
+
+    std::string sessionsJson(const std::vector<GamblingSession>& sessions, const std::vector<TicketBatch>& batches)
+    {
+        std::ostringstream out;
+        SessionJson::writeSessions(out, sessions, batches);
+        return out.str();
+    }
+
+    SessionJson::ReadStats readJson(const std::string& text)
+    {
+        std::istringstream in(text);
+        return SessionJson::readSessions(in, [](GamblingSession&) {}, [](TicketBatch&) {});
+    }
+}
+
+TEST(SessionJson, SessionsRoundTrip)
+{
+    std::vector<GamblingSession> sessions = makeSessions(5);
+    sessions.push_back(GamblingSession("12-31-2024", "Caf\xC3\xA9 \"Lucky\" \\ Bar", "NJ", "Poker", 250.0, 6000.0,
+                                       true, 1440.0, "W-2G\tcopy", "line one\nline two"));
+    std::vector<TicketBatch> batches = makeBatches();
+    std::string text = sessionsJson(sessions, batches);
+
+    std::vector<GamblingSession> readSessions;
+    std::vector<TicketBatch> readBatches;
+    std::istringstream in(text);
+    SessionJson::ReadStats stats = SessionJson::readSessions(in,
+        [&readSessions](GamblingSession& session) { readSessions.push_back(session); },
+        [&readBatches](TicketBatch& batch) { readBatches.push_back(batch); });
+
+    CHECK(stats.invalid == 0);
+    REQUIRE(readSessions.size() == sessions.size());
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        CHECK(readSessions[i].toCSV() == sessions[i].toCSV());
+        CHECK(readSessions[i].getNotes() == sessions[i].getNotes());
+    }
+    REQUIRE(readBatches.size() == 1);
+    CHECK(readBatches[0].getTicketCents() == batches[0].getTicketCents());
+    CHECK(readBatches[0].getLocation() == "Store");
+
+    // Chunked storage writes the same document
+    SessionChunks chunks;
+    for (const auto& session : sessions) chunks.pushBack(GamblingSession(session));
+    std::ostringstream fromChunks;
+    SessionJson::writeSessions(fromChunks, chunks, batches);
+    CHECK(fromChunks.str() == text);
+}
+
+TEST(SessionJson, TaxSummaryRoundTrips)
+{
+    TaxSummary summary = TaxSummary();
+    summary.totalWinnings = 12345.67;
+    summary.totalLosses = 2000.5;
+    summary.netFederalResult = 10345.17;
+    summary.deductibleLosses = 2000.5;
+    summary.federalTaxableIncome = 12345.67;
+    summary.estimatedFederalTax = 1481.48;
+    summary.federalMarginalRate = 0.22;
+    summary.totalWithheld = 300.0;
+    summary.stateWinnings["NJ"] = 12345.67;
+    summary.stateLosses["NV"] = 2000.5;
+    summary.stateTaxes["NJ"] = 370.37;
+    summary.hasWinnings = true;
+    summary.itemizingRecommended = true;
+    summary.documentationReminders.push_back("Keep \"W-2G\" forms");
+    summary.taxYear = 2024;
+    summary.rulesVersion = "2024.1";
+
+    std::ostringstream out;
+    SessionJson::writeTaxSummary(out, summary);
+    std::istringstream in(out.str());
+    TaxSummary read = SessionJson::readTaxSummary(in);
+
+    CHECK(read.totalWinnings == 12345.67);
+    CHECK(read.totalLosses == 2000.5);
+    CHECK(read.netFederalResult == 10345.17);
+    CHECK(read.estimatedFederalTax == 1481.48);
+    CHECK(read.federalMarginalRate == 0.22);
+    CHECK(read.totalWithheld == 300.0);
+    CHECK(read.stateWinnings["NJ"] == 12345.67);
+    CHECK(read.stateLosses["NV"] == 2000.5);
+    CHECK(read.stateTaxes["NJ"] == 370.37);
+    CHECK(read.hasWinnings && !read.hasDeductibleLosses && read.itemizingRecommended);
+    REQUIRE(read.documentationReminders.size() == 1);
+    CHECK(read.documentationReminders[0] == "Keep \"W-2G\" forms");
+    CHECK(read.taxYear == 2024);
+    CHECK(read.rulesVersion == "2024.1");
+}
+
+TEST(SessionJson, ReaderEnforcesTheDepthLimit)
+{
+    JsonHandler handler;
+    std::istringstream shallow(std::string(10, '[') + std::string(10, ']'));
+    JsonReader(shallow).parse(handler);
+
+    std::istringstream deep(std::string(1000, '[') + std::string(1000, ']'));
+    CHECK_THROWS(std::runtime_error, JsonReader(deep).parse(handler));
+}
+
+TEST(SessionJson, ReaderRejectsEveryTruncation)
+{
+    std::string text = sessionsJson(makeSessions(3), makeBatches());
+    SessionJson::ReadStats stats = readJson(text);
+    CHECK(stats.sessions == 3);
+    CHECK(stats.ticketBatches == 1);
+
+    // Trailing whitespace aside, every proper prefix is an incomplete document
+    size_t end = text.find_last_not_of(" \n") + 1;
+    for (size_t length = 0; length < end; length++)
+    {
+        CHECK_THROWS(std::runtime_error, readJson(text.substr(0, length)));
+    }
+}
+
+TEST(SessionJson, RecordsThatFailValidationAreCounted)
+{
+    std::string text = sessionsJson(makeSessions(2), {});
+    size_t date = text.find("04-01-2024");
+    REQUIRE(date != std::string::npos);
+    text.replace(date, 10, "2024-04-01");
+    SessionJson::ReadStats stats = readJson(text);
+    CHECK(stats.sessions == 1);
+    CHECK(stats.invalid == 1);
+}
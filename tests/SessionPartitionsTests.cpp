@@ -0,0 +1,143 @@
+#include "TestRunner.h"
+#include "../include/SessionPartitions.h"
+#include "../include/TaxCalculator.h"
+#include <cmath>
+
+namespace
+{
+    GamblingSession makeSession(const std::string& date, const std::string& state, double net)
+    {
+        return GamblingSession(date, "Casino", state, "Blackjack", 1000.0, 1000.0 + net, false, 0.0, "", "");
+    }
+
+    bool near(double a, double b)
+    {
+        return std::fabs(a - b) < 0.005;
+    }
+}
+
+TEST(SessionPartitions, ZoneMapsFollowAddsAndRemoves)
+{
+    SessionDatabase sessions;
+    std::vector<TicketBatch> batches;
+    SessionId early = sessions.insert(makeSession("01-05-2024", "NV", 500.0));
+    SessionId late = sessions.insert(makeSession("11-20-2024", "NV", -200.0));
+    SessionId jersey = sessions.insert(makeSession("06-01-2024", "NJ", 75.25));
+    sessions.insert(makeSession("03-03-2023", "NV", 10.0));
+    sessions.insert(makeSession("", "NV", 10.0));
+    TicketBatch batch("07-04-2024", "NJ", "NJ", "Lottery");
+    batch.addTicket(2.0);
+    batch.addTicket(5.0);
+    batches.push_back(batch);
+
+    SessionPartitions partitions;
+    partitions.rebuild(sessions, batches);
+    CHECK(partitions.getTaxYears() == std::vector<int>({SessionPartitions::UNDATED_YEAR, 2023, 2024}));
+    CHECK(partitions.getStates(2024) == std::vector<std::string>({"NJ", "NV"}));
+    CHECK(SessionPartitions::taxYearOf("12-31-2019") == 2019);
+    CHECK(SessionPartitions::taxYearOf("not a date") == SessionPartitions::UNDATED_YEAR);
+
+    ZoneMap nevada = partitions.getZoneMap(2024, "NV");
+    CHECK(nevada.sessions == 2);
+    CHECK(nevada.winningsCents == 50000);
+    CHECK(nevada.lossesCents == 20000);
+    CHECK(nevada.firstDay == GamblingSession::dateToDayNumber("01-05-2024"));
+    CHECK(nevada.lastDay == GamblingSession::dateToDayNumber("11-20-2024"));
+    CHECK(nevada.overlaps(nevada.lastDay, nevada.lastDay + 10));
+    CHECK(!nevada.overlaps(nevada.lastDay + 1, nevada.lastDay + 10));
+
+    ZoneMap year = partitions.getZoneMap(2024);
+    CHECK(year.sessions == 3);
+    CHECK(year.tickets == 2);
+    CHECK(year.winningsCents == 57525);
+    CHECK(year.lossesCents == 20700);
+    CHECK(partitions.getZoneMap(2022).isEmpty());
+
+    // Bounds stay as wide as they were; an emptied partition goes away
+    partitions.remove(late, sessions[sessions.positionOf(late)]);
+    partitions.remove(late, sessions[sessions.positionOf(late)]);
+    nevada = partitions.getZoneMap(2024, "NV");
+    CHECK(nevada.sessions == 1);
+    CHECK(nevada.lossesCents == 0);
+    CHECK(nevada.lastDay == GamblingSession::dateToDayNumber("11-20-2024"));
+    partitions.remove(early, sessions[sessions.positionOf(early)]);
+    CHECK(partitions.getStates(2024) == std::vector<std::string>({"NJ"}));
+
+    // The swap-remove keeps later removals pointing at the right member
+    SessionId second = sessions.insert(makeSession("08-08-2024", "NJ", 1.0));
+    partitions.add(second, sessions[sessions.positionOf(second)]);
+    partitions.remove(jersey, sessions[sessions.positionOf(jersey)]);
+    CHECK(partitions.getZoneMap(2024, "NJ").sessions == 1);
+    partitions.remove(second, sessions[sessions.positionOf(second)]);
+    CHECK(partitions.getZoneMap(2024, "NJ").sessions == 0);
+    CHECK(partitions.getZoneMap(2024, "NJ").tickets == 2);
+}
+
+TEST(SessionPartitions, AggregatesReuseUnchangedPartitions)
+{
+    TestRunner::ScratchDir scratch;
+    TaxCalculator calculator(false, scratch.str());
+    SessionDatabase sessions;
+    std::vector<TicketBatch> batches;
+    const char* states[] = {"NV", "NJ", "PA", "MI"};
+    double winnings2024 = 0.0;
+    double losses2024 = 0.0;
+    for (int i = 0; i < 400; i++)
+    {
+        double net = static_cast<double>((i * 37) % 301) - 150.0;
+        std::string date = "0" + std::to_string(1 + i % 9) + "-15-" + std::to_string(2022 + i % 3);
+        sessions.insert(makeSession(date, states[i % 4], net));
+        if (i % 3 == 2)
+        {
+            if (net > 0) winnings2024 += net;
+            else losses2024 -= net;
+        }
+    }
+
+    SessionPartitions partitions;
+    partitions.rebuild(sessions, batches);
+
+    PartitionScan first;
+    SessionAggregate totals = partitions.aggregate(2024, "", sessions, batches, calculator, &first);
+    CHECK(first.read == 4);
+    CHECK(first.skipped == 8);
+    CHECK(first.reused == 0);
+    CHECK(near(totals.totalWinnings, winnings2024));
+    CHECK(near(totals.totalLosses, losses2024));
+    CHECK(totals.sessionCount == 133);
+    CHECK(totals.states.size() == 4);
+
+    PartitionScan second;
+    SessionAggregate again = partitions.aggregate(2024, "", sessions, batches, calculator, &second);
+    CHECK(second.reused == 4);
+    CHECK(near(again.totalWinnings, totals.totalWinnings));
+
+    // One changed partition is aggregated again; the others come from the cache
+    SessionId added = sessions.insert(makeSession("02-02-2024", "PA", 999.0));
+    partitions.add(added, sessions[sessions.positionOf(added)]);
+    PartitionScan third;
+    totals = partitions.aggregate(2024, "", sessions, batches, calculator, &third);
+    CHECK(third.reused == 3);
+    CHECK(near(totals.totalWinnings, winnings2024 + 999.0));
+
+    PartitionScan state;
+    SessionAggregate pennsylvania = partitions.aggregate(2024, "PA", sessions, batches, calculator, &state);
+    CHECK(state.read == 1 && state.reused == 1 && state.skipped == 11);
+    CHECK(pennsylvania.states.size() == 1);
+
+    // New rules invalidate every cached aggregate
+    calculator.getTaxRules().setFederalRules(calculator.getTaxRules().getFederalRules());
+    PartitionScan fourth;
+    partitions.aggregate(2024, "", sessions, batches, calculator, &fourth);
+    CHECK(fourth.reused == 0);
+
+    std::vector<GamblingSession> selected;
+    std::vector<TicketBatch> selectedBatches;
+    partitions.select(2024, "PA", sessions, batches, selected, selectedBatches);
+    CHECK(selected.size() == pennsylvania.sessionCount);
+    for (const auto& session : selected)
+    {
+        CHECK(session.getState() == "PA");
+        CHECK(SessionPartitions::taxYearOf(session.getDate()) == 2024);
+    }
+}
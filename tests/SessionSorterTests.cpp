@@ -0,0 +1,145 @@
+#include "TestRunner.h"
+#include "../include/SessionSorter.h"
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    GamblingSession makeSession(const std::string& date, const std::string& tag, double net = 5.0)
+    {
+        return GamblingSession(date, "Casino", "NV", "Poker", 100.0, 100.0 + net, false, 0.0, "", tag);
+    }
+
+    void writeCsv(const std::string& path, const std::vector<GamblingSession>& sessions)
+    {
+        std::string text = std::string(SessionFileReader::CSV_HEADER) + "\n";
+        for (const auto& session : sessions) text += session.toCSV() + "\n";
+        TestRunner::writeFile(path, text);
+    }
+
+    // Notes column of each output row, in order
+    std::vector<std::string> outputTags(const std::string& path)
+    {
+        std::vector<std::string> tags;
+        std::istringstream in(TestRunner::readFile(path));
+        std::string line;
+        std::getline(in, line);
+        while (std::getline(in, line))
+        {
+            tags.push_back(GamblingSession::fromCSV(line).getNotes());
+        }
+        return tags;
+    }
+
+    SortStats sort(const std::vector<std::string>& sources, const std::string& output, const SortOptions& options)
+    {
+        TaskProgress progress;
+        return SessionSorter::sortFiles(sources, output, options, progress, [](const std::string&) {});
+    }
+
+    size_t leftoverTempFiles(const TestRunner::ScratchDir& scratch)
+    {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(scratch.str()))
+        {
+            if (entry.path().extension() == ".tmp") count++;
+        }
+        return count;
+    }
+
+    // Three sources with several records on the same days, out of date order
+    std::vector<std::string> writeSources(const TestRunner::ScratchDir& scratch)
+    {
+        writeCsv(scratch.path("a.csv"), {makeSession("05-03-2024", "a1"), makeSession("05-01-2024", "a2"),
+                                         makeSession("05-03-2024", "a3"), makeSession("05-02-2024", "a4")});
+        writeCsv(scratch.path("b.csv"), {makeSession("05-03-2024", "b1"), makeSession("05-01-2024", "b2"),
+                                         makeSession("05-02-2024", "b3"), makeSession("05-01-2024", "b4")});
+        writeCsv(scratch.path("c.csv"), {makeSession("05-02-2024", "c1"), makeSession("05-03-2024", "c2")});
+        return {scratch.path("a.csv"), scratch.path("b.csv"), scratch.path("c.csv")};
+    }
+}
+
+TEST(SessionSorter, SameDayRecordsKeepSourceThenFileOrder)
+{
+    TestRunner::ScratchDir scratch;
+    std::vector<std::string> sources = writeSources(scratch);
+    SortStats stats = sort(sources, scratch.path("out.csv"), SortOptions());
+
+    std::vector<std::string> expected = {"a2", "b2", "b4", "a4", "b3", "c1", "a1", "a3", "b1", "c2"};
+    CHECK(outputTags(scratch.path("out.csv")) == expected);
+    CHECK(stats.records == 10);
+    CHECK(stats.written == 10);
+    CHECK(stats.runs == 0);
+}
+
+TEST(SessionSorter, SpilledRunsAndMergePassesGiveTheSameOrder)
+{
+    TestRunner::ScratchDir scratch;
+    std::vector<std::string> sources = writeSources(scratch);
+    sort(sources, scratch.path("memory.csv"), SortOptions());
+
+    SortOptions options;
+    options.memoryBudget = 1;       // Every record becomes its own run
+    options.maxFanIn = 2;           // So the merge takes several passes
+    SortStats stats = sort(sources, scratch.path("disk.csv"), options);
+
+    CHECK(stats.runs == 10);
+    CHECK(stats.mergePasses > 1);
+    CHECK(TestRunner::readFile(scratch.path("disk.csv")) == TestRunner::readFile(scratch.path("memory.csv")));
+    CHECK(leftoverTempFiles(scratch) == 0);
+}
+
+TEST(SessionSorter, DuplicatesFromEarlierSourcesAreDropped)
+{
+    TestRunner::ScratchDir scratch;
+    GamblingSession ticket = makeSession("06-01-2024", "ticket", -5.0);
+    GamblingSession other = makeSession("06-01-2024", "other", -7.0);     // Notes aren't part of the content hash
+    writeCsv(scratch.path("a.csv"), {ticket, ticket, other});
+    writeCsv(scratch.path("b.csv"), {ticket, ticket, ticket, other});
+
+    for (size_t budget : {size_t(256u << 20), size_t(1)})
+    {
+        SortOptions options;
+        options.removeDuplicates = true;
+        options.memoryBudget = budget;
+        SortStats stats = sort({scratch.path("a.csv"), scratch.path("b.csv")}, scratch.path("out.csv"), options);
+
+        // Both copies in a.csv are kept; b.csv adds only its third ticket
+        std::vector<std::string> expected = {"ticket", "ticket", "other", "ticket"};
+        CHECK(outputTags(scratch.path("out.csv")) == expected);
+        CHECK(stats.duplicates == 3);
+        CHECK(stats.written == 4);
+    }
+}
+
+TEST(SessionSorter, UnreadableSourceLeavesOutputUntouched)
+{
+    TestRunner::ScratchDir scratch;
+    std::vector<std::string> sources = writeSources(scratch);
+    TestRunner::writeFile(scratch.path("out.csv"), "previous contents\n");
+    TestRunner::writeFile(scratch.path("broken.json"), "{\"format\":\"gambling-sessions\",\"version\":1,\"sessions\":[{\"da");
+    sources.push_back(scratch.path("broken.json"));
+
+    SortOptions options;
+    options.memoryBudget = 1;
+    CHECK_THROWS(std::runtime_error, sort(sources, scratch.path("out.csv"), options));
+    CHECK(TestRunner::readFile(scratch.path("out.csv")) == "previous contents\n");
+    CHECK(leftoverTempFiles(scratch) == 0);
+}
+
+TEST(SessionSorter, MergeRejectsUnsortedSources)
+{
+    TestRunner::ScratchDir scratch;
+    writeCsv(scratch.path("sorted.csv"), {makeSession("07-01-2024", "s1"), makeSession("07-02-2024", "s2")});
+    writeCsv(scratch.path("unsorted.csv"), {makeSession("07-03-2024", "u1"), makeSession("07-01-2024", "u2")});
+    TaskProgress progress;
+    CHECK_THROWS(std::runtime_error, SessionSorter::mergeSortedFiles(
+        {scratch.path("sorted.csv"), scratch.path("unsorted.csv")}, scratch.path("out.csv"), SortOptions(),
+        progress, [](const std::string&) {}));
+    CHECK(!std::filesystem::exists(scratch.path("out.csv")));
+
+    SortStats stats = SessionSorter::mergeSortedFiles({scratch.path("sorted.csv")}, scratch.path("out.csv"),
+                                                      SortOptions(), progress, [](const std::string&) {});
+    CHECK(stats.written == 2);
+}
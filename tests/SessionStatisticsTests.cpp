@@ -0,0 +1,126 @@
+#include "TestRunner.h"
+#include "../include/SessionStatistics.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    // Share of the sorted values at or below value
+    double rankOf(const std::vector<double>& sorted, double value)
+    {
+        return static_cast<double>(std::upper_bound(sorted.begin(), sorted.end(), value) - sorted.begin()) /
+               static_cast<double>(sorted.size());
+    }
+
+    GamblingSession makeSession(double net, const std::string& state = "NV", const std::string& game = "Poker")
+    {
+        return GamblingSession("06-01-2024", "Casino", state, game, 1000.0, 1000.0 + net, false, 0.0, "", "");
+    }
+}
+
+TEST(SessionStatistics, DigestQuantilesStayCloseToExactRanks)
+{
+    // Heavy-tailed, like session results: most small, a few very large
+    std::mt19937 random(11);
+    std::lognormal_distribution<double> distribution(3.0, 1.5);
+    std::vector<double> values;
+    TDigest whole;
+    TDigest left;
+    TDigest right;
+    for (int i = 0; i < 100000; i++)
+    {
+        double value = distribution(random) * (i % 3 == 0 ? -1.0 : 1.0);
+        values.push_back(value);
+        whole.add(value);
+        (i % 2 ? left : right).add(value);
+    }
+    left.merge(right);
+    std::sort(values.begin(), values.end());
+
+    CHECK(whole.getCount() == 100000);
+    CHECK(whole.getMin() == values.front());
+    CHECK(whole.getMax() == values.back());
+    CHECK(whole.getCentroidCount() <= 400);
+    CHECK(whole.quantile(0.0) == values.front());
+    CHECK(whole.quantile(1.0) == values.back());
+
+    for (double q : {0.001, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999})
+    {
+        // Tighter in the tails, as the arcsine scale promises
+        double allowed = q < 0.05 || q > 0.95 ? 0.002 : 0.01;
+        CHECK(std::fabs(rankOf(values, whole.quantile(q)) - q) < allowed);
+        CHECK(std::fabs(rankOf(values, left.quantile(q)) - q) < allowed);
+    }
+
+    TDigest empty;
+    CHECK(empty.quantile(0.5) == 0.0);
+    TDigest single;
+    single.add(42.0);
+    CHECK(single.quantile(0.1) == 42.0 && single.quantile(0.9) == 42.0);
+}
+
+TEST(SessionStatistics, TopNKeepsTheLargestInOrder)
+{
+    std::mt19937 random(5);
+    std::vector<double> amounts;
+    TopN top(10);
+    TopN first(10);
+    TopN second(10);
+    for (int i = 0; i < 5000; i++)
+    {
+        double amount = static_cast<double>(random() % 1000000) / 100.0;
+        amounts.push_back(amount);
+        top.offer(amount, makeSession(amount));
+        (i < 2500 ? first : second).offer(amount, makeSession(amount));
+    }
+    first.merge(second);
+    std::sort(amounts.rbegin(), amounts.rend());
+
+    std::vector<RankedSession> ranked = top.sorted();
+    std::vector<RankedSession> merged = first.sorted();
+    REQUIRE(ranked.size() == 10);
+    REQUIRE(merged.size() == 10);
+    for (size_t i = 0; i < 10; i++)
+    {
+        CHECK(ranked[i].amount == amounts[i]);
+        CHECK(merged[i].amount == amounts[i]);
+    }
+
+    TopN none(0);
+    none.offer(1.0, makeSession(1.0));
+    CHECK(none.size() == 0);
+}
+
+TEST(SessionStatistics, GroupsAgreeAcrossThreadCounts)
+{
+    const char* states[] = {"NV", "NJ", "PA"};
+    const char* games[] = {"Poker", "Slot Machine"};
+    std::vector<GamblingSession> sessions;
+    SessionChunks chunks;
+    for (int i = 0; i < 50000; i++)
+    {
+        double net = static_cast<double>((i * 7919) % 20001) - 10000.0;
+        sessions.push_back(makeSession(net, states[i % 3], games[i % 2]));
+        chunks.pushBack(GamblingSession(sessions.back()));
+    }
+
+    SessionStatistics serial = SessionStatistics::compute(sessions, 1);
+    SessionStatistics parallel = SessionStatistics::compute(chunks, 4);
+    CHECK(serial.getOverall().sessions == 50000);
+    CHECK(parallel.getOverall().sessions == 50000);
+    CHECK(serial.getByState().size() == 3);
+    CHECK(parallel.getByGameType().size() == 2);
+    CHECK(parallel.getByState().at("NJ").sessions == serial.getByState().at("NJ").sessions);
+
+    // Largest win and loss are exact however the work was split
+    CHECK(serial.getOverall().largestWins.sorted()[0].amount == 10000.0);
+    CHECK(parallel.getOverall().largestWins.sorted()[0].amount == 10000.0);
+    CHECK(parallel.getOverall().largestLosses.sorted()[0].amount == 10000.0);
+    CHECK(parallel.getOverall().largestWins.size() == 10);
+    CHECK(parallel.getByState().at("PA").largestWins.size() == 5);
+
+    // Results are spread evenly over [-10000, 10000]
+    CHECK(std::fabs(parallel.getOverall().results.quantile(0.5)) < 200.0);
+    CHECK(std::fabs(serial.getOverall().results.quantile(0.5)) < 200.0);
+}
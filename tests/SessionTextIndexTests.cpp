@@ -0,0 +1,134 @@
+#include "TestRunner.h"
+#include "../include/SessionTextIndex.h"
+#include <algorithm>
+
+namespace
+{
+    GamblingSession makeSession(const std::string& location, const std::string& notes = "",
+                                const std::string& documentationNote = "")
+    {
+        return GamblingSession("03-01-2024", location, "CT", "Slot Machine", 100.0, 50.0, false, 0.0,
+                               documentationNote, notes);
+    }
+
+    std::vector<std::string> tokens(const std::string& text)
+    {
+        std::vector<std::string> words;
+        SessionTextIndex::tokenize(text, words);
+        return words;
+    }
+}
+
+TEST(SessionTextIndex, TokenizeKeepsHyphenatedWordsJoined)
+{
+    CHECK(tokens("W-2G filed, Mohegan Sun") ==
+          std::vector<std::string>({"w", "2g", "w2g", "filed", "mohegan", "sun"}));
+    CHECK(tokens("a-b-c") == std::vector<std::string>({"a", "b", "c", "abc"}));
+    CHECK(tokens("dash- end -start") == std::vector<std::string>({"dash", "end", "start"}));
+    CHECK(tokens("  ...  ").empty());
+}
+
+TEST(SessionTextIndex, AndOrAndPrefixQueries)
+{
+    SessionDatabase sessions;
+    SessionId mohegan = sessions.insert(makeSession("Mohegan Sun", "W-2G received"));
+    SessionId foxwoods = sessions.insert(makeSession("Foxwoods", "big night", "Receipt in folder"));
+    SessionId moheganAgain = sessions.insert(makeSession("Mohegan Sun", "no paperwork"));
+    SessionTextIndex index;
+    index.rebuild(sessions);
+    CHECK(index.getSessionCount() == 3);
+
+    CHECK(index.search("mohegan") == std::vector<SessionId>({mohegan, moheganAgain}));
+    CHECK(index.search("MOHEGAN w2g") == std::vector<SessionId>({mohegan}));
+    CHECK(index.search("mohegan sun w-2g") == std::vector<SessionId>({mohegan}));
+    CHECK(index.search("w2g OR receipt") == std::vector<SessionId>({mohegan, foxwoods}));
+    CHECK(index.search("receipt OR w2g OR receipt") == std::vector<SessionId>({mohegan, foxwoods}));
+    CHECK(index.search("rec*") == std::vector<SessionId>({mohegan, foxwoods}));
+    CHECK(index.search("mohegan pa*") == std::vector<SessionId>({moheganAgain}));
+    CHECK(index.search("wynn").empty());
+    CHECK(index.search("mohegan wynn").empty());
+    CHECK(index.search("zz*").empty());
+}
+
+TEST(SessionTextIndex, EditsAndDeletesHideOldText)
+{
+    SessionDatabase sessions;
+    SessionId first = sessions.insert(makeSession("Bellagio"));
+    SessionId second = sessions.insert(makeSession("Wynn"));
+    SessionTextIndex index;
+    index.rebuild(sessions);
+
+    GamblingSession edited = makeSession("Aria", "moved tables");
+    sessions.update(first, edited);
+    index.update(first, edited);
+    CHECK(index.search("bellagio").empty());
+    CHECK(index.search("aria") == std::vector<SessionId>({first}));
+    CHECK(index.search("aria OR wynn") == std::vector<SessionId>({second, first}));
+
+    sessions.erase(second);
+    index.remove(second);
+    index.remove(second);
+    CHECK(index.search("wynn").empty());
+    CHECK(index.getSessionCount() == 1);
+
+    // Terms added after the first prefix lookup are still found by prefix
+    SessionId third = sessions.insert(makeSession("Arizona Charlie's"));
+    index.add(third, sessions[sessions.positionOf(third)]);
+    CHECK(index.search("ar*") == std::vector<SessionId>({first, third}));
+}
+
+TEST(SessionTextIndex, SearchAcrossManyChunksResolvesPositions)
+{
+    // Several thousand sessions span more than one 1024-session chunk
+    SessionDatabase sessions;
+    SessionTextIndex index;
+    std::vector<SessionId> ids;
+    for (int i = 0; i < 5000; i++)
+    {
+        std::string location = i % 10 == 0 ? "Mohegan Sun" : "Casino " + std::to_string(i);
+        ids.push_back(sessions.insert(makeSession(location, i % 20 == 0 ? "W-2G" : "")));
+        index.add(ids.back(), sessions[sessions.size() - 1]);
+    }
+
+    // Deletes move sessions from the end into the gaps
+    for (int i = 0; i < 5000; i += 7)
+    {
+        sessions.erase(ids[i]);
+        index.remove(ids[i]);
+    }
+
+    std::vector<SessionId> hits = index.search("mohegan w2g");
+    size_t expected = 0;
+    for (int i = 0; i < 5000; i += 20)
+    {
+        if (i % 7 != 0) expected++;
+    }
+    REQUIRE(hits.size() == expected);
+    for (SessionId id : hits)
+    {
+        size_t position = sessions.positionOf(id);
+        REQUIRE(position < sessions.size());
+        CHECK(sessions.idAt(position) == id);
+        CHECK(sessions[position].getLocation() == "Mohegan Sun");
+    }
+    CHECK(sessions.positionOf(ids[0]) == sessions.size());
+
+    // Compaction keeps the same answers
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        if (i % 7 != 0 && i % 10 != 0)
+        {
+            sessions.erase(ids[i]);
+            index.remove(ids[i]);
+        }
+    }
+    CHECK(index.needsCompaction());
+    std::vector<SessionId> before = index.search("mohegan OR w2g");
+    index.rebuild(sessions);
+    CHECK(!index.needsCompaction());
+    std::vector<SessionId> after = index.search("mohegan OR w2g");
+    std::sort(before.begin(), before.end(), [](SessionId a, SessionId b) { return a.toInteger() < b.toInteger(); });
+    std::sort(after.begin(), after.end(), [](SessionId a, SessionId b) { return a.toInteger() < b.toInteger(); });
+    CHECK(before == after);
+    CHECK(after.size() == sessions.size());
+}
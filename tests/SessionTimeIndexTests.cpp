@@ -0,0 +1,144 @@
+#include "TestRunner.h"
+#include "../include/SessionTimeIndex.h"
+#include "../include/TaxCalculator.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    std::string dateOf(long long day)
+    {
+        // Day numbers back to MM-DD-YYYY by search; test dates stay within 2015-2030
+        for (int year = 2015; year <= 2030; year++)
+        {
+            for (int month = 1; month <= 12; month++)
+            {
+                long long first = GamblingSession::dateToDayNumber(year, month, 1);
+                long long next = month == 12 ? GamblingSession::dateToDayNumber(year + 1, 1, 1)
+                                             : GamblingSession::dateToDayNumber(year, month + 1, 1);
+                if (day >= first && day < next)
+                {
+                    char date[16];
+                    std::snprintf(date, sizeof(date), "%02d-%02d-%04d", month, static_cast<int>(day - first + 1), year);
+                    return date;
+                }
+            }
+        }
+        return "";
+    }
+
+    long long cents(double amount)
+    {
+        return std::llround(amount * 100.0);
+    }
+
+    // Straight sum over the sessions in [from, to]
+    DayTotals bruteForce(const std::vector<GamblingSession>& sessions, const std::string& state,
+                         long long from, long long to)
+    {
+        DayTotals totals;
+        for (const auto& session : sessions)
+        {
+            long long day = GamblingSession::dateToDayNumber(session.getDate());
+            if (day < from || day > to) continue;
+            if (!state.empty() && session.getState() != state) continue;
+            double net = session.getNetResult();
+            if (net > 0) totals.winningsCents += cents(net);
+            else if (net < 0) totals.lossesCents += cents(-net);
+            totals.withheldCents += cents(session.getWithheldAmount());
+            totals.sessions++;
+        }
+        return totals;
+    }
+
+    bool sameTotals(const DayTotals& a, const DayTotals& b)
+    {
+        return a.winningsCents == b.winningsCents && a.lossesCents == b.lossesCents &&
+               a.withheldCents == b.withheldCents && a.sessions == b.sessions;
+    }
+}
+
+TEST(SessionTimeIndex, RangeTotalsMatchAStraightSum)
+{
+    TestRunner::ScratchDir scratch;
+    TaxCalculator calculator(false, scratch.str());
+    SessionTimeIndex index(calculator);
+
+    // Dates added out of order and years apart, so the window grows both ways
+    std::mt19937 random(7);
+    long long start = GamblingSession::dateToDayNumber(2016, 1, 1);
+    long long span = GamblingSession::dateToDayNumber(2029, 12, 31) - start;
+    const char* states[] = {"NV", "NJ", "PA"};
+    std::vector<GamblingSession> sessions;
+    for (int i = 0; i < 600; i++)
+    {
+        long long day = start + static_cast<long long>(random() % (span + 1));
+        double buyIn = 1.0 + random() % 50000 / 100.0;
+        double cashOut = random() % 100000 / 100.0;
+        bool withheld = random() % 10 == 0;
+        sessions.push_back(GamblingSession(dateOf(day), "Casino", states[random() % 3], "Blackjack", buyIn, cashOut,
+                                           withheld, withheld ? 12.34 : 0.0, "", ""));
+        index.add(sessions.back());
+    }
+
+    // Remove every fifth session again
+    std::vector<GamblingSession> kept;
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        if (i % 5 == 0) index.remove(sessions[i]);
+        else kept.push_back(sessions[i]);
+    }
+
+    for (int query = 0; query < 300; query++)
+    {
+        long long a = start - 30 + static_cast<long long>(random() % (span + 60));
+        long long b = start - 30 + static_cast<long long>(random() % (span + 60));
+        long long from = std::min(a, b);
+        long long to = std::max(a, b);
+        CHECK(sameTotals(index.totals(from, to), bruteForce(kept, "", from, to)));
+        CHECK(sameTotals(index.totals("NJ", from, to), bruteForce(kept, "NJ", from, to)));
+    }
+    CHECK(sameTotals(index.totals("ZZ", start, start + span), DayTotals()));
+}
+
+TEST(SessionTimeIndex, BatchesUndatedSessionsAndMissedWithholding)
+{
+    TestRunner::ScratchDir scratch;
+    TaxCalculator calculator(false, scratch.str());
+    SessionTimeIndex index(calculator);
+    CHECK(index.isEmpty());
+
+    GamblingSession bigWin("05-01-2024", "Casino", "NV", "Slot Machine", 100.0, 5100.0, false, 0.0, "", "");
+    GamblingSession undated("", "Casino", "NV", "Slot Machine", 10.0, 0.0, false, 0.0, "", "");
+    TicketBatch batch("05-03-2024", "Store", "NV", "Lottery");
+    batch.addTicket(2.0);
+    batch.addTicket(3.5);
+    index.add(bigWin);
+    index.add(undated);
+    index.add(batch);
+
+    long long may1 = GamblingSession::dateToDayNumber(2024, 5, 1);
+    CHECK(index.getUndatedCount() == 1);
+    CHECK(index.getFirstDay() == may1);
+    CHECK(index.getLastDay() == may1 + 2);
+
+    DayTotals totals = index.totals(may1, may1 + 2);
+    CHECK(totals.winningsCents == 500000);
+    CHECK(totals.lossesCents == 550);
+    CHECK(totals.tickets == 2);
+    CHECK(totals.sessions == 1);
+    CHECK(totals.missedWithholding == 1);
+    CHECK(index.totals(may1 + 1, may1 + 1).sessions == 0);
+
+    SessionAggregate aggregate = index.aggregate(may1, may1 + 2);
+    CHECK(aggregate.missedWithholding);
+    CHECK(std::llround(aggregate.totalWinnings * 100) == 500000);
+    CHECK(std::llround(aggregate.states["NV"].losses * 100) == 550);
+
+    index.remove(batch);
+    index.remove(bigWin);
+    totals = index.totals(may1, may1 + 2);
+    CHECK(sameTotals(totals, DayTotals()));
+    CHECK(totals.tickets == 0 && totals.missedWithholding == 0);
+}
@@ -0,0 +1,133 @@
+#include "TestRunner.h"
+#include "../include/TaxBrackets.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    typedef std::vector<std::pair<double, double>> Brackets;
+
+    // Bracket by bracket, the way the schedule is written on paper
+    double referenceTax(Brackets brackets, double income)
+    {
+        std::sort(brackets.begin(), brackets.end());
+        brackets[0].first = 0.0;
+        double tax = 0.0;
+        for (size_t i = 0; i < brackets.size(); i++)
+        {
+            double upper = i + 1 < brackets.size() ? brackets[i + 1].first : income;
+            if (income > brackets[i].first)
+            {
+                tax += (std::min(income, upper) - brackets[i].first) * brackets[i].second;
+            }
+        }
+        return tax;
+    }
+
+    bool near(double a, double b)
+    {
+        return std::fabs(a - b) < 1e-6;
+    }
+
+    // 2024 federal single
+    const Brackets FEDERAL_SINGLE = {{0, 0.10}, {11600, 0.12}, {47150, 0.22}, {100525, 0.24},
+                                     {191950, 0.32}, {243725, 0.35}, {609350, 0.37}};
+}
+
+TEST(TaxBrackets, TotalTaxMatchesBracketByBracketSums)
+{
+    // 7 brackets pad to 8, 5 pad to 8, 1 and 2 need no padding
+    std::vector<Brackets> schedules = {
+        FEDERAL_SINGLE,
+        {{0, 0.01}, {10000, 0.02}, {25000, 0.04}, {40000, 0.06}, {60000, 0.08}},
+        {{0, 0.05}},
+        {{500, 0.03}, {0, 0.0}},    // Unsorted input; the first edge is zero
+    };
+    for (const auto& brackets : schedules)
+    {
+        BracketSchedule schedule;
+        schedule.compile(brackets);
+        CHECK(schedule.getBracketCount() == brackets.size());
+        for (double income = 0.0; income < 700000.0; income += 997.13)
+        {
+            CHECK(near(schedule.totalTax(income), referenceTax(brackets, income)));
+        }
+        for (const auto& bracket : brackets)
+        {
+            CHECK(near(schedule.totalTax(bracket.first), referenceTax(brackets, bracket.first)));
+        }
+    }
+
+    BracketSchedule federal;
+    federal.compile(FEDERAL_SINGLE);
+    CHECK(near(federal.totalTax(50000.0), 1160.0 + 4266.0 + 627.0));
+    CHECK(near(federal.totalTax(-500.0), 0.0));
+}
+
+TEST(TaxBrackets, MarginalRateChangesAtEachThreshold)
+{
+    BracketSchedule schedule;
+    schedule.compile(FEDERAL_SINGLE);
+    CHECK(schedule.marginalRate(0.0) == 0.10);
+    CHECK(schedule.marginalRate(11599.99) == 0.10);
+    CHECK(schedule.marginalRate(11600.0) == 0.12);
+    CHECK(schedule.marginalRate(609350.0) == 0.37);
+    CHECK(schedule.marginalRate(1e9) == 0.37);
+    CHECK(schedule.marginalRate(-1.0) == 0.10);
+
+    BracketSchedule empty;
+    CHECK(empty.isEmpty());
+    CHECK(empty.totalTax(1000.0) == 0.0);
+    CHECK(empty.marginalRate(1000.0) == 0.0);
+}
+
+TEST(TaxBrackets, BatchFormsMatchSingleIncomes)
+{
+    BracketSchedule schedule;
+    schedule.compile(FEDERAL_SINGLE);
+    std::vector<double> incomes = {-10.0, 0.0, 11600.0, 47149.99, 250000.0, 2e6};
+    std::vector<double> taxes;
+    std::vector<double> rates;
+    schedule.totalTax(incomes, taxes);
+    schedule.marginalRate(incomes, rates);
+    REQUIRE(taxes.size() == incomes.size());
+    REQUIRE(rates.size() == incomes.size());
+    for (size_t i = 0; i < incomes.size(); i++)
+    {
+        CHECK(taxes[i] == schedule.totalTax(incomes[i]));
+        CHECK(rates[i] == schedule.marginalRate(incomes[i]));
+    }
+}
+
+TEST(TaxBrackets, TableFallsBackByYearAndFilingStatus)
+{
+    TestRunner::ScratchDir scratch;
+    TestRunner::writeFile(scratch.path("brackets.cfg"),
+        "# comment\n"
+        "[FEDERAL 2023 single]\n0 = 0.10\n"
+        "[FEDERAL 2025 single]\n0 = 0.20\n"
+        "[FEDERAL 2025 married_jointly]\n0 = 0.30\n"
+        "[CA 2024 single]\n0 = 0.01\n10000 = 0.02\nnot a bracket\n"
+        "[XX 2024 widowed]\n0 = 0.50\n"
+        "[NY 2024 single]\n");
+
+    TaxBracketTable table;
+    CHECK(!table.load(scratch.path("missing.cfg")));
+    REQUIRE(table.load(scratch.path("brackets.cfg")));
+    CHECK(table.getScheduleCount() == 4);
+
+    const BracketSchedule* schedule = table.find(TaxBracketTable::FEDERAL, 2024, FilingStatus::SINGLE);
+    REQUIRE(schedule != nullptr);
+    CHECK(schedule->marginalRate(1.0) == 0.10);     // Latest year at or before 2024
+    CHECK(table.find(TaxBracketTable::FEDERAL, 2030, FilingStatus::SINGLE)->marginalRate(1.0) == 0.20);
+    CHECK(table.find(TaxBracketTable::FEDERAL, 2000, FilingStatus::SINGLE)->marginalRate(1.0) == 0.10);
+    CHECK(table.find(TaxBracketTable::FEDERAL, 2025, FilingStatus::MARRIED_FILING_JOINTLY)->marginalRate(1.0) == 0.30);
+
+    // No schedule of its own: the single schedule for that year
+    CHECK(table.find(TaxBracketTable::FEDERAL, 2025, FilingStatus::HEAD_OF_HOUSEHOLD)->marginalRate(1.0) == 0.20);
+
+    // Malformed lines and unknown statuses are skipped; empty sections add nothing
+    CHECK(table.find("CA", 2024, FilingStatus::SINGLE)->getBracketCount() == 2);
+    CHECK(table.find("XX", 2024, FilingStatus::SINGLE) == nullptr);
+    CHECK(table.find("NY", 2024, FilingStatus::SINGLE) == nullptr);
+}
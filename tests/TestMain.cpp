@@ -0,0 +1,88 @@
+#include "TestRunner.h"
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    size_t failures = 0;
+    std::atomic<unsigned> scratchCount(0);
+}
+
+std::vector<TestRunner::TestCase>& TestRunner::registry()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void TestRunner::fail(const char* file, int line, const std::string& message)
+{
+    failures++;
+    std::cout << "    " << file << ":" << line << ": " << message << "\n";
+}
+
+TestRunner::ScratchDir::ScratchDir()
+{
+    root = std::filesystem::current_path() /
+           ("test-scratch-" + std::to_string(scratchCount++));
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+}
+
+TestRunner::ScratchDir::~ScratchDir()
+{
+    std::error_code error;
+    std::filesystem::remove_all(root, error);
+}
+
+std::string TestRunner::readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+void TestRunner::writeFile(const std::string& path, const std::string& contents)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+// Usage: gambling-tests [suite]; runs every suite without an argument
+int main(int argc, char* argv[])
+{
+    std::string only = argc > 1 ? argv[1] : "";
+    size_t run = 0;
+    size_t failed = 0;
+    for (const auto& test : TestRunner::registry())
+    {
+        if (!only.empty() && test.suite != only) continue;
+
+        std::cout << test.suite << "." << test.name << "\n";
+        size_t before = failures;
+        try
+        {
+            test.body();
+        }
+        catch (const TestRunner::RequireFailed&)
+        {
+        }
+        catch (const std::exception& e)
+        {
+            TestRunner::fail(__FILE__, __LINE__, std::string("unexpected exception: ") + e.what());
+        }
+        run++;
+        if (failures != before) failed++;
+    }
+
+    std::cout << run - failed << "/" << run << " tests passed\n";
+    if (run == 0)
+    {
+        std::cout << "No tests in suite " << only << "\n";
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
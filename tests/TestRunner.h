@@ -0,0 +1,82 @@
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal test harness for the gambling-tests executable. TEST(Suite, Name)
+// registers a test; ctest runs one suite per test entry (see CMakeLists.txt).
+// CHECK records a failure and carries on, REQUIRE ends the test.
+namespace TestRunner
+{
+    struct TestCase
+    {
+        std::string suite;
+        std::string name;
+        std::function<void()> body;
+    };
+
+    struct RequireFailed {};
+
+    std::vector<TestCase>& registry();
+    void fail(const char* file, int line, const std::string& message);
+
+    struct Registrar
+    {
+        Registrar(const char* suite, const char* name, void (*body)())
+        {
+            registry().push_back(TestCase{suite, name, body});
+        }
+    };
+
+    // A fresh directory under the working directory, removed with everything in it
+    class ScratchDir
+    {
+    public:
+        ScratchDir();
+        ~ScratchDir();
+
+        ScratchDir(const ScratchDir&) = delete;
+        ScratchDir& operator=(const ScratchDir&) = delete;
+
+        std::string path(const std::string& name) const { return (root / name).string(); }
+        std::string str() const { return root.string(); }
+
+    private:
+        std::filesystem::path root;
+    };
+
+    std::string readFile(const std::string& path);
+    void writeFile(const std::string& path, const std::string& contents);
+}
+
+#define TEST(suite, name)                                                                       \
+    static void suite##_##name();                                                               \
+    static TestRunner::Registrar suite##_##name##_registrar(#suite, #name, &suite##_##name);    \
+    static void suite##_##name()
+
+#define CHECK(condition)                                                                        \
+    do                                                                                          \
+    {                                                                                           \
+        if (!(condition)) TestRunner::fail(__FILE__, __LINE__, "CHECK(" #condition ")");         \
+    } while (0)
+
+#define REQUIRE(condition)                                                                      \
+    do                                                                                          \
+    {                                                                                           \
+        if (!(condition))                                                                       \
+        {                                                                                       \
+            TestRunner::fail(__FILE__, __LINE__, "REQUIRE(" #condition ")");                     \
+            throw TestRunner::RequireFailed();                                                  \
+        }                                                                                       \
+    } while (0)
+
+// Passes when the expression throws an exception derived from type
+#define CHECK_THROWS(type, expression)                                                          \
+    do                                                                                          \
+    {                                                                                           \
+        bool thrown = false;                                                                    \
+        try { expression; }                                                                     \
+        catch (const type&) { thrown = true; }                                                  \
+        if (!thrown) TestRunner::fail(__FILE__, __LINE__, "CHECK_THROWS(" #type ", " #expression ")"); \
+    } while (0)